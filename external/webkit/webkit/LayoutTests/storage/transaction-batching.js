@@ -0,0 +1,71 @@
+var transactionCount = 5;
+var failingTransaction = 3;
+var results = [];
+var completed = 0;
+
+function checkRows(db)
+{
+    db.readTransaction(function(tx) {
+        tx.executeSql("SELECT id FROM BatchTest ORDER BY id", [], function(tx, result) {
+            var ids = [];
+            for (var i = 0; i < result.rows.length; ++i)
+                ids.push(result.rows.item(i).id);
+            log("Rows in the database: " + ids.join(", "));
+        });
+    }, function(err) {
+        log("Reading the rows errored - " + err.message);
+        finishTest();
+    }, finishTest);
+}
+
+function finishTest()
+{
+    if (window.layoutTestController)
+        layoutTestController.notifyDone();
+}
+
+function transactionCompleted(db, index, result)
+{
+    results[index] = result;
+    if (++completed < transactionCount)
+        return;
+
+    // Deferred success callbacks run when their batch commits, so report
+    // them in queueing order.
+    for (var i = 1; i <= transactionCount; ++i)
+        log("Transaction " + i + " " + results[i]);
+    checkRows(db);
+}
+
+function queueTransaction(db, index)
+{
+    db.transaction(function(tx) {
+        tx.executeSql("INSERT INTO BatchTest VALUES (?)", [index]);
+        // A statement error without an error callback fails the whole
+        // transaction, which must only undo its own insert.
+        if (index == failingTransaction)
+            tx.executeSql("INSERT INTO NoSuchTable VALUES (?)", [index]);
+    }, function(err) {
+        transactionCompleted(db, index, "errored");
+    }, function() {
+        transactionCompleted(db, index, "succeeded");
+    });
+}
+
+function runTest()
+{
+    if (window.layoutTestController)
+        layoutTestController.overridePreference("WebKitDatabaseTransactionBatchingEnabled", true);
+
+    var db = openDatabaseWithSuffix("TransactionBatchingTest", "1.0", "Test that batched transactions keep their own outcome", 32768);
+    db.transaction(function(tx) {
+        tx.executeSql("DROP TABLE IF EXISTS BatchTest");
+        tx.executeSql("CREATE TABLE BatchTest (id INTEGER)");
+    }, function(err) {
+        log("Setup errored - " + err.message);
+        finishTest();
+    }, function() {
+        for (var i = 1; i <= transactionCount; ++i)
+            queueTransaction(db, i);
+    });
+}
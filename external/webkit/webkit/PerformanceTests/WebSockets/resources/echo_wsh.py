@@ -0,0 +1,13 @@
+from mod_pywebsocket import msgutil
+
+
+def web_socket_do_extra_handshake(request):
+    pass
+
+
+def web_socket_transfer_data(request):
+    while True:
+        message = msgutil.receive_message(request)
+        if message is None:
+            return
+        msgutil.send_message(request, message)
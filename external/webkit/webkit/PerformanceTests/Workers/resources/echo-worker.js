@@ -0,0 +1,9 @@
+// Sends every message straight back. ArrayBuffers that came in on the
+// transfer list go back on it too.
+onmessage = function(event) {
+    var message = event.data;
+    if (message.transfer)
+        postMessage(message, [message.buffer]);
+    else
+        postMessage(message);
+};
@@ -1391,8 +1391,14 @@ CodeBlock::CodeBlock(ScriptExecutable* ownerExecutable, CodeType codeType, JSGlo
 CodeBlock::~CodeBlock()
 {
 #if ENABLE(JIT)
-    for (size_t size = m_structureStubInfos.size(), i = 0; i < size; ++i)
+    for (size_t size = m_structureStubInfos.size(), i = 0; i < size; ++i) {
+#if ENABLE(JIT_PROPERTY_ACCESS_STATS)
+        StructureStubInfo& stubInfo = m_structureStubInfos[i];
+        if (stubInfo.hitCount || stubInfo.missCount)
+            printf("CodeBlock %p property access %u: %u megamorphic cache hits, %u misses\n", this, static_cast<unsigned>(i), stubInfo.hitCount, stubInfo.missCount);
+#endif
         m_structureStubInfos[i].deref();
+    }
 #endif // ENABLE(JIT)
 
 #if DUMP_CODE_BLOCK_STATISTICS
@@ -55,6 +55,10 @@ namespace JSC {
         StructureStubInfo(AccessType accessType)
             : accessType(accessType)
             , seen(false)
+#if ENABLE(JIT_PROPERTY_ACCESS_STATS)
+            , hitCount(0)
+            , missCount(0)
+#endif
         {
         }
 
@@ -164,6 +168,15 @@ namespace JSC {
         CodeLocationLabel stubRoutine;
         CodeLocationCall callReturnLocation;
         CodeLocationLabel hotPathBegin;
+
+#if ENABLE(JIT_PROPERTY_ACCESS_STATS)
+        // Accesses made after the site went megamorphic: hits were satisfied
+        // by the megamorphic property cache, misses needed a full property
+        // lookup. Accesses made while the inline cache was still being filled
+        // are not counted.
+        unsigned hitCount;
+        unsigned missCount;
+#endif
     };
 
 } // namespace JSC
@@ -77,6 +77,7 @@ void Heap::destroy()
 
 #if ENABLE(JIT)
     m_globalData->jitStubs->clearHostFunctionStubs();
+    m_globalData->jitStubs->megamorphicPropertyCache().clear();
 #endif
 
     delete m_markListSet;
@@ -394,6 +395,11 @@ void Heap::reset(SweepToggle sweepToggle)
     markRoots();
     m_handleHeap.finalizeWeakHandles();
 
+#if ENABLE(JIT)
+    // The megamorphic property cache holds unmarked Structure and JSObject pointers.
+    m_globalData->jitStubs->megamorphicPropertyCache().clear();
+#endif
+
     JAVASCRIPTCORE_GC_MARKED();
 
     m_markedSpace.reset();
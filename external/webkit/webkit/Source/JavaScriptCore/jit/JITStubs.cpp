@@ -801,6 +801,141 @@ JITThunks::~JITThunks()
 {
 }
 
+MegamorphicPropertyCache::MegamorphicPropertyCache()
+#if ENABLE(JIT_PROPERTY_ACCESS_STATS)
+    : m_hitCount(0)
+    , m_missCount(0)
+#endif
+{
+    clear();
+}
+
+MegamorphicPropertyCache::~MegamorphicPropertyCache()
+{
+#if ENABLE(JIT_PROPERTY_ACCESS_STATS)
+    printf("MegamorphicPropertyCache: %u hits, %u misses\n", m_hitCount, m_missCount);
+#endif
+}
+
+void MegamorphicPropertyCache::clear()
+{
+    for (unsigned i = 0; i < cacheSize; ++i) {
+        m_getEntries[i].structure = 0;
+        m_getEntries[i].propertyName = 0;
+        m_putEntries[i].structure = 0;
+        m_putEntries[i].propertyName = 0;
+    }
+}
+
+bool MegamorphicPropertyCache::get(JSValue baseValue, const Identifier& propertyName, JSValue& result)
+{
+    if (!baseValue.isCell())
+        return false;
+
+    Structure* structure = baseValue.asCell()->structure();
+    Entry& entry = m_getEntries[indexFor(structure, propertyName.impl())];
+    if (entry.structure != structure || entry.propertyName != propertyName.impl()) {
+#if ENABLE(JIT_PROPERTY_ACCESS_STATS)
+        ++m_missCount;
+#endif
+        return false;
+    }
+
+    // The base Structure pins down the prototype, but the prototype itself may have changed shape.
+    JSObject* slotBase = entry.prototype ? entry.prototype : asObject(baseValue);
+    if (entry.prototype && entry.prototype->structure() != entry.prototypeStructure) {
+#if ENABLE(JIT_PROPERTY_ACCESS_STATS)
+        ++m_missCount;
+#endif
+        return false;
+    }
+
+#if ENABLE(JIT_PROPERTY_ACCESS_STATS)
+    ++m_hitCount;
+#endif
+    result = slotBase->getDirectOffset(entry.offset);
+    return true;
+}
+
+void MegamorphicPropertyCache::addGet(CallFrame* callFrame, JSValue baseValue, const Identifier& propertyName, const PropertySlot& slot)
+{
+    if (!baseValue.isObject() || !slot.isCacheable() || slot.cachedPropertyType() != PropertySlot::Value)
+        return;
+
+    Structure* structure = baseValue.asCell()->structure();
+    if (structure->isDictionary())
+        return;
+
+    JSObject* prototype = 0;
+    Structure* prototypeStructure = 0;
+    if (slot.slotBase() != baseValue) {
+        // Only cache a single step up the prototype chain; longer chains are rare enough
+        // at megamorphic sites that validating them is not worth the extra loads.
+        if (slot.slotBase() != structure->prototypeForLookup(callFrame))
+            return;
+        prototype = asObject(slot.slotBase());
+        prototypeStructure = prototype->structure();
+        if (prototypeStructure->isDictionary())
+            return;
+    }
+
+    Entry& entry = m_getEntries[indexFor(structure, propertyName.impl())];
+    entry.structure = structure;
+    entry.propertyName = propertyName.impl();
+    entry.prototype = prototype;
+    entry.prototypeStructure = prototypeStructure;
+    entry.offset = slot.cachedOffset();
+}
+
+bool MegamorphicPropertyCache::put(JSGlobalData& globalData, JSValue baseValue, const Identifier& propertyName, JSValue value)
+{
+    if (!baseValue.isCell())
+        return false;
+
+    Structure* structure = baseValue.asCell()->structure();
+    Entry& entry = m_putEntries[indexFor(structure, propertyName.impl())];
+    if (entry.structure != structure || entry.propertyName != propertyName.impl()) {
+#if ENABLE(JIT_PROPERTY_ACCESS_STATS)
+        ++m_missCount;
+#endif
+        return false;
+    }
+
+#if ENABLE(JIT_PROPERTY_ACCESS_STATS)
+    ++m_hitCount;
+#endif
+    asObject(baseValue)->putDirectOffset(globalData, entry.offset, value);
+    return true;
+}
+
+void MegamorphicPropertyCache::addPut(JSGlobalData& globalData, JSValue baseValue, const Identifier& propertyName, const PutPropertySlot& slot)
+{
+    if (!baseValue.isCell() || !slot.isCacheable() || slot.type() != PutPropertySlot::ExistingProperty)
+        return;
+
+    JSCell* baseCell = baseValue.asCell();
+    if (baseCell != slot.base())
+        return;
+
+    Structure* structure = baseCell->structure();
+    if (structure->isDictionary())
+        return;
+
+    // Storing over a specific function value must despecify the Structure, which
+    // only the full put path knows how to do.
+    unsigned attributes;
+    JSCell* specificValue;
+    if (structure->get(globalData, propertyName, attributes, specificValue) == WTF::notFound || specificValue)
+        return;
+
+    Entry& entry = m_putEntries[indexFor(structure, propertyName.impl())];
+    entry.structure = structure;
+    entry.propertyName = propertyName.impl();
+    entry.prototype = 0;
+    entry.prototypeStructure = 0;
+    entry.offset = slot.cachedOffset();
+}
+
 #if ENABLE(JIT_OPTIMIZE_PROPERTY_ACCESS)
 
 NEVER_INLINE void JITThunks::tryCachePutByID(CallFrame* callFrame, CodeBlock* codeBlock, ReturnAddressPtr returnAddress, JSValue baseValue, const PutPropertySlot& slot, StructureStubInfo* stubInfo, bool direct)
@@ -1429,6 +1564,21 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_generic)
 
 #if ENABLE(JIT_OPTIMIZE_PROPERTY_ACCESS)
 
+static inline void countPropertyAccess(CodeBlock* codeBlock, ReturnAddressPtr returnAddress, bool hit)
+{
+#if ENABLE(JIT_PROPERTY_ACCESS_STATS)
+    StructureStubInfo& stubInfo = codeBlock->getStubInfo(returnAddress);
+    if (hit)
+        ++stubInfo.hitCount;
+    else
+        ++stubInfo.missCount;
+#else
+    UNUSED_PARAM(codeBlock);
+    UNUSED_PARAM(returnAddress);
+    UNUSED_PARAM(hit);
+#endif
+}
+
 DEFINE_STUB_FUNCTION(void, op_put_by_id)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
@@ -1493,6 +1643,29 @@ DEFINE_STUB_FUNCTION(void, op_put_by_id_direct_fail)
     CHECK_FOR_EXCEPTION_AT_END();
 }
 
+DEFINE_STUB_FUNCTION(void, op_put_by_id_megamorphic)
+{
+    STUB_INIT_STACK_FRAME(stackFrame);
+
+    CallFrame* callFrame = stackFrame.callFrame;
+    Identifier& ident = stackFrame.args[1].identifier();
+    JSValue baseValue = stackFrame.args[0].jsValue();
+    JSValue value = stackFrame.args[2].jsValue();
+
+    MegamorphicPropertyCache& cache = callFrame->globalData().jitStubs->megamorphicPropertyCache();
+    if (cache.put(callFrame->globalData(), baseValue, ident, value)) {
+        countPropertyAccess(callFrame->codeBlock(), STUB_RETURN_ADDRESS, true);
+        return;
+    }
+    countPropertyAccess(callFrame->codeBlock(), STUB_RETURN_ADDRESS, false);
+
+    PutPropertySlot slot(callFrame->codeBlock()->isStrictMode());
+    baseValue.put(callFrame, ident, value, slot);
+    CHECK_FOR_EXCEPTION_VOID();
+
+    cache.addPut(callFrame->globalData(), baseValue, ident, slot);
+}
+
 DEFINE_STUB_FUNCTION(JSObject*, op_put_by_id_transition_realloc)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
@@ -1602,6 +1775,30 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id)
     return JSValue::encode(result);
 }
 
+DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_megamorphic)
+{
+    STUB_INIT_STACK_FRAME(stackFrame);
+
+    CallFrame* callFrame = stackFrame.callFrame;
+    Identifier& ident = stackFrame.args[1].identifier();
+    JSValue baseValue = stackFrame.args[0].jsValue();
+
+    MegamorphicPropertyCache& cache = callFrame->globalData().jitStubs->megamorphicPropertyCache();
+    JSValue result;
+    if (cache.get(baseValue, ident, result)) {
+        countPropertyAccess(callFrame->codeBlock(), STUB_RETURN_ADDRESS, true);
+        return JSValue::encode(result);
+    }
+    countPropertyAccess(callFrame->codeBlock(), STUB_RETURN_ADDRESS, false);
+
+    PropertySlot slot(baseValue);
+    result = baseValue.get(callFrame, ident, slot);
+    CHECK_FOR_EXCEPTION();
+
+    cache.addGet(callFrame, baseValue, ident, slot);
+    return JSValue::encode(result);
+}
+
 DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_self_fail)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
@@ -1641,7 +1838,7 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_self_fail)
             JIT::compileGetByIdSelfList(callFrame->scopeChain()->globalData, codeBlock, stubInfo, polymorphicStructureList, listIndex, baseValue.asCell()->structure(), ident, slot, slot.cachedOffset());
 
             if (listIndex == (POLYMORPHIC_LIST_CACHE_SIZE - 1))
-                ctiPatchCallByReturnAddress(codeBlock, STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_id_generic));
+                ctiPatchCallByReturnAddress(codeBlock, STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_id_megamorphic));
         }
     } else
         ctiPatchCallByReturnAddress(callFrame->codeBlock(), STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_id_generic));
@@ -1753,7 +1950,7 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_proto_list)
             JIT::compileGetByIdProtoList(callFrame->scopeChain()->globalData, callFrame, codeBlock, stubInfo, prototypeStructureList, listIndex, structure, slotBaseObject->structure(), propertyName, slot, offset);
 
             if (listIndex == (POLYMORPHIC_LIST_CACHE_SIZE - 1))
-                ctiPatchCallByReturnAddress(codeBlock, STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_id_proto_list_full));
+                ctiPatchCallByReturnAddress(codeBlock, STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_id_megamorphic));
         }
     } else if (size_t count = normalizePrototypeChain(callFrame, baseValue, slot.slotBase(), propertyName, offset)) {
         ASSERT(!baseValue.asCell()->structure()->isDictionary());
@@ -1765,7 +1962,7 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_proto_list)
             JIT::compileGetByIdChainList(callFrame->scopeChain()->globalData, callFrame, codeBlock, stubInfo, prototypeStructureList, listIndex, structure, protoChain, count, propertyName, slot, offset);
 
             if (listIndex == (POLYMORPHIC_LIST_CACHE_SIZE - 1))
-                ctiPatchCallByReturnAddress(codeBlock, STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_id_proto_list_full));
+                ctiPatchCallByReturnAddress(codeBlock, STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_id_megamorphic));
         }
     } else
         ctiPatchCallByReturnAddress(codeBlock, STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_id_proto_fail));
@@ -1773,18 +1970,6 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_proto_list)
     return JSValue::encode(result);
 }
 
-DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_proto_list_full)
-{
-    STUB_INIT_STACK_FRAME(stackFrame);
-
-    JSValue baseValue = stackFrame.args[0].jsValue();
-    PropertySlot slot(baseValue);
-    JSValue result = baseValue.get(stackFrame.callFrame, stackFrame.args[1].identifier(), slot);
-
-    CHECK_FOR_EXCEPTION_AT_END();
-    return JSValue::encode(result);
-}
-
 DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_proto_fail)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
@@ -35,6 +35,7 @@
 #include "Register.h"
 #include "ThunkGenerators.h"
 #include <wtf/HashMap.h>
+#include <wtf/text/StringImpl.h>
 
 #if ENABLE(JIT)
 
@@ -58,6 +59,7 @@ namespace JSC {
     class PutPropertySlot;
     class RegisterFile;
     class RegExp;
+    class Structure;
 
     union JITStubArg {
         void* asPointer;
@@ -277,6 +279,50 @@ namespace JSC {
 
     template <typename T> class Strong;
 
+    // Direct-mapped cache of (Structure, property name) -> storage offset, shared by every
+    // property access site in a JSGlobalData. Sites whose polymorphic inline caches have
+    // overflowed consult it before falling back to a full property lookup. Entries hold
+    // raw cell pointers, so the heap clears the cache at the start of every collection.
+    class MegamorphicPropertyCache {
+        WTF_MAKE_NONCOPYABLE(MegamorphicPropertyCache);
+    public:
+        MegamorphicPropertyCache();
+        ~MegamorphicPropertyCache();
+
+        bool get(JSValue baseValue, const Identifier& propertyName, JSValue& result);
+        void addGet(CallFrame*, JSValue baseValue, const Identifier& propertyName, const PropertySlot&);
+
+        bool put(JSGlobalData&, JSValue baseValue, const Identifier& propertyName, JSValue);
+        void addPut(JSGlobalData&, JSValue baseValue, const Identifier& propertyName, const PutPropertySlot&);
+
+        void clear();
+
+    private:
+        static const unsigned cacheSize = 512;
+
+        struct Entry {
+            Structure* structure;
+            RefPtr<StringImpl> propertyName;
+            // Non-zero when the property was found one step up the prototype chain.
+            JSObject* prototype;
+            Structure* prototypeStructure;
+            size_t offset;
+        };
+
+        static unsigned indexFor(Structure* structure, StringImpl* propertyName)
+        {
+            return ((reinterpret_cast<uintptr_t>(structure) >> 4) ^ propertyName->existingHash()) & (cacheSize - 1);
+        }
+
+        Entry m_getEntries[cacheSize];
+        Entry m_putEntries[cacheSize];
+
+#if ENABLE(JIT_PROPERTY_ACCESS_STATS)
+        unsigned m_hitCount;
+        unsigned m_missCount;
+#endif
+    };
+
     class JITThunks {
     public:
         JITThunks(JSGlobalData*);
@@ -301,6 +347,8 @@ namespace JSC {
 
         void clearHostFunctionStubs();
 
+        MegamorphicPropertyCache& megamorphicPropertyCache() { return m_megamorphicPropertyCache; }
+
     private:
         typedef HashMap<ThunkGenerator, MacroAssemblerCodePtr> CTIStubMap;
         CTIStubMap m_ctiStubMap;
@@ -309,6 +357,7 @@ namespace JSC {
         RefPtr<ExecutablePool> m_executablePool;
 
         TrampolineStructure m_trampolineStructure;
+        MegamorphicPropertyCache m_megamorphicPropertyCache;
     };
 
 extern "C" {
@@ -333,10 +382,10 @@ extern "C" {
     EncodedJSValue JIT_STUB cti_op_get_by_id_custom_stub(STUB_ARGS_DECLARATION);
     EncodedJSValue JIT_STUB cti_op_get_by_id_generic(STUB_ARGS_DECLARATION);
     EncodedJSValue JIT_STUB cti_op_get_by_id_getter_stub(STUB_ARGS_DECLARATION);
+    EncodedJSValue JIT_STUB cti_op_get_by_id_megamorphic(STUB_ARGS_DECLARATION);
     EncodedJSValue JIT_STUB cti_op_get_by_id_method_check(STUB_ARGS_DECLARATION);
     EncodedJSValue JIT_STUB cti_op_get_by_id_proto_fail(STUB_ARGS_DECLARATION);
     EncodedJSValue JIT_STUB cti_op_get_by_id_proto_list(STUB_ARGS_DECLARATION);
-    EncodedJSValue JIT_STUB cti_op_get_by_id_proto_list_full(STUB_ARGS_DECLARATION);
     EncodedJSValue JIT_STUB cti_op_get_by_id_self_fail(STUB_ARGS_DECLARATION);
     EncodedJSValue JIT_STUB cti_op_get_by_id_string_fail(STUB_ARGS_DECLARATION);
     EncodedJSValue JIT_STUB cti_op_get_by_val(STUB_ARGS_DECLARATION);
@@ -408,6 +457,7 @@ extern "C" {
     void JIT_STUB cti_op_put_by_id(STUB_ARGS_DECLARATION);
     void JIT_STUB cti_op_put_by_id_fail(STUB_ARGS_DECLARATION);
     void JIT_STUB cti_op_put_by_id_generic(STUB_ARGS_DECLARATION);
+    void JIT_STUB cti_op_put_by_id_megamorphic(STUB_ARGS_DECLARATION);
     void JIT_STUB cti_op_put_by_id_direct(STUB_ARGS_DECLARATION);
     void JIT_STUB cti_op_put_by_id_direct_fail(STUB_ARGS_DECLARATION);
     void JIT_STUB cti_op_put_by_id_direct_generic(STUB_ARGS_DECLARATION);
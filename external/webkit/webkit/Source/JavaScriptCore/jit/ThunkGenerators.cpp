@@ -44,6 +44,8 @@ static void stringCharLoad(SpecializedThunkJIT& jit)
     jit.load32(MacroAssembler::Address(SpecializedThunkJIT::regT0, ThunkHelpers::jsStringLengthOffset()), SpecializedThunkJIT::regT2);
     jit.loadPtr(MacroAssembler::Address(SpecializedThunkJIT::regT0, ThunkHelpers::jsStringValueOffset()), SpecializedThunkJIT::regT0);
     jit.loadPtr(MacroAssembler::Address(SpecializedThunkJIT::regT0, ThunkHelpers::stringImplDataOffset()), SpecializedThunkJIT::regT0);
+    // 8-bit strings have no UTF-16 buffer until one is requested; take the slow path.
+    jit.appendFailure(jit.branchTestPtr(MacroAssembler::Zero, SpecializedThunkJIT::regT0));
 
     // load index
     jit.loadInt32Argument(0, SpecializedThunkJIT::regT1); // regT1 contains the index
@@ -203,6 +203,9 @@ static bool tryDFGCompile(JSGlobalData* globalData, CodeBlock* codeBlock, JITCod
     if (codeBlock->numberOfJumpTargets() || codeBlock->numberOfStructureStubInfos())
         return false;
 #endif
+    // FIXME: DFG code is only ever entered at the start of a function, and
+    // calls are never inlined. Entering it at loop headers needs a baseline
+    // tier to enter from, which means tiering up from the baseline JIT first.
 
     DFG::Graph dfg;
     if (!parse(dfg, globalData, codeBlock))
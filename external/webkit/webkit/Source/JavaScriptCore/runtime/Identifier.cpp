@@ -39,20 +39,20 @@ namespace JSC {
 
 IdentifierTable::~IdentifierTable()
 {
-    HashSet<StringImpl*>::iterator end = m_table.end();
-    for (HashSet<StringImpl*>::iterator iter = m_table.begin(); iter != end; ++iter)
+    StringSet::iterator end = m_table.end();
+    for (StringSet::iterator iter = m_table.begin(); iter != end; ++iter)
         (*iter)->setIsIdentifier(false);
 }
-std::pair<HashSet<StringImpl*>::iterator, bool> IdentifierTable::add(StringImpl* value)
+std::pair<IdentifierTable::StringSet::iterator, bool> IdentifierTable::add(StringImpl* value)
 {
-    std::pair<HashSet<StringImpl*>::iterator, bool> result = m_table.add(value);
+    std::pair<StringSet::iterator, bool> result = m_table.add(value);
     (*result.first)->setIsIdentifier(true);
     return result;
 }
 template<typename U, typename V>
-std::pair<HashSet<StringImpl*>::iterator, bool> IdentifierTable::add(U value)
+std::pair<IdentifierTable::StringSet::iterator, bool> IdentifierTable::add(U value)
 {
-    std::pair<HashSet<StringImpl*>::iterator, bool> result = m_table.add<U, V>(value);
+    std::pair<StringSet::iterator, bool> result = m_table.add<U, V>(value);
     (*result.first)->setIsIdentifier(true);
     return result;
 }
@@ -127,7 +127,7 @@ PassRefPtr<StringImpl> Identifier::add(JSGlobalData* globalData, const char* c)
     if (iter != literalIdentifierTable.end())
         return iter->second;
 
-    pair<HashSet<StringImpl*>::iterator, bool> addResult = identifierTable.add<const char*, IdentifierCStringTranslator>(c);
+    pair<IdentifierTable::StringSet::iterator, bool> addResult = identifierTable.add<const char*, IdentifierCStringTranslator>(c);
 
     // If the string is newly-translated, then we need to adopt it.
     // The boolean in the pair tells us if that is so.
@@ -223,7 +223,7 @@ PassRefPtr<StringImpl> Identifier::add(JSGlobalData* globalData, const UChar* s,
     if (!length)
         return StringImpl::empty();
     UCharBuffer buf = {s, length}; 
-    pair<HashSet<StringImpl*>::iterator, bool> addResult = globalData->identifierTable->add<UCharBuffer, IdentifierUCharBufferTranslator>(buf);
+    pair<IdentifierTable::StringSet::iterator, bool> addResult = globalData->identifierTable->add<UCharBuffer, IdentifierUCharBufferTranslator>(buf);
 
     // If the string is newly-translated, then we need to adopt it.
     // The boolean in the pair tells us if that is so.
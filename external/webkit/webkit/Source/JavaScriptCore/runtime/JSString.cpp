@@ -214,9 +214,23 @@ JSValue JSString::replaceCharacter(ExecState* exec, UChar character, const UStri
     return JSValue(new (globalData) JSString(globalData, builder.release()));
 }
 
+// Short ropes are searched fiber by fiber rather than flattened, since walking a few
+// fibers is cheaper than copying the whole string when only one character is needed.
 JSString* JSString::getIndexSlowCase(ExecState* exec, unsigned i)
 {
     ASSERT(isRope());
+
+    unsigned fiberCount = 0;
+    unsigned fiberEnd = 0;
+    RopeIterator end;
+    for (RopeIterator it(m_other.m_fibers.data(), m_fiberCount); it != end && ++fiberCount <= substringFromRopeCutoff; ++it) {
+        StringImpl* fiberString = *it;
+        unsigned fiberStart = fiberEnd;
+        fiberEnd = fiberStart + fiberString->length();
+        if (i < fiberEnd)
+            return jsSingleCharacterSubstring(exec, UString(fiberString), i - fiberStart);
+    }
+
     resolveRope(exec);
     // Return a safe no-value result, this should never be used, since the excetion will be thrown.
     if (exec->exception())
@@ -226,6 +240,35 @@ JSString* JSString::getIndexSlowCase(ExecState* exec, unsigned i)
     return jsSingleCharacterSubstring(exec, m_value, i);
 }
 
+size_t JSString::find(ExecState* exec, UChar character, unsigned start)
+{
+    if (!isRope())
+        return m_value.find(character, start);
+
+    unsigned fiberCount = 0;
+    unsigned fiberEnd = 0;
+    RopeIterator end;
+    for (RopeIterator it(m_other.m_fibers.data(), m_fiberCount); it != end; ++it) {
+        if (++fiberCount > substringFromRopeCutoff)
+            break;
+        StringImpl* fiberString = *it;
+        unsigned fiberStart = fiberEnd;
+        fiberEnd = fiberStart + fiberString->length();
+        if (start >= fiberEnd)
+            continue;
+        size_t position = fiberString->find(character, start > fiberStart ? start - fiberStart : 0);
+        if (position != notFound)
+            return fiberStart + position;
+    }
+    if (fiberCount <= substringFromRopeCutoff)
+        return notFound;
+
+    resolveRope(exec);
+    if (exec->exception())
+        return notFound;
+    return m_value.find(character, start);
+}
+
 JSValue JSString::toPrimitive(ExecState*, PreferredPrimitiveType) const
 {
     return const_cast<JSString*>(this);
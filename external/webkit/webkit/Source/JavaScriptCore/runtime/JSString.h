@@ -347,6 +347,8 @@ namespace JSC {
         JSString* getIndex(ExecState*, unsigned);
         JSString* getIndexSlowCase(ExecState*, unsigned);
 
+        size_t find(ExecState*, UChar, unsigned start);
+
         JSValue replaceCharacter(ExecState*, UChar, const UString& replacement);
 
         static Structure* createStructure(JSGlobalData& globalData, JSValue proto) { return Structure::create(globalData, proto, TypeInfo(StringType, OverridesGetOwnPropertySlot | NeedsThisConversion), AnonymousSlotCount, 0); }
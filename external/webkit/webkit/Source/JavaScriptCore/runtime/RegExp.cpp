@@ -66,11 +66,31 @@ RegExpFlags regExpFlags(const UString& string)
     return flags;
 }
   
+// The longest subject string whose last match is remembered, see RegExpRepresentation.
+static const unsigned maximumLastMatchStringLength = 16 * 1024;
+
 struct RegExpRepresentation {
+    RegExpRepresentation()
+        : m_lastMatchStart(-1)
+        , m_lastMatchResult(-1)
+    {
+    }
+
 #if ENABLE(YARR_JIT)
     Yarr::YarrCodeBlock m_regExpJITCode;
 #endif
     OwnPtr<Yarr::BytecodePattern> m_regExpBytecode;
+
+    // The result of the most recent match. Callers such as String.prototype.replace
+    // and split commonly rematch the same string from the same offset (e.g. test()
+    // followed by exec() or replace()), so this lets us skip the rescan. Holding a
+    // reference to the subject keeps its StringImpl, and so its characters, unchanged.
+    // It also keeps the subject alive for as long as the RegExp lives, so only short
+    // subjects that do not share a longer string's buffer are remembered.
+    RefPtr<StringImpl> m_lastMatchString;
+    int m_lastMatchStart;
+    int m_lastMatchResult;
+    Vector<int> m_lastMatchOffsetVector;
 };
 
 inline RegExp::RegExp(JSGlobalData* globalData, const UString& patternString, RegExpFlags flags)
@@ -111,7 +131,7 @@ RegExp::RegExpState RegExp::compile(JSGlobalData* globalData)
     RegExpState res = ByteCode;
 
 #if ENABLE(YARR_JIT)
-    if (!pattern.m_containsBackreferences && globalData->canUseJIT()) {
+    if (globalData->canUseJIT()) {
         Yarr::jitCompile(pattern, globalData, m_representation->m_regExpJITCode);
 #if ENABLE(YARR_JIT_DEBUG)
         if (!m_representation->m_regExpJITCode.isFallBack())
@@ -144,6 +164,15 @@ int RegExp::match(const UString& s, int startOffset, Vector<int, 32>* ovector)
 
     if (m_state != ParseError) {
         int offsetVectorSize = (m_numSubpatterns + 1) * 2;
+
+        if (m_representation->m_lastMatchString == s.impl() && m_representation->m_lastMatchStart == startOffset) {
+            if (ovector) {
+                ovector->resize(offsetVectorSize);
+                memcpy(ovector->data(), m_representation->m_lastMatchOffsetVector.data(), offsetVectorSize * sizeof(int));
+            }
+            return m_representation->m_lastMatchResult;
+        }
+
         int* offsetVector;
         Vector<int, 32> nonReturnedOvector;
         if (ovector) {
@@ -173,6 +202,15 @@ int RegExp::match(const UString& s, int startOffset, Vector<int, 32>* ovector)
             result = Yarr::interpret(m_representation->m_regExpBytecode.get(), s.characters(), startOffset, s.length(), offsetVector);
         ASSERT(result >= -1);
 
+        if (s.length() <= maximumLastMatchStringLength && !s.impl()->isSubstring()) {
+            m_representation->m_lastMatchString = s.impl();
+            m_representation->m_lastMatchStart = startOffset;
+            m_representation->m_lastMatchResult = result;
+            m_representation->m_lastMatchOffsetVector.resize(offsetVectorSize);
+            memcpy(m_representation->m_lastMatchOffsetVector.data(), offsetVector, offsetVectorSize * sizeof(int));
+        } else
+            m_representation->m_lastMatchString = 0;
+
 #if ENABLE(REGEXP_TRACING)
         if (result != -1)
             m_rtMatchFoundCount++;
@@ -65,6 +65,9 @@ class StructureTransitionTable {
 
         static const bool needsDestruction = FirstTraits::needsDestruction || SecondTraits::needsDestruction;
 
+        // Transitions for the same property name hash alike, so control bytes would not tell them apart.
+        static const bool usesControlBytes = false;
+
         static void constructDeletedValue(TraitType& slot) { FirstTraits::constructDeletedValue(slot.first); }
         static bool isDeletedValue(const TraitType& value) { return FirstTraits::isDeletedValue(value.first); }
     };
@@ -107,6 +107,25 @@ inline int atomicDecrement(int volatile* addend) { return __gnu_cxx::__exchange_
 
 #endif
 
+// Stores newValue at location if it still holds expectedValue, with a full memory barrier.
+// Returns whether the store happened.
+#if OS(WINDOWS)
+#define WTF_USE_LOCKFREE_COMPARE_AND_SWAP 1
+
+inline bool atomicCompareAndSwap(void* volatile* location, void* expectedValue, void* newValue) { return InterlockedCompareExchangePointer(location, newValue, expectedValue) == expectedValue; }
+
+#elif OS(DARWIN)
+#define WTF_USE_LOCKFREE_COMPARE_AND_SWAP 1
+
+inline bool atomicCompareAndSwap(void* volatile* location, void* expectedValue, void* newValue) { return OSAtomicCompareAndSwapPtrBarrier(expectedValue, newValue, location); }
+
+#elif COMPILER(GCC) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 1))) && !OS(SYMBIAN)
+#define WTF_USE_LOCKFREE_COMPARE_AND_SWAP 1
+
+inline bool atomicCompareAndSwap(void* volatile* location, void* expectedValue, void* newValue) { return __sync_bool_compare_and_swap(location, expectedValue, newValue); }
+
+#endif
+
 } // namespace WTF
 
 #if USE(LOCKFREE_THREADSAFEREFCOUNTED)
@@ -114,4 +133,8 @@ using WTF::atomicDecrement;
 using WTF::atomicIncrement;
 #endif
 
+#if USE(LOCKFREE_COMPARE_AND_SWAP)
+using WTF::atomicCompareAndSwap;
+#endif
+
 #endif // Atomics_h
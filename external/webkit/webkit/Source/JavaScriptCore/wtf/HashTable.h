@@ -25,9 +25,14 @@
 #include "FastMalloc.h"
 #include "HashTraits.h"
 #include "ValueCheck.h"
+#include <string.h>
 #include <wtf/Assertions.h>
 #include <wtf/Threading.h>
 
+#if CPU(X86_SSE2) && COMPILER(GCC)
+#include <emmintrin.h>
+#endif
+
 namespace WTF {
 
 #define DUMP_HASHTABLE_STATS 0
@@ -283,6 +288,94 @@ namespace WTF {
         static void translate(Value& location, const Key&, const Value& value) { location = value; }
     };
 
+    // Tables whose key traits set usesControlBytes keep a control byte for each bucket, stored after the
+    // buckets in the same allocation. A full bucket's control byte holds 7 bits of its key's hash; empty and
+    // deleted buckets have markers with the high bit set. Buckets are probed in aligned groups, quadratically
+    // from group to group. The control bytes of a group are compared all at once, so a lookup only looks at
+    // the keys whose hash bits match, and stops at the first group with an empty bucket.
+    static const unsigned char emptyControlByte = 0x80;
+    static const unsigned char deletedControlByte = 0xFE;
+
+    static inline unsigned char controlByteForHash(unsigned h)
+    {
+        // The low bits of the hash pick the group; use high ones here, but not the top bit, which string hashes
+        // leave clear.
+        return (h >> 24) & 0x7F;
+    }
+
+#if CPU(X86_SSE2) && COMPILER(GCC)
+
+    class ControlByteGroup {
+    public:
+        static const unsigned width = 16;
+        typedef unsigned MatchMask;
+
+        explicit ControlByteGroup(const unsigned char* controlBytes)
+            : m_controlBytes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(controlBytes)))
+        {
+        }
+
+        MatchMask match(unsigned char controlByte) const { return _mm_movemask_epi8(_mm_cmpeq_epi8(m_controlBytes, _mm_set1_epi8(controlByte))); }
+        MatchMask matchEmpty() const { return match(emptyControlByte); }
+        // Only the empty and deleted markers have the high bit set.
+        MatchMask matchEmptyOrDeleted() const { return _mm_movemask_epi8(m_controlBytes); }
+
+        static unsigned firstIndex(MatchMask mask) { return __builtin_ctz(mask); }
+        static MatchMask removeFirst(MatchMask mask) { return mask & (mask - 1); }
+
+    private:
+        __m128i m_controlBytes;
+    };
+
+#else
+
+    // Compares the 8 control bytes of a group held in a 64-bit word. A match sets the high bit of the byte.
+    class ControlByteGroup {
+    public:
+        static const unsigned width = 8;
+        typedef uint64_t MatchMask;
+
+        explicit ControlByteGroup(const unsigned char* controlBytes)
+        {
+            memcpy(&m_controlBytes, controlBytes, sizeof(m_controlBytes));
+#if CPU(BIG_ENDIAN)
+            // Put the first control byte in the low bits, as on little endian CPUs.
+            uint64_t swapped = 0;
+            for (unsigned i = 0; i < width; ++i)
+                swapped |= ((m_controlBytes >> (i * 8)) & 0xFF) << ((width - 1 - i) * 8);
+            m_controlBytes = swapped;
+#endif
+        }
+
+        MatchMask match(unsigned char controlByte) const
+        {
+            uint64_t lowBits = 0x7F7F7F7F7F7F7F7FULL;
+            uint64_t difference = m_controlBytes ^ (0x0101010101010101ULL * controlByte);
+            // Exact, unlike the usual borrow based test: no carry crosses a byte here.
+            return ~(((difference & lowBits) + lowBits) | difference | lowBits);
+        }
+        MatchMask matchEmpty() const { return match(emptyControlByte); }
+        MatchMask matchEmptyOrDeleted() const { return m_controlBytes & 0x8080808080808080ULL; }
+
+        static unsigned firstIndex(MatchMask mask)
+        {
+#if COMPILER(GCC)
+            return __builtin_ctzll(mask) >> 3;
+#else
+            unsigned index = 0;
+            while (!(mask & (0x80ULL << (index * 8))))
+                ++index;
+            return index;
+#endif
+        }
+        static MatchMask removeFirst(MatchMask mask) { return mask & (mask - 1); }
+
+    private:
+        uint64_t m_controlBytes;
+    };
+
+#endif
+
     template<typename Key, typename Value, typename Extractor, typename HashFunctions, typename Traits, typename KeyTraits>
     class HashTable {
     public:
@@ -369,6 +462,14 @@ namespace WTF {
         template<typename T, typename HashTranslator> FullLookupType fullLookupForWriting(const T&);
         template<typename T, typename HashTranslator> LookupType lookupForWriting(const T&);
 
+        static const bool usesControlBytes = KeyTraits::usesControlBytes;
+        unsigned char* controlBytes() const { return reinterpret_cast<unsigned char*>(m_table + m_tableSize); }
+        void setControlByte(ValueType* entry, unsigned char controlByte) { controlBytes()[entry - m_table] = controlByte; }
+        unsigned firstProbedGroup(unsigned h) const { return h & m_tableSizeMask & ~(ControlByteGroup::width - 1); }
+        template<typename T, typename HashTranslator> ValueType* lookupUsingControlBytes(const T&, unsigned h);
+        template<typename T, typename HashTranslator> LookupType lookupForWritingUsingControlBytes(const T&, unsigned h);
+        ValueType* emptyBucketUsingControlBytes(unsigned h);
+
         template<typename T, typename HashTranslator> void checkKey(const T&);
 
         void removeAndInvalidateWithoutEntryConsistencyCheck(ValueType*);
@@ -489,6 +590,9 @@ namespace WTF {
         if (!table)
             return 0;
 
+        if (usesControlBytes)
+            return lookupUsingControlBytes<T, HashTranslator>(key, h);
+
 #if DUMP_HASHTABLE_STATS
         atomicIncrement(&HashTableStats::numAccesses);
         int probeCount = 0;
@@ -534,6 +638,9 @@ namespace WTF {
         unsigned h = HashTranslator::hash(key);
         int i = h & sizeMask;
 
+        if (usesControlBytes)
+            return lookupForWritingUsingControlBytes<T, HashTranslator>(key, h);
+
 #if DUMP_HASHTABLE_STATS
         atomicIncrement(&HashTableStats::numAccesses);
         int probeCount = 0;
@@ -586,6 +693,11 @@ namespace WTF {
         unsigned h = HashTranslator::hash(key);
         int i = h & sizeMask;
 
+        if (usesControlBytes) {
+            LookupType lookupResult = lookupForWritingUsingControlBytes<T, HashTranslator>(key, h);
+            return makeLookupResult(lookupResult.first, lookupResult.second, h);
+        }
+
 #if DUMP_HASHTABLE_STATS
         atomicIncrement(&HashTableStats::numAccesses);
         int probeCount = 0;
@@ -646,42 +758,51 @@ namespace WTF {
         unsigned h = HashTranslator::hash(key);
         int i = h & sizeMask;
 
+        ValueType* deletedEntry = 0;
+        ValueType* entry;
+        if (usesControlBytes) {
+            LookupType lookupResult = lookupForWritingUsingControlBytes<T, HashTranslator>(key, h);
+            if (lookupResult.second)
+                return std::make_pair(makeKnownGoodIterator(lookupResult.first), false);
+            entry = lookupResult.first;
+            if (isDeletedBucket(*entry))
+                deletedEntry = entry;
+        } else {
 #if DUMP_HASHTABLE_STATS
-        atomicIncrement(&HashTableStats::numAccesses);
-        int probeCount = 0;
+            atomicIncrement(&HashTableStats::numAccesses);
+            int probeCount = 0;
 #endif
 
-        ValueType* deletedEntry = 0;
-        ValueType* entry;
-        while (1) {
-            entry = table + i;
+            while (1) {
+                entry = table + i;
             
-            // we count on the compiler to optimize out this branch
-            if (HashFunctions::safeToCompareToEmptyOrDeleted) {
-                if (isEmptyBucket(*entry))
-                    break;
+                // we count on the compiler to optimize out this branch
+                if (HashFunctions::safeToCompareToEmptyOrDeleted) {
+                    if (isEmptyBucket(*entry))
+                        break;
                 
-                if (HashTranslator::equal(Extractor::extract(*entry), key))
-                    return std::make_pair(makeKnownGoodIterator(entry), false);
+                    if (HashTranslator::equal(Extractor::extract(*entry), key))
+                        return std::make_pair(makeKnownGoodIterator(entry), false);
                 
-                if (isDeletedBucket(*entry))
-                    deletedEntry = entry;
-            } else {
-                if (isEmptyBucket(*entry))
-                    break;
+                    if (isDeletedBucket(*entry))
+                        deletedEntry = entry;
+                } else {
+                    if (isEmptyBucket(*entry))
+                        break;
             
-                if (isDeletedBucket(*entry))
-                    deletedEntry = entry;
-                else if (HashTranslator::equal(Extractor::extract(*entry), key))
-                    return std::make_pair(makeKnownGoodIterator(entry), false);
-            }
+                    if (isDeletedBucket(*entry))
+                        deletedEntry = entry;
+                    else if (HashTranslator::equal(Extractor::extract(*entry), key))
+                        return std::make_pair(makeKnownGoodIterator(entry), false);
+                }
 #if DUMP_HASHTABLE_STATS
-            ++probeCount;
-            HashTableStats::recordCollisionAtCount(probeCount);
+                ++probeCount;
+                HashTableStats::recordCollisionAtCount(probeCount);
 #endif
-            if (k == 0)
-                k = 1 | doubleHash(h);
-            i = (i + k) & sizeMask;
+                if (k == 0)
+                    k = 1 | doubleHash(h);
+                i = (i + k) & sizeMask;
+            }
         }
 
         if (deletedEntry) {
@@ -691,6 +812,8 @@ namespace WTF {
         }
 
         HashTranslator::translate(*entry, key, extra);
+        if (usesControlBytes)
+            setControlByte(entry, controlByteForHash(h));
 
         ++m_keyCount;
         
@@ -738,6 +861,8 @@ namespace WTF {
         }
         
         HashTranslator::translate(*entry, key, extra, h);
+        if (usesControlBytes)
+            setControlByte(entry, controlByteForHash(h));
         ++m_keyCount;
         if (shouldExpand()) {
             // FIXME: This makes an extra copy on expand. Probably not that bad since
@@ -765,9 +890,112 @@ namespace WTF {
         atomicIncrement(&HashTableStats::numReinserts);
 #endif
 
+        if (usesControlBytes) {
+            // The new table holds neither deleted buckets nor a key equal to this one, so the first empty bucket
+            // will do, and no key needs to be compared.
+            unsigned h = HashFunctions::hash(Extractor::extract(entry));
+            ValueType* newEntry = emptyBucketUsingControlBytes(h);
+            setControlByte(newEntry, controlByteForHash(h));
+            Mover<ValueType, Traits::needsDestruction>::move(entry, *newEntry);
+            return;
+        }
+
         Mover<ValueType, Traits::needsDestruction>::move(entry, *lookupForWriting(Extractor::extract(entry)).first);
     }
 
+    template<typename Key, typename Value, typename Extractor, typename HashFunctions, typename Traits, typename KeyTraits>
+    template<typename T, typename HashTranslator>
+    inline Value* HashTable<Key, Value, Extractor, HashFunctions, Traits, KeyTraits>::lookupUsingControlBytes(const T& key, unsigned h)
+    {
+        ValueType* table = m_table;
+        const unsigned char* controlBytes = this->controlBytes();
+        unsigned char controlByte = controlByteForHash(h);
+        unsigned sizeMask = m_tableSizeMask;
+        unsigned position = firstProbedGroup(h);
+        unsigned step = 0;
+
+#if DUMP_HASHTABLE_STATS
+        atomicIncrement(&HashTableStats::numAccesses);
+        int probeCount = 0;
+#endif
+
+        while (1) {
+            ControlByteGroup group(controlBytes + position);
+            for (ControlByteGroup::MatchMask match = group.match(controlByte); match; match = ControlByteGroup::removeFirst(match)) {
+                ValueType* entry = table + position + ControlByteGroup::firstIndex(match);
+                if (HashTranslator::equal(Extractor::extract(*entry), key))
+                    return entry;
+            }
+            if (group.matchEmpty())
+                return 0;
+#if DUMP_HASHTABLE_STATS
+            ++probeCount;
+            HashTableStats::recordCollisionAtCount(probeCount);
+#endif
+            step += ControlByteGroup::width;
+            position = (position + step) & sizeMask;
+        }
+    }
+
+    template<typename Key, typename Value, typename Extractor, typename HashFunctions, typename Traits, typename KeyTraits>
+    template<typename T, typename HashTranslator>
+    inline typename HashTable<Key, Value, Extractor, HashFunctions, Traits, KeyTraits>::LookupType HashTable<Key, Value, Extractor, HashFunctions, Traits, KeyTraits>::lookupForWritingUsingControlBytes(const T& key, unsigned h)
+    {
+        ASSERT(m_table);
+
+        ValueType* table = m_table;
+        const unsigned char* controlBytes = this->controlBytes();
+        unsigned char controlByte = controlByteForHash(h);
+        unsigned sizeMask = m_tableSizeMask;
+        unsigned position = firstProbedGroup(h);
+        unsigned step = 0;
+
+#if DUMP_HASHTABLE_STATS
+        atomicIncrement(&HashTableStats::numAccesses);
+        int probeCount = 0;
+#endif
+
+        // The first empty or deleted bucket on the way, to be used if the key is not found.
+        ValueType* availableEntry = 0;
+
+        while (1) {
+            ControlByteGroup group(controlBytes + position);
+            for (ControlByteGroup::MatchMask match = group.match(controlByte); match; match = ControlByteGroup::removeFirst(match)) {
+                ValueType* entry = table + position + ControlByteGroup::firstIndex(match);
+                if (HashTranslator::equal(Extractor::extract(*entry), key))
+                    return LookupType(entry, true);
+            }
+            if (!availableEntry) {
+                if (ControlByteGroup::MatchMask available = group.matchEmptyOrDeleted())
+                    availableEntry = table + position + ControlByteGroup::firstIndex(available);
+            }
+            if (group.matchEmpty())
+                return LookupType(availableEntry, false);
+#if DUMP_HASHTABLE_STATS
+            ++probeCount;
+            HashTableStats::recordCollisionAtCount(probeCount);
+#endif
+            step += ControlByteGroup::width;
+            position = (position + step) & sizeMask;
+        }
+    }
+
+    template<typename Key, typename Value, typename Extractor, typename HashFunctions, typename Traits, typename KeyTraits>
+    inline Value* HashTable<Key, Value, Extractor, HashFunctions, Traits, KeyTraits>::emptyBucketUsingControlBytes(unsigned h)
+    {
+        const unsigned char* controlBytes = this->controlBytes();
+        unsigned sizeMask = m_tableSizeMask;
+        unsigned position = firstProbedGroup(h);
+        unsigned step = 0;
+
+        while (1) {
+            if (ControlByteGroup::MatchMask empty = ControlByteGroup(controlBytes + position).matchEmpty())
+                return m_table + position + ControlByteGroup::firstIndex(empty);
+            step += ControlByteGroup::width;
+            position = (position + step) & sizeMask;
+        }
+    }
+
     template<typename Key, typename Value, typename Extractor, typename HashFunctions, typename Traits, typename KeyTraits>
     template <typename T, typename HashTranslator> 
     typename HashTable<Key, Value, Extractor, HashFunctions, Traits, KeyTraits>::iterator HashTable<Key, Value, Extractor, HashFunctions, Traits, KeyTraits>::find(const T& key)
@@ -828,8 +1056,19 @@ namespace WTF {
         atomicIncrement(&HashTableStats::numRemoves);
 #endif
 
-        deleteBucket(*pos);
-        ++m_deletedCount;
+        // Once a group has no empty bucket, it gets one back only by a rehash. So if the group still has one, no
+        // lookup has ever gone past it, and the bucket can be emptied rather than marked deleted.
+        unsigned groupPosition = static_cast<unsigned>(pos - m_table) & ~(ControlByteGroup::width - 1);
+        if (usesControlBytes && ControlByteGroup(controlBytes() + groupPosition).matchEmpty()) {
+            pos->~ValueType();
+            initializeBucket(*pos);
+            setControlByte(pos, emptyControlByte);
+        } else {
+            deleteBucket(*pos);
+            if (usesControlBytes)
+                setControlByte(pos, deletedControlByte);
+            ++m_deletedCount;
+        }
         --m_keyCount;
 
         if (shouldShrink())
@@ -874,13 +1113,22 @@ namespace WTF {
     template<typename Key, typename Value, typename Extractor, typename HashFunctions, typename Traits, typename KeyTraits>
     Value* HashTable<Key, Value, Extractor, HashFunctions, Traits, KeyTraits>::allocateTable(int size)
     {
+        size_t allocationSize = size * sizeof(ValueType);
+        if (usesControlBytes)
+            allocationSize += size;
+
         // would use a template member function with explicit specializations here, but
         // gcc doesn't appear to support that
+        ValueType* result;
         if (Traits::emptyValueIsZero)
-            return static_cast<ValueType*>(fastZeroedMalloc(size * sizeof(ValueType)));
-        ValueType* result = static_cast<ValueType*>(fastMalloc(size * sizeof(ValueType)));
-        for (int i = 0; i < size; i++)
-            initializeBucket(result[i]);
+            result = static_cast<ValueType*>(fastZeroedMalloc(allocationSize));
+        else {
+            result = static_cast<ValueType*>(fastMalloc(allocationSize));
+            for (int i = 0; i < size; i++)
+                initializeBucket(result[i]);
+        }
+        if (usesControlBytes)
+            memset(result + size, emptyControlByte, size);
         return result;
     }
 
@@ -1022,14 +1270,18 @@ namespace WTF {
         int deletedCount = 0;
         for (int j = 0; j < m_tableSize; ++j) {
             ValueType* entry = m_table + j;
-            if (isEmptyBucket(*entry))
+            if (isEmptyBucket(*entry)) {
+                ASSERT(!usesControlBytes || controlBytes()[j] == emptyControlByte);
                 continue;
+            }
 
             if (isDeletedBucket(*entry)) {
+                ASSERT(!usesControlBytes || controlBytes()[j] == deletedControlByte);
                 ++deletedCount;
                 continue;
             }
 
+            ASSERT(!usesControlBytes || controlBytes()[j] == controlByteForHash(HashFunctions::hash(Extractor::extract(*entry))));
             const_iterator it = find(Extractor::extract(*entry));
             ASSERT(entry == it.m_position);
             ++count;
@@ -40,12 +40,14 @@ namespace WTF {
     template<typename T> struct GenericHashTraitsBase<false, T> {
         static const bool emptyValueIsZero = false;
         static const bool needsDestruction = true;
+        static const bool usesControlBytes = false;
     };
 
     // Default integer traits disallow both 0 and -1 as keys (max value instead of -1 for unsigned).
     template<typename T> struct GenericHashTraitsBase<true, T> {
         static const bool emptyValueIsZero = true;
         static const bool needsDestruction = false;
+        static const bool usesControlBytes = false;
         static void constructDeletedValue(T& slot) { slot = static_cast<T>(-1); }
         static bool isDeletedValue(T value) { return value == static_cast<T>(-1); }
     };
@@ -92,6 +94,13 @@ namespace WTF {
     template<typename P> struct HashTraits<RefPtr<P> > : SimpleClassHashTraits<RefPtr<P> > { };
     template<> struct HashTraits<String> : SimpleClassHashTraits<String> { };
 
+    // Key traits that make a table keep a control byte for each bucket and probe groups of buckets at once,
+    // see HashTable.h. Costs a byte per bucket; worth it for large, hot tables, especially ones whose keys
+    // are expensive to compare.
+    template<typename Traits> struct ControlByteHashTraits : Traits {
+        static const bool usesControlBytes = true;
+    };
+
     // special traits for pairs, helpful for their use in HashMap implementation
 
     template<typename FirstTraitsArg, typename SecondTraitsArg>
@@ -114,6 +123,7 @@ namespace WTF {
 
 } // namespace WTF
 
+using WTF::ControlByteHashTraits;
 using WTF::HashTraits;
 using WTF::PairHashTraits;
 
@@ -225,6 +225,12 @@
 #define WTF_CPU_X86_64 1
 #endif
 
+/* CPU(X86_SSE2) - SSE2 instructions can be used without a runtime check */
+#if (CPU(X86) || CPU(X86_64)) \
+    && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define WTF_CPU_X86_SSE2 1
+#endif
+
 /* CPU(ARM) - ARM, any version*/
 #if   defined(arm) \
     || defined(__arm__) \
@@ -1060,6 +1066,10 @@
 #define ENABLE_OPCODE_STATS 0
 #endif
 
+#if !defined(ENABLE_JIT_PROPERTY_ACCESS_STATS)
+#define ENABLE_JIT_PROPERTY_ACCESS_STATS 0
+#endif
+
 #if !defined(ENABLE_GLOBAL_FASTMALLOC_NEW)
 #define ENABLE_GLOBAL_FASTMALLOC_NEW 1
 #endif
@@ -76,7 +76,7 @@ public:
         result += result >> 15;
         result ^= result << 10;
 
-        // First bit is used in UStringImpl for m_isIdentifier.
+        // The top bit is used by StringImpl to flag 8-bit strings.
         result &= 0x7fffffff;
 
         // This avoids ever returning a hash code of 0, since that is used to
@@ -158,6 +158,11 @@ private:
         return static_cast<unsigned char>(ch);
     }
 
+    static inline UChar defaultCoverter(LChar ch)
+    {
+        return ch;
+    }
+
     inline void addCharactersToHash(UChar a, UChar b)
     {
         m_hash += a;
@@ -55,15 +55,18 @@ typedef HashMap<const char*, RefPtr<StringImpl>, PtrHash<const char*> > LiteralI
 class IdentifierTable {
     WTF_MAKE_FAST_ALLOCATED;
 public:
+    // Like the atomic string table, found by characters and big enough to be worth probing with control bytes.
+    typedef HashSet<StringImpl*, StringHash, ControlByteHashTraits<HashTraits<StringImpl*> > > StringSet;
+
     ~IdentifierTable();
 
-    std::pair<HashSet<StringImpl*>::iterator, bool> add(StringImpl* value);
+    std::pair<StringSet::iterator, bool> add(StringImpl* value);
     template<typename U, typename V>
-    std::pair<HashSet<StringImpl*>::iterator, bool> add(U value);
+    std::pair<StringSet::iterator, bool> add(U value);
 
     bool remove(StringImpl* r)
     {
-        HashSet<StringImpl*>::iterator iter = m_table.find(r);
+        StringSet::iterator iter = m_table.find(r);
         if (iter == m_table.end())
             return false;
         m_table.remove(iter);
@@ -73,7 +76,7 @@ public:
     LiteralIdentifierTable& literalTable() { return m_literalTable; }
 
 private:
-    HashSet<StringImpl*> m_table;
+    StringSet m_table;
     LiteralIdentifierTable m_literalTable;
 };
 
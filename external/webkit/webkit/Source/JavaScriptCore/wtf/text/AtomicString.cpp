@@ -35,6 +35,10 @@ using namespace Unicode;
 
 COMPILE_ASSERT(sizeof(AtomicString) == sizeof(String), atomic_string_and_string_must_be_same_size);
 
+// Adding and finding atomic strings compares characters, so keep control bytes to avoid looking at strings
+// whose hash does not match.
+typedef HashSet<StringImpl*, StringHash, ControlByteHashTraits<HashTraits<StringImpl*> > > AtomicStringSet;
+
 class AtomicStringTable {
 public:
     static AtomicStringTable* create()
@@ -48,7 +52,7 @@ public:
         return table;
     }
 
-    HashSet<StringImpl*>& table()
+    AtomicStringSet& table()
     {
         return m_table;
     }
@@ -56,16 +60,16 @@ public:
 private:
     static void destroy(AtomicStringTable* table)
     {
-        HashSet<StringImpl*>::iterator end = table->m_table.end();
-        for (HashSet<StringImpl*>::iterator iter = table->m_table.begin(); iter != end; ++iter)
+        AtomicStringSet::iterator end = table->m_table.end();
+        for (AtomicStringSet::iterator iter = table->m_table.begin(); iter != end; ++iter)
             (*iter)->setIsAtomic(false);
         delete table;
     }
 
-    HashSet<StringImpl*> m_table;
+    AtomicStringSet m_table;
 };
 
-static inline HashSet<StringImpl*>& stringTable()
+static inline AtomicStringSet& stringTable()
 {
     // Once possible we should make this non-lazy (constructed in WTFThreadData's constructor).
     AtomicStringTable* table = wtfThreadData().atomicStringTable();
@@ -77,7 +81,7 @@ static inline HashSet<StringImpl*>& stringTable()
 template<typename T, typename HashTranslator>
 static inline PassRefPtr<StringImpl> addToStringTable(const T& value)
 {
-    pair<HashSet<StringImpl*>::iterator, bool> addResult = stringTable().add<T, HashTranslator>(value);
+    pair<AtomicStringSet::iterator, bool> addResult = stringTable().add<T, HashTranslator>(value);
 
     // If the string is newly-translated, then we need to adopt it.
     // The boolean in the pair tells us if that is so.
@@ -93,6 +97,14 @@ struct CStringTranslator {
     static bool equal(StringImpl* r, const char* s)
     {
         int length = r->length();
+        if (r->is8Bit()) {
+            const LChar* d = r->characters8();
+            for (int i = 0; i != length; ++i) {
+                if (d[i] != static_cast<LChar>(s[i]) || !s[i])
+                    return false;
+            }
+            return !s[length];
+        }
         const UChar* d = r->characters();
         for (int i = 0; i != length; ++i) {
             unsigned char c = s[i];
@@ -104,7 +116,7 @@ struct CStringTranslator {
 
     static void translate(StringImpl*& location, const char* const& c, unsigned hash)
     {
-        location = StringImpl::create(c).leakRef();
+        location = StringImpl::create(reinterpret_cast<const LChar*>(c), strlen(c)).leakRef();
         location->setHash(hash);
         location->setIsAtomic(true);
     }
@@ -113,9 +125,9 @@ struct CStringTranslator {
 bool operator==(const AtomicString& a, const char* b)
 { 
     StringImpl* impl = a.impl();
-    if ((!impl || !impl->characters()) && !b)
+    if (!impl && !b)
         return true;
-    if ((!impl || !impl->characters()) || !b)
+    if (!impl || !b)
         return false;
     return CStringTranslator::equal(impl, b); 
 }
@@ -140,6 +152,9 @@ static inline bool equal(StringImpl* string, const UChar* characters, unsigned l
     if (string->length() != length)
         return false;
 
+    if (string->is8Bit())
+        return WTF::equal(string->characters8(), characters, length);
+
     // FIXME: perhaps we should have a more abstract macro that indicates when
     // going 4 bytes at a time is unsafe
 #if CPU(ARM) || CPU(SH4) || CPU(MIPS) || CPU(SPARC)
@@ -186,7 +201,7 @@ struct UCharBufferTranslator {
 
     static void translate(StringImpl*& location, const UCharBuffer& buf, unsigned hash)
     {
-        location = StringImpl::create(buf.s, buf.length).leakRef();
+        location = StringImpl::create8BitIfPossible(buf.s, buf.length).leakRef();
         location->setHash(hash);
         location->setIsAtomic(true);
     }
@@ -212,7 +227,7 @@ struct HashAndCharactersTranslator {
 
     static void translate(StringImpl*& location, const HashAndCharacters& buffer, unsigned hash)
     {
-        location = StringImpl::create(buffer.characters, buffer.length).leakRef();
+        location = StringImpl::create8BitIfPossible(buffer.characters, buffer.length).leakRef();
         location->setHash(hash);
         location->setIsAtomic(true);
     }
@@ -236,9 +251,15 @@ struct HashAndUTF8CharactersTranslator {
         if (buffer.utf16Length != string->length())
             return false;
 
+        // If buffer contains only ASCII characters UTF-8 and UTF16 length are the same.
+        if (string->is8Bit()) {
+            if (buffer.utf16Length != buffer.length)
+                return false;
+            return !memcmp(string->characters8(), buffer.characters, buffer.length);
+        }
+
         const UChar* stringCharacters = string->characters();
 
-        // If buffer contains only ASCII characters UTF-8 and UTF16 length are the same.
         if (buffer.utf16Length != buffer.length)
             return equalUTF16WithUTF8(stringCharacters, stringCharacters + string->length(), buffer.characters, buffer.characters + buffer.length);
 
@@ -253,6 +274,15 @@ struct HashAndUTF8CharactersTranslator {
 
     static void translate(StringImpl*& location, const HashAndUTF8Characters& buffer, unsigned hash)
     {
+        if (buffer.utf16Length == buffer.length) {
+            LChar* data;
+            location = StringImpl::createUninitialized(buffer.length, data).leakRef();
+            memcpy(data, buffer.characters, buffer.length);
+            location->setHash(hash);
+            location->setIsAtomic(true);
+            return;
+        }
+
         UChar* target;
         location = StringImpl::createUninitialized(buffer.utf16Length, target).releaseRef();
 
@@ -328,7 +358,7 @@ AtomicStringImpl* AtomicString::find(const UChar* s, unsigned length, unsigned e
         return static_cast<AtomicStringImpl*>(StringImpl::empty());
 
     HashAndCharacters buffer = { existingHash, s, length }; 
-    HashSet<StringImpl*>::iterator iterator = stringTable().find<HashAndCharacters, HashAndCharactersTranslator>(buffer);
+    AtomicStringSet::iterator iterator = stringTable().find<HashAndCharacters, HashAndCharactersTranslator>(buffer);
     if (iterator == stringTable().end())
         return 0;
     return static_cast<AtomicStringImpl*>(*iterator);
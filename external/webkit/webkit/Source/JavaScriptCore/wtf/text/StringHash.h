@@ -53,6 +53,15 @@ namespace WTF {
             if (aLength != bLength)
                 return false;
 
+            // Compare 8-bit strings without creating their UTF-16 buffers.
+            if (a->is8Bit()) {
+                if (b->is8Bit())
+                    return !memcmp(a->characters8(), b->characters8(), aLength);
+                return WTF::equal(a->characters8(), b->characters(), aLength);
+            }
+            if (b->is8Bit())
+                return WTF::equal(b->characters8(), a->characters(), aLength);
+
             // FIXME: perhaps we should have a more abstract macro that indicates when
             // going 4 bytes at a time is unsafe
 #if CPU(ARM) || CPU(SH4) || CPU(MIPS)
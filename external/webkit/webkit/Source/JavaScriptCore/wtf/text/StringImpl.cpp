@@ -28,15 +28,332 @@
 #include "AtomicString.h"
 #include "StringBuffer.h"
 #include "StringHash.h"
+#include <wtf/Atomics.h>
 #include <wtf/StdLibExtras.h>
+#include <wtf/Threading.h>
 #include <wtf/WTFThreadData.h>
 
+#if CPU(X86_SSE2) && COMPILER(GCC)
+#include <emmintrin.h>
+#endif
+
 using namespace std;
 
 namespace WTF {
 
 using namespace Unicode;
 
+#if CPU(X86_SSE2) && COMPILER(GCC)
+
+// The searches below compare a vector of characters at a time: sixteen LChars or eight UChars.
+// _mm_movemask_epi8 produces one bit per byte, so the lane of a set bit is the bit index
+// shifted right by laneShift.
+template <typename CharType> struct CharacterLanes;
+
+template <> struct CharacterLanes<LChar> {
+    static const unsigned count = sizeof(__m128i);
+    static const unsigned laneShift = 0;
+    static __m128i splat(UChar character) { return _mm_set1_epi8(static_cast<char>(character)); }
+    static __m128i compare(__m128i a, __m128i b) { return _mm_cmpeq_epi8(a, b); }
+};
+
+template <> struct CharacterLanes<UChar> {
+    static const unsigned count = sizeof(__m128i) / sizeof(UChar);
+    static const unsigned laneShift = 1;
+    static __m128i splat(UChar character) { return _mm_set1_epi16(character); }
+    static __m128i compare(__m128i a, __m128i b) { return _mm_cmpeq_epi16(a, b); }
+};
+
+static inline __m128i loadCharacters(const void* characters)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(characters));
+}
+
+template <typename CharType>
+static inline unsigned matchMask(const CharType* characters, __m128i match)
+{
+    return _mm_movemask_epi8(CharacterLanes<CharType>::compare(loadCharacters(characters), match));
+}
+
+template <typename CharType>
+static inline unsigned clearLane(unsigned mask, unsigned lane)
+{
+    return mask & ~(((1u << sizeof(CharType)) - 1) << (lane << CharacterLanes<CharType>::laneShift));
+}
+
+// An LChar string cannot contain a character above 0xFF, and splatting one would truncate it.
+template <typename CharType>
+static inline bool canContain(UChar character)
+{
+    return sizeof(CharType) == sizeof(UChar) || character <= 0xFF;
+}
+
+template <typename CharType>
+static size_t findCharacter(const CharType* characters, unsigned length, UChar matchCharacter, unsigned index)
+{
+    typedef CharacterLanes<CharType> Lanes;
+
+    // Keeps index + Lanes::count from wrapping around for a start index near UINT_MAX.
+    if (index >= length || !canContain<CharType>(matchCharacter))
+        return notFound;
+
+    __m128i match = Lanes::splat(matchCharacter);
+    for (; index + Lanes::count <= length; index += Lanes::count) {
+        if (unsigned mask = matchMask(characters + index, match))
+            return index + (__builtin_ctz(mask) >> Lanes::laneShift);
+    }
+    for (; index < length; ++index) {
+        if (characters[index] == matchCharacter)
+            return index;
+    }
+    return notFound;
+}
+
+template <typename CharType>
+static size_t reverseFindCharacter(const CharType* characters, unsigned length, UChar matchCharacter, unsigned index)
+{
+    typedef CharacterLanes<CharType> Lanes;
+
+    if (!length || !canContain<CharType>(matchCharacter))
+        return notFound;
+    if (index >= length)
+        index = length - 1;
+
+    // 'end' is one past the last character still to be examined.
+    unsigned end = index + 1;
+    __m128i match = Lanes::splat(matchCharacter);
+    for (; end >= Lanes::count; end -= Lanes::count) {
+        if (unsigned mask = matchMask(characters + end - Lanes::count, match))
+            return end - Lanes::count + ((31 - __builtin_clz(mask)) >> Lanes::laneShift);
+    }
+    while (end) {
+        if (characters[--end] == matchCharacter)
+            return end;
+    }
+    return notFound;
+}
+
+static inline bool equalCharacters(const LChar* a, const LChar* b, unsigned length)
+{
+    unsigned i = 0;
+    for (; i + sizeof(__m128i) <= length; i += sizeof(__m128i)) {
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(loadCharacters(a + i), loadCharacters(b + i))) != 0xFFFF)
+            return false;
+    }
+    for (; i < length; ++i) {
+        if (a[i] != b[i])
+            return false;
+    }
+    return true;
+}
+
+static inline bool equalCharacters(const UChar* a, const UChar* b, unsigned length)
+{
+    unsigned i = 0;
+    for (; i + CharacterLanes<UChar>::count <= length; i += CharacterLanes<UChar>::count) {
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(loadCharacters(a + i), loadCharacters(b + i))) != 0xFFFF)
+            return false;
+    }
+    for (; i < length; ++i) {
+        if (a[i] != b[i])
+            return false;
+    }
+    return true;
+}
+
+// Widens eight LChars at a time to compare them with UChars.
+static inline bool equalCharacters(const LChar* a, const UChar* b, unsigned length)
+{
+    unsigned i = 0;
+    __m128i zero = _mm_setzero_si128();
+    for (; i + CharacterLanes<UChar>::count <= length; i += CharacterLanes<UChar>::count) {
+        __m128i wide = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(a + i)), zero);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(wide, loadCharacters(b + i))) != 0xFFFF)
+            return false;
+    }
+    for (; i < length; ++i) {
+        if (a[i] != b[i])
+            return false;
+    }
+    return true;
+}
+
+static inline bool equalCharacters(const UChar* a, const LChar* b, unsigned length)
+{
+    return equalCharacters(b, a, length);
+}
+
+// Returns the offset of the first occurrence of match within searchCharacters[0, delta + matchLength),
+// or notFound. Candidates are filtered by comparing both the first and the last character of the
+// match, which rejects most false positives before comparing the characters in between.
+template <typename SearchChar, typename MatchChar>
+static size_t findSubstring(const SearchChar* searchCharacters, unsigned delta, const MatchChar* matchCharacters, unsigned matchLength)
+{
+    typedef CharacterLanes<SearchChar> Lanes;
+
+    ASSERT(matchLength > 1);
+    unsigned lastOffset = matchLength - 1;
+    if (!canContain<SearchChar>(matchCharacters[0]) || !canContain<SearchChar>(matchCharacters[lastOffset]))
+        return notFound;
+    __m128i first = Lanes::splat(matchCharacters[0]);
+    __m128i last = Lanes::splat(matchCharacters[lastOffset]);
+
+    unsigned i = 0;
+    for (; i + Lanes::count <= delta + 1; i += Lanes::count) {
+        unsigned mask = matchMask(searchCharacters + i, first) & matchMask(searchCharacters + i + lastOffset, last);
+        while (mask) {
+            unsigned lane = __builtin_ctz(mask) >> Lanes::laneShift;
+            unsigned candidate = i + lane;
+            if (equalCharacters(searchCharacters + candidate + 1, matchCharacters + 1, matchLength - 2))
+                return candidate;
+            mask = clearLane<SearchChar>(mask, lane);
+        }
+    }
+    for (; i <= delta; ++i) {
+        if (searchCharacters[i] == matchCharacters[0] && searchCharacters[i + lastOffset] == matchCharacters[lastOffset]
+            && equalCharacters(searchCharacters + i + 1, matchCharacters + 1, matchLength - 2))
+            return i;
+    }
+    return notFound;
+}
+
+// As findSubstring, but returns the last occurrence starting at or before delta.
+template <typename SearchChar, typename MatchChar>
+static size_t reverseFindSubstring(const SearchChar* searchCharacters, unsigned delta, const MatchChar* matchCharacters, unsigned matchLength)
+{
+    typedef CharacterLanes<SearchChar> Lanes;
+
+    ASSERT(matchLength > 1);
+    unsigned lastOffset = matchLength - 1;
+    if (!canContain<SearchChar>(matchCharacters[0]) || !canContain<SearchChar>(matchCharacters[lastOffset]))
+        return notFound;
+    __m128i first = Lanes::splat(matchCharacters[0]);
+    __m128i last = Lanes::splat(matchCharacters[lastOffset]);
+
+    // 'end' is one past the last candidate offset still to be examined.
+    unsigned end = delta + 1;
+    for (; end >= Lanes::count; end -= Lanes::count) {
+        unsigned start = end - Lanes::count;
+        unsigned mask = matchMask(searchCharacters + start, first) & matchMask(searchCharacters + start + lastOffset, last);
+        while (mask) {
+            unsigned lane = (31 - __builtin_clz(mask)) >> Lanes::laneShift;
+            unsigned candidate = start + lane;
+            if (equalCharacters(searchCharacters + candidate + 1, matchCharacters + 1, matchLength - 2))
+                return candidate;
+            mask = clearLane<SearchChar>(mask, lane);
+        }
+    }
+    while (end) {
+        --end;
+        if (searchCharacters[end] == matchCharacters[0] && searchCharacters[end + lastOffset] == matchCharacters[lastOffset]
+            && equalCharacters(searchCharacters + end + 1, matchCharacters + 1, matchLength - 2))
+            return end;
+    }
+    return notFound;
+}
+
+#else
+
+template <typename CharType>
+static inline size_t findCharacter(const CharType* characters, unsigned length, UChar matchCharacter, unsigned index)
+{
+    for (; index < length; ++index) {
+        if (characters[index] == matchCharacter)
+            return index;
+    }
+    return notFound;
+}
+
+template <typename CharType>
+static inline size_t reverseFindCharacter(const CharType* characters, unsigned length, UChar matchCharacter, unsigned index)
+{
+    if (!length)
+        return notFound;
+    if (index >= length)
+        index = length - 1;
+    while (characters[index] != matchCharacter) {
+        if (!index--)
+            return notFound;
+    }
+    return index;
+}
+
+template <typename A, typename B>
+static inline bool equalCharacters(const A* a, const B* b, unsigned length)
+{
+    for (unsigned i = 0; i < length; ++i) {
+        if (a[i] != b[i])
+            return false;
+    }
+    return true;
+}
+
+template <typename SearchChar, typename MatchChar>
+static size_t findSubstring(const SearchChar* searchCharacters, unsigned delta, const MatchChar* matchCharacters, unsigned matchLength)
+{
+    // Optimization 2: keep a running hash of the strings,
+    // only compare the characters if the hashes match.
+    unsigned searchHash = 0;
+    unsigned matchHash = 0;
+    for (unsigned i = 0; i < matchLength; ++i) {
+        searchHash += searchCharacters[i];
+        matchHash += matchCharacters[i];
+    }
+
+    unsigned i = 0;
+    // keep looping until we match
+    while (searchHash != matchHash || !equalCharacters(searchCharacters + i, matchCharacters, matchLength)) {
+        if (i == delta)
+            return notFound;
+        searchHash += searchCharacters[i + matchLength];
+        searchHash -= searchCharacters[i];
+        ++i;
+    }
+    return i;
+}
+
+template <typename SearchChar, typename MatchChar>
+static size_t reverseFindSubstring(const SearchChar* searchCharacters, unsigned delta, const MatchChar* matchCharacters, unsigned matchLength)
+{
+    // Optimization 2: keep a running hash of the strings,
+    // only compare the characters if the hashes match.
+    unsigned searchHash = 0;
+    unsigned matchHash = 0;
+    for (unsigned i = 0; i < matchLength; ++i) {
+        searchHash += searchCharacters[delta + i];
+        matchHash += matchCharacters[i];
+    }
+
+    // keep looping until we match
+    while (searchHash != matchHash || !equalCharacters(searchCharacters + delta, matchCharacters, matchLength)) {
+        if (!delta)
+            return notFound;
+        delta--;
+        searchHash -= searchCharacters[delta + matchLength];
+        searchHash += searchCharacters[delta];
+    }
+    return delta;
+}
+
+#endif
+
+// Dispatch on the width of the string being looked for, so that neither string needs a UTF-16 copy.
+template <typename SearchChar>
+static inline size_t findSubstring(const SearchChar* searchCharacters, unsigned delta, const StringImpl* matchString)
+{
+    if (matchString->is8Bit())
+        return findSubstring(searchCharacters, delta, matchString->characters8(), matchString->length());
+    return findSubstring(searchCharacters, delta, matchString->characters16(), matchString->length());
+}
+
+template <typename SearchChar>
+static inline size_t reverseFindSubstring(const SearchChar* searchCharacters, unsigned delta, const StringImpl* matchString)
+{
+    if (matchString->is8Bit())
+        return reverseFindSubstring(searchCharacters, delta, matchString->characters8(), matchString->length());
+    return reverseFindSubstring(searchCharacters, delta, matchString->characters16(), matchString->length());
+}
+
 static const unsigned minLengthToShare = 20;
 
 COMPILE_ASSERT(sizeof(StringImpl) == 2 * sizeof(int) + 3 * sizeof(void*), StringImpl_should_stay_small);
@@ -55,7 +372,11 @@ StringImpl::~StringImpl()
 #endif
 
     BufferOwnership ownership = bufferOwnership();
-    if (ownership != BufferInternal) {
+    if (ownership == BufferInternal) {
+        // The UTF-16 copy of an 8-bit string is allocated separately.
+        if (is8Bit() && m_data)
+            fastFree(const_cast<UChar*>(m_data));
+    } else {
         if (ownership == BufferOwned) {
             ASSERT(!m_sharedBuffer);
             ASSERT(m_data);
@@ -90,6 +411,78 @@ PassRefPtr<StringImpl> StringImpl::createUninitialized(unsigned length, UChar*&
     return adoptRef(new (string) StringImpl(length));
 }
 
+PassRefPtr<StringImpl> StringImpl::createUninitialized(unsigned length, LChar*& data)
+{
+    if (!length) {
+        data = 0;
+        return empty();
+    }
+
+    if (length > ((std::numeric_limits<unsigned>::max() - sizeof(StringImpl)) / sizeof(LChar)))
+        CRASH();
+    size_t size = sizeof(StringImpl) + length * sizeof(LChar);
+    StringImpl* string = static_cast<StringImpl*>(fastMalloc(size));
+
+    data = reinterpret_cast<LChar*>(string + 1);
+    return adoptRef(new (string) StringImpl(length, Force8BitConstructor));
+}
+
+PassRefPtr<StringImpl> StringImpl::create(const LChar* characters, unsigned length)
+{
+    if (!characters || !length)
+        return empty();
+
+    LChar* data;
+    RefPtr<StringImpl> string = createUninitialized(length, data);
+    memcpy(data, characters, length * sizeof(LChar));
+    return string.release();
+}
+
+PassRefPtr<StringImpl> StringImpl::create8BitIfPossible(const UChar* characters, unsigned length)
+{
+    if (!characters || !length)
+        return empty();
+
+    for (unsigned i = 0; i < length; ++i) {
+        if (characters[i] > 0xFF)
+            return create(characters, length);
+    }
+
+    LChar* data;
+    RefPtr<StringImpl> string = createUninitialized(length, data);
+    for (unsigned i = 0; i < length; ++i)
+        data[i] = static_cast<LChar>(characters[i]);
+    return string.release();
+}
+
+const UChar* StringImpl::upconvertCharacters() const
+{
+    ASSERT(is8Bit());
+    ASSERT(!m_data);
+
+    const LChar* source = characters8();
+    UChar* data = static_cast<UChar*>(fastMalloc(m_length * sizeof(UChar)));
+    for (unsigned i = 0; i < m_length; ++i)
+        data[i] = source[i];
+
+#if USE(LOCKFREE_COMPARE_AND_SWAP)
+    // Another thread holding the same string may have upconverted it first. Keep
+    // whichever copy was published first, so no reader ever sees a copy freed.
+    if (!atomicCompareAndSwap(reinterpret_cast<void* volatile*>(const_cast<UChar**>(&m_data)), 0, data)) {
+        fastFree(data);
+        ASSERT(m_data);
+    }
+#else
+    AtomicallyInitializedStatic(Mutex&, upconvertMutex = *new Mutex);
+    MutexLocker locker(upconvertMutex);
+    if (m_data)
+        fastFree(data);
+    else
+        m_data = data;
+#endif
+    return m_data;
+}
+
 PassRefPtr<StringImpl> StringImpl::create(const UChar* characters, unsigned length)
 {
     if (!characters || !length)
@@ -161,6 +554,14 @@ bool StringImpl::containsOnlyWhitespace()
     // FIXME: The definition of whitespace here includes a number of characters
     // that are not whitespace from the point of view of RenderText; I wonder if
     // that's a problem in practice.
+    if (is8Bit()) {
+        const LChar* characters = characters8();
+        for (unsigned i = 0; i < m_length; i++)
+            if (!isASCIISpace(characters[i]))
+                return false;
+        return true;
+    }
+
     for (unsigned i = 0; i < m_length; i++)
         if (!isASCIISpace(m_data[i]))
             return false;
@@ -177,11 +578,15 @@ PassRefPtr<StringImpl> StringImpl::substring(unsigned start, unsigned length)
             return this;
         length = maxLength;
     }
-    return create(m_data + start, length);
+    if (is8Bit())
+        return create(characters8() + start, length);
+    return create(characters() + start, length);
 }
 
 UChar32 StringImpl::characterStartingAt(unsigned i)
 {
+    if (is8Bit())
+        return characters8()[i];
     if (U16_IS_SINGLE(m_data[i]))
         return m_data[i];
     if (i + 1 < m_length && U16_IS_LEAD(m_data[i]) && U16_IS_TRAIL(m_data[i + 1]))
@@ -194,11 +599,33 @@ PassRefPtr<StringImpl> StringImpl::lower()
     // Note: This is a hot function in the Dromaeo benchmark, specifically the
     // no-op code path up through the first 'return' statement.
     
+    if (is8Bit()) {
+        // Most 8-bit strings are ASCII names that are already lowercase.
+        const LChar* characters = characters8();
+        LChar ored = 0;
+        bool noUpper = true;
+        for (unsigned i = 0; i < m_length; ++i) {
+            if (UNLIKELY(isASCIIUpper(characters[i])))
+                noUpper = false;
+            ored |= characters[i];
+        }
+        if (noUpper && !(ored & ~0x7F))
+            return this;
+        if (!(ored & ~0x7F)) {
+            LChar* data;
+            RefPtr<StringImpl> newImpl = createUninitialized(m_length, data);
+            for (unsigned i = 0; i < m_length; ++i)
+                data[i] = toASCIILower(characters[i]);
+            return newImpl.release();
+        }
+    }
+
     // First scan the string for uppercase and non-ASCII characters:
+    const UChar* characters = this->characters();
     UChar ored = 0;
     bool noUpper = true;
-    const UChar *end = m_data + m_length;
-    for (const UChar* chp = m_data; chp != end; chp++) {
+    const UChar *end = characters + m_length;
+    for (const UChar* chp = characters; chp != end; chp++) {
         if (UNLIKELY(isASCIIUpper(*chp)))
             noUpper = false;
         ored |= *chp;
@@ -218,7 +645,7 @@ PassRefPtr<StringImpl> StringImpl::lower()
     if (!(ored & ~0x7F)) {
         // Do a faster loop for the case where all the characters are ASCII.
         for (int i = 0; i < length; i++) {
-            UChar c = m_data[i];
+            UChar c = characters[i];
             data[i] = toASCIILower(c);
         }
         return newImpl;
@@ -226,11 +653,11 @@ PassRefPtr<StringImpl> StringImpl::lower()
     
     // Do a slower implementation for cases that include non-ASCII characters.
     bool error;
-    int32_t realLength = Unicode::toLower(data, length, m_data, m_length, &error);
+    int32_t realLength = Unicode::toLower(data, length, characters, m_length, &error);
     if (!error && realLength == length)
         return newImpl;
     newImpl = createUninitialized(realLength, data);
-    Unicode::toLower(data, realLength, m_data, m_length, &error);
+    Unicode::toLower(data, realLength, characters, m_length, &error);
     if (error)
         return this;
     return newImpl;
@@ -241,6 +668,7 @@ PassRefPtr<StringImpl> StringImpl::upper()
     // This function could be optimized for no-op cases the way lower() is,
     // but in empirical testing, few actual calls to upper() are no-ops, so
     // it wouldn't be worth the extra time for pre-scanning.
+    const UChar* characters = this->characters();
     UChar* data;
     RefPtr<StringImpl> newImpl = createUninitialized(m_length, data);
 
@@ -251,7 +679,7 @@ PassRefPtr<StringImpl> StringImpl::upper()
     // Do a faster loop for the case where all the characters are ASCII.
     UChar ored = 0;
     for (int i = 0; i < length; i++) {
-        UChar c = m_data[i];
+        UChar c = characters[i];
         ored |= c;
         data[i] = toASCIIUpper(c);
     }
@@ -260,11 +688,11 @@ PassRefPtr<StringImpl> StringImpl::upper()
 
     // Do a slower implementation for cases that include non-ASCII characters.
     bool error;
-    int32_t realLength = Unicode::toUpper(data, length, m_data, m_length, &error);
+    int32_t realLength = Unicode::toUpper(data, length, characters, m_length, &error);
     if (!error && realLength == length)
         return newImpl;
     newImpl = createUninitialized(realLength, data);
-    Unicode::toUpper(data, realLength, m_data, m_length, &error);
+    Unicode::toUpper(data, realLength, characters, m_length, &error);
     if (error)
         return this;
     return newImpl.release();
@@ -280,12 +708,13 @@ PassRefPtr<StringImpl> StringImpl::secure(UChar character, LastCharacterBehavior
     unsigned lastCharacterIndex = m_length - 1;
     for (unsigned i = 0; i < lastCharacterIndex; ++i)
         data[i] = character;
-    data[lastCharacterIndex] = (behavior == ObscureLastCharacter) ? character : m_data[lastCharacterIndex];
+    data[lastCharacterIndex] = (behavior == ObscureLastCharacter) ? character : (*this)[lastCharacterIndex];
     return newImpl.release();
 }
 
 PassRefPtr<StringImpl> StringImpl::foldCase()
 {
+    const UChar* characters = this->characters();
     UChar* data;
     RefPtr<StringImpl> newImpl = createUninitialized(m_length, data);
 
@@ -296,7 +725,7 @@ PassRefPtr<StringImpl> StringImpl::foldCase()
     // Do a faster loop for the case where all the characters are ASCII.
     UChar ored = 0;
     for (int32_t i = 0; i < length; i++) {
-        UChar c = m_data[i];
+        UChar c = characters[i];
         ored |= c;
         data[i] = toASCIILower(c);
     }
@@ -305,11 +734,11 @@ PassRefPtr<StringImpl> StringImpl::foldCase()
 
     // Do a slower implementation for cases that include non-ASCII characters.
     bool error;
-    int32_t realLength = Unicode::foldCase(data, length, m_data, m_length, &error);
+    int32_t realLength = Unicode::foldCase(data, length, characters, m_length, &error);
     if (!error && realLength == length)
         return newImpl.release();
     newImpl = createUninitialized(realLength, data);
-    Unicode::foldCase(data, realLength, m_data, m_length, &error);
+    Unicode::foldCase(data, realLength, characters, m_length, &error);
     if (error)
         return this;
     return newImpl.release();
@@ -324,7 +753,7 @@ PassRefPtr<StringImpl> StringImpl::stripWhiteSpace()
     unsigned end = m_length - 1;
     
     // skip white space from start
-    while (start <= end && isSpaceOrNewline(m_data[start]))
+    while (start <= end && isSpaceOrNewline((*this)[start]))
         start++;
     
     // only white space
@@ -332,17 +761,17 @@ PassRefPtr<StringImpl> StringImpl::stripWhiteSpace()
         return empty();
 
     // skip white space from end
-    while (end && isSpaceOrNewline(m_data[end]))
+    while (end && isSpaceOrNewline((*this)[end]))
         end--;
 
     if (!start && end == m_length - 1)
         return this;
-    return create(m_data + start, end + 1 - start);
+    return substring(start, end + 1 - start);
 }
 
 PassRefPtr<StringImpl> StringImpl::removeCharacters(CharacterMatchFunctionPtr findMatch)
 {
-    const UChar* from = m_data;
+    const UChar* from = characters();
     const UChar* fromend = from + m_length;
 
     // Assume the common case will not remove any characters
@@ -353,10 +782,10 @@ PassRefPtr<StringImpl> StringImpl::removeCharacters(CharacterMatchFunctionPtr fi
 
     StringBuffer data(m_length);
     UChar* to = data.characters();
-    unsigned outc = from - m_data;
+    unsigned outc = from - characters();
 
     if (outc)
-        memcpy(to, m_data, outc * sizeof(UChar));
+        memcpy(to, characters(), outc * sizeof(UChar));
 
     while (true) {
         while (from != fromend && findMatch(*from))
@@ -376,7 +805,7 @@ PassRefPtr<StringImpl> StringImpl::simplifyWhiteSpace()
 {
     StringBuffer data(m_length);
 
-    const UChar* from = m_data;
+    const UChar* from = characters();
     const UChar* fromend = from + m_length;
     int outc = 0;
     bool changedToSpace = false;
@@ -410,62 +839,62 @@ PassRefPtr<StringImpl> StringImpl::simplifyWhiteSpace()
 
 int StringImpl::toIntStrict(bool* ok, int base)
 {
-    return charactersToIntStrict(m_data, m_length, ok, base);
+    return charactersToIntStrict(characters(), m_length, ok, base);
 }
 
 unsigned StringImpl::toUIntStrict(bool* ok, int base)
 {
-    return charactersToUIntStrict(m_data, m_length, ok, base);
+    return charactersToUIntStrict(characters(), m_length, ok, base);
 }
 
 int64_t StringImpl::toInt64Strict(bool* ok, int base)
 {
-    return charactersToInt64Strict(m_data, m_length, ok, base);
+    return charactersToInt64Strict(characters(), m_length, ok, base);
 }
 
 uint64_t StringImpl::toUInt64Strict(bool* ok, int base)
 {
-    return charactersToUInt64Strict(m_data, m_length, ok, base);
+    return charactersToUInt64Strict(characters(), m_length, ok, base);
 }
 
 intptr_t StringImpl::toIntPtrStrict(bool* ok, int base)
 {
-    return charactersToIntPtrStrict(m_data, m_length, ok, base);
+    return charactersToIntPtrStrict(characters(), m_length, ok, base);
 }
 
 int StringImpl::toInt(bool* ok)
 {
-    return charactersToInt(m_data, m_length, ok);
+    return charactersToInt(characters(), m_length, ok);
 }
 
 unsigned StringImpl::toUInt(bool* ok)
 {
-    return charactersToUInt(m_data, m_length, ok);
+    return charactersToUInt(characters(), m_length, ok);
 }
 
 int64_t StringImpl::toInt64(bool* ok)
 {
-    return charactersToInt64(m_data, m_length, ok);
+    return charactersToInt64(characters(), m_length, ok);
 }
 
 uint64_t StringImpl::toUInt64(bool* ok)
 {
-    return charactersToUInt64(m_data, m_length, ok);
+    return charactersToUInt64(characters(), m_length, ok);
 }
 
 intptr_t StringImpl::toIntPtr(bool* ok)
 {
-    return charactersToIntPtr(m_data, m_length, ok);
+    return charactersToIntPtr(characters(), m_length, ok);
 }
 
 double StringImpl::toDouble(bool* ok, bool* didReadNumber)
 {
-    return charactersToDouble(m_data, m_length, ok, didReadNumber);
+    return charactersToDouble(characters(), m_length, ok, didReadNumber);
 }
 
 float StringImpl::toFloat(bool* ok, bool* didReadNumber)
 {
-    return charactersToFloat(m_data, m_length, ok, didReadNumber);
+    return charactersToFloat(characters(), m_length, ok, didReadNumber);
 }
 
 static bool equal(const UChar* a, const char* b, int length)
@@ -520,12 +949,19 @@ int codePointCompare(const StringImpl* s1, const StringImpl* s2)
 
 size_t StringImpl::find(UChar c, unsigned start)
 {
-    return WTF::find(m_data, m_length, c, start);
+    if (is8Bit()) {
+        if (c > 0xFF || start >= m_length)
+            return notFound;
+        const LChar* characters = characters8();
+        const void* match = memchr(characters + start, c, m_length - start);
+        return match ? static_cast<const LChar*>(match) - characters : notFound;
+    }
+    return findCharacter(characters16(), m_length, c, start);
 }
 
 size_t StringImpl::find(CharacterMatchFunctionPtr matchFunction, unsigned start)
 {
-    return WTF::find(m_data, m_length, matchFunction, start);
+    return WTF::find(characters(), m_length, matchFunction, start);
 }
 
 size_t StringImpl::find(const char* matchString, unsigned index)
@@ -620,8 +1056,12 @@ size_t StringImpl::find(StringImpl* matchString, unsigned index)
         return min(index, length());
 
     // Optimization 1: fast case for strings of length 1.
-    if (matchLength == 1)
-        return WTF::find(characters(), length(), matchString->characters()[0], index);
+    if (matchLength == 1) {
+        UChar matchCharacter = (*matchString)[0];
+        if (is8Bit())
+            return findCharacter(characters8(), length(), matchCharacter, index);
+        return findCharacter(characters16(), length(), matchCharacter, index);
+    }
 
     // Check index & matchLength are in range.
     if (index > length())
@@ -632,28 +1072,12 @@ size_t StringImpl::find(StringImpl* matchString, unsigned index)
     // delta is the number of additional times to test; delta == 0 means test only once.
     unsigned delta = searchLength - matchLength;
 
-    const UChar* searchCharacters = characters() + index;
-    const UChar* matchCharacters = matchString->characters();
-
-    // Optimization 2: keep a running hash of the strings,
-    // only call memcmp if the hashes match.
-    unsigned searchHash = 0;
-    unsigned matchHash = 0;
-    for (unsigned i = 0; i < matchLength; ++i) {
-        searchHash += searchCharacters[i];
-        matchHash += matchCharacters[i];
-    }
-
-    unsigned i = 0;
-    // keep looping until we match
-    while (searchHash != matchHash || memcmp(searchCharacters + i, matchCharacters, matchLength * sizeof(UChar))) {
-        if (i == delta)
-            return notFound;
-        searchHash += searchCharacters[i + matchLength];
-        searchHash -= searchCharacters[i];
-        ++i;
-    }
-    return index + i;
+    size_t offset;
+    if (is8Bit())
+        offset = findSubstring(characters8() + index, delta, matchString);
+    else
+        offset = findSubstring(characters16() + index, delta, matchString);
+    return offset == notFound ? notFound : index + offset;
 }
 
 size_t StringImpl::findIgnoringCase(StringImpl* matchString, unsigned index)
@@ -689,7 +1113,9 @@ size_t StringImpl::findIgnoringCase(StringImpl* matchString, unsigned index)
 
 size_t StringImpl::reverseFind(UChar c, unsigned index)
 {
-    return WTF::reverseFind(m_data, m_length, c, index);
+    if (is8Bit())
+        return reverseFindCharacter(characters8(), m_length, c, index);
+    return reverseFindCharacter(characters16(), m_length, c, index);
 }
 
 size_t StringImpl::reverseFind(StringImpl* matchString, unsigned index)
@@ -702,8 +1128,12 @@ size_t StringImpl::reverseFind(StringImpl* matchString, unsigned index)
         return min(index, length());
 
     // Optimization 1: fast case for strings of length 1.
-    if (matchLength == 1)
-        return WTF::reverseFind(characters(), length(), matchString->characters()[0], index);
+    if (matchLength == 1) {
+        UChar matchCharacter = (*matchString)[0];
+        if (is8Bit())
+            return reverseFindCharacter(characters8(), length(), matchCharacter, index);
+        return reverseFindCharacter(characters16(), length(), matchCharacter, index);
+    }
 
     // Check index & matchLength are in range.
     if (matchLength > length())
@@ -711,27 +1141,9 @@ size_t StringImpl::reverseFind(StringImpl* matchString, unsigned index)
     // delta is the number of additional times to test; delta == 0 means test only once.
     unsigned delta = min(index, length() - matchLength);
 
-    const UChar *searchCharacters = characters();
-    const UChar *matchCharacters = matchString->characters();
-
-    // Optimization 2: keep a running hash of the strings,
-    // only call memcmp if the hashes match.
-    unsigned searchHash = 0;
-    unsigned matchHash = 0;
-    for (unsigned i = 0; i < matchLength; ++i) {
-        searchHash += searchCharacters[delta + i];
-        matchHash += matchCharacters[i];
-    }
-
-    // keep looping until we match
-    while (searchHash != matchHash || memcmp(searchCharacters + delta, matchCharacters, matchLength * sizeof(UChar))) {
-        if (!delta)
-            return notFound;
-        delta--;
-        searchHash -= searchCharacters[delta + matchLength];
-        searchHash += searchCharacters[delta];
-    }
-    return delta;
+    if (is8Bit())
+        return reverseFindSubstring(characters8(), delta, matchString);
+    return reverseFindSubstring(characters16(), delta, matchString);
 }
 
 size_t StringImpl::reverseFindIgnoringCase(StringImpl* matchString, unsigned index)
@@ -777,16 +1189,17 @@ PassRefPtr<StringImpl> StringImpl::replace(UChar oldC, UChar newC)
         return this;
     unsigned i;
     for (i = 0; i != m_length; ++i)
-        if (m_data[i] == oldC)
+        if ((*this)[i] == oldC)
             break;
     if (i == m_length)
         return this;
 
+    const UChar* characters = this->characters();
     UChar* data;
     RefPtr<StringImpl> newImpl = createUninitialized(m_length, data);
 
     for (i = 0; i != m_length; ++i) {
-        UChar ch = m_data[i];
+        UChar ch = characters[i];
         if (ch == oldC)
             ch = newC;
         data[i] = ch;
@@ -856,15 +1269,15 @@ PassRefPtr<StringImpl> StringImpl::replace(UChar pattern, StringImpl* replacemen
     
     while ((srcSegmentEnd = find(pattern, srcSegmentStart)) != notFound) {
         srcSegmentLength = srcSegmentEnd - srcSegmentStart;
-        memcpy(data + dstOffset, m_data + srcSegmentStart, srcSegmentLength * sizeof(UChar));
+        memcpy(data + dstOffset, characters() + srcSegmentStart, srcSegmentLength * sizeof(UChar));
         dstOffset += srcSegmentLength;
-        memcpy(data + dstOffset, replacement->m_data, repStrLength * sizeof(UChar));
+        memcpy(data + dstOffset, replacement->characters(), repStrLength * sizeof(UChar));
         dstOffset += repStrLength;
         srcSegmentStart = srcSegmentEnd + 1;
     }
 
     srcSegmentLength = m_length - srcSegmentStart;
-    memcpy(data + dstOffset, m_data + srcSegmentStart, srcSegmentLength * sizeof(UChar));
+    memcpy(data + dstOffset, characters() + srcSegmentStart, srcSegmentLength * sizeof(UChar));
 
     ASSERT(dstOffset + srcSegmentLength == newImpl->length());
 
@@ -914,15 +1327,15 @@ PassRefPtr<StringImpl> StringImpl::replace(StringImpl* pattern, StringImpl* repl
     
     while ((srcSegmentEnd = find(pattern, srcSegmentStart)) != notFound) {
         srcSegmentLength = srcSegmentEnd - srcSegmentStart;
-        memcpy(data + dstOffset, m_data + srcSegmentStart, srcSegmentLength * sizeof(UChar));
+        memcpy(data + dstOffset, characters() + srcSegmentStart, srcSegmentLength * sizeof(UChar));
         dstOffset += srcSegmentLength;
-        memcpy(data + dstOffset, replacement->m_data, repStrLength * sizeof(UChar));
+        memcpy(data + dstOffset, replacement->characters(), repStrLength * sizeof(UChar));
         dstOffset += repStrLength;
         srcSegmentStart = srcSegmentEnd + patternLength;
     }
 
     srcSegmentLength = m_length - srcSegmentStart;
-    memcpy(data + dstOffset, m_data + srcSegmentStart, srcSegmentLength * sizeof(UChar));
+    memcpy(data + dstOffset, characters() + srcSegmentStart, srcSegmentLength * sizeof(UChar));
 
     ASSERT(dstOffset + srcSegmentLength == newImpl->length());
 
@@ -931,6 +1344,21 @@ PassRefPtr<StringImpl> StringImpl::replace(StringImpl* pattern, StringImpl* repl
 
 bool equal(const StringImpl* a, const StringImpl* b)
 {
+#if CPU(X86_SSE2) && COMPILER(GCC)
+    if (a && b && a != b) {
+        unsigned length = a->length();
+        if (length != b->length())
+            return false;
+        if (a->is8Bit()) {
+            if (b->is8Bit())
+                return equalCharacters(a->characters8(), b->characters8(), length);
+            return equalCharacters(a->characters8(), b->characters16(), length);
+        }
+        if (b->is8Bit())
+            return equalCharacters(a->characters16(), b->characters8(), length);
+        return equalCharacters(a->characters16(), b->characters16(), length);
+    }
+#endif
     return StringHash::equal(a, b);
 }
 
@@ -942,6 +1370,18 @@ bool equal(const StringImpl* a, const char* b)
         return !a;
 
     unsigned length = a->length();
+    if (a->is8Bit()) {
+        const LChar* as = a->characters8();
+        for (unsigned i = 0; i != length; ++i) {
+            LChar bc = b[i];
+            if (!bc)
+                return false;
+            if (as[i] != bc)
+                return false;
+        }
+        return !b[length];
+    }
+
     const UChar* as = a->characters();
     for (unsigned i = 0; i != length; ++i) {
         unsigned char bc = b[i];
@@ -1008,7 +1448,7 @@ bool equalIgnoringNullity(StringImpl* a, StringImpl* b)
 WTF::Unicode::Direction StringImpl::defaultWritingDirection(bool* hasStrongDirectionality)
 {
     for (unsigned i = 0; i < m_length; ++i) {
-        WTF::Unicode::Direction charDirection = WTF::Unicode::direction(m_data[i]);
+        WTF::Unicode::Direction charDirection = WTF::Unicode::direction((*this)[i]);
         if (charDirection == WTF::Unicode::LeftToRight) {
             if (hasStrongDirectionality)
                 *hasStrongDirectionality = true;
@@ -1056,17 +1496,19 @@ PassRefPtr<StringImpl> StringImpl::createWithTerminatingNullCharacter(const Stri
     if (length >= numeric_limits<unsigned>::max())
         CRASH();
     RefPtr<StringImpl> terminatedString = createUninitialized(length + 1, data);
-    memcpy(data, string.m_data, length * sizeof(UChar));
+    memcpy(data, string.characters(), length * sizeof(UChar));
     data[length] = 0;
     terminatedString->m_length--;
-    terminatedString->m_hash = string.m_hash;
+    terminatedString->m_hashAndFlags = string.m_hashAndFlags & s_hashMask;
     terminatedString->m_refCountAndFlags |= s_refCountFlagHasTerminatingNullCharacter;
     return terminatedString.release();
 }
 
 PassRefPtr<StringImpl> StringImpl::threadsafeCopy() const
 {
-    return create(m_data, m_length);
+    if (is8Bit())
+        return create(characters8(), m_length);
+    return create(characters(), m_length);
 }
 
 PassRefPtr<StringImpl> StringImpl::crossThreadString()
@@ -78,7 +78,7 @@ private:
         : StringImplBase(length, ConstructStaticString)
         , m_data(characters)
         , m_buffer(0)
-        , m_hash(0)
+        , m_hashAndFlags(0)
     {
         // Ensure that the hash is computed so that AtomicStringHash can call existingHash()
         // with impunity. The empty string is special because it is never entered into
@@ -91,18 +91,31 @@ private:
         : StringImplBase(length, BufferInternal)
         , m_data(reinterpret_cast<const UChar*>(this + 1))
         , m_buffer(0)
-        , m_hash(0)
+        , m_hashAndFlags(0)
     {
         ASSERT(m_data);
         ASSERT(m_length);
     }
 
+    // Create a Latin-1 string with internal storage (BufferInternal). The UTF-16
+    // buffer returned by characters() is only created if someone asks for it.
+    enum Force8Bit { Force8BitConstructor };
+    StringImpl(unsigned length, Force8Bit)
+        : StringImplBase(length, BufferInternal)
+        , m_data(0)
+        , m_buffer(0)
+        , m_hashAndFlags(0)
+    {
+        ASSERT(m_length);
+        m_hashAndFlags = s_hashFlagIs8Bit;
+    }
+
     // Create a StringImpl adopting ownership of the provided buffer (BufferOwned)
     StringImpl(const UChar* characters, unsigned length)
         : StringImplBase(length, BufferOwned)
         , m_data(characters)
         , m_buffer(0)
-        , m_hash(0)
+        , m_hashAndFlags(0)
     {
         ASSERT(m_data);
         ASSERT(m_length);
@@ -113,7 +126,7 @@ private:
         : StringImplBase(length, BufferSubstring)
         , m_data(characters)
         , m_substringBuffer(base.leakRef())
-        , m_hash(0)
+        , m_hashAndFlags(0)
     {
         ASSERT(m_data);
         ASSERT(m_length);
@@ -125,7 +138,7 @@ private:
         : StringImplBase(length, BufferShared)
         , m_data(characters)
         , m_sharedBuffer(sharedBuffer.leakRef())
-        , m_hash(0)
+        , m_hashAndFlags(0)
     {
         ASSERT(m_data);
         ASSERT(m_length);
@@ -135,9 +148,10 @@ private:
     void setHash(unsigned hash)
     {
         ASSERT(!isStatic());
-        ASSERT(!m_hash);
-        ASSERT(hash == StringHasher::computeHash(m_data, m_length));
-        m_hash = hash;
+        ASSERT(!(m_hashAndFlags & s_hashMask));
+        ASSERT(!(hash & ~s_hashMask));
+        ASSERT(hash == (is8Bit() ? StringHasher::computeHash(characters8(), m_length) : StringHasher::computeHash(m_data, m_length)));
+        m_hashAndFlags |= hash;
     }
 
 public:
@@ -146,6 +160,11 @@ public:
     static PassRefPtr<StringImpl> create(const UChar*, unsigned length);
     static PassRefPtr<StringImpl> create(const char*, unsigned length);
     static PassRefPtr<StringImpl> create(const char*);
+    // Creates an 8-bit string. Unlike create(const char*, unsigned), which widens
+    // its input, this keeps one byte per character until characters() is called.
+    static PassRefPtr<StringImpl> create(const LChar*, unsigned length);
+    // Creates an 8-bit string if all the characters fit in Latin-1.
+    static PassRefPtr<StringImpl> create8BitIfPossible(const UChar*, unsigned length);
     static PassRefPtr<StringImpl> create(const UChar*, unsigned length, PassRefPtr<SharedUChar> sharedBuffer);
     static ALWAYS_INLINE PassRefPtr<StringImpl> create(PassRefPtr<StringImpl> rep, unsigned offset, unsigned length)
     {
@@ -155,11 +174,15 @@ public:
         if (!length)
             return empty();
 
+        if (rep->is8Bit())
+            return create(rep->characters8() + offset, length);
+
         StringImpl* ownerRep = (rep->bufferOwnership() == BufferSubstring) ? rep->m_substringBuffer : rep.get();
         return adoptRef(new StringImpl(rep->m_data + offset, length, ownerRep));
     }
 
     static PassRefPtr<StringImpl> createUninitialized(unsigned length, UChar*& data);
+    static PassRefPtr<StringImpl> createUninitialized(unsigned length, LChar*& data);
     static ALWAYS_INLINE PassRefPtr<StringImpl> tryCreateUninitialized(unsigned length, UChar*& output)
     {
         if (!length) {
@@ -180,6 +203,7 @@ public:
         return adoptRef(new(resultImpl) StringImpl(length));
     }
 
+    // Note that m_data is null for an 8-bit string until characters() is first called.
     static unsigned dataOffset() { return OBJECT_OFFSETOF(StringImpl, m_data); }
     static PassRefPtr<StringImpl> createWithTerminatingNullCharacter(const StringImpl&);
     static PassRefPtr<StringImpl> createStrippingNullCharacters(const UChar*, unsigned length);
@@ -198,7 +222,18 @@ public:
     static PassRefPtr<StringImpl> adopt(StringBuffer&);
 
     SharedUChar* sharedBuffer();
-    const UChar* characters() const { return m_data; }
+    // A substring keeps the whole of the string it was taken from alive.
+    bool isSubstring() const { return bufferOwnership() == BufferSubstring; }
+    const UChar* characters() const
+    {
+        if (UNLIKELY(!m_data))
+            return upconvertCharacters();
+        return m_data;
+    }
+
+    bool is8Bit() const { return m_hashAndFlags & s_hashFlagIs8Bit; }
+    const LChar* characters8() const { ASSERT(is8Bit()); return reinterpret_cast<const LChar*>(this + 1); }
+    const UChar* characters16() const { ASSERT(!is8Bit()); return m_data; }
 
     size_t cost()
     {
@@ -235,8 +270,16 @@ public:
             m_refCountAndFlags &= ~s_refCountFlagIsAtomic;
     }
 
-    unsigned hash() const { if (!m_hash) m_hash = StringHasher::computeHash(m_data, m_length); return m_hash; }
-    unsigned existingHash() const { ASSERT(m_hash); return m_hash; }
+    unsigned hash() const
+    {
+        unsigned hash = m_hashAndFlags & s_hashMask;
+        if (!hash) {
+            hash = is8Bit() ? StringHasher::computeHash(characters8(), m_length) : StringHasher::computeHash(m_data, m_length);
+            m_hashAndFlags |= hash;
+        }
+        return hash;
+    }
+    unsigned existingHash() const { ASSERT(m_hashAndFlags & s_hashMask); return m_hashAndFlags & s_hashMask; }
 
     ALWAYS_INLINE void deref() { m_refCountAndFlags -= s_refCountIncrement; if (!(m_refCountAndFlags & (s_refCountMask | s_refCountFlagStatic))) delete this; }
     ALWAYS_INLINE bool hasOneRef() const { return (m_refCountAndFlags & (s_refCountMask | s_refCountFlagStatic)) == s_refCountIncrement; }
@@ -261,7 +304,7 @@ public:
 
     PassRefPtr<StringImpl> substring(unsigned pos, unsigned len = UINT_MAX);
 
-    UChar operator[](unsigned i) { ASSERT(i < m_length); return m_data[i]; }
+    UChar operator[](unsigned i) { ASSERT(i < m_length); return is8Bit() ? characters8()[i] : m_data[i]; }
     UChar32 characterStartingAt(unsigned);
 
     bool containsOnlyWhitespace();
@@ -327,22 +370,39 @@ private:
     static const unsigned s_copyCharsInlineCutOff = 20;
 
     static PassRefPtr<StringImpl> createStrippingNullCharactersSlowCase(const UChar*, unsigned length);
+
+    const UChar* upconvertCharacters() const;
     
     BufferOwnership bufferOwnership() const { return static_cast<BufferOwnership>(m_refCountAndFlags & s_refCountMaskBufferOwnership); }
     bool isStatic() const { return m_refCountAndFlags & s_refCountFlagStatic; }
-    const UChar* m_data;
+    // For 8-bit strings this is the lazily created UTF-16 copy, owned by the string.
+    mutable const UChar* m_data;
     union {
         void* m_buffer;
         StringImpl* m_substringBuffer;
         SharedUChar* m_sharedBuffer;
     };
-    mutable unsigned m_hash;
+    // StringHasher only ever produces 31 bit hashes, so the top bit is free to
+    // say whether the characters are stored as Latin-1. Keeping the flag here
+    // leaves the reference count in m_refCountAndFlags at its full width.
+    static const unsigned s_hashFlagIs8Bit = 1u << 31;
+    static const unsigned s_hashMask = ~s_hashFlagIs8Bit;
+    mutable unsigned m_hashAndFlags;
 };
 
 bool equal(const StringImpl*, const StringImpl*);
 bool equal(const StringImpl*, const char*);
 inline bool equal(const char* a, StringImpl* b) { return equal(b, a); }
 
+inline bool equal(const LChar* a, const UChar* b, unsigned length)
+{
+    for (unsigned i = 0; i < length; ++i) {
+        if (a[i] != b[i])
+            return false;
+    }
+    return true;
+}
+
 bool equalIgnoringCase(StringImpl*, StringImpl*);
 bool equalIgnoringCase(StringImpl*, const char*);
 inline bool equalIgnoringCase(const char* a, StringImpl* b) { return equalIgnoringCase(b, a); }
@@ -139,6 +139,11 @@ public:
         return m_impl->characters();
     }
 
+    // Only valid on a non-null string. Callers that can read Latin-1 should
+    // check is8Bit() and use characters8() to avoid creating a UTF-16 copy.
+    bool is8Bit() const { return m_impl->is8Bit(); }
+    const LChar* characters8() const { return m_impl->characters8(); }
+
     CString ascii() const;
     CString latin1() const;
     CString utf8(bool strict = false) const;
@@ -252,6 +257,7 @@ public:
     // into the buffer returned in data before the returned string is used.
     // Failure to do this will have unpredictable results.
     static String createUninitialized(unsigned length, UChar*& data) { return StringImpl::createUninitialized(length, data); }
+    static String createUninitialized(unsigned length, LChar*& data) { return StringImpl::createUninitialized(length, data); }
 
     void split(const String& separator, Vector<String>& result) const;
     void split(const String& separator, bool allowEmptyEntries, Vector<String>& result) const;
@@ -41,4 +41,7 @@
 
 COMPILE_ASSERT(sizeof(UChar) == 2, UCharIsTwoBytes);
 
+// A Latin-1 character, as stored by 8-bit StringImpls.
+typedef unsigned char LChar;
+
 #endif // WTF_UNICODE_H
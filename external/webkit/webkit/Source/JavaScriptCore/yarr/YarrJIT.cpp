@@ -909,6 +909,23 @@ class YarrGenerator : private MacroAssembler {
                 && (lookaheadTerm().quantityCount == 1);
         }
 
+        // The JIT stores a capture's start on entry to its parentheses and its end on exit, and
+        // does not reset either when backtracking out. A back reference can only rely on these
+        // values if the referenced parentheses are a preceding term of the same alternative, and
+        // are matched exactly once, since then they must have been (re)matched on the way here.
+        bool isBackReferenceToPrecedingParentheses()
+        {
+            ASSERT(alternativeValid());
+            ASSERT(term().type == PatternTerm::TypeBackReference);
+            unsigned subpatternId = term().backReferenceSubpatternId;
+            for (unsigned i = 0; i < t; ++i) {
+                PatternTerm& candidate = alternative()->m_terms[i];
+                if ((candidate.type == PatternTerm::TypeParenthesesSubpattern) && candidate.capture() && (candidate.parentheses.subpatternId == subpatternId))
+                    return (candidate.quantityType == QuantifierFixedCount) && (candidate.quantityCount == 1) && !candidate.parentheses.isCopy;
+            }
+            return false;
+        }
+
         int inputOffset()
         {
             return term().inputPosition - checkedTotal;
@@ -1543,6 +1560,65 @@ class YarrGenerator : private MacroAssembler {
         state.setBacktrackLabel(backtrackBegin);
     }
 
+    void generateBackReference(TermGenerationState& state)
+    {
+        const RegisterID character = regT0;
+        const RegisterID matchPosition = regT1;
+        // There are no spare registers for the loop below, so 'length' is spilled
+        // to the second frame slot and used to hold the input character.
+        const RegisterID inputCharacter = length;
+        PatternTerm& term = state.term();
+        ASSERT(term.quantityType == QuantifierFixedCount);
+        ASSERT(term.quantityCount == 1);
+        ASSERT(!m_pattern.m_ignoreCase);
+
+        unsigned subpatternId = term.backReferenceSubpatternId;
+        Address matchBeginAddress(output, (subpatternId << 1) * sizeof(int));
+        Address matchEndAddress(output, ((subpatternId << 1) + 1) * sizeof(int));
+
+        JumpList matched;
+        JumpList failures;
+
+        storeToFrame(index, term.frameLocation);
+
+        // A reference to a subpattern that did not participate, or matched the
+        // empty string, always succeeds without consuming any input.
+        load32(matchBeginAddress, matchPosition);
+        matched.append(branch32(Equal, matchPosition, TrustedImm32(-1)));
+        load32(matchEndAddress, character);
+        sub32(matchPosition, character);
+        matched.append(branchTest32(Zero, character));
+
+        add32(character, index);
+        failures.append(branch32(Above, index, length));
+        sub32(character, index);
+
+        storeToFrame(length, term.frameLocation + 1);
+
+        Label loop(this);
+        load16(BaseIndex(input, matchPosition, TimesTwo), character);
+        load16(BaseIndex(input, index, TimesTwo, state.inputOffset() * sizeof(UChar)), inputCharacter);
+        Jump characterMismatch = branch32(NotEqual, character, inputCharacter);
+        add32(TrustedImm32(1), matchPosition);
+        add32(TrustedImm32(1), index);
+        branch32(NotEqual, matchPosition, matchEndAddress).linkTo(loop, this);
+
+        loadFromFrame(term.frameLocation + 1, length);
+        matched.append(jump());
+
+        characterMismatch.link(this);
+        loadFromFrame(term.frameLocation + 1, length);
+        failures.link(this);
+
+        Label backtrackBegin(this);
+        loadFromFrame(term.frameLocation, index);
+        state.jumpToBacktrack(this);
+
+        matched.link(this);
+
+        state.setBacktrackLabel(backtrackBegin);
+    }
+
     void generateParenthesesDisjunction(PatternTerm& parenthesesTerm, TermGenerationState& state, unsigned alternativeFrameLocation)
     {
         ASSERT((parenthesesTerm.type == PatternTerm::TypeParenthesesSubpattern) || (parenthesesTerm.type == PatternTerm::TypeParentheticalAssertion));
@@ -1897,7 +1973,10 @@ class YarrGenerator : private MacroAssembler {
             break;
 
         case PatternTerm::TypeBackReference:
-            m_shouldFallBack = true;
+            if ((term.quantityType == QuantifierFixedCount) && (term.quantityCount == 1) && !m_pattern.m_ignoreCase && state.isBackReferenceToPrecedingParentheses())
+                generateBackReference(state);
+            else
+                m_shouldFallBack = true;
             break;
 
         case PatternTerm::TypeForwardReference:
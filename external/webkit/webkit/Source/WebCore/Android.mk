@@ -71,6 +71,7 @@ LOCAL_SRC_FILES := \
 	css/CSSTimingFunctionValue.cpp \
 	css/CSSUnicodeRangeValue.cpp \
 	css/CSSValueList.cpp \
+	css/CompiledSelector.cpp \
 	css/FontFamilyValue.cpp \
 	css/FontValue.cpp \
 	css/MediaFeatureNames.cpp \
@@ -392,6 +393,8 @@ LOCAL_SRC_FILES := $(LOCAL_SRC_FILES) \
 	html/canvas/WebGLObject.cpp \
 	html/canvas/WebGLVertexArrayObjectOES.cpp \
 	\
+	html/parser/BackgroundHTMLParser.cpp \
+	html/parser/CompactHTMLToken.cpp \
 	html/parser/HTMLConstructionSite.cpp \
 	html/parser/HTMLDocumentParser.cpp \
 	html/parser/HTMLElementStack.cpp \
@@ -433,6 +436,7 @@ LOCAL_SRC_FILES := $(LOCAL_SRC_FILES) \
 	loader/cache/CachedResourceLoader.cpp \
 	loader/cache/CachedResourceRequest.cpp \
 	loader/cache/CachedScript.cpp \
+	loader/cache/DiskCache.cpp \
 	loader/CrossOriginAccessControl.cpp \
 	loader/CrossOriginPreflightResultCache.cpp \
 	loader/DocumentLoader.cpp \
@@ -604,6 +608,7 @@ LOCAL_SRC_FILES := $(LOCAL_SRC_FILES) \
 	\
 	platform/graphics/BitmapImage.cpp \
 	platform/graphics/Color.cpp \
+	platform/graphics/DecodedFrameCache.cpp \
 	platform/graphics/FloatPoint.cpp \
 	platform/graphics/FloatPoint3D.cpp \
 	platform/graphics/FloatQuad.cpp \
@@ -634,6 +639,7 @@ LOCAL_SRC_FILES := $(LOCAL_SRC_FILES) \
 	platform/graphics/SimpleFontData.cpp \
 	platform/graphics/StringTruncator.cpp \
 	platform/graphics/WidthIterator.cpp \
+	platform/graphics/WordWidthCache.cpp \
 	platform/graphics/WOFFFileFormat.cpp \
 	\
 	platform/graphics/android/BitmapAllocatorAndroid.cpp \
@@ -757,6 +763,8 @@ LOCAL_SRC_FILES := $(LOCAL_SRC_FILES) \
 	\
 	platform/leveldb/LevelDBDatabase.cpp \
 	platform/leveldb/LevelDBIterator.cpp \
+	platform/leveldb/LevelDBTransaction.cpp \
+	platform/leveldb/LevelDBWriteBatch.cpp \
 	\
 	platform/mock/DeviceOrientationClientMock.cpp \
 	platform/mock/GeolocationClientMock.cpp \
@@ -880,6 +888,7 @@ LOCAL_SRC_FILES := $(LOCAL_SRC_FILES) \
 	rendering/RenderLayer.cpp \
 	rendering/RenderLayerBacking.cpp \
 	rendering/RenderLayerCompositor.cpp \
+	rendering/RenderLayerDisplayList.cpp \
 	rendering/RenderLineBoxList.cpp \
 	rendering/RenderListBox.cpp \
 	rendering/RenderListItem.cpp \
@@ -1046,6 +1055,7 @@ LOCAL_SRC_FILES := $(LOCAL_SRC_FILES) \
 	storage/SQLResultSet.cpp \
 	storage/SQLResultSetRowList.cpp \
 	storage/SQLStatement.cpp \
+	storage/SQLStatementCache.cpp \
 	storage/SQLStatementSync.cpp \
 	storage/SQLTransaction.cpp \
 	storage/SQLTransactionClient.cpp \
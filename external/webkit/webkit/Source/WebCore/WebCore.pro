@@ -425,6 +425,7 @@ SOURCES += \
     css/CSSTimingFunctionValue.cpp \
     css/CSSUnicodeRangeValue.cpp \
     css/CSSValueList.cpp \
+    css/CompiledSelector.cpp \
     css/FontFamilyValue.cpp \
     css/FontValue.cpp \
     css/MediaFeatureNames.cpp \
@@ -784,7 +785,9 @@ SOURCES += \
     html/canvas/Uint16Array.cpp \
     html/canvas/Uint32Array.cpp \
     html/canvas/Uint8Array.cpp \
+    html/parser/BackgroundHTMLParser.cpp \
     html/parser/CSSPreloadScanner.cpp \
+    html/parser/CompactHTMLToken.cpp \
     html/parser/HTMLConstructionSite.cpp \
     html/parser/HTMLDocumentParser.cpp \
     html/parser/HTMLElementStack.cpp \
@@ -860,6 +863,7 @@ SOURCES += \
     loader/cache/CachedResource.cpp \
     loader/cache/CachedScript.cpp \
     loader/cache/CachedXSLStyleSheet.cpp \
+    loader/cache/DiskCache.cpp \
     loader/CrossOriginAccessControl.cpp \
     loader/CrossOriginPreflightResultCache.cpp \
     loader/cache/CachedResourceLoader.cpp \
@@ -973,6 +977,7 @@ SOURCES += \
     platform/graphics/BitmapImage.cpp \
     platform/graphics/Color.cpp \
     platform/graphics/ContextShadow.cpp \
+    platform/graphics/DecodedFrameCache.cpp \
     platform/graphics/FloatPoint3D.cpp \
     platform/graphics/FloatPoint.cpp \
     platform/graphics/FloatQuad.cpp \
@@ -997,6 +1002,7 @@ SOURCES += \
     platform/graphics/SegmentedFontData.cpp \
     platform/graphics/SimpleFontData.cpp \
     platform/graphics/TiledBackingStore.cpp \
+    platform/graphics/WordWidthCache.cpp \
     platform/graphics/transforms/AffineTransform.cpp \
     platform/graphics/transforms/TransformationMatrix.cpp \
     platform/graphics/transforms/MatrixTransformOperation.cpp \
@@ -1018,6 +1024,10 @@ SOURCES += \
     platform/leveldb/LevelDBIterator.cpp \
     platform/leveldb/LevelDBIterator.h \
     platform/leveldb/LevelDBSlice.h \
+    platform/leveldb/LevelDBTransaction.cpp \
+    platform/leveldb/LevelDBTransaction.h \
+    platform/leveldb/LevelDBWriteBatch.cpp \
+    platform/leveldb/LevelDBWriteBatch.h \
     platform/LinkHash.cpp \
     platform/Logging.cpp \
     platform/MIMETypeRegistry.cpp \
@@ -1408,6 +1418,7 @@ HEADERS += \
     css/CSSTimingFunctionValue.h \
     css/CSSUnicodeRangeValue.h \
     css/CSSValueList.h \
+    css/CompiledSelector.h \
     css/FontFamilyValue.h \
     css/FontValue.h \
     css/MediaFeatureNames.h \
@@ -1735,7 +1746,9 @@ HEADERS += \
     html/TextDocument.h \
     html/TimeRanges.h \
     html/ValidityState.h \
+    html/parser/BackgroundHTMLParser.h \
     html/parser/CSSPreloadScanner.h \
+    html/parser/CompactHTMLToken.h \
     html/parser/HTMLConstructionSite.h \
     html/parser/HTMLDocumentParser.h \
     html/parser/HTMLElementStack.h \
@@ -1809,6 +1822,7 @@ HEADERS += \
     loader/cache/CachedResourceRequest.h \
     loader/cache/CachedScript.h \
     loader/cache/CachedXSLStyleSheet.h \
+    loader/cache/DiskCache.h \
     loader/cache/MemoryCache.h \
     loader/CrossOriginAccessControl.h \
     loader/CrossOriginPreflightResultCache.h \
@@ -1918,6 +1932,7 @@ HEADERS += \
     platform/graphics/BitmapImage.h \
     platform/graphics/Color.h \
     platform/graphics/ContextShadow.h \
+    platform/graphics/DecodedFrameCache.h \
     platform/graphics/filters/FEBlend.h \
     platform/graphics/filters/FEColorMatrix.h \
     platform/graphics/filters/FEComponentTransfer.h \
@@ -1975,6 +1990,7 @@ HEADERS += \
     platform/graphics/Tile.h \
     platform/graphics/TiledBackingStore.h \    
     platform/graphics/TiledBackingStoreClient.h \
+    platform/graphics/WordWidthCache.h \
     platform/graphics/transforms/Matrix3DTransformOperation.h \
     platform/graphics/transforms/MatrixTransformOperation.h \
     platform/graphics/transforms/PerspectiveTransformOperation.h \
@@ -2686,6 +2702,7 @@ contains(DEFINES, ENABLE_DATABASE=1) {
         storage/SQLResultSet.cpp \
         storage/SQLResultSetRowList.cpp \
         storage/SQLStatement.cpp \
+        storage/SQLStatementCache.cpp \
         storage/SQLStatementSync.cpp \
         storage/SQLTransaction.cpp \
         storage/SQLTransactionClient.cpp \
@@ -2790,6 +2807,7 @@ contains(DEFINES, ENABLE_DOM_STORAGE=1) {
         storage/SQLResultSet.h \
         storage/SQLResultSetRowList.h \
         storage/SQLStatement.h \
+        storage/SQLStatementCache.h \
         storage/SQLStatementSync.h \
         storage/SQLTransaction.h \
         storage/SQLTransactionClient.h \
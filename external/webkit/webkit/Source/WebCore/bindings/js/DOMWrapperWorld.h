@@ -32,7 +32,8 @@ namespace WebCore {
 class JSDOMWrapper;
 class ScriptController;
 
-typedef HashMap<void*, JSC::Weak<JSDOMWrapper> > DOMObjectWrapperMap;
+// Looked up whenever a DOM object that is not a node is wrapped, and big in pages that use many of them.
+typedef HashMap<void*, JSC::Weak<JSDOMWrapper>, PtrHash<void*>, ControlByteHashTraits<HashTraits<void*> > > DOMObjectWrapperMap;
 typedef JSC::WeakGCMap<StringImpl*, JSC::JSString> JSStringCache;
 
 class JSDOMWrapperOwner : public JSC::WeakHandleOwner {
@@ -714,14 +714,15 @@ JSValue JSDOMWindow::showModalDialog(ExecState* exec)
 
 JSValue JSDOMWindow::postMessage(ExecState* exec)
 {
-    PassRefPtr<SerializedScriptValue> message = SerializedScriptValue::create(exec, exec->argument(0));
-
+    MessagePortArray messagePorts;
+    ArrayBufferArray arrayBuffers;
+    if (exec->argumentCount() > 2)
+        fillMessagePortArray(exec, exec->argument(1), messagePorts, arrayBuffers);
     if (exec->hadException())
         return jsUndefined();
 
-    MessagePortArray messagePorts;
-    if (exec->argumentCount() > 2)
-        fillMessagePortArray(exec, exec->argument(1), messagePorts);
+    PassRefPtr<SerializedScriptValue> message = SerializedScriptValue::create(exec, exec->argument(0), &arrayBuffers);
+
     if (exec->hadException())
         return jsUndefined();
 
@@ -36,6 +36,7 @@
 #include "JSEventTarget.h"
 #include "JSMessagePortCustom.h"
 #include "MessageEvent.h"
+#include <runtime/Error.h>
 #include <runtime/JSArray.h>
 
 using namespace JSC;
@@ -68,9 +69,15 @@ JSC::JSValue JSMessageEvent::initMessageEvent(JSC::ExecState* exec)
     OwnPtr<MessagePortArray> messagePorts;
     if (!exec->argument(7).isUndefinedOrNull()) {
         messagePorts = new MessagePortArray();
-        fillMessagePortArray(exec, exec->argument(7), *messagePorts);
+        ArrayBufferArray arrayBuffers;
+        fillMessagePortArray(exec, exec->argument(7), *messagePorts, arrayBuffers);
         if (exec->hadException())
             return jsUndefined();
+        // An event that is not being sent anywhere has nothing to transfer.
+        if (!arrayBuffers.isEmpty()) {
+            throwTypeError(exec);
+            return jsUndefined();
+        }
     }
 
     MessageEvent* event = static_cast<MessageEvent*>(this->impl());
@@ -29,6 +29,7 @@
 #include "Event.h"
 #include "ExceptionCode.h"
 #include "Frame.h"
+#include "JSArrayBuffer.h"
 #include "JSDOMGlobalObject.h"
 #include "JSEvent.h"
 #include "JSEventListener.h"
@@ -57,14 +58,14 @@ JSC::JSValue JSMessagePort::postMessage(JSC::ExecState* exec)
     return handlePostMessage(exec, impl());
 }
 
-void fillMessagePortArray(JSC::ExecState* exec, JSC::JSValue value, MessagePortArray& portArray)
+void fillMessagePortArray(JSC::ExecState* exec, JSC::JSValue value, MessagePortArray& portArray, ArrayBufferArray& arrayBuffers)
 {
-    // Convert from the passed-in JS array-like object to a MessagePortArray.
+    // Convert from the passed-in JS array-like object to a MessagePortArray and an ArrayBufferArray.
     // Also validates the elements per sections 4.1.13 and 4.1.15 of the WebIDL spec and section 8.3.3 of the HTML5 spec.
-    if (value.isUndefinedOrNull()) {
-        portArray.resize(0);
+    portArray.resize(0);
+    arrayBuffers.resize(0);
+    if (value.isUndefinedOrNull())
         return;
-    }
 
     // Validation of sequence types, per WebIDL spec 4.1.13.
     unsigned length;
@@ -72,7 +73,6 @@ void fillMessagePortArray(JSC::ExecState* exec, JSC::JSValue value, MessagePortA
     if (exec->hadException())
         return;
 
-    portArray.resize(length);
     for (unsigned i = 0 ; i < length; ++i) {
         JSValue value = object->get(exec, i);
         if (exec->hadException())
@@ -84,12 +84,16 @@ void fillMessagePortArray(JSC::ExecState* exec, JSC::JSValue value, MessagePortA
         }
 
         // Validation of Objects implementing an interface, per WebIDL spec 4.1.15.
-        RefPtr<MessagePort> port = toMessagePort(value);
-        if (!port) {
-            throwTypeError(exec);
-            return;
+        if (RefPtr<MessagePort> port = toMessagePort(value)) {
+            portArray.append(port.release());
+            continue;
         }
-        portArray[i] = port.release();
+        if (RefPtr<ArrayBuffer> arrayBuffer = toArrayBuffer(value)) {
+            arrayBuffers.append(arrayBuffer.release());
+            continue;
+        }
+        throwTypeError(exec);
+        return;
     }
 }
 
@@ -31,6 +31,7 @@
 #ifndef JSMessagePortCustom_h
 #define JSMessagePortCustom_h
 
+#include "ArrayBuffer.h"
 #include "MessagePort.h"
 #include <runtime/JSValue.h>
 #include <wtf/Forward.h>
@@ -39,18 +40,23 @@ namespace WebCore {
 
     typedef int ExceptionCode;
 
-    // Helper function which pulls the values out of a JS sequence and into a MessagePortArray.
+    // Helper function which pulls the values out of a JS sequence and into a MessagePortArray and an ArrayBufferArray.
     // Also validates the elements per sections 4.1.13 and 4.1.15 of the WebIDL spec and section 8.3.3 of the HTML5 spec.
     // May generate an exception via the passed ExecState.
-    void fillMessagePortArray(JSC::ExecState*, JSC::JSValue, MessagePortArray&);
+    void fillMessagePortArray(JSC::ExecState*, JSC::JSValue, MessagePortArray&, ArrayBufferArray&);
 
     // Helper function to convert from JS postMessage arguments to WebCore postMessage arguments.
     template <typename T>
     inline JSC::JSValue handlePostMessage(JSC::ExecState* exec, T* impl)
     {
-        PassRefPtr<SerializedScriptValue> message = SerializedScriptValue::create(exec, exec->argument(0));
         MessagePortArray portArray;
-        fillMessagePortArray(exec, exec->argument(1), portArray);
+        ArrayBufferArray arrayBufferArray;
+        fillMessagePortArray(exec, exec->argument(1), portArray, arrayBufferArray);
+        if (exec->hadException())
+            return JSC::jsUndefined();
+
+        // The transferred ArrayBuffers are neutered once the message is serialized.
+        PassRefPtr<SerializedScriptValue> message = SerializedScriptValue::create(exec, exec->argument(0), &arrayBufferArray);
         if (exec->hadException())
             return JSC::jsUndefined();
 
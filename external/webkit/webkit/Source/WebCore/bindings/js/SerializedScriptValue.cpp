@@ -28,16 +28,37 @@
 #include "SerializedScriptValue.h"
 
 #include "Blob.h"
+#include "DataView.h"
+#include "ExceptionCode.h"
 #include "File.h"
 #include "FileList.h"
+#include "Float32Array.h"
+#include "Float64Array.h"
 #include "ImageData.h"
+#include "Int16Array.h"
+#include "Int32Array.h"
+#include "Int8Array.h"
+#include "JSArrayBuffer.h"
+#include "JSArrayBufferView.h"
 #include "JSBlob.h"
 #include "JSDOMGlobalObject.h"
+#include "JSDataView.h"
 #include "JSFile.h"
 #include "JSFileList.h"
+#include "JSFloat32Array.h"
+#include "JSFloat64Array.h"
 #include "JSImageData.h"
+#include "JSInt16Array.h"
+#include "JSInt32Array.h"
+#include "JSInt8Array.h"
 #include "JSNavigator.h"
+#include "JSUint16Array.h"
+#include "JSUint32Array.h"
+#include "JSUint8Array.h"
 #include "SharedBuffer.h"
+#include "Uint16Array.h"
+#include "Uint32Array.h"
+#include "Uint8Array.h"
 #include <limits>
 #include <JavaScriptCore/APICast.h>
 #include <JavaScriptCore/APIShims.h>
@@ -88,16 +109,32 @@ enum SerializationTag {
     EmptyStringTag = 17,
     RegExpTag = 18,
     ObjectReferenceTag = 19,
+    ArrayBufferTag = 20,
+    ArrayBufferViewTag = 21,
+    ArrayBufferTransferTag = 22,
     ErrorTag = 255
 };
 
+enum ArrayBufferViewSubtag {
+    DataViewSubtag = 0,
+    Int8ArraySubtag = 1,
+    Uint8ArraySubtag = 2,
+    Int16ArraySubtag = 3,
+    Uint16ArraySubtag = 4,
+    Int32ArraySubtag = 5,
+    Uint32ArraySubtag = 6,
+    Float32ArraySubtag = 7,
+    Float64ArraySubtag = 8
+};
+
 /* CurrentVersion tracks the serialization version so that persistant stores
  * are able to correctly bail out in the case of encountering newer formats.
  *
  * Initial version was 1.
  * Version 2. added the ObjectReferenceTag and support for serialization of cyclic graphs.
+ * Version 3. added ArrayBuffers, ArrayBufferViews and transferred ArrayBuffers.
  */
-static const unsigned int CurrentVersion = 2;
+static const unsigned int CurrentVersion = 3;
 static const unsigned int TerminatorTag = 0xFFFFFFFF;
 static const unsigned int StringPoolTag = 0xFFFFFFFE;
 
@@ -133,6 +170,8 @@ static const unsigned int StringPoolTag = 0xFFFFFFFE;
  *    | ImageData
  *    | Blob
  *    | ObjectReferenceTag <opIndex:IndexType>
+ *    | ArrayBuffer
+ *    | ArrayBufferView
  *
  * String :-
  *      EmptyStringTag
@@ -159,6 +198,15 @@ static const unsigned int StringPoolTag = 0xFFFFFFFE;
  *
  * RegExp :-
  *    RegExpTag <pattern:StringData><flags:StringData>
+ *
+ * ArrayBuffer :-
+ *    ArrayBufferTag <length:uint32_t><data:uint8_t{length}>
+ *    ArrayBufferTransferTag <transferIndex:uint32_t> // Index into the transferred ArrayBufferContents
+ *
+ * ArrayBufferView :-
+ *    ArrayBufferViewTag <subtag:uint8_t><byteOffset:uint32_t><byteLength:uint32_t> (ArrayBuffer | ObjectReferenceTag <opIndex:IndexType>)
+ *
+ * ArrayBuffers and ArrayBufferViews take part in the object pool, a view after its buffer.
  */
 
 typedef pair<JSC::JSValue, SerializationReturnCode> DeserializationResult;
@@ -250,9 +298,9 @@ template <typename T> static bool writeLittleEndian(Vector<uint8_t>& buffer, con
 
 class CloneSerializer : CloneBase {
 public:
-    static SerializationReturnCode serialize(ExecState* exec, JSValue value, Vector<uint8_t>& out)
+    static SerializationReturnCode serialize(ExecState* exec, JSValue value, ArrayBufferArray* arrayBuffers, Vector<uint8_t>& out)
     {
-        CloneSerializer serializer(exec, out);
+        CloneSerializer serializer(exec, arrayBuffers, out);
         return serializer.serialize(value);
     }
 
@@ -269,12 +317,16 @@ public:
     }
 
 private:
-    CloneSerializer(ExecState* exec, Vector<uint8_t>& out)
+    CloneSerializer(ExecState* exec, ArrayBufferArray* arrayBuffers, Vector<uint8_t>& out)
         : CloneBase(exec)
         , m_buffer(out)
         , m_emptyIdentifier(exec, UString("", 0))
     {
         write(CurrentVersion);
+        if (arrayBuffers) {
+            for (size_t i = 0; i < arrayBuffers->size(); i++)
+                m_transferredArrayBuffers.add(arrayBuffers->at(i).get(), i);
+        }
     }
 
     SerializationReturnCode serialize(JSValue in);
@@ -289,21 +341,31 @@ private:
 
     bool startObjectInternal(JSObject* object)
     {
-        // Record object for graph reconstruction
-        pair<ObjectPool::iterator, bool> iter = m_objectPool.add(object, m_objectPool.size());
-        
-        // Handle duplicate references
-        if (!iter.second) {
-            write(ObjectReferenceTag);
-            ASSERT(static_cast<int32_t>(iter.first->second) < m_objectPool.size());
-            writeObjectIndex(iter.first->second);
+        if (writeObjectReferenceIfSeen(object))
             return false;
-        }
-        
-        m_gcBuffer.append(object);
+        recordObject(object);
+        return true;
+    }
+
+    // Handle duplicate references
+    bool writeObjectReferenceIfSeen(JSObject* object)
+    {
+        ObjectPool::iterator iter = m_objectPool.find(object);
+        if (iter == m_objectPool.end())
+            return false;
+        write(ObjectReferenceTag);
+        ASSERT(static_cast<int32_t>(iter->second) < m_objectPool.size());
+        writeObjectIndex(iter->second);
         return true;
     }
 
+    // Record object for graph reconstruction
+    void recordObject(JSObject* object)
+    {
+        m_objectPool.add(object, m_objectPool.size());
+        m_gcBuffer.append(object);
+    }
+
     bool startObject(JSObject* object)
     {
         if (!startObjectInternal(object))
@@ -390,6 +452,63 @@ private:
         }
     }
 
+    void dumpArrayBuffer(JSObject* object)
+    {
+        if (writeObjectReferenceIfSeen(object))
+            return;
+        recordObject(object);
+
+        ArrayBuffer* arrayBuffer = toArrayBuffer(object);
+        TransferredArrayBufferMap::iterator iter = m_transferredArrayBuffers.find(arrayBuffer);
+        if (iter != m_transferredArrayBuffers.end()) {
+            write(ArrayBufferTransferTag);
+            write(iter->second);
+            return;
+        }
+
+        write(ArrayBufferTag);
+        write(arrayBuffer->byteLength());
+        write(static_cast<const uint8_t*>(arrayBuffer->data()), arrayBuffer->byteLength());
+    }
+
+    static uint8_t arrayBufferViewSubtag(ArrayBufferView* view)
+    {
+        if (view->isByteArray())
+            return Int8ArraySubtag;
+        if (view->isUnsignedByteArray())
+            return Uint8ArraySubtag;
+        if (view->isShortArray())
+            return Int16ArraySubtag;
+        if (view->isUnsignedShortArray())
+            return Uint16ArraySubtag;
+        if (view->isIntArray())
+            return Int32ArraySubtag;
+        if (view->isUnsignedIntArray())
+            return Uint32ArraySubtag;
+        if (view->isFloatArray())
+            return Float32ArraySubtag;
+        if (view->isDoubleArray())
+            return Float64ArraySubtag;
+        ASSERT(view->isDataView());
+        return DataViewSubtag;
+    }
+
+    void dumpArrayBufferView(JSObject* object)
+    {
+        if (writeObjectReferenceIfSeen(object))
+            return;
+
+        ArrayBufferView* view = toArrayBufferView(object);
+        RefPtr<ArrayBuffer> arrayBuffer = view->buffer();
+        write(ArrayBufferViewTag);
+        write(arrayBufferViewSubtag(view));
+        write(view->byteOffset());
+        write(view->byteLength());
+        JSValue arrayBufferObject = toJS(m_exec, static_cast<JSArrayBufferView*>(object)->globalObject(), arrayBuffer.get());
+        dumpArrayBuffer(asObject(arrayBufferObject));
+        recordObject(object);
+    }
+
     bool dumpIfTerminal(JSValue value)
     {
         if (!value.isCell()) {
@@ -458,6 +577,14 @@ private:
                 write(data->data()->data()->data(), data->data()->length());
                 return true;
             }
+            if (obj->inherits(&JSArrayBuffer::s_info)) {
+                dumpArrayBuffer(obj);
+                return true;
+            }
+            if (obj->inherits(&JSArrayBufferView::s_info)) {
+                dumpArrayBufferView(obj);
+                return true;
+            }
             if (obj->inherits(&RegExpObject::s_info)) {
                 RegExpObject* regExp = asRegExpObject(obj);
                 char flags[3];
@@ -546,8 +673,15 @@ private:
 
     void write(const Identifier& ident)
     {
-        UString str = ident.ustring();
-        pair<StringConstantPool::iterator, bool> iter = m_constantPool.add(str.impl(), m_constantPool.size());
+        writeStringData(ident.impl());
+    }
+
+    // The constant pool is keyed on the StringImpl rather than the string's
+    // characters. Property names are atomic so equal names are still pooled,
+    // and string values do not have to be turned into Identifiers first.
+    void writeStringData(StringImpl* str)
+    {
+        pair<StringConstantPool::iterator, bool> iter = m_constantPool.add(str, m_constantPool.size());
         if (!iter.second) {
             write(StringPoolTag);
             writeStringIndex(iter.first->second);
@@ -556,19 +690,19 @@ private:
 
         // This condition is unlikely to happen as they would imply an ~8gb
         // string but we should guard against it anyway
-        if (str.length() >= StringPoolTag) {
+        if (str->length() >= StringPoolTag) {
             fail();
             return;
         }
 
         // Guard against overflow
-        if (str.length() > (numeric_limits<uint32_t>::max() - sizeof(uint32_t)) / sizeof(UChar)) {
+        if (str->length() > (numeric_limits<uint32_t>::max() - sizeof(uint32_t)) / sizeof(UChar)) {
             fail();
             return;
         }
 
-        writeLittleEndian<uint32_t>(m_buffer, str.length());
-        if (!writeLittleEndian<uint16_t>(m_buffer, reinterpret_cast<const uint16_t*>(str.characters()), str.length()))
+        writeLittleEndian<uint32_t>(m_buffer, str->length());
+        if (!writeLittleEndian<uint16_t>(m_buffer, reinterpret_cast<const uint16_t*>(str->characters()), str->length()))
             fail();
     }
 
@@ -577,7 +711,7 @@ private:
         if (str.isNull())
             write(m_emptyIdentifier);
         else
-            write(Identifier(m_exec, str));
+            writeStringData(str.impl());
     }
 
     void write(const String& str)
@@ -585,7 +719,7 @@ private:
         if (str.isEmpty())
             write(m_emptyIdentifier);
         else
-            write(Identifier(m_exec, str.impl()));
+            writeStringData(str.impl());
     }
 
     void write(const File* file)
@@ -606,6 +740,8 @@ private:
     typedef HashMap<RefPtr<StringImpl>, uint32_t, IdentifierRepHash> StringConstantPool;
     StringConstantPool m_constantPool;
     Identifier m_emptyIdentifier;
+    typedef HashMap<ArrayBuffer*, uint32_t> TransferredArrayBufferMap;
+    TransferredArrayBufferMap m_transferredArrayBuffers;
 };
 
 SerializationReturnCode CloneSerializer::serialize(JSValue in)
@@ -783,11 +919,11 @@ public:
         return String(str.impl());
     }
 
-    static DeserializationResult deserialize(ExecState* exec, JSGlobalObject* globalObject, const Vector<uint8_t>& buffer)
+    static DeserializationResult deserialize(ExecState* exec, JSGlobalObject* globalObject, const Vector<uint8_t>& buffer, ArrayBufferContentsArray* arrayBufferContentsArray)
     {
         if (!buffer.size())
             return make_pair(jsNull(), UnspecifiedError);
-        CloneDeserializer deserializer(exec, globalObject, buffer);
+        CloneDeserializer deserializer(exec, globalObject, buffer, arrayBufferContentsArray);
         if (!deserializer.isValid())
             return make_pair(JSValue(), ValidationError);
         return deserializer.deserialize();
@@ -806,11 +942,18 @@ private:
                 m_jsString = JSC::jsString(exec, m_string);
             return m_jsString;
         }
+        const Identifier& identifier(ExecState* exec)
+        {
+            if (m_identifier.isNull())
+                m_identifier = Identifier(exec, m_string);
+            return m_identifier;
+        }
         const UString& ustring() { return m_string; }
 
     private:
         UString m_string;
         JSValue m_jsString;
+        Identifier m_identifier;
     };
 
     struct CachedStringRef {
@@ -832,13 +975,14 @@ private:
         size_t m_index;
     };
 
-    CloneDeserializer(ExecState* exec, JSGlobalObject* globalObject, const Vector<uint8_t>& buffer)
+    CloneDeserializer(ExecState* exec, JSGlobalObject* globalObject, const Vector<uint8_t>& buffer, ArrayBufferContentsArray* arrayBufferContentsArray)
         : CloneBase(exec)
         , m_globalObject(globalObject)
         , m_isDOMGlobalObject(globalObject->inherits(&JSDOMGlobalObject::s_info))
         , m_ptr(buffer.data())
         , m_end(buffer.data() + buffer.size())
         , m_version(0xFFFFFFFF)
+        , m_arrayBufferContentsArray(arrayBufferContentsArray)
     {
         if (!read(m_version))
             m_version = 0xFFFFFFFF;
@@ -1054,6 +1198,135 @@ private:
         return true;
     }
 
+    // Like the serializer, appends the buffer to the object pool.
+    JSValue readArrayBuffer(SerializationTag tag)
+    {
+        RefPtr<ArrayBuffer> arrayBuffer;
+        if (tag == ArrayBufferTransferTag) {
+            uint32_t index;
+            if (!read(index))
+                return JSValue();
+            if (!m_arrayBufferContentsArray || index >= m_arrayBufferContentsArray->size()) {
+                fail();
+                return JSValue();
+            }
+            arrayBuffer = ArrayBuffer::create(m_arrayBufferContentsArray->at(index));
+        } else {
+            uint32_t length;
+            if (!read(length))
+                return JSValue();
+            if (static_cast<uint32_t>(m_end - m_ptr) < length) {
+                fail();
+                return JSValue();
+            }
+            if (m_isDOMGlobalObject) {
+                arrayBuffer = ArrayBuffer::create(const_cast<uint8_t*>(m_ptr), length);
+                if (!arrayBuffer) {
+                    fail();
+                    return JSValue();
+                }
+            }
+            m_ptr += length;
+        }
+
+        JSValue result = jsNull();
+        if (m_isDOMGlobalObject)
+            result = toJS(m_exec, static_cast<JSDOMGlobalObject*>(m_globalObject), arrayBuffer.get());
+        m_gcBuffer.append(result);
+        return result;
+    }
+
+    template <class ArrayClass, typename ElementType>
+    JSValue createTypedArray(PassRefPtr<ArrayBuffer> arrayBuffer, uint32_t byteOffset, uint32_t byteLength)
+    {
+        if (byteLength % sizeof(ElementType))
+            return JSValue();
+        RefPtr<ArrayClass> array = ArrayClass::create(arrayBuffer, byteOffset, byteLength / sizeof(ElementType));
+        if (!array)
+            return JSValue();
+        return toJS(m_exec, static_cast<JSDOMGlobalObject*>(m_globalObject), array.get());
+    }
+
+    JSValue createArrayBufferView(uint8_t subtag, PassRefPtr<ArrayBuffer> arrayBuffer, uint32_t byteOffset, uint32_t byteLength)
+    {
+        switch (subtag) {
+        case DataViewSubtag: {
+            RefPtr<DataView> dataView = DataView::create(arrayBuffer, byteOffset, byteLength);
+            if (!dataView)
+                return JSValue();
+            return toJS(m_exec, static_cast<JSDOMGlobalObject*>(m_globalObject), dataView.get());
+        }
+        case Int8ArraySubtag:
+            return createTypedArray<Int8Array, signed char>(arrayBuffer, byteOffset, byteLength);
+        case Uint8ArraySubtag:
+            return createTypedArray<Uint8Array, unsigned char>(arrayBuffer, byteOffset, byteLength);
+        case Int16ArraySubtag:
+            return createTypedArray<Int16Array, short>(arrayBuffer, byteOffset, byteLength);
+        case Uint16ArraySubtag:
+            return createTypedArray<Uint16Array, unsigned short>(arrayBuffer, byteOffset, byteLength);
+        case Int32ArraySubtag:
+            return createTypedArray<Int32Array, int>(arrayBuffer, byteOffset, byteLength);
+        case Uint32ArraySubtag:
+            return createTypedArray<Uint32Array, unsigned>(arrayBuffer, byteOffset, byteLength);
+        case Float32ArraySubtag:
+            return createTypedArray<Float32Array, float>(arrayBuffer, byteOffset, byteLength);
+        case Float64ArraySubtag:
+            return createTypedArray<Float64Array, double>(arrayBuffer, byteOffset, byteLength);
+        default:
+            return JSValue();
+        }
+    }
+
+    JSValue readArrayBufferView()
+    {
+        uint8_t subtag;
+        if (!read(subtag))
+            return JSValue();
+        uint32_t byteOffset;
+        if (!read(byteOffset))
+            return JSValue();
+        uint32_t byteLength;
+        if (!read(byteLength))
+            return JSValue();
+
+        SerializationTag bufferTag = readTag();
+        JSValue arrayBufferObject;
+        if (bufferTag == ArrayBufferTag || bufferTag == ArrayBufferTransferTag)
+            arrayBufferObject = readArrayBuffer(bufferTag);
+        else if (bufferTag == ObjectReferenceTag)
+            arrayBufferObject = readObjectReference();
+        if (!arrayBufferObject) {
+            fail();
+            return JSValue();
+        }
+
+        JSValue result = jsNull();
+        if (m_isDOMGlobalObject) {
+            RefPtr<ArrayBuffer> arrayBuffer = toArrayBuffer(arrayBufferObject);
+            if (!arrayBuffer) {
+                fail();
+                return JSValue();
+            }
+            result = createArrayBufferView(subtag, arrayBuffer.release(), byteOffset, byteLength);
+            if (!result) {
+                fail();
+                return JSValue();
+            }
+        }
+        m_gcBuffer.append(result);
+        return result;
+    }
+
+    JSValue readObjectReference()
+    {
+        unsigned index = 0;
+        if (!readConstantPoolIndex(m_gcBuffer, index) || index >= static_cast<unsigned>(m_gcBuffer.size())) {
+            fail();
+            return JSValue();
+        }
+        return m_gcBuffer.at(index);
+    }
+
     JSValue readTerminal()
     {
         SerializationTag tag = readTag();
@@ -1169,14 +1442,13 @@ private:
             RefPtr<RegExp> regExp = RegExp::create(&m_exec->globalData(), pattern->ustring(), reFlags);
             return new (m_exec) RegExpObject(m_exec->lexicalGlobalObject(), m_globalObject->regExpStructure(), regExp); 
         }
-        case ObjectReferenceTag: {
-            unsigned index = 0;
-            if (!readConstantPoolIndex(m_gcBuffer, index)) {
-                fail();
-                return JSValue();
-            }
-            return m_gcBuffer.at(index);
-        }
+        case ObjectReferenceTag:
+            return readObjectReference();
+        case ArrayBufferTag:
+        case ArrayBufferTransferTag:
+            return readArrayBuffer(tag);
+        case ArrayBufferViewTag:
+            return readArrayBufferView();
         default:
             m_ptr--; // Push the tag back
             return JSValue();
@@ -1189,6 +1461,7 @@ private:
     const uint8_t* m_end;
     unsigned m_version;
     Vector<CachedString> m_constantPool;
+    ArrayBufferContentsArray* m_arrayBufferContentsArray;
 };
 
 DeserializationResult CloneDeserializer::deserialize()
@@ -1282,11 +1555,11 @@ DeserializationResult CloneDeserializer::deserialize()
             }
 
             if (JSValue terminal = readTerminal()) {
-                putProperty(outputObjectStack.last(), Identifier(m_exec, cachedString->ustring()), terminal);
+                putProperty(outputObjectStack.last(), cachedString->identifier(m_exec), terminal);
                 goto objectStartVisitMember;
             }
             stateStack.append(ObjectEndVisitMember);
-            propertyNameStack.append(Identifier(m_exec, cachedString->ustring()));
+            propertyNameStack.append(cachedString->identifier(m_exec));
             goto stateUnknown;
         }
         case ObjectEndVisitMember: {
@@ -1338,17 +1611,54 @@ SerializedScriptValue::SerializedScriptValue(Vector<uint8_t>& buffer)
     m_data.swap(buffer);
 }
 
+SerializedScriptValue::SerializedScriptValue(Vector<uint8_t>& buffer, PassOwnPtr<ArrayBufferContentsArray> arrayBufferContentsArray)
+    : m_arrayBufferContentsArray(arrayBufferContentsArray)
+{
+    m_data.swap(buffer);
+}
+
 PassRefPtr<SerializedScriptValue> SerializedScriptValue::create(ExecState* exec, JSValue value, SerializationErrorMode throwExceptions)
 {
+    return create(exec, value, 0, throwExceptions);
+}
+
+PassRefPtr<SerializedScriptValue> SerializedScriptValue::create(ExecState* exec, JSValue value, ArrayBufferArray* arrayBuffers, SerializationErrorMode throwExceptions)
+{
+    if (arrayBuffers) {
+        for (size_t i = 0; i < arrayBuffers->size(); i++) {
+            ArrayBuffer* arrayBuffer = arrayBuffers->at(i).get();
+            bool isDuplicate = false;
+            for (size_t j = 0; j < i && !isDuplicate; j++)
+                isDuplicate = arrayBuffers->at(j) == arrayBuffer;
+            if (arrayBuffer->isNeutered() || isDuplicate) {
+                if (throwExceptions == Throwing)
+                    setDOMException(exec, INVALID_STATE_ERR);
+                return 0;
+            }
+        }
+    }
+
     Vector<uint8_t> buffer;
-    SerializationReturnCode code = CloneSerializer::serialize(exec, value, buffer);
+    SerializationReturnCode code = CloneSerializer::serialize(exec, value, arrayBuffers, buffer);
     if (throwExceptions == Throwing)
         maybeThrowExceptionIfSerializationFailed(exec, code);
 
     if (!serializationDidCompleteSuccessfully(code))
         return 0;
-        
-    return adoptRef(new SerializedScriptValue(buffer));
+
+    if (!arrayBuffers || arrayBuffers->isEmpty())
+        return adoptRef(new SerializedScriptValue(buffer));
+    return adoptRef(new SerializedScriptValue(buffer, transferArrayBuffers(*arrayBuffers)));
+}
+
+PassOwnPtr<ArrayBufferContentsArray> SerializedScriptValue::transferArrayBuffers(ArrayBufferArray& arrayBuffers)
+{
+    OwnPtr<ArrayBufferContentsArray> contents = adoptPtr(new ArrayBufferContentsArray(arrayBuffers.size()));
+    for (size_t i = 0; i < arrayBuffers.size(); i++) {
+        bool result = arrayBuffers[i]->transfer(contents->at(i));
+        ASSERT_UNUSED(result, result);
+    }
+    return contents.release();
 }
 
 PassRefPtr<SerializedScriptValue> SerializedScriptValue::create()
@@ -1388,7 +1698,7 @@ String SerializedScriptValue::toString()
 
 JSValue SerializedScriptValue::deserialize(ExecState* exec, JSGlobalObject* globalObject, SerializationErrorMode throwExceptions)
 {
-    DeserializationResult result = CloneDeserializer::deserialize(exec, globalObject, m_data);
+    DeserializationResult result = CloneDeserializer::deserialize(exec, globalObject, m_data, m_arrayBufferContentsArray.get());
     if (throwExceptions == Throwing)
         maybeThrowExceptionIfSerializationFailed(exec, result.second);
     return result.first;
@@ -27,9 +27,11 @@
 #ifndef SerializedScriptValue_h
 #define SerializedScriptValue_h
 
+#include "ArrayBuffer.h"
 #include <heap/Strong.h>
 #include <runtime/JSValue.h>
 #include <wtf/Forward.h>
+#include <wtf/OwnPtr.h>
 #include <wtf/PassRefPtr.h>
 #include <wtf/RefCounted.h>
 
@@ -55,6 +57,10 @@ class SharedBuffer;
 class SerializedScriptValue : public RefCounted<SerializedScriptValue> {
 public:
     static PassRefPtr<SerializedScriptValue> create(JSC::ExecState*, JSC::JSValue, SerializationErrorMode = Throwing);
+    // The ArrayBuffers in |arrayBuffers| are not copied: their contents move
+    // into the serialized value and the buffers are neutered. Throws an
+    // INVALID_STATE_ERR if one of them is listed twice or already neutered.
+    static PassRefPtr<SerializedScriptValue> create(JSC::ExecState*, JSC::JSValue, ArrayBufferArray* arrayBuffers, SerializationErrorMode = Throwing);
     static PassRefPtr<SerializedScriptValue> create(JSContextRef, JSValueRef value, JSValueRef* exception);
     static PassRefPtr<SerializedScriptValue> create(String string);
     static PassRefPtr<SerializedScriptValue> adopt(Vector<uint8_t>& buffer)
@@ -79,7 +85,11 @@ private:
     static bool serializationDidCompleteSuccessfully(SerializationReturnCode);
     
     SerializedScriptValue(Vector<unsigned char>&);
+    SerializedScriptValue(Vector<unsigned char>&, PassOwnPtr<ArrayBufferContentsArray>);
+    static PassOwnPtr<ArrayBufferContentsArray> transferArrayBuffers(ArrayBufferArray&);
+
     Vector<unsigned char> m_data;
+    OwnPtr<ArrayBufferContentsArray> m_arrayBufferContentsArray;
 };
 
 }
@@ -154,6 +154,7 @@ CSSParser::CSSParser(bool strictParsing)
     , m_ruleRangeMap(0)
     , m_currentRuleData(0)
     , m_data(0)
+    , yytext(0)
     , yy_start(1)
     , m_lineNumber(0)
     , m_lastSelectorLineNumber(0)
@@ -235,8 +236,12 @@ void CSSParser::parseSheet(CSSStyleSheet* sheet, const String& string, int start
     }
 
     m_lineNumber = startLineNumber;
-    setupParser("", string, "");
-    cssyyparse(this);
+    // The inspector needs source ranges, which only the grammar records.
+    if (ruleRangeMap || !m_styleSheet) {
+        setupParser("", string, "");
+        cssyyparse(this);
+    } else
+        parseSheetWithFastPath(string);
     m_ruleRangeMap = 0;
     m_currentRuleData = 0;
     m_rule = 0;
@@ -525,6 +530,15 @@ bool CSSParser::parseDeclaration(CSSMutableStyleDeclaration* declaration, const
         m_currentRuleData = CSSRuleSourceData::create();
         m_currentRuleData->styleSourceData = CSSStyleSourceData::create();
         m_inStyleRuleOrDeclaration = true;
+    } else {
+        Vector<CSSProperty, 16> properties;
+        if (parseDeclarationListFast(string.characters(), string.characters() + string.length(), properties)) {
+            Vector<const CSSProperty*, 16> propertyPointers(properties.size());
+            for (size_t i = 0; i < properties.size(); ++i)
+                propertyPointers[i] = &properties[i];
+            declaration->addParsedProperties(propertyPointers.data(), propertyPointers.size());
+            return !properties.isEmpty();
+        }
     }
 
     setupParser("@-webkit-decls{", string, "} ");
@@ -557,6 +571,646 @@ bool CSSParser::parseDeclaration(CSSMutableStyleDeclaration* declaration, const
     return ok;
 }
 
+// The fast path below handles style rules whose selectors are made of type,
+// class and id selectors and combinators, and whose declarations each have a
+// single keyword, length, hex color, inherit or initial value. It goes
+// straight from characters to CSS values, without the CSSParserValue lists the
+// grammar builds for every declaration. Whenever it meets anything else, the
+// rule is handed to the grammar instead, so it must only accept input that the
+// grammar would parse to the same result.
+
+static inline bool isIdentifierStart(UChar c)
+{
+    return isASCIIAlpha(c) || c == '_';
+}
+
+static inline bool isIdentifierCharacter(UChar c)
+{
+    return isASCIIAlphanumeric(c) || c == '_' || c == '-';
+}
+
+// Returns the end of the identifier at |position|, or |position| if there is
+// none. Escapes and non-ASCII characters are left to the grammar.
+static const UChar* scanIdentifier(const UChar* position, const UChar* end)
+{
+    const UChar* start = position;
+    if (position < end && *position == '-')
+        ++position;
+    if (position == end || !isIdentifierStart(*position))
+        return start;
+    while (++position < end && isIdentifierCharacter(*position)) { }
+    return position;
+}
+
+static inline const UChar* skipWhitespace(const UChar* position, const UChar* end)
+{
+    while (position < end && isHTMLSpace(*position))
+        ++position;
+    return position;
+}
+
+static inline bool startsWith(const UChar* position, const UChar* end, const char* prefix)
+{
+    for (; *prefix; ++position, ++prefix) {
+        if (position == end || *position != *prefix)
+            return false;
+    }
+    return true;
+}
+
+static const UChar* findEndOfComment(const UChar* position, const UChar* end)
+{
+    for (position += 2; position + 1 < end; ++position) {
+        if (position[0] == '*' && position[1] == '/')
+            return position + 2;
+    }
+    return 0;
+}
+
+// Skips what the grammar skips between rules. Returns 0 if a comment is not
+// terminated.
+static const UChar* skipToNextRule(const UChar* position, const UChar* end)
+{
+    while (position < end) {
+        if (isHTMLSpace(*position))
+            ++position;
+        else if (startsWith(position, end, "/*")) {
+            position = findEndOfComment(position, end);
+            if (!position)
+                return 0;
+        } else if (startsWith(position, end, "<!--"))
+            position += 4;
+        else if (startsWith(position, end, "-->"))
+            position += 3;
+        else
+            break;
+    }
+    return position;
+}
+
+// Returns the end of the rule at |position|: just past the '}' that closes
+// its block or, for an at-rule without a block, the ';' that ends it. Returns
+// 0 when the rule is not terminated, or when strings, braces or parentheses
+// are unbalanced in a way the grammar's error recovery could treat
+// differently; the rest of the sheet then goes to the grammar.
+static const UChar* findEndOfRule(const UChar* position, const UChar* end)
+{
+    bool isAtRule = *position == '@';
+    unsigned braceDepth = 0;
+    unsigned parenthesisDepth = 0;
+    for (; position < end; ++position) {
+        switch (*position) {
+        case '\\':
+            if (++position == end)
+                return 0;
+            break;
+        case '"':
+        case '\'': {
+            UChar quote = *position;
+            while (++position < end && *position != quote) {
+                if (*position == '\\') {
+                    if (++position == end)
+                        return 0;
+                } else if (*position == '\n' || *position == '\r' || *position == '\f')
+                    return 0;
+            }
+            if (position == end)
+                return 0;
+            break;
+        }
+        case '/':
+            if (position + 1 < end && position[1] == '*') {
+                position = findEndOfComment(position, end);
+                if (!position)
+                    return 0;
+                --position;
+            }
+            break;
+        case '(':
+            ++parenthesisDepth;
+            break;
+        case ')':
+            if (parenthesisDepth)
+                --parenthesisDepth;
+            break;
+        case '{':
+            if (parenthesisDepth)
+                return 0;
+            ++braceDepth;
+            break;
+        case '}':
+            if (parenthesisDepth || !braceDepth)
+                return 0;
+            if (!--braceDepth)
+                return position + 1;
+            break;
+        case ';':
+            if (isAtRule && !braceDepth) {
+                if (parenthesisDepth)
+                    return 0;
+                return position + 1;
+            }
+            break;
+        }
+    }
+    return 0;
+}
+
+static int countLineBreaks(const UChar* position, const UChar* end)
+{
+    int lineBreaks = 0;
+    for (; position < end; ++position) {
+        if (*position == '\n')
+            ++lineBreaks;
+    }
+    return lineBreaks;
+}
+
+void CSSParser::parseSheetWithFastPath(const String& string)
+{
+    const UChar* characters = string.characters();
+    const UChar* end = characters + string.length();
+    bool lowercaseElementNames = document() && document()->isHTMLDocument();
+
+    const UChar* position = skipToNextRule(characters, end);
+    if (!position) {
+        setupParser("", string, "");
+        cssyyparse(this);
+        return;
+    }
+    const UChar* firstRule = position;
+    int lineNumber = m_lineNumber + countLineBreaks(characters, position);
+
+    // The rules the fast path could not handle, waiting to be parsed by the
+    // grammar in one go. If that includes the first rule, the grammar gets
+    // everything before it too, so that it sees the start of the sheet as is.
+    const UChar* grammarStart = 0;
+    int grammarStartLineNumber = 0;
+    int sheetStartLineNumber = m_lineNumber;
+
+    while (position < end) {
+        const UChar* ruleEnd = findEndOfRule(position, end);
+        if (!ruleEnd) {
+            if (!grammarStart) {
+                grammarStart = position == firstRule ? characters : position;
+                grammarStartLineNumber = position == firstRule ? sheetStartLineNumber : lineNumber;
+            }
+            break;
+        }
+
+        bool parsed = false;
+        if (*position != '@') {
+            const UChar* blockStart = position;
+            while (*blockStart != '{')
+                ++blockStart;
+            Vector<OwnPtr<CSSParserSelector> > selectors;
+            Vector<CSSProperty, 16> properties;
+            if (parseSelectorListFast(position, blockStart, lowercaseElementNames, selectors)
+                && parseDeclarationListFast(blockStart + 1, ruleEnd - 1, properties)) {
+                if (grammarStart) {
+                    parseSheetRangeWithGrammar(grammarStart, position, grammarStartLineNumber, grammarStart == characters);
+                    grammarStart = 0;
+                }
+                m_lineNumber = lineNumber + countLineBreaks(position, blockStart);
+                m_lastSelectorLineNumber = m_lineNumber;
+                for (size_t i = 0; i < properties.size(); ++i)
+                    addProperty(properties[i].id(), properties[i].value(), properties[i].isImportant());
+                m_styleSheet->append(createStyleRule(&selectors));
+                m_hadSyntacticallyValidCSSRule = true;
+                parsed = true;
+            }
+        }
+        if (!parsed && !grammarStart) {
+            grammarStart = position == firstRule ? characters : position;
+            grammarStartLineNumber = position == firstRule ? sheetStartLineNumber : lineNumber;
+        }
+
+        const UChar* nextRule = skipToNextRule(ruleEnd, end);
+        if (!nextRule) {
+            if (!grammarStart) {
+                grammarStart = ruleEnd;
+                grammarStartLineNumber = lineNumber + countLineBreaks(position, ruleEnd);
+            }
+            break;
+        }
+        lineNumber += countLineBreaks(position, nextRule);
+        position = nextRule;
+    }
+
+    if (grammarStart)
+        parseSheetRangeWithGrammar(grammarStart, end, grammarStartLineNumber, grammarStart == characters);
+}
+
+void CSSParser::parseSheetRangeWithGrammar(const UChar* start, const UChar* end, int startLineNumber, bool atStartOfSheet)
+{
+    m_lineNumber = startLineNumber;
+    // Past the start of the sheet, lead in with an SGML comment delimiter,
+    // which the grammar skips, so that a @charset rule is ignored as it would
+    // have been had the grammar seen the whole sheet.
+    setupParser(atStartOfSheet ? "" : "<!-- ", String(start, end - start), "");
+    cssyyparse(this);
+}
+
+bool CSSParser::parseSelectorListFast(const UChar* position, const UChar* end, bool lowercaseElementNames, Vector<OwnPtr<CSSParserSelector> >& selectors)
+{
+    while (true) {
+        position = skipWhitespace(position, end);
+        OwnPtr<CSSParserSelector> selector;
+        CSSSelector::Relation relation = CSSSelector::Descendant;
+        while (true) {
+            OwnPtr<CSSParserSelector> compound;
+            if (!parseCompoundSelectorFast(position, end, lowercaseElementNames, compound))
+                return false;
+            if (selector) {
+                CSSParserSelector* last = compound.get();
+                while (last->tagHistory())
+                    last = last->tagHistory();
+                last->setRelation(relation);
+                last->setTagHistory(selector.release());
+            }
+            selector = compound.release();
+
+            const UChar* afterWhitespace = skipWhitespace(position, end);
+            bool sawWhitespace = afterWhitespace != position;
+            position = afterWhitespace;
+            if (position == end || *position == ',')
+                break;
+            if (*position == '>' || *position == '+' || *position == '~') {
+                if (*position == '>')
+                    relation = CSSSelector::Child;
+                else if (*position == '+')
+                    relation = CSSSelector::DirectAdjacent;
+                else
+                    relation = CSSSelector::IndirectAdjacent;
+                position = skipWhitespace(position + 1, end);
+            } else if (sawWhitespace)
+                relation = CSSSelector::Descendant;
+            else
+                return false;
+        }
+        selectors.append(selector.release());
+        if (position == end)
+            return true;
+        ++position;
+    }
+}
+
+bool CSSParser::parseCompoundSelectorFast(const UChar*& position, const UChar* end, bool lowercaseElementNames, OwnPtr<CSSParserSelector>& compound)
+{
+    AtomicString elementName = starAtom;
+    bool hasElementName = false;
+    if (position < end && *position == '*') {
+        ++position;
+        hasElementName = true;
+    } else {
+        const UChar* nameEnd = scanIdentifier(position, end);
+        if (nameEnd != position) {
+            elementName = AtomicString(position, nameEnd - position);
+            if (lowercaseElementNames)
+                elementName = elementName.lower();
+            position = nameEnd;
+            hasElementName = true;
+        }
+    }
+
+    CSSParserSelector* last = 0;
+    while (position < end && (*position == '.' || *position == '#')) {
+        CSSSelector::Match match = *position == '.' ? CSSSelector::Class : CSSSelector::Id;
+        const UChar* valueStart = ++position;
+        position = scanIdentifier(position, end);
+        if (position == valueStart)
+            return false;
+        AtomicString value(valueStart, position - valueStart);
+        if (!m_strict)
+            value = value.lower();
+
+        OwnPtr<CSSParserSelector> specifier = adoptPtr(new CSSParserSelector);
+        specifier->setMatch(match);
+        specifier->setValue(value);
+        CSSParserSelector* next = specifier.get();
+        if (last) {
+            last->setRelation(CSSSelector::SubSelector);
+            last->setTagHistory(specifier.release());
+        } else
+            compound = specifier.release();
+        last = next;
+    }
+
+    if (!last) {
+        if (!hasElementName)
+            return false;
+        compound = adoptPtr(new CSSParserSelector);
+        compound->setTag(QualifiedName(nullAtom, elementName, m_defaultNamespace));
+        return true;
+    }
+    updateSpecifiersWithElementName(nullAtom, elementName, compound.get());
+    return true;
+}
+
+static inline bool isFastValueCharacter(UChar c)
+{
+    return isASCIIAlphanumeric(c) || c == '-' || c == '_' || c == '.' || c == '#' || c == '%' || c == '+' || c == '!' || isHTMLSpace(c);
+}
+
+bool CSSParser::parseDeclarationListFast(const UChar* position, const UChar* end, Vector<CSSProperty, 16>& properties)
+{
+    static const unsigned importantLength = 9;
+
+    while (true) {
+        while (position < end && (isHTMLSpace(*position) || *position == ';'))
+            ++position;
+        if (position == end)
+            return true;
+
+        const UChar* nameStart = position;
+        position = scanIdentifier(position, end);
+        if (position == nameStart)
+            return false;
+        CSSParserString name;
+        name.characters = const_cast<UChar*>(nameStart);
+        name.length = position - nameStart;
+
+        position = skipWhitespace(position, end);
+        if (position == end || *position != ':')
+            return false;
+        const UChar* valueStart = skipWhitespace(position + 1, end);
+        for (position = valueStart; position < end && *position != ';'; ++position) {
+            if (!isFastValueCharacter(*position))
+                return false;
+        }
+
+        const UChar* valueEnd = position;
+        while (valueEnd > valueStart && isHTMLSpace(valueEnd[-1]))
+            --valueEnd;
+        bool important = false;
+        if (static_cast<unsigned>(valueEnd - valueStart) > importantLength && WTF::equalIgnoringCase(valueEnd - importantLength, "important", importantLength)) {
+            const UChar* bang = valueEnd - importantLength;
+            while (bang > valueStart && isHTMLSpace(bang[-1]))
+                --bang;
+            if (bang > valueStart && bang[-1] == '!') {
+                important = true;
+                valueEnd = bang - 1;
+                while (valueEnd > valueStart && isHTMLSpace(valueEnd[-1]))
+                    --valueEnd;
+            }
+        }
+        if (valueStart == valueEnd)
+            return false;
+        // Values made of more than one token are left to the grammar.
+        for (const UChar* c = valueStart; c < valueEnd; ++c) {
+            if (isHTMLSpace(*c) || *c == '!')
+                return false;
+        }
+
+        // Like the grammar, drop declarations of unknown properties.
+        int propertyId = cssPropertyID(name);
+        if (!propertyId)
+            continue;
+        RefPtr<CSSValue> value = parseValueFast(propertyId, valueStart, valueEnd - valueStart);
+        if (!value)
+            return false;
+        properties.append(CSSProperty(propertyId, value.release(), important));
+    }
+}
+
+static inline bool isValidColorKeyword(int valueID, bool strict)
+{
+    return valueID == CSSValueWebkitText || valueID == CSSValueCurrentcolor
+        || (valueID >= CSSValueAqua && valueID <= CSSValueWindowtext) || valueID == CSSValueMenu
+        || (valueID >= CSSValueWebkitFocusRingColor && valueID < CSSValueWebkitText && !strict);
+}
+
+static inline bool isValidSimpleLengthKeyword(int propertyId, int valueID)
+{
+    switch (propertyId) {
+    case CSSPropertyFontSize:
+        return valueID >= CSSValueXxSmall && valueID <= CSSValueLarger;
+    case CSSPropertyHeight:
+    case CSSPropertyWidth:
+    case CSSPropertyWebkitLogicalWidth:
+    case CSSPropertyWebkitLogicalHeight:
+    case CSSPropertyBottom:
+    case CSSPropertyLeft:
+    case CSSPropertyRight:
+    case CSSPropertyTop:
+    case CSSPropertyMarginTop:
+    case CSSPropertyMarginRight:
+    case CSSPropertyMarginBottom:
+    case CSSPropertyMarginLeft:
+    case CSSPropertyWebkitMarginStart:
+    case CSSPropertyWebkitMarginEnd:
+    case CSSPropertyWebkitMarginBefore:
+    case CSSPropertyWebkitMarginAfter:
+        return valueID == CSSValueAuto;
+    default:
+        return false;
+    }
+}
+
+// Mirrors the keyword checks in parseValue(int, bool) for the properties that
+// only take a keyword.
+static bool isValidKeywordPropertyAndValue(int propertyId, int valueID)
+{
+    switch (propertyId) {
+    case CSSPropertyBorderCollapse:
+        return valueID == CSSValueCollapse || valueID == CSSValueSeparate;
+    case CSSPropertyBorderTopStyle:
+    case CSSPropertyBorderRightStyle:
+    case CSSPropertyBorderBottomStyle:
+    case CSSPropertyBorderLeftStyle:
+    case CSSPropertyWebkitBorderStartStyle:
+    case CSSPropertyWebkitBorderEndStyle:
+    case CSSPropertyWebkitBorderBeforeStyle:
+    case CSSPropertyWebkitBorderAfterStyle:
+    case CSSPropertyWebkitColumnRuleStyle:
+        return valueID >= CSSValueNone && valueID <= CSSValueDouble;
+    case CSSPropertyCaptionSide:
+        return valueID == CSSValueLeft || valueID == CSSValueRight || valueID == CSSValueTop || valueID == CSSValueBottom;
+    case CSSPropertyClear:
+        return valueID == CSSValueNone || valueID == CSSValueLeft || valueID == CSSValueRight || valueID == CSSValueBoth;
+    case CSSPropertyDirection:
+        return valueID == CSSValueLtr || valueID == CSSValueRtl;
+    case CSSPropertyDisplay:
+#if ENABLE(WCSS)
+        return (valueID >= CSSValueInline && valueID <= CSSValueWapMarquee) || valueID == CSSValueNone;
+#else
+        return (valueID >= CSSValueInline && valueID <= CSSValueWebkitInlineBox) || valueID == CSSValueNone;
+#endif
+    case CSSPropertyEmptyCells:
+        return valueID == CSSValueShow || valueID == CSSValueHide;
+    case CSSPropertyFloat:
+        return valueID == CSSValueLeft || valueID == CSSValueRight || valueID == CSSValueNone || valueID == CSSValueCenter;
+    case CSSPropertyFontStyle:
+        return valueID == CSSValueNormal || valueID == CSSValueItalic || valueID == CSSValueOblique;
+    case CSSPropertyFontVariant:
+        return valueID == CSSValueNormal || valueID == CSSValueSmallCaps;
+    case CSSPropertyFontWeight:
+        return valueID >= CSSValueNormal && valueID <= CSSValue900;
+    case CSSPropertyListStylePosition:
+        return valueID == CSSValueInside || valueID == CSSValueOutside;
+    case CSSPropertyListStyleType:
+        return (valueID >= CSSValueDisc && valueID <= CSSValueKatakanaIroha) || valueID == CSSValueNone;
+    case CSSPropertyOutlineStyle:
+        return valueID == CSSValueAuto || valueID == CSSValueNone || (valueID >= CSSValueInset && valueID <= CSSValueDouble);
+    case CSSPropertyOverflowX:
+    case CSSPropertyOverflowY:
+        return valueID == CSSValueVisible || valueID == CSSValueHidden || valueID == CSSValueScroll || valueID == CSSValueAuto
+            || valueID == CSSValueOverlay || valueID == CSSValueWebkitMarquee;
+    case CSSPropertyPageBreakAfter:
+    case CSSPropertyPageBreakBefore:
+    case CSSPropertyWebkitColumnBreakAfter:
+    case CSSPropertyWebkitColumnBreakBefore:
+        return valueID == CSSValueAuto || valueID == CSSValueAlways || valueID == CSSValueAvoid || valueID == CSSValueLeft || valueID == CSSValueRight;
+    case CSSPropertyPageBreakInside:
+    case CSSPropertyWebkitColumnBreakInside:
+        return valueID == CSSValueAuto || valueID == CSSValueAvoid;
+    case CSSPropertyPosition:
+        return valueID == CSSValueStatic || valueID == CSSValueRelative || valueID == CSSValueAbsolute || valueID == CSSValueFixed;
+    case CSSPropertyTextAlign:
+        return (valueID >= CSSValueWebkitAuto && valueID <= CSSValueWebkitMatchParent) || valueID == CSSValueStart || valueID == CSSValueEnd;
+    case CSSPropertyTextDecoration:
+    case CSSPropertyWebkitTextDecorationsInEffect:
+        return valueID == CSSValueNone;
+    case CSSPropertyTextTransform:
+        return (valueID >= CSSValueCapitalize && valueID <= CSSValueLowercase) || valueID == CSSValueNone;
+    case CSSPropertyUnicodeBidi:
+        return valueID == CSSValueNormal || valueID == CSSValueEmbed || valueID == CSSValueBidiOverride || valueID == CSSValueWebkitIsolate;
+    case CSSPropertyVerticalAlign:
+        return valueID >= CSSValueBaseline && valueID <= CSSValueWebkitBaselineMiddle;
+    case CSSPropertyVisibility:
+        return valueID == CSSValueVisible || valueID == CSSValueHidden || valueID == CSSValueCollapse;
+    case CSSPropertyWhiteSpace:
+        return valueID == CSSValueNormal || valueID == CSSValuePre || valueID == CSSValuePreWrap || valueID == CSSValuePreLine || valueID == CSSValueNowrap;
+    default:
+        return false;
+    }
+}
+
+// Parses a number with an optional sign and length or percentage unit, the
+// way the tokenizer splits it into a unary operator and a number token.
+static bool parseSimpleNumber(const UChar* characters, unsigned length, double& number, CSSPrimitiveValue::UnitTypes& unit)
+{
+    const UChar* position = characters;
+    const UChar* end = characters + length;
+    bool negative = false;
+    if (position < end && (*position == '+' || *position == '-')) {
+        negative = *position == '-';
+        ++position;
+    }
+
+    const UChar* numberStart = position;
+    while (position < end && isASCIIDigit(*position))
+        ++position;
+    if (position < end && *position == '.') {
+        const UChar* fractionStart = ++position;
+        while (position < end && isASCIIDigit(*position))
+            ++position;
+        if (position == fractionStart)
+            return false;
+    }
+    if (position == numberStart)
+        return false;
+
+    bool ok;
+    number = charactersToDouble(numberStart, position - numberStart, &ok);
+    if (!ok)
+        return false;
+    if (negative)
+        number = -number;
+
+    unsigned unitLength = end - position;
+    if (!unitLength)
+        unit = CSSPrimitiveValue::CSS_NUMBER;
+    else if (unitLength == 1 && *position == '%')
+        unit = CSSPrimitiveValue::CSS_PERCENTAGE;
+    else if (unitLength == 2) {
+        if (WTF::equalIgnoringCase(position, "px", 2))
+            unit = CSSPrimitiveValue::CSS_PX;
+        else if (WTF::equalIgnoringCase(position, "em", 2))
+            unit = CSSPrimitiveValue::CSS_EMS;
+        else if (WTF::equalIgnoringCase(position, "ex", 2))
+            unit = CSSPrimitiveValue::CSS_EXS;
+        else if (WTF::equalIgnoringCase(position, "pt", 2))
+            unit = CSSPrimitiveValue::CSS_PT;
+        else if (WTF::equalIgnoringCase(position, "pc", 2))
+            unit = CSSPrimitiveValue::CSS_PC;
+        else if (WTF::equalIgnoringCase(position, "cm", 2))
+            unit = CSSPrimitiveValue::CSS_CM;
+        else if (WTF::equalIgnoringCase(position, "mm", 2))
+            unit = CSSPrimitiveValue::CSS_MM;
+        else if (WTF::equalIgnoringCase(position, "in", 2))
+            unit = CSSPrimitiveValue::CSS_IN;
+        else
+            return false;
+    } else if (unitLength == 3 && WTF::equalIgnoringCase(position, "rem", 3))
+        unit = CSSPrimitiveValue::CSS_REMS;
+    else
+        return false;
+    return true;
+}
+
+PassRefPtr<CSSValue> CSSParser::parseValueFast(int propertyId, const UChar* characters, unsigned length)
+{
+    int valueID = 0;
+    if (scanIdentifier(characters, characters + length) == characters + length) {
+        CSSParserString string;
+        string.characters = const_cast<UChar*>(characters);
+        string.length = length;
+        valueID = cssValueKeywordID(string);
+        if (!valueID)
+            return 0;
+        if (valueID == CSSValueInherit)
+            return CSSInheritedValue::create();
+        if (valueID == CSSValueInitial)
+            return CSSInitialValue::createExplicit();
+    }
+
+    if (isColorPropertyID(propertyId)) {
+        if (valueID)
+            return isValidColorKeyword(valueID, m_strict) ? primitiveValueCache()->createIdentifierValue(valueID) : 0;
+        RGBA32 color;
+        if ((length != 4 && length != 7) || characters[0] != '#' || !Color::parseHexColor(characters + 1, length - 1, color))
+            return 0;
+        return primitiveValueCache()->createColorValue(color);
+    }
+
+    bool acceptsNegativeNumbers;
+    if (isSimpleLengthPropertyID(propertyId, acceptsNegativeNumbers)) {
+        if (valueID)
+            return isValidSimpleLengthKeyword(propertyId, valueID) ? primitiveValueCache()->createIdentifierValue(valueID) : 0;
+        double number;
+        CSSPrimitiveValue::UnitTypes unit;
+        if (!parseSimpleNumber(characters, length, number, unit))
+            return 0;
+        if (unit == CSSPrimitiveValue::CSS_NUMBER) {
+            if (number && m_strict)
+                return 0;
+            unit = CSSPrimitiveValue::CSS_PX;
+        }
+        if (number < 0 && !acceptsNegativeNumbers)
+            return 0;
+        return primitiveValueCache()->createValue(number, unit);
+    }
+
+    if (!valueID) {
+        if (propertyId != CSSPropertyFontWeight)
+            return 0;
+        // Numeric weights, as parseFontWeight() maps them.
+        for (unsigned i = 0; i < length; ++i) {
+            if (!isASCIIDigit(characters[i]))
+                return 0;
+        }
+        int weight = static_cast<int>(charactersToDouble(characters, length));
+        if (weight % 100 || weight < 100 || weight > 900)
+            return 0;
+        return primitiveValueCache()->createIdentifierValue(CSSValue100 + weight / 100 - 1);
+    }
+
+    if (!isValidKeywordPropertyAndValue(propertyId, valueID))
+        return 0;
+    return primitiveValueCache()->createIdentifierValue(valueID);
+}
+
 bool CSSParser::parseMediaQuery(MediaList* queries, const String& string)
 {
     if (string.isEmpty())
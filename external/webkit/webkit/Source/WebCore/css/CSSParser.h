@@ -282,6 +282,16 @@ namespace WebCore {
 
         void setupParser(const char* prefix, const String&, const char* suffix);
 
+        // A hand-written parser for style rules and declaration blocks made
+        // only of simple selectors and single-token values. Anything else is
+        // left to the grammar.
+        void parseSheetWithFastPath(const String&);
+        void parseSheetRangeWithGrammar(const UChar* start, const UChar* end, int startLineNumber, bool atStartOfSheet);
+        bool parseSelectorListFast(const UChar* start, const UChar* end, bool lowercaseElementNames, Vector<OwnPtr<CSSParserSelector> >&);
+        bool parseCompoundSelectorFast(const UChar*& position, const UChar* end, bool lowercaseElementNames, OwnPtr<CSSParserSelector>&);
+        bool parseDeclarationListFast(const UChar* start, const UChar* end, Vector<CSSProperty, 16>&);
+        PassRefPtr<CSSValue> parseValueFast(int propId, const UChar*, unsigned length);
+
         bool inShorthand() const { return m_inParseShorthand; }
 
         void checkForOrphanedUnits();
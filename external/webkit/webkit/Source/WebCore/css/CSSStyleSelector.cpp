@@ -51,6 +51,7 @@
 #include "CSSTimingFunctionValue.h"
 #include "CSSValueList.h"
 #include "CachedImage.h"
+#include "CompiledSelector.h"
 #include "Counter.h"
 #include "FocusController.h"
 #include "FontFamilyValue.h"
@@ -98,7 +99,9 @@
 #include "WebKitCSSKeyframesRule.h"
 #include "WebKitCSSTransformValue.h"
 #include "XMLNames.h"
+#include <limits>
 #include <wtf/StdLibExtras.h>
+#include <wtf/StringHasher.h>
 #include <wtf/Vector.h>
 
 #if USE(PLATFORM_STRATEGIES)
@@ -294,7 +297,7 @@ public:
     CSSStyleRule* rule() const { return m_rule; }
     CSSSelector* selector() const { return m_selector; }
     
-    bool hasFastCheckableSelector() const { return m_hasFastCheckableSelector; }
+    CompiledSelector* compiledSelector() const { return m_compiledSelector.get(); }
     bool hasMultipartSelector() const { return m_hasMultipartSelector; }
     bool hasTopSelectorMatchingHTMLBasedOnRuleHash() const { return m_hasTopSelectorMatchingHTMLBasedOnRuleHash; }
     unsigned specificity() const { return m_specificity; }
@@ -309,9 +312,9 @@ private:
     
     CSSStyleRule* m_rule;
     CSSSelector* m_selector;
+    RefPtr<CompiledSelector> m_compiledSelector;
     unsigned m_specificity;
-    unsigned m_position : 29;
-    bool m_hasFastCheckableSelector : 1;
+    unsigned m_position : 30;
     bool m_hasMultipartSelector : 1;
     bool m_hasTopSelectorMatchingHTMLBasedOnRuleHash : 1;
     // Use plain array instead of a Vector to minimize memory overhead.
@@ -436,6 +439,8 @@ CSSStyleSelector::CSSStyleSelector(Document* document, StyleSheetList* styleShee
     , m_styledElement(0)
     , m_elementLinkState(NotInsideLink)
     , m_fontSelector(CSSFontSelector::create(document))
+    , m_hasExplicitlyInheritedProperties(false)
+    , m_matchedStyleCacheAdditionsSinceLastSweep(0)
     , m_applyProperty(CSSStyleApplyProperty::sharedCSSStyleApplyProperty())
 {
     m_matchAuthorAndUserStyles = matchAuthorAndUserStyles;
@@ -843,6 +848,8 @@ inline void CSSStyleSelector::initForStyleResolve(Element* e, RenderStyle* paren
     m_ruleList = 0;
 
     m_fontDirty = false;
+
+    m_hasExplicitlyInheritedProperties = false;
 }
 
 static inline const AtomicString* linkAttribute(Node* node)
@@ -937,7 +944,7 @@ bool CSSStyleSelector::SelectorChecker::checkSelector(CSSSelector* sel, Element*
     return checkSelector(sel, element, 0, dynamicPseudo, false, false) == SelectorMatches;
 }
 
-static const unsigned cStyleSearchThreshold = 10;
+static const unsigned cStyleSearchThreshold = 20;
 static const unsigned cStyleSearchLevelThreshold = 10;
 
 Node* CSSStyleSelector::locateCousinList(Element* parent, unsigned& visitedNodeCount) const
@@ -1260,8 +1267,11 @@ PassRefPtr<RenderStyle> CSSStyleSelector::styleForElement(Element* e, RenderStyl
     initForStyleResolve(e, defaultParent);
     if (allowSharing) {
         RenderStyle* sharedStyle = locateSharedStyle();
-        if (sharedStyle)
+        if (sharedStyle) {
+            ++m_styleCacheStatistics.sharedStyleHits;
             return sharedStyle;
+        }
+        ++m_styleCacheStatistics.sharedStyleMisses;
     }
 
     // Compute our style allowing :visited to match first.
@@ -1444,7 +1454,56 @@ PassRefPtr<RenderStyle> CSSStyleSelector::styleForElement(Element* e, RenderStyl
 
     // Reset the value back before applying properties, so that -webkit-link knows what color to use.
     m_checker.m_matchVisitedPseudoClass = matchVisitedPseudoClass;
-    
+
+    MatchedRuleRanges ranges;
+    ranges.firstUARule = firstUARule;
+    ranges.lastUARule = lastUARule;
+    ranges.firstUserRule = firstUserRule;
+    ranges.lastUserRule = lastUserRule;
+    ranges.firstAuthorRule = firstAuthorRule;
+    ranges.lastAuthorRule = lastAuthorRule;
+
+    unsigned cacheHash = 0;
+    if (!resolveForRootDefault && !visitedStyle && !matchVisitedPseudoClass && isCacheableInMatchedStyleCache())
+        cacheHash = computeMatchedStyleCacheHash(ranges);
+    const MatchedStyleCacheItem* cacheItem = cacheHash ? findFromMatchedStyleCache(cacheHash, ranges) : 0;
+    if (cacheItem && m_parentStyle->inheritedDataShared(cacheItem->parentRenderStyle.get())) {
+        // The parent's inherited style is the same as when we built the cached style, so applying
+        // the declarations would give the same style again. Copy the style data but keep the bits
+        // that the rule matching set on our style.
+        ++m_styleCacheStatistics.matchedStyleCacheHits;
+        m_style->copyNonInheritedFrom(cacheItem->renderStyle.get());
+        m_style->inheritFrom(cacheItem->renderStyle.get());
+        cacheBorderAndBackground();
+    } else {
+        if (cacheHash)
+            ++m_styleCacheStatistics.matchedStyleCacheMisses;
+        applyMatchedDeclarations(ranges, resolveForRootDefault);
+        if (cacheHash)
+            addToMatchedStyleCache(cacheHash, ranges);
+    }
+
+    // Clean up our style object's display and text decorations (among other fixups).
+    adjustRenderStyle(style(), m_parentStyle, e);
+
+    // If we have first-letter pseudo style, do not share this style
+    if (m_style->hasPseudoStyle(FIRST_LETTER))
+        m_style->setUnique();
+
+    if (visitedStyle) {
+        // Add the visited style off the main style.
+        m_style->addCachedPseudoStyle(visitedStyle.release());
+    }
+
+    if (!matchVisitedPseudoClass)
+        initElement(0); // Clear out for the next resolve.
+
+    // Now return the style.
+    return m_style.release();
+}
+
+void CSSStyleSelector::applyMatchedDeclarations(const MatchedRuleRanges& ranges, bool resolveForRootDefault)
+{
     // Now we have all of the matched rules in the appropriate order.  Walk the rules and apply
     // high-priority properties first, i.e., those properties that other properties depend on.
     // The order is (1) high-priority not important, (2) high-priority important, (3) normal not important
@@ -1452,10 +1511,10 @@ PassRefPtr<RenderStyle> CSSStyleSelector::styleForElement(Element* e, RenderStyl
     m_lineHeightValue = 0;
     applyDeclarations<true>(false, 0, m_matchedDecls.size() - 1);
     if (!resolveForRootDefault) {
-        applyDeclarations<true>(true, firstAuthorRule, lastAuthorRule);
-        applyDeclarations<true>(true, firstUserRule, lastUserRule);
+        applyDeclarations<true>(true, ranges.firstAuthorRule, ranges.lastAuthorRule);
+        applyDeclarations<true>(true, ranges.firstUserRule, ranges.lastUserRule);
     }
-    applyDeclarations<true>(true, firstUARule, lastUARule);
+    applyDeclarations<true>(true, ranges.firstUARule, ranges.lastUARule);
     
     // If our font got dirtied, go ahead and update it now.
     if (m_fontDirty)
@@ -1466,45 +1525,122 @@ PassRefPtr<RenderStyle> CSSStyleSelector::styleForElement(Element* e, RenderStyl
         applyProperty(CSSPropertyLineHeight, m_lineHeightValue);
 
     // Now do the normal priority UA properties.
-    applyDeclarations<false>(false, firstUARule, lastUARule);
+    applyDeclarations<false>(false, ranges.firstUARule, ranges.lastUARule);
     
     // Cache our border and background so that we can examine them later.
     cacheBorderAndBackground();
     
     // Now do the author and user normal priority properties and all the !important properties.
     if (!resolveForRootDefault) {
-        applyDeclarations<false>(false, lastUARule + 1, m_matchedDecls.size() - 1);
-        applyDeclarations<false>(true, firstAuthorRule, lastAuthorRule);
-        applyDeclarations<false>(true, firstUserRule, lastUserRule);
+        applyDeclarations<false>(false, ranges.lastUARule + 1, m_matchedDecls.size() - 1);
+        applyDeclarations<false>(true, ranges.firstAuthorRule, ranges.lastAuthorRule);
+        applyDeclarations<false>(true, ranges.firstUserRule, ranges.lastUserRule);
     }
-    applyDeclarations<false>(true, firstUARule, lastUARule);
+    applyDeclarations<false>(true, ranges.firstUARule, ranges.lastUARule);
 
     ASSERT(!m_fontDirty);
     // If our font got dirtied by one of the non-essential font props, 
     // go ahead and update it a second time.
     if (m_fontDirty)
         updateFont();
-    
-    // Clean up our style object's display and text decorations (among other fixups).
-    adjustRenderStyle(style(), m_parentStyle, e);
 
     // Start loading images referenced by this style.
     loadPendingImages();
+}
 
-    // If we have first-letter pseudo style, do not share this style
-    if (m_style->hasPseudoStyle(FIRST_LETTER))
-        m_style->setUnique();
+// How often we look for matched style cache items that are unlikely to be used again.
+static const unsigned matchedStyleCacheAdditionsBetweenSweeps = 100;
 
-    if (visitedStyle) {
-        // Add the visited style off the main style.
-        m_style->addCachedPseudoStyle(visitedStyle.release());
+bool CSSStyleSelector::isCacheableInMatchedStyleCache() const
+{
+    // The root element's style is applied with side effects on the document (e.g., the writing mode).
+    if (!m_parentNode || m_element == m_element->document()->documentElement())
+        return false;
+    // The inline style declaration changes in place.
+    if (m_styledElement && m_styledElement->inlineStyleDecl())
+        return false;
+    // Links and the elements inside them also get a :visited style, SVG elements use their own
+    // zoom rules, and some properties (e.g., -wap-input-format) change form controls directly.
+    if (m_element->isLink() || m_style->insideLink() != NotInsideLink)
+        return false;
+    if (m_element->isSVGElement() || m_element->isFormControlElement())
+        return false;
+    // A cache hit only requires the parent's inherited data to be the same, but 'inherit' on a
+    // non-inherited property (e.g., width: inherit) reads the parent's non-inherited data too.
+    if (m_hasExplicitlyInheritedProperties)
+        return false;
+    return !m_style->unique();
+}
+
+unsigned CSSStyleSelector::computeMatchedStyleCacheHash(const MatchedRuleRanges& ranges) const
+{
+    unsigned hash = StringHasher::hashMemory(m_matchedDecls.data(), m_matchedDecls.size() * sizeof(CSSMutableStyleDeclaration*));
+    hash ^= StringHasher::hashMemory<sizeof(MatchedRuleRanges)>(&ranges);
+    // 0 and -1 are the empty and deleted values of the cache's hash table.
+    if (!hash || hash == std::numeric_limits<unsigned>::max())
+        hash = 1;
+    return hash;
+}
+
+const CSSStyleSelector::MatchedStyleCacheItem* CSSStyleSelector::findFromMatchedStyleCache(unsigned hash, const MatchedRuleRanges& ranges) const
+{
+    MatchedStyleCache::const_iterator it = m_matchedStyleCache.find(hash);
+    if (it == m_matchedStyleCache.end())
+        return 0;
+    const MatchedStyleCacheItem& cacheItem = it->second;
+    if (!(cacheItem.ranges == ranges) || cacheItem.declarations.size() != m_matchedDecls.size())
+        return 0;
+    for (size_t i = 0; i < m_matchedDecls.size(); ++i) {
+        if (cacheItem.declarations[i] != m_matchedDecls[i])
+            return 0;
     }
+    return &cacheItem;
+}
 
-    if (!matchVisitedPseudoClass)
-        initElement(0); // Clear out for the next resolve.
+void CSSStyleSelector::addToMatchedStyleCache(unsigned hash, const MatchedRuleRanges& ranges)
+{
+    // These styles depend on more than the declarations and the parent's inherited style.
+    if (m_style->unique() || m_style->hasAppearance() || m_hasExplicitlyInheritedProperties)
+        return;
 
-    // Now return the style.
-    return m_style.release();
+    if (++m_matchedStyleCacheAdditionsSinceLastSweep >= matchedStyleCacheAdditionsBetweenSweeps)
+        sweepMatchedStyleCache();
+
+    MatchedStyleCacheItem cacheItem;
+    cacheItem.declarations.reserveInitialCapacity(m_matchedDecls.size());
+    for (size_t i = 0; i < m_matchedDecls.size(); ++i)
+        cacheItem.declarations.uncheckedAppend(m_matchedDecls[i]);
+    cacheItem.ranges = ranges;
+    // The cached style must not see the changes adjustRenderStyle() makes to m_style.
+    cacheItem.renderStyle = RenderStyle::clone(m_style.get());
+    cacheItem.parentRenderStyle = m_parentStyle;
+    m_matchedStyleCache.set(hash, cacheItem);
+}
+
+void CSSStyleSelector::sweepMatchedStyleCache()
+{
+    m_matchedStyleCacheAdditionsSinceLastSweep = 0;
+
+    // Drop the items whose parent style is no longer used by any element; elements with a parent
+    // style like it are unlikely to be styled again soon. Also drop the items with a declaration
+    // that only we hold on to (e.g., for an attribute value that is gone).
+    Vector<unsigned, 16> toRemove;
+    MatchedStyleCache::iterator end = m_matchedStyleCache.end();
+    for (MatchedStyleCache::iterator it = m_matchedStyleCache.begin(); it != end; ++it) {
+        const MatchedStyleCacheItem& cacheItem = it->second;
+        bool shouldRemove = cacheItem.parentRenderStyle->hasOneRef();
+        for (size_t i = 0; !shouldRemove && i < cacheItem.declarations.size(); ++i)
+            shouldRemove = cacheItem.declarations[i]->hasOneRef();
+        if (shouldRemove)
+            toRemove.append(it->first);
+    }
+    for (size_t i = 0; i < toRemove.size(); ++i)
+        m_matchedStyleCache.remove(toRemove[i]);
+}
+
+void CSSStyleSelector::invalidateMatchedStyleCache()
+{
+    m_matchedStyleCache.clear();
 }
 
 PassRefPtr<RenderStyle> CSSStyleSelector::styleForKeyframe(const RenderStyle* elementStyle, const WebKitCSSKeyframeRule* keyframeRule, KeyframeValue& keyframe)
@@ -2046,8 +2182,9 @@ inline bool CSSStyleSelector::checkSelector(const RuleData& ruleData)
 {
     m_dynamicPseudo = NOPSEUDO;
 
-    // Let the slow path handle SVG as it has some additional rules regarding shadow trees.
-    if (ruleData.hasFastCheckableSelector() && !m_element->isSVGElement()) {
+    // Let the slow path handle SVG as it has some additional rules regarding shadow trees, and
+    // visited link matching as it depends on the links between the element and its ancestors.
+    if (ruleData.compiledSelector() && !m_element->isSVGElement() && !m_checker.m_matchVisitedPseudoClass) {
         // We know this selector does not include any pseudo selectors.
         if (m_checker.m_pseudoStyle != NOPSEUDO)
             return false;
@@ -2055,7 +2192,13 @@ inline bool CSSStyleSelector::checkSelector(const RuleData& ruleData)
         // This is limited to HTML only so we don't need to check the namespace.
         if (ruleData.hasTopSelectorMatchingHTMLBasedOnRuleHash() && !ruleData.hasMultipartSelector() && m_element->isHTMLElement())
             return true;
-        return SelectorChecker::fastCheckSelector(ruleData.selector(), m_element);
+        CompiledSelector::MatchContext context;
+        context.elementStyle = style();
+        context.elementParentStyle = m_parentNode ? m_parentNode->renderStyle() : 0;
+        context.selectorAttrs = &m_selectorAttrs;
+        context.documentIsHTML = m_checker.m_documentIsHTML;
+        context.collectRulesOnly = m_checker.m_collectRulesOnly;
+        return ruleData.compiledSelector()->match(m_element, context);
     }
 
     // Slow path.
@@ -2078,111 +2221,6 @@ static inline bool selectorTagMatches(const Element* element, const CSSSelector*
     return namespaceURI == starAtom || namespaceURI == element->namespaceURI();
 }
 
-static inline bool isFastCheckableSelector(const CSSSelector* selector)
-{
-    for (; selector; selector = selector->tagHistory()) {
-        if (selector->relation() != CSSSelector::Descendant && selector->relation() != CSSSelector::Child && selector->relation() != CSSSelector::SubSelector)
-            return false;
-        if (selector->m_match != CSSSelector::None && selector->m_match != CSSSelector::Id && selector->m_match != CSSSelector::Class)
-            return false;
-    }
-    return true;
-}
-    
-template <class ValueChecker>
-inline bool fastCheckSingleSelector(const CSSSelector*& selector, const Element*& element, const CSSSelector*& topChildOrSubselector, const Element*& topChildOrSubselectorMatchElement)
-{
-    AtomicStringImpl* value = selector->value().impl();
-    for (; element; element = element->parentElement()) {
-        if (ValueChecker::checkValue(element, value) && selectorTagMatches(element, selector)) {
-            if (selector->relation() == CSSSelector::Descendant)
-                topChildOrSubselector = 0;
-            else if (!topChildOrSubselector) {
-                ASSERT(selector->relation() == CSSSelector::Child || selector->relation() == CSSSelector::SubSelector);
-                topChildOrSubselector = selector;
-                topChildOrSubselectorMatchElement = element;
-            }
-            if (selector->relation() != CSSSelector::SubSelector)
-                element = element->parentElement();
-            selector = selector->tagHistory();
-            return true;
-        }
-        if (topChildOrSubselector) {
-            // Child or subselector check failed.
-            // If the match element is null, topChildOrSubselector was also the very topmost selector and had to match 
-            // the original element we were checking.
-            if (!topChildOrSubselectorMatchElement)
-                return false;
-            // There may be other matches down the ancestor chain.
-            // Rewind to the topmost child or subselector and the element it matched, continue checking ancestors.
-            selector = topChildOrSubselector;
-            element = topChildOrSubselectorMatchElement->parentElement();
-            topChildOrSubselector = 0;
-            return true;
-        }
-    }
-    return false;
-}
-
-struct ClassCheck {
-    static bool checkValue(const Element* element, AtomicStringImpl* value) 
-    {
-        return element->hasClass() && static_cast<const StyledElement*>(element)->classNames().contains(value);
-    }
-};
-struct IdCheck {
-    static bool checkValue(const Element* element, AtomicStringImpl* value) 
-    {
-        return element->hasID() && element->idForStyleResolution().impl() == value;
-    }
-};
-struct TagCheck {
-    static bool checkValue(const Element*, AtomicStringImpl*)
-    {
-        return true;
-    }
-};
-
-bool CSSStyleSelector::SelectorChecker::fastCheckSelector(const CSSSelector* selector, const Element* element)
-{
-    ASSERT(isFastCheckableSelector(selector));
-
-    // The top selector requires tag check only as rule hashes have already handled id and class matches.
-    if (!selectorTagMatches(element, selector))
-        return false;
-
-    const CSSSelector* topChildOrSubselector = 0;
-    const Element* topChildOrSubselectorMatchElement = 0;
-    if (selector->relation() == CSSSelector::Child || selector->relation() == CSSSelector::SubSelector)
-        topChildOrSubselector = selector;
-
-    if (selector->relation() != CSSSelector::SubSelector)
-        element = element->parentElement();
-
-    selector = selector->tagHistory();
-
-    // We know this compound selector has descendant, child and subselector combinators only and all components are simple.
-    while (selector) {
-        switch (selector->m_match) {
-        case CSSSelector::Class:
-            if (!fastCheckSingleSelector<ClassCheck>(selector, element, topChildOrSubselector, topChildOrSubselectorMatchElement))
-                return false;
-            break;
-        case CSSSelector::Id:
-            if (!fastCheckSingleSelector<IdCheck>(selector, element, topChildOrSubselector, topChildOrSubselectorMatchElement))
-                return false;
-            break;
-        case CSSSelector::None:
-            if (!fastCheckSingleSelector<TagCheck>(selector, element, topChildOrSubselector, topChildOrSubselectorMatchElement))
-                return false;
-            break;
-        default:
-            ASSERT_NOT_REACHED();
-        }
-    }
-    return true;
-}
-
 // Recursive check of selectors and combinators
 // It can return 3 different values:
 // * SelectorMatches         - the selector matches the element e
@@ -2361,7 +2399,7 @@ static HashSet<AtomicStringImpl*>* createHtmlCaseInsensitiveAttributesSet()
     return attrSet;
 }
 
-static bool htmlAttributeHasCaseInsensitiveValue(const QualifiedName& attr)
+bool CSSStyleSelector::SelectorChecker::htmlAttributeHasCaseInsensitiveValue(const QualifiedName& attr)
 {
     static HashSet<AtomicStringImpl*>* htmlCaseInsensitiveAttributesSet = createHtmlCaseInsensitiveAttributesSet();
     bool isPossibleHTMLAttr = !attr.hasPrefix() && (attr.namespaceURI() == nullAtom);
@@ -3048,9 +3086,9 @@ static inline bool isSelectorMatchingHTMLBasedOnRuleHash(const CSSSelector* sele
 RuleData::RuleData(CSSStyleRule* rule, CSSSelector* selector, unsigned position)
     : m_rule(rule)
     , m_selector(selector)
+    , m_compiledSelector(CompiledSelector::compile(selector))
     , m_specificity(selector->specificity())
     , m_position(position)
-    , m_hasFastCheckableSelector(isFastCheckableSelector(selector))
     , m_hasMultipartSelector(selector->tagHistory())
     , m_hasTopSelectorMatchingHTMLBasedOnRuleHash(isSelectorMatchingHTMLBasedOnRuleHash(selector))
 {
@@ -3563,6 +3601,11 @@ void CSSStyleSelector::applyProperty(int id, CSSValue *value)
 
     bool isInherit = m_parentNode && valueType == CSSValue::CSS_INHERIT;
     bool isInitial = valueType == CSSValue::CSS_INITIAL || (!m_parentNode && valueType == CSSValue::CSS_INHERIT);
+
+    // Every HANDLE_INHERIT* macro and isInherit branch below copies from the parent style, possibly
+    // from its non-inherited data, which the matched style cache does not compare.
+    if (isInherit)
+        m_hasExplicitlyInheritedProperties = true;
     
     id = CSSProperty::resolveDirectionAwareProperty(id, m_style->direction(), m_style->writingMode());
 
@@ -60,6 +60,7 @@ class KeyframeList;
 class KeyframeValue;
 class MediaQueryEvaluator;
 class Node;
+class QualifiedName;
 class RuleData;
 class RuleSet;
 class Settings;
@@ -183,6 +184,26 @@ public:
         bool usesBeforeAfterRules() const { return m_features.usesBeforeAfterRules; }
         bool usesLinkRules() const { return m_features.usesLinkRules; }
 
+        struct StyleCacheStatistics {
+            StyleCacheStatistics()
+                : sharedStyleHits(0)
+                , sharedStyleMisses(0)
+                , matchedStyleCacheHits(0)
+                , matchedStyleCacheMisses(0)
+            {
+            }
+
+            unsigned sharedStyleHits;
+            unsigned sharedStyleMisses;
+            unsigned matchedStyleCacheHits;
+            unsigned matchedStyleCacheMisses;
+        };
+        const StyleCacheStatistics& styleCacheStatistics() const { return m_styleCacheStatistics; }
+
+        // Some style values depend on the document as well as on the matched declarations (e.g., the
+        // zoom factor and the link colors). Call this when one of those changes.
+        void invalidateMatchedStyleCache();
+
         static bool createTransformOperations(CSSValue* inValue, RenderStyle* inStyle, RenderStyle* rootStyle, TransformOperations& outOperations);
 
         struct Features {
@@ -218,6 +239,49 @@ public:
         template <bool firstPass>
         void applyDeclarations(bool important, int startIndex, int endIndex);
 
+        // Where the user agent, user and author declarations are in m_matchedDecls.
+        struct MatchedRuleRanges {
+            MatchedRuleRanges()
+                : firstUARule(-1)
+                , lastUARule(-1)
+                , firstUserRule(-1)
+                , lastUserRule(-1)
+                , firstAuthorRule(-1)
+                , lastAuthorRule(-1)
+            {
+            }
+
+            bool operator==(const MatchedRuleRanges& other) const
+            {
+                return firstUARule == other.firstUARule && lastUARule == other.lastUARule
+                    && firstUserRule == other.firstUserRule && lastUserRule == other.lastUserRule
+                    && firstAuthorRule == other.firstAuthorRule && lastAuthorRule == other.lastAuthorRule;
+            }
+
+            int firstUARule;
+            int lastUARule;
+            int firstUserRule;
+            int lastUserRule;
+            int firstAuthorRule;
+            int lastAuthorRule;
+        };
+        void applyMatchedDeclarations(const MatchedRuleRanges&, bool resolveForRootDefault);
+
+        // Elements that match the same declarations, and whose parents have the same inherited
+        // style, get the same style. The cache maps the matched declarations to the style we
+        // computed for them, so that we don't have to apply them again.
+        struct MatchedStyleCacheItem {
+            Vector<RefPtr<CSSMutableStyleDeclaration> > declarations;
+            MatchedRuleRanges ranges;
+            RefPtr<RenderStyle> renderStyle;
+            RefPtr<RenderStyle> parentRenderStyle;
+        };
+        bool isCacheableInMatchedStyleCache() const;
+        unsigned computeMatchedStyleCacheHash(const MatchedRuleRanges&) const;
+        const MatchedStyleCacheItem* findFromMatchedStyleCache(unsigned hash, const MatchedRuleRanges&) const;
+        void addToMatchedStyleCache(unsigned hash, const MatchedRuleRanges&);
+        void sweepMatchedStyleCache();
+
         void matchPageRules(RuleSet*, bool isLeftPage, bool isFirstPage, const String& pageName);
         void matchPageRulesForList(const Vector<RuleData>*, bool isLeftPage, bool isFirstPage, const String& pageName);
         bool isLeftPage(int pageIndex) const;
@@ -262,7 +326,7 @@ public:
             SelectorMatch checkSelector(CSSSelector*, Element*, HashSet<AtomicStringImpl*>* selectorAttrs, PseudoId& dynamicPseudo, bool isSubSelector, bool encounteredLink, RenderStyle* = 0, RenderStyle* elementParentStyle = 0) const;
             bool checkOneSelector(CSSSelector*, Element*, HashSet<AtomicStringImpl*>* selectorAttrs, PseudoId& dynamicPseudo, bool isSubSelector, bool encounteredLink, RenderStyle*, RenderStyle* elementParentStyle) const;
             bool checkScrollbarPseudoClass(CSSSelector*, PseudoId& dynamicPseudo) const;
-            static bool fastCheckSelector(const CSSSelector*, const Element*);
+            static bool htmlAttributeHasCaseInsensitiveValue(const QualifiedName&);
 
             EInsideLink determineLinkState(Element* element) const;
             EInsideLink determineLinkStateSlowCase(Element* element) const;
@@ -354,9 +418,17 @@ public:
         CSSValue* m_lineHeightValue;
         bool m_fontDirty;
         bool m_matchAuthorAndUserStyles;
+        // Set when a declaration applied to the current style used 'inherit'.
+        bool m_hasExplicitlyInheritedProperties;
         
         RefPtr<CSSFontSelector> m_fontSelector;
         HashSet<AtomicStringImpl*> m_selectorAttrs;
+
+        typedef HashMap<unsigned, MatchedStyleCacheItem> MatchedStyleCache;
+        MatchedStyleCache m_matchedStyleCache;
+        unsigned m_matchedStyleCacheAdditionsSinceLastSweep;
+        StyleCacheStatistics m_styleCacheStatistics;
+
         Vector<CSSMutableStyleDeclaration*> m_additionalAttributeStyleDecls;
         Vector<MediaQueryResult*> m_viewportDependentMediaQueryResults;
 
@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2011 Google, Inc. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "CompiledSelector.h"
+
+#include "CSSStyleSelector.h"
+#include "HTMLNames.h"
+#include "RenderStyle.h"
+#include "StyledElement.h"
+
+namespace WebCore {
+
+using namespace HTMLNames;
+
+static inline bool isCompilableRelation(CSSSelector::Relation relation)
+{
+    switch (relation) {
+    case CSSSelector::Descendant:
+    case CSSSelector::Child:
+    case CSSSelector::DirectAdjacent:
+    case CSSSelector::IndirectAdjacent:
+    case CSSSelector::SubSelector:
+        return true;
+    case CSSSelector::ShadowDescendant:
+        return false;
+    }
+    return false;
+}
+
+PassRefPtr<CompiledSelector> CompiledSelector::compile(const CSSSelector* selector)
+{
+    RefPtr<CompiledSelector> compiled = adoptRef(new CompiledSelector);
+    Vector<Check>& checks = compiled->m_checks;
+
+    Compound compound;
+    compound.firstCheck = 0;
+    for (; selector; selector = selector->tagHistory()) {
+        if (!isCompilableRelation(selector->relation()))
+            return 0;
+
+        // Like checkOneSelector(), test the tag before the other component.
+        if (selector->hasTag()) {
+            const QualifiedName& tag = selector->tag();
+            if (tag.localName() != starAtom || tag.namespaceURI() != starAtom) {
+                Check check(TagCheck);
+                check.value = tag.localName() == starAtom ? 0 : tag.localName().impl();
+                check.namespaceURI = tag.namespaceURI() == starAtom ? 0 : tag.namespaceURI().impl();
+                checks.append(check);
+            }
+        }
+
+        switch (selector->m_match) {
+        case CSSSelector::None:
+            break;
+        case CSSSelector::Id:
+        case CSSSelector::Class: {
+            Check check(selector->m_match == CSSSelector::Id ? IdCheck : ClassCheck);
+            check.value = selector->value().impl();
+            checks.append(check);
+            break;
+        }
+        case CSSSelector::Set:
+        case CSSSelector::Exact: {
+            Check check(selector->m_match == CSSSelector::Set ? AttributeSetCheck : AttributeExactCheck);
+            check.value = selector->value().impl();
+            check.attribute = selector->attribute();
+            check.attributeValueIsCaseInsensitive = CSSStyleSelector::SelectorChecker::htmlAttributeHasCaseInsensitiveValue(check.attribute);
+            checks.append(check);
+            break;
+        }
+        default:
+            return 0;
+        }
+
+        if (selector->relation() == CSSSelector::SubSelector && selector->tagHistory())
+            continue;
+
+        compound.checkCount = checks.size() - compound.firstCheck;
+        compound.relation = selector->relation();
+        compiled->m_compounds.append(compound);
+        compound.firstCheck = checks.size();
+    }
+
+    checks.shrinkToFit();
+    compiled->m_compounds.shrinkToFit();
+    return compiled.release();
+}
+
+static inline Element* parentElement(Element* element)
+{
+    ContainerNode* parent = element->parentNode();
+    return parent && parent->isElementNode() ? static_cast<Element*>(parent) : 0;
+}
+
+static inline Element* previousElementSibling(Element* element)
+{
+    Node* sibling = element->previousSibling();
+    while (sibling && !sibling->isElementNode())
+        sibling = sibling->previousSibling();
+    return static_cast<Element*>(sibling);
+}
+
+bool CompiledSelector::matchCompound(unsigned compoundIndex, Element* element, const MatchContext& context) const
+{
+    // Only the element whose style is being resolved gets the attribute
+    // selector bookkeeping, as in SelectorChecker::checkSelector().
+    RenderStyle* elementStyle = compoundIndex ? 0 : context.elementStyle;
+
+    const Compound& compound = m_compounds[compoundIndex];
+    const Check* check = m_checks.data() + compound.firstCheck;
+    const Check* end = check + compound.checkCount;
+    for (; check != end; ++check) {
+        switch (check->type) {
+        case TagCheck:
+            if (check->value && check->value != element->localName().impl())
+                return false;
+            if (check->namespaceURI && check->namespaceURI != element->namespaceURI().impl())
+                return false;
+            break;
+        case IdCheck:
+            if (!element->hasID() || element->idForStyleResolution().impl() != check->value)
+                return false;
+            break;
+        case ClassCheck:
+            if (!element->hasClass() || !static_cast<StyledElement*>(element)->classNames().contains(check->value))
+                return false;
+            break;
+        case AttributeSetCheck:
+        case AttributeExactCheck: {
+            const QualifiedName& attribute = check->attribute;
+            if (elementStyle && (!element->isStyledElement() || (!static_cast<StyledElement*>(element)->isMappedAttribute(attribute) && attribute != typeAttr && attribute != readonlyAttr))) {
+                elementStyle->setAffectedByAttributeSelectors();
+                if (context.selectorAttrs)
+                    context.selectorAttrs->add(attribute.localName().impl());
+            }
+            const AtomicString& value = element->getAttribute(attribute);
+            if (value.isNull())
+                return false;
+            if (check->type == AttributeSetCheck)
+                break;
+            if (context.documentIsHTML && check->attributeValueIsCaseInsensitive) {
+                if (!equalIgnoringCase(check->value, value.impl()))
+                    return false;
+            } else if (check->value != value.impl())
+                return false;
+            break;
+        }
+        }
+    }
+    return true;
+}
+
+CompiledSelector::Result CompiledSelector::matchFrom(unsigned compoundIndex, Element* element, const MatchContext& context) const
+{
+    if (!matchCompound(compoundIndex, element, context))
+        return FailsLocally;
+
+    const Compound& compound = m_compounds[compoundIndex];
+    unsigned nextCompound = compoundIndex + 1;
+    if (nextCompound == m_compounds.size())
+        return Matches;
+
+    switch (compound.relation) {
+    case CSSSelector::Descendant:
+        for (element = parentElement(element); element; element = parentElement(element)) {
+            Result result = matchFrom(nextCompound, element, context);
+            if (result != FailsLocally)
+                return result;
+        }
+        return FailsCompletely;
+    case CSSSelector::Child:
+        element = parentElement(element);
+        if (!element)
+            return FailsCompletely;
+        return matchFrom(nextCompound, element, context);
+    case CSSSelector::DirectAdjacent:
+    case CSSSelector::IndirectAdjacent: {
+        if (!context.collectRulesOnly && parentElement(element)) {
+            RenderStyle* parentStyle = compoundIndex || !context.elementStyle ? element->parentNode()->renderStyle() : context.elementParentStyle;
+            if (parentStyle) {
+                if (compound.relation == CSSSelector::DirectAdjacent)
+                    parentStyle->setChildrenAffectedByDirectAdjacentRules();
+                else
+                    parentStyle->setChildrenAffectedByForwardPositionalRules();
+            }
+        }
+        while ((element = previousElementSibling(element))) {
+            Result result = matchFrom(nextCompound, element, context);
+            if (result != FailsLocally || compound.relation == CSSSelector::DirectAdjacent)
+                return result;
+        }
+        return FailsLocally;
+    }
+    case CSSSelector::SubSelector:
+    case CSSSelector::ShadowDescendant:
+        break;
+    }
+    ASSERT_NOT_REACHED();
+    return FailsCompletely;
+}
+
+bool CompiledSelector::match(Element* element, const MatchContext& context) const
+{
+    return matchFrom(0, element, context) == Matches;
+}
+
+} // namespace WebCore
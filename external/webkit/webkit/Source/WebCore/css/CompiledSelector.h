@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2011 Google, Inc. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CompiledSelector_h
+#define CompiledSelector_h
+
+#include "CSSSelector.h"
+#include "QualifiedName.h"
+#include <wtf/HashSet.h>
+#include <wtf/PassRefPtr.h>
+#include <wtf/RefCounted.h>
+#include <wtf/Vector.h>
+
+namespace WebCore {
+
+class Element;
+class RenderStyle;
+
+// A selector flattened into a table of simple checks, one run of checks per
+// compound selector, so that matching it does not have to walk the
+// CSSSelector chain and switch on each component's match type.
+//
+// Only selectors made of type, id, class, [attr] and [attr=value] components,
+// joined by descendant, child and sibling combinators, can be compiled.
+// Everything else (pseudo-classes in particular) is left to
+// CSSStyleSelector::SelectorChecker::checkSelector().
+class CompiledSelector : public RefCounted<CompiledSelector> {
+public:
+    // Returns 0 if the selector has a component we cannot compile.
+    static PassRefPtr<CompiledSelector> compile(const CSSSelector*);
+
+    struct MatchContext {
+        MatchContext()
+            : elementStyle(0)
+            , elementParentStyle(0)
+            , selectorAttrs(0)
+            , documentIsHTML(true)
+            , collectRulesOnly(false)
+        {
+        }
+
+        // The style being resolved for the element, and its parent's style.
+        RenderStyle* elementStyle;
+        RenderStyle* elementParentStyle;
+        HashSet<AtomicStringImpl*>* selectorAttrs;
+        bool documentIsHTML;
+        bool collectRulesOnly;
+    };
+
+    // Has the same side effects on the styles and |selectorAttrs| as
+    // SelectorChecker::checkSelector().
+    bool match(Element*, const MatchContext&) const;
+
+private:
+    enum CheckType { TagCheck, IdCheck, ClassCheck, AttributeSetCheck, AttributeExactCheck };
+
+    struct Check {
+        Check(CheckType type)
+            : type(type)
+            , value(0)
+            , namespaceURI(0)
+            , attribute(anyQName())
+            , attributeValueIsCaseInsensitive(false)
+        {
+        }
+
+        CheckType type;
+        // The tag's local name, or the id, class or attribute value. For a
+        // TagCheck, 0 matches any local name.
+        AtomicStringImpl* value;
+        // 0 matches any namespace.
+        AtomicStringImpl* namespaceURI;
+        QualifiedName attribute;
+        bool attributeValueIsCaseInsensitive;
+    };
+
+    struct Compound {
+        unsigned firstCheck;
+        unsigned checkCount;
+        // How the element matching the next compound relates to the element
+        // matching this one.
+        CSSSelector::Relation relation;
+    };
+
+    enum Result { Matches, FailsLocally, FailsCompletely };
+
+    CompiledSelector() { }
+
+    bool matchCompound(unsigned compoundIndex, Element*, const MatchContext&) const;
+    Result matchFrom(unsigned compoundIndex, Element*, const MatchContext&) const;
+
+    Vector<Check> m_checks;
+    Vector<Compound> m_compounds;
+};
+
+} // namespace WebCore
+
+#endif // CompiledSelector_h
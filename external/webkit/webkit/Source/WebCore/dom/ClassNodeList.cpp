@@ -31,6 +31,7 @@
 #include "ClassNodeList.h"
 
 #include "Document.h"
+#include "SelectorNodeList.h"
 #include "StyledElement.h"
 
 namespace WebCore {
@@ -57,4 +58,23 @@ bool ClassNodeList::nodeMatches(Element* testNode) const
     return static_cast<StyledElement*>(testNode)->classNames().containsAll(m_classNames);
 }
 
+bool ClassNodeList::itemsVersion(uint64_t& version) const
+{
+    // Versions only ever grow, so the newest one of any of the classes
+    // changes whenever an element with one of them does.
+    Document* document = m_rootNode->document();
+    version = 0;
+    for (size_t i = 0; i < m_classNames.size(); ++i)
+        version = std::max(version, document->elementsWithClassVersion(m_classNames[i]));
+    return true;
+}
+
+const Vector<Element*>* ClassNodeList::indexedItems() const
+{
+    // There is only an index for each class, not for sets of them.
+    if (!m_rootNode->isDocumentNode() || m_classNames.size() != 1)
+        return 0;
+    return &static_cast<Document*>(m_rootNode.get())->selectorQueryCache()->elementsWithClass(m_classNames[0]);
+}
+
 } // namespace WebCore
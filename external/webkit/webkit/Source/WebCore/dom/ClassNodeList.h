@@ -49,6 +49,8 @@ namespace WebCore {
         ClassNodeList(PassRefPtr<Node> rootNode, const String& classNames);
 
         virtual bool nodeMatches(Element*) const;
+        virtual bool itemsVersion(uint64_t&) const;
+        virtual const Vector<Element*>* indexedItems() const;
 
         SpaceSplitString m_classNames;
         String m_originalClassNames;
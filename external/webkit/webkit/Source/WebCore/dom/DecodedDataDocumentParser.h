@@ -39,12 +39,12 @@ public:
 protected:
     explicit DecodedDataDocumentParser(Document*);
 
+    // appendBytes is used by DocumentWriter (the loader)
+    virtual void appendBytes(DocumentWriter*, const char* bytes, int length, bool flush);
+
 private:
     // append is used by DocumentWriter::replaceDocument
     virtual void append(const SegmentedString&) = 0;
-
-    // appendBytes is used by DocumentWriter (the loader)
-    virtual void appendBytes(DocumentWriter*, const char* bytes, int length, bool flush);
 };
 
 }
@@ -132,9 +132,12 @@
 #include "SecurityOrigin.h"
 #include "SegmentedString.h"
 #include "SelectionController.h"
+#include "SelectorNodeList.h"
 #include "Settings.h"
+#include "SpaceSplitString.h"
 #include "StaticHashSetNodeList.h"
 #include "StyleSheetList.h"
+#include "StyledElement.h"
 #include "TextEvent.h"
 #include "TextResourceDecoder.h"
 #include "Timer.h"
@@ -392,6 +395,7 @@ Document::Document(Frame* frame, const KURL& url, bool isXHTML, bool isHTML)
     , m_compatibilityMode(NoQuirksMode)
     , m_compatibilityModeLocked(false)
     , m_domTreeVersion(++s_globalTreeVersion)
+    , m_elementsVersion(0)
 #ifdef ANDROID_STYLE_VERSION
     , m_styleVersion(0)
 #endif
@@ -651,6 +655,8 @@ void Document::setCompatibilityMode(CompatibilityMode mode)
         // All user stylesheets have to reparse using the different mode.
         clearPageUserSheet();
         clearPageGroupUserSheets();
+        if (m_selectorQueryCache)
+            m_selectorQueryCache->clearParsedSelectors();
     }
 }
 
@@ -1511,6 +1517,11 @@ void Document::recalcStyle(StyleChange change)
     if (change == Force) {
         // style selector may set this again during recalc
         m_hasNodesWithPlaceholderStyle = false;
+
+        // A forced recalc usually means something the matched declarations do not
+        // capture has changed, like the zoom factor or the link colors.
+        if (m_styleSelector)
+            m_styleSelector->invalidateMatchedStyleCache();
         
         RefPtr<RenderStyle> documentStyle = CSSStyleSelector::styleForDocument(this);
         StyleChange ch = diff(documentStyle.get(), renderer()->style());
@@ -3395,6 +3406,81 @@ void Document::setCSSTarget(Element* n)
         n->setNeedsStyleRecalc();
 }
 
+uint64_t Document::elementsWithLocalNameVersion(const AtomicString& localName) const
+{
+    return m_elementsWithLocalNameVersions.get(localName);
+}
+
+uint64_t Document::elementsWithClassVersion(const AtomicString& className) const
+{
+    return m_elementsWithClassVersions.get(className);
+}
+
+bool Document::tracksElementsVersions() const
+{
+    return hasNodeListCaches() || m_selectorQueryCache;
+}
+
+void Document::elementInserted(Element* element)
+{
+    if (!tracksElementsVersions())
+        return;
+    if (m_selectorQueryCache)
+        m_selectorQueryCache->elementInserted(element);
+    elementsChanged(element);
+}
+
+void Document::elementRemoved(Element* element)
+{
+    if (!tracksElementsVersions())
+        return;
+    if (m_selectorQueryCache)
+        m_selectorQueryCache->elementRemoved(element);
+    elementsChanged(element);
+}
+
+void Document::elementClassesAdded(Element* element, const SpaceSplitString& classNames)
+{
+    if (!tracksElementsVersions())
+        return;
+    if (m_selectorQueryCache)
+        m_selectorQueryCache->elementClassesAdded(element, classNames);
+    elementClassesChanged(classNames);
+}
+
+void Document::elementClassesRemoved(Element* element, const SpaceSplitString& classNames)
+{
+    if (!tracksElementsVersions())
+        return;
+    if (m_selectorQueryCache)
+        m_selectorQueryCache->elementClassesRemoved(element, classNames);
+    elementClassesChanged(classNames);
+}
+
+void Document::elementsChanged(Element* element)
+{
+    m_elementsVersion = ++s_globalTreeVersion;
+    m_elementsWithLocalNameVersions.set(element->localName(), m_elementsVersion);
+    if (element->hasClass())
+        elementClassesChanged(static_cast<StyledElement*>(element)->classNames());
+}
+
+void Document::elementClassesChanged(const SpaceSplitString& classNames)
+{
+    // Class lists in quirks mode match case-insensitively, so fold case here
+    // and let strict mode lists see a few more changes than they need to.
+    uint64_t version = ++s_globalTreeVersion;
+    for (size_t i = 0; i < classNames.size(); ++i)
+        m_elementsWithClassVersions.set(classNames[i], version);
+}
+
+SelectorQueryCache* Document::selectorQueryCache()
+{
+    if (!m_selectorQueryCache)
+        m_selectorQueryCache = adoptPtr(new SelectorQueryCache(this));
+    return m_selectorQueryCache.get();
+}
+
 void Document::attachNodeIterator(NodeIterator* ni)
 {
     m_nodeIterators.add(ni);
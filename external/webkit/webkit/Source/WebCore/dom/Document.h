@@ -119,7 +119,9 @@ class ScriptRunner;
 class SecurityOrigin;
 class SerializedScriptValue;
 class SegmentedString;
+class SelectorQueryCache;
 class Settings;
+class SpaceSplitString;
 class StyleSheet;
 class StyleSheetList;
 class Text;
@@ -918,6 +920,22 @@ public:
     void incDOMTreeVersion() { m_domTreeVersion = ++s_globalTreeVersion; }
     uint64_t domTreeVersion() const { return m_domTreeVersion; }
 
+    // Versions of the set of all elements in the document and of the sets of
+    // elements with a given local name or class. They change whenever such an
+    // element enters or leaves the document, or changes class while in it, as
+    // long as there are node lists or selector indexes that might have cached
+    // the set. They are drawn from the same sequence as the DOM tree version,
+    // so a version is never reused, not even by another document.
+    uint64_t elementsVersion() const { return m_elementsVersion; }
+    uint64_t elementsWithLocalNameVersion(const AtomicString&) const;
+    uint64_t elementsWithClassVersion(const AtomicString&) const;
+    void elementInserted(Element*);
+    void elementRemoved(Element*);
+    void elementClassesAdded(Element*, const SpaceSplitString&);
+    void elementClassesRemoved(Element*, const SpaceSplitString&);
+
+    SelectorQueryCache* selectorQueryCache();
+
 #ifdef ANDROID_STYLE_VERSION
     void incStyleVersion() { ++m_styleVersion; }
     unsigned styleVersion() const { return m_styleVersion; }
@@ -1163,6 +1181,10 @@ private:
 
     void loadEventDelayTimerFired(Timer<Document>*);
 
+    bool tracksElementsVersions() const;
+    void elementsChanged(Element*);
+    void elementClassesChanged(const SpaceSplitString&);
+
 #if ENABLE(PAGE_VISIBILITY_API)
     PageVisibilityState visibilityState() const;
 #endif
@@ -1240,6 +1262,11 @@ private:
 
     uint64_t m_domTreeVersion;
     static uint64_t s_globalTreeVersion;
+
+    uint64_t m_elementsVersion;
+    HashMap<AtomicString, uint64_t> m_elementsWithLocalNameVersions;
+    HashMap<AtomicString, uint64_t, CaseFoldingHash> m_elementsWithClassVersions;
+    OwnPtr<SelectorQueryCache> m_selectorQueryCache;
 #ifdef ANDROID_STYLE_VERSION
     unsigned m_styleVersion;
 #endif
@@ -49,18 +49,53 @@ DynamicNodeList::~DynamicNodeList()
     m_rootNode->unregisterDynamicNodeList(this);
 }
 
+bool DynamicNodeList::isItemVectorCurrent() const
+{
+    // Versions only follow elements that are in the document.
+    if (!m_caches->isItemVectorValid || !m_rootNode->inDocument())
+        return false;
+    uint64_t version;
+    return itemsVersion(version) && version == m_caches->itemsVersion;
+}
+
 unsigned DynamicNodeList::length() const
 {
+    if (const Vector<Element*>* items = indexedItems())
+        return items->size();
+
     if (m_caches->isLengthCacheValid)
         return m_caches->cachedLength;
 
+    if (isItemVectorCurrent()) {
+        m_caches->cachedLength = m_caches->items.size();
+        m_caches->isLengthCacheValid = true;
+        return m_caches->cachedLength;
+    }
+
+    // Counting has to visit every item anyway, so keep them if we can tell
+    // when they change; this makes a loop over the list that mutates the
+    // document elsewhere linear instead of quadratic.
+    uint64_t version;
+    bool keepItems = m_rootNode->inDocument() && itemsVersion(version);
+    m_caches->items.clear();
+    m_caches->isItemVectorValid = false;
+
     unsigned length = 0;
 
-    for (Node* n = m_rootNode->firstChild(); n; n = n->traverseNextNode(m_rootNode.get()))
-        length += n->isElementNode() && nodeMatches(static_cast<Element*>(n));
+    for (Node* n = m_rootNode->firstChild(); n; n = n->traverseNextNode(m_rootNode.get())) {
+        if (n->isElementNode() && nodeMatches(static_cast<Element*>(n))) {
+            if (keepItems)
+                m_caches->items.append(n);
+            ++length;
+        }
+    }
 
     m_caches->cachedLength = length;
     m_caches->isLengthCacheValid = true;
+    if (keepItems) {
+        m_caches->itemsVersion = version;
+        m_caches->isItemVectorValid = true;
+    }
 
     return length;
 }
@@ -103,12 +138,19 @@ Node* DynamicNodeList::itemBackwardsFromCurrent(Node* start, unsigned offset, in
 
 Node* DynamicNodeList::item(unsigned offset) const
 {
+    if (const Vector<Element*>* items = indexedItems())
+        return offset < items->size() ? items->at(offset) : 0;
+
+    if (m_caches->isItemCacheValid && offset == m_caches->lastItemOffset)
+        return m_caches->lastItem;
+
+    if (isItemVectorCurrent())
+        return offset < m_caches->items.size() ? m_caches->items[offset] : 0;
+
     int remainingOffset = offset;
     Node* start = m_rootNode->firstChild();
     if (m_caches->isItemCacheValid) {
-        if (offset == m_caches->lastItemOffset)
-            return m_caches->lastItem;
-        else if (offset > m_caches->lastItemOffset || m_caches->lastItemOffset - offset < offset) {
+        if (offset > m_caches->lastItemOffset || m_caches->lastItemOffset - offset < offset) {
             start = m_caches->lastItem;
             remainingOffset -= m_caches->lastItemOffset;
         }
@@ -161,6 +203,8 @@ DynamicNodeList::Caches::Caches()
     : lastItem(0)
     , isLengthCacheValid(false)
     , isItemCacheValid(false)
+    , itemsVersion(0)
+    , isItemVectorValid(false)
 {
 }
 
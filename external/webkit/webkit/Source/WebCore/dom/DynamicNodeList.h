@@ -28,6 +28,7 @@
 #include <wtf/RefCounted.h>
 #include <wtf/Forward.h>
 #include <wtf/RefPtr.h>
+#include <wtf/Vector.h>
 
 namespace WebCore {
 
@@ -45,6 +46,13 @@ namespace WebCore {
             unsigned lastItemOffset;
             bool isLengthCacheValid : 1;
             bool isItemCacheValid : 1;
+
+            // All items, for lists that have an items version. Unlike the
+            // caches above, they outlive DOM mutations until the version
+            // changes, so reset() leaves them alone.
+            Vector<Node*> items;
+            uint64_t itemsVersion;
+            bool isItemVectorValid : 1;
         protected:
             Caches();
         };
@@ -68,12 +76,24 @@ namespace WebCore {
 
         virtual bool nodeMatches(Element*) const = 0;
 
+        // Lists whose items only depend on the elements with a given local
+        // name or class return the document's version of those elements here;
+        // see Document::elementsVersion().
+        virtual bool itemsVersion(uint64_t&) const { return false; }
+
+        // Lists whose items are exactly the document's elements with a given
+        // local name or class return the document's index of them here; see
+        // SelectorQueryCache. It is kept up to date as the document changes,
+        // so length() and item() read it directly.
+        virtual const Vector<Element*>* indexedItems() const { return 0; }
+
         RefPtr<Node> m_rootNode;
         mutable RefPtr<Caches> m_caches;
         bool m_ownsCaches;
 
     private:
         virtual bool isDynamicNodeList() const;
+        bool isItemVectorCurrent() const;
         Node* itemForwardsFromCurrent(Node* start, unsigned offset, int remainingOffset) const;
         Node* itemBackwardsFromCurrent(Node* start, unsigned offset, int remainingOffset) const;
     };
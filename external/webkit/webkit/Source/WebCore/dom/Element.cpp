@@ -941,6 +941,8 @@ void Element::insertedIntoDocument()
     if (Node* shadow = shadowRoot())
         shadow->insertedIntoDocument();
 
+    document()->elementInserted(this);
+
     if (hasID()) {
         if (m_attributeMap) {
             Attribute* idItem = m_attributeMap->getAttributeItem(document()->idAttributeName());
@@ -960,6 +962,8 @@ void Element::removedFromDocument()
         }
     }
 
+    document()->elementRemoved(this);
+
     ContainerNode::removedFromDocument();
     if (Node* shadow = shadowRoot())
         shadow->removedFromDocument();
@@ -225,6 +225,10 @@ void NamedNodeMap::setAttributes(const NamedNodeMap& other)
     if (oldId || newId)
         m_element->updateId(oldId ? oldId->value() : nullAtom, newId ? newId->value() : nullAtom);
 
+    // The new class attribute, if any, is reported by attributeChanged() below.
+    if (m_classNames.size() && m_element->inDocument())
+        m_element->document()->elementClassesRemoved(m_element, m_classNames);
+
     clearAttributes();
     unsigned newLength = other.length();
     m_attributes.resize(newLength);
@@ -33,7 +33,6 @@
 #include "AXObjectCache.h"
 #include "Attr.h"
 #include "Attribute.h"
-#include "CSSParser.h"
 #include "CSSRule.h"
 #include "CSSRuleList.h"
 #include "CSSSelector.h"
@@ -1766,45 +1765,12 @@ PassRefPtr<Element> Node::querySelector(const String& selectors, ExceptionCode&
         ec = SYNTAX_ERR;
         return 0;
     }
-    bool strictParsing = !document()->inQuirksMode();
-    CSSParser p(strictParsing);
 
-    CSSSelectorList querySelectorList;
-    p.parseSelector(selectors, document(), querySelectorList);
-
-    if (!querySelectorList.first() || querySelectorList.hasUnknownPseudoElements()) {
-        ec = SYNTAX_ERR;
-        return 0;
-    }
-
-    // throw a NAMESPACE_ERR if the selector includes any namespace prefixes.
-    if (querySelectorList.selectorsNeedNamespaceResolution()) {
-        ec = NAMESPACE_ERR;
+    const CSSSelectorList* querySelectorList = document()->selectorQueryCache()->parsedSelectors(selectors, ec);
+    if (!querySelectorList)
         return 0;
-    }
-
-    CSSStyleSelector::SelectorChecker selectorChecker(document(), strictParsing);
-
-    // FIXME: we could also optimize for the the [id="foo"] case
-    if (strictParsing && inDocument() && querySelectorList.hasOneSelector() && querySelectorList.first()->m_match == CSSSelector::Id) {
-        Element* element = document()->getElementById(querySelectorList.first()->value());
-        if (element && (isDocumentNode() || element->isDescendantOf(this)) && selectorChecker.checkSelector(querySelectorList.first(), element))
-            return element;
-        return 0;
-    }
 
-    // FIXME: We can speed this up by implementing caching similar to the one use by getElementById
-    for (Node* n = firstChild(); n; n = n->traverseNextNode(this)) {
-        if (n->isElementNode()) {
-            Element* element = static_cast<Element*>(n);
-            for (CSSSelector* selector = querySelectorList.first(); selector; selector = CSSSelectorList::next(selector)) {
-                if (selectorChecker.checkSelector(selector, element))
-                    return element;
-            }
-        }
-    }
-    
-    return 0;
+    return firstElementMatchingSelectors(this, *querySelectorList);
 }
 
 PassRefPtr<NodeList> Node::querySelectorAll(const String& selectors, ExceptionCode& ec)
@@ -1813,24 +1779,12 @@ PassRefPtr<NodeList> Node::querySelectorAll(const String& selectors, ExceptionCo
         ec = SYNTAX_ERR;
         return 0;
     }
-    bool strictParsing = !document()->inQuirksMode();
-    CSSParser p(strictParsing);
-
-    CSSSelectorList querySelectorList;
-    p.parseSelector(selectors, document(), querySelectorList);
 
-    if (!querySelectorList.first() || querySelectorList.hasUnknownPseudoElements()) {
-        ec = SYNTAX_ERR;
+    const CSSSelectorList* querySelectorList = document()->selectorQueryCache()->parsedSelectors(selectors, ec);
+    if (!querySelectorList)
         return 0;
-    }
-
-    // Throw a NAMESPACE_ERR if the selector includes any namespace prefixes.
-    if (querySelectorList.selectorsNeedNamespaceResolution()) {
-        ec = NAMESPACE_ERR;
-        return 0;
-    }
 
-    return createSelectorNodeList(this, querySelectorList);
+    return createSelectorNodeList(this, *querySelectorList);
 }
 
 Document *Node::ownerDocument() const
@@ -29,46 +29,402 @@
 #include "config.h"
 #include "SelectorNodeList.h"
 
+#include "CSSParser.h"
 #include "CSSSelector.h"
 #include "CSSSelectorList.h"
 #include "CSSStyleSelector.h"
 #include "Document.h"
 #include "Element.h"
+#include "ExceptionCode.h"
 #include "HTMLNames.h"
 #include "StaticNodeList.h"
+#include "StyledElement.h"
+#include <wtf/OwnPtr.h>
+#include <wtf/PassOwnPtr.h>
 
 namespace WebCore {
 
 using namespace HTMLNames;
 
-PassRefPtr<StaticNodeList> createSelectorNodeList(Node* rootNode, const CSSSelectorList& querySelectorList)
+// Both are cleared wholesale when full; pages use a handful of each.
+static const unsigned maximumParsedSelectors = 256;
+static const unsigned maximumElementIndexes = 32;
+
+SelectorQueryCache::SelectorQueryCache(Document* document)
+    : m_document(document)
 {
-    Vector<RefPtr<Node> > nodes;
-    Document* document = rootNode->document();
-    CSSSelector* onlySelector = querySelectorList.hasOneSelector() ? querySelectorList.first() : 0;
-    bool strictParsing = !document->inQuirksMode();
-
-    CSSStyleSelector::SelectorChecker selectorChecker(document, strictParsing);
-
-    if (strictParsing && rootNode->inDocument() && onlySelector && onlySelector->m_match == CSSSelector::Id && !document->containsMultipleElementsWithId(onlySelector->value())) {
-        Element* element = document->getElementById(onlySelector->value());
-        if (element && (rootNode->isDocumentNode() || element->isDescendantOf(rootNode)) && selectorChecker.checkSelector(onlySelector, element))
-            nodes.append(element);
-    } else {
-        for (Node* n = rootNode->firstChild(); n; n = n->traverseNextNode(rootNode)) {
-            if (n->isElementNode()) {
-                Element* element = static_cast<Element*>(n);
-                for (CSSSelector* selector = querySelectorList.first(); selector; selector = CSSSelectorList::next(selector)) {
-                    if (selectorChecker.checkSelector(selector, element)) {
-                        nodes.append(n);
-                        break;
-                    }
-                }
-            }
+}
+
+SelectorQueryCache::~SelectorQueryCache()
+{
+    clearParsedSelectors();
+}
+
+const CSSSelectorList* SelectorQueryCache::parsedSelectors(const String& selectors, ExceptionCode& ec)
+{
+    if (CSSSelectorList* selectorList = m_parsedSelectors.get(selectors))
+        return selectorList;
+
+    OwnPtr<CSSSelectorList> selectorList = adoptPtr(new CSSSelectorList);
+    CSSParser parser(!m_document->inQuirksMode());
+    parser.parseSelector(selectors, m_document, *selectorList);
+
+    if (!selectorList->first() || selectorList->hasUnknownPseudoElements()) {
+        ec = SYNTAX_ERR;
+        return 0;
+    }
+
+    // Throw a NAMESPACE_ERR if the selector includes any namespace prefixes.
+    if (selectorList->selectorsNeedNamespaceResolution()) {
+        ec = NAMESPACE_ERR;
+        return 0;
+    }
+
+    if (m_parsedSelectors.size() >= maximumParsedSelectors)
+        clearParsedSelectors();
+    m_parsedSelectors.set(selectors, selectorList.get());
+    return selectorList.leakPtr();
+}
+
+void SelectorQueryCache::clearParsedSelectors()
+{
+    deleteAllValues(m_parsedSelectors);
+    m_parsedSelectors.clear();
+}
+
+SelectorQueryCache::ElementIndex& SelectorQueryCache::indexFor(ElementIndexMap& indexes, const AtomicString& key)
+{
+    if (indexes.size() >= maximumElementIndexes && !indexes.contains(key))
+        indexes.clear();
+    return indexes.add(key, ElementIndex()).first->second;
+}
+
+void SelectorQueryCache::compact(ElementIndex& index)
+{
+    if (index.removedElements.isEmpty())
+        return;
+    Vector<Element*>& elements = index.elements;
+    size_t size = elements.size();
+    size_t kept = 0;
+    for (size_t i = 0; i < size; ++i) {
+        if (!index.removedElements.contains(elements[i]))
+            elements[kept++] = elements[i];
+    }
+    elements.shrink(kept);
+    index.removedElements.clear();
+}
+
+void SelectorQueryCache::insert(ElementIndex& index, Element* element)
+{
+    if (!index.isValid)
+        return;
+    compact(index);
+
+    // Parsing and appending add elements after the ones already there, so
+    // check the end first, then search for the element's place.
+    Vector<Element*>& elements = index.elements;
+    size_t begin = 0;
+    size_t end = elements.size();
+    while (begin < end) {
+        size_t middle = end == elements.size() ? end - 1 : begin + (end - begin) / 2;
+        unsigned short position = element->compareDocumentPosition(elements[middle]);
+        if (position == Node::DOCUMENT_POSITION_EQUIVALENT)
+            return;
+        if (position & Node::DOCUMENT_POSITION_DISCONNECTED) {
+            // Only elements in the document are indexed, so this should not
+            // happen; start over from the tree if it does.
+            index.elements.clear();
+            index.isValid = false;
+            return;
         }
+        if (position & Node::DOCUMENT_POSITION_PRECEDING)
+            begin = middle + 1;
+        else
+            end = middle;
     }
-    
+    elements.insert(begin, element);
+}
+
+void SelectorQueryCache::remove(ElementIndex& index, Element* element)
+{
+    // Removing from the middle of the vector right away would make removing
+    // a subtree quadratic, so only note the element until the next use.
+    if (index.isValid)
+        index.removedElements.add(element);
+}
+
+const Vector<Element*>& SelectorQueryCache::elementsWithClass(const AtomicString& className)
+{
+    ElementIndex& index = indexFor(m_classIndexes, className);
+    if (index.isValid) {
+        compact(index);
+        return index.elements;
+    }
+
+    for (Node* node = m_document->firstChild(); node; node = node->traverseNextNode()) {
+        if (!node->isElementNode())
+            continue;
+        Element* element = static_cast<Element*>(node);
+        if (element->hasClass() && static_cast<StyledElement*>(element)->classNames().contains(className))
+            index.elements.append(element);
+    }
+    index.isValid = true;
+    return index.elements;
+}
+
+const Vector<Element*>& SelectorQueryCache::elementsWithLocalName(const AtomicString& localName)
+{
+    ElementIndex& index = indexFor(m_localNameIndexes, localName);
+    if (index.isValid) {
+        compact(index);
+        return index.elements;
+    }
+
+    for (Node* node = m_document->firstChild(); node; node = node->traverseNextNode()) {
+        if (node->isElementNode() && static_cast<Element*>(node)->localName() == localName)
+            index.elements.append(static_cast<Element*>(node));
+    }
+    index.isValid = true;
+    return index.elements;
+}
+
+void SelectorQueryCache::elementInserted(Element* element)
+{
+    ElementIndexMap::iterator it = m_localNameIndexes.find(element->localName());
+    if (it != m_localNameIndexes.end())
+        insert(it->second, element);
+    if (element->hasClass())
+        elementClassesAdded(element, static_cast<StyledElement*>(element)->classNames());
+}
+
+void SelectorQueryCache::elementRemoved(Element* element)
+{
+    ElementIndexMap::iterator it = m_localNameIndexes.find(element->localName());
+    if (it != m_localNameIndexes.end())
+        remove(it->second, element);
+    if (element->hasClass())
+        elementClassesRemoved(element, static_cast<StyledElement*>(element)->classNames());
+}
+
+void SelectorQueryCache::elementClassesAdded(Element* element, const SpaceSplitString& classNames)
+{
+    for (size_t i = 0; i < classNames.size(); ++i) {
+        ElementIndexMap::iterator it = m_classIndexes.find(classNames[i]);
+        if (it != m_classIndexes.end())
+            insert(it->second, element);
+    }
+}
+
+void SelectorQueryCache::elementClassesRemoved(Element* element, const SpaceSplitString& classNames)
+{
+    for (size_t i = 0; i < classNames.size(); ++i) {
+        ElementIndexMap::iterator it = m_classIndexes.find(classNames[i]);
+        if (it != m_classIndexes.end())
+            remove(it->second, element);
+    }
+}
+
+// Whether |selector| is a single compound selector made of nothing but a tag,
+// ids and classes, which can be matched without the SelectorChecker.
+static bool isSimpleCompoundSelector(const CSSSelector* selector)
+{
+    for (; selector; selector = selector->tagHistory()) {
+        if (selector->m_match != CSSSelector::None && selector->m_match != CSSSelector::Id && selector->m_match != CSSSelector::Class)
+            return false;
+        if (selector->tagHistory() && selector->relation() != CSSSelector::SubSelector)
+            return false;
+    }
+    return true;
+}
+
+// Does the same checks as SelectorChecker::checkOneSelector() for the
+// selectors isSimpleCompoundSelector() accepts.
+static bool simpleCompoundSelectorMatches(const CSSSelector* selector, Element* element)
+{
+    for (; selector; selector = selector->tagHistory()) {
+        if (selector->hasTag()) {
+            const QualifiedName& tag = selector->tag();
+            if (tag.localName() != starAtom && tag.localName() != element->localName())
+                return false;
+            if (tag.namespaceURI() != starAtom && tag.namespaceURI() != element->namespaceURI())
+                return false;
+        }
+        if (selector->m_match == CSSSelector::Class) {
+            if (!element->hasClass() || !static_cast<StyledElement*>(element)->classNames().contains(selector->value()))
+                return false;
+        } else if (selector->m_match == CSSSelector::Id) {
+            if (!element->hasID() || element->idForStyleResolution() != selector->value())
+                return false;
+        }
+    }
+    return true;
+}
+
+namespace {
+
+// Answers a query for a selector list under a root node. Lists of a single
+// selector first look for its most selective part: an id, which either is
+// the answer or narrows the search to one subtree, or else a class or tag
+// of the element itself, whose index replaces the walk over the document.
+// Candidates are then matched right to left as usual.
+class SelectorQuery {
+public:
+    SelectorQuery(Node* rootNode, const CSSSelectorList& selectorList)
+        : m_rootNode(rootNode)
+        , m_document(rootNode->document())
+        , m_selectorList(selectorList)
+        , m_onlySelector(selectorList.hasOneSelector() ? selectorList.first() : 0)
+        , m_isSimple(m_onlySelector && isSimpleCompoundSelector(m_onlySelector))
+        , m_strictParsing(!m_document->inQuirksMode())
+        , m_selectorChecker(m_document, m_strictParsing)
+    {
+    }
+
+    void execute(bool firstOnly, Vector<RefPtr<Node> >& result) const;
+
+private:
+    bool matches(Element*) const;
+    bool findIdElement(Element*& idElement, bool& idIsSubject) const;
+    void collectFromSubtree(Node* subtreeRoot, bool firstOnly, Vector<RefPtr<Node> >& result) const;
+    bool collectFromIndex(bool firstOnly, Vector<RefPtr<Node> >& result) const;
+
+    Node* m_rootNode;
+    Document* m_document;
+    const CSSSelectorList& m_selectorList;
+    CSSSelector* m_onlySelector;
+    bool m_isSimple;
+    bool m_strictParsing;
+    CSSStyleSelector::SelectorChecker m_selectorChecker;
+};
+
+bool SelectorQuery::matches(Element* element) const
+{
+    if (m_isSimple)
+        return simpleCompoundSelectorMatches(m_onlySelector, element);
+    for (CSSSelector* selector = m_selectorList.first(); selector; selector = CSSSelectorList::next(selector)) {
+        if (m_selectorChecker.checkSelector(selector, element))
+            return true;
+    }
+    return false;
+}
+
+// Finds the element for the rightmost id in the selector that every match
+// must either be or be a descendant of. Returns false if there is no such id
+// or it can not be looked up in the id map.
+bool SelectorQuery::findIdElement(Element*& idElement, bool& idIsSubject) const
+{
+    if (!m_onlySelector || !m_strictParsing || !m_rootNode->inDocument())
+        return false;
+
+    idIsSubject = true;
+    for (CSSSelector* selector = m_onlySelector; selector; selector = selector->tagHistory()) {
+        if (selector->m_match == CSSSelector::Id) {
+            if (m_document->containsMultipleElementsWithId(selector->value()))
+                return false;
+            idElement = m_document->getElementById(selector->value());
+            return true;
+        }
+        switch (selector->relation()) {
+        case CSSSelector::SubSelector:
+            break;
+        case CSSSelector::Descendant:
+        case CSSSelector::Child:
+            idIsSubject = false;
+            break;
+        default:
+            // Siblings of an element are not inside it.
+            return false;
+        }
+    }
+    return false;
+}
+
+void SelectorQuery::collectFromSubtree(Node* subtreeRoot, bool firstOnly, Vector<RefPtr<Node> >& result) const
+{
+    for (Node* node = subtreeRoot->firstChild(); node; node = node->traverseNextNode(subtreeRoot)) {
+        if (node->isElementNode() && matches(static_cast<Element*>(node))) {
+            result.append(node);
+            if (firstOnly)
+                return;
+        }
+    }
+}
+
+bool SelectorQuery::collectFromIndex(bool firstOnly, Vector<RefPtr<Node> >& result) const
+{
+    // The indexes cover the whole document, so only use them from its root.
+    if (!m_onlySelector || !m_rootNode->isDocumentNode())
+        return false;
+
+    const Vector<Element*>* candidates = 0;
+    SelectorQueryCache* cache = m_document->selectorQueryCache();
+    for (CSSSelector* selector = m_onlySelector; selector; selector = selector->tagHistory()) {
+        if (selector->m_match == CSSSelector::Class) {
+            candidates = &cache->elementsWithClass(selector->value());
+            break;
+        }
+        if (selector->relation() != CSSSelector::SubSelector)
+            break;
+    }
+    if (!candidates) {
+        const AtomicString& localName = m_onlySelector->tag().localName();
+        if (!m_onlySelector->hasTag() || localName == starAtom)
+            return false;
+        candidates = &cache->elementsWithLocalName(localName);
+    }
+
+    // Matching can not change the document, so the index stays put.
+    size_t size = candidates->size();
+    for (size_t i = 0; i < size; ++i) {
+        Element* element = candidates->at(i);
+        if (matches(element)) {
+            result.append(element);
+            if (firstOnly)
+                break;
+        }
+    }
+    return true;
+}
+
+void SelectorQuery::execute(bool firstOnly, Vector<RefPtr<Node> >& result) const
+{
+    Element* idElement;
+    bool idIsSubject;
+    if (findIdElement(idElement, idIsSubject)) {
+        if (!idElement)
+            return;
+        if (idIsSubject) {
+            if ((m_rootNode->isDocumentNode() || idElement->isDescendantOf(m_rootNode)) && matches(idElement))
+                result.append(idElement);
+            return;
+        }
+        if (idElement->isDescendantOf(m_rootNode))
+            collectFromSubtree(idElement, firstOnly, result);
+        else if (idElement == m_rootNode || m_rootNode->isDescendantOf(idElement))
+            collectFromSubtree(m_rootNode, firstOnly, result);
+        return;
+    }
+
+    if (collectFromIndex(firstOnly, result))
+        return;
+
+    collectFromSubtree(m_rootNode, firstOnly, result);
+}
+
+} // namespace
+
+PassRefPtr<StaticNodeList> createSelectorNodeList(Node* rootNode, const CSSSelectorList& querySelectorList)
+{
+    Vector<RefPtr<Node> > nodes;
+    SelectorQuery(rootNode, querySelectorList).execute(false, nodes);
     return StaticNodeList::adopt(nodes);
 }
 
+Element* firstElementMatchingSelectors(Node* rootNode, const CSSSelectorList& querySelectorList)
+{
+    Vector<RefPtr<Node> > nodes;
+    SelectorQuery(rootNode, querySelectorList).execute(true, nodes);
+    return nodes.isEmpty() ? 0 : static_cast<Element*>(nodes[0].get());
+}
+
 } // namespace WebCore
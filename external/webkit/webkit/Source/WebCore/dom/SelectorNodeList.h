@@ -29,15 +29,79 @@
 #ifndef SelectorNodeList_h
 #define SelectorNodeList_h
 
+#include <wtf/Forward.h>
+#include <wtf/HashMap.h>
+#include <wtf/HashSet.h>
+#include <wtf/Noncopyable.h>
 #include <wtf/PassRefPtr.h>
+#include <wtf/Vector.h>
+#include <wtf/text/AtomicStringHash.h>
+#include <wtf/text/StringHash.h>
 
 namespace WebCore {
 
     class CSSSelectorList;
+    class Document;
+    class Element;
     class Node;
+    class SpaceSplitString;
     class StaticNodeList;
 
+    typedef int ExceptionCode;
+
+    // Per document state that makes repeated queries cheap: the parsed form
+    // of recently used selector strings, and lists of the elements with a
+    // given class or tag name. A list is built by walking the document the
+    // first time it is asked for, and from then on the document keeps it up
+    // to date as elements are inserted, removed or change class. Live tag and
+    // class node lists and the document's HTMLCollections read them too.
+    class SelectorQueryCache {
+        WTF_MAKE_NONCOPYABLE(SelectorQueryCache); WTF_MAKE_FAST_ALLOCATED;
+    public:
+        explicit SelectorQueryCache(Document*);
+        ~SelectorQueryCache();
+
+        // Returns 0 and sets the exception code if |selectors| can not be used
+        // with querySelector().
+        const CSSSelectorList* parsedSelectors(const String& selectors, ExceptionCode&);
+        void clearParsedSelectors();
+
+        // In document order. The vectors are only valid until the next
+        // mutation of the document.
+        const Vector<Element*>& elementsWithClass(const AtomicString&);
+        const Vector<Element*>& elementsWithLocalName(const AtomicString&);
+
+        // Called by the document for elements that enter or leave it, and
+        // for the classes an element in it gains or loses.
+        void elementInserted(Element*);
+        void elementRemoved(Element*);
+        void elementClassesAdded(Element*, const SpaceSplitString&);
+        void elementClassesRemoved(Element*, const SpaceSplitString&);
+
+    private:
+        struct ElementIndex {
+            ElementIndex() : isValid(false) { }
+            Vector<Element*> elements;
+            // Elements that left since the last compact(). They are only
+            // compared by address, as they may have been destroyed since.
+            HashSet<Element*> removedElements;
+            bool isValid;
+        };
+        typedef HashMap<AtomicString, ElementIndex> ElementIndexMap;
+
+        ElementIndex& indexFor(ElementIndexMap&, const AtomicString&);
+        static void compact(ElementIndex&);
+        static void insert(ElementIndex&, Element*);
+        static void remove(ElementIndex&, Element*);
+
+        Document* m_document;
+        HashMap<String, CSSSelectorList*> m_parsedSelectors;
+        ElementIndexMap m_classIndexes;
+        ElementIndexMap m_localNameIndexes;
+    };
+
     PassRefPtr<StaticNodeList> createSelectorNodeList(Node* rootNode, const CSSSelectorList&);
+    Element* firstElementMatchingSelectors(Node* rootNode, const CSSSelectorList&);
 
 } // namespace WebCore
 
@@ -220,11 +220,15 @@ void StyledElement::classAttributeChanged(const AtomicString& newClassString)
             break;
     }
     bool hasClass = i < length;
+    if (this->hasClass() && inDocument())
+        document()->elementClassesRemoved(this, classNames());
     setHasClass(hasClass);
     if (hasClass) {
         attributes()->setClass(newClassString);
         if (DOMTokenList* classList = optionalClassList())
             static_cast<ClassList*>(classList)->reset(newClassString);
+        if (inDocument())
+            document()->elementClassesAdded(this, classNames());
     } else if (attributeMap())
         attributeMap()->clearClass();
     setNeedsStyleRecalc();
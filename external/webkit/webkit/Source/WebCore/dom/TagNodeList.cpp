@@ -24,7 +24,9 @@
 #include "config.h"
 #include "TagNodeList.h"
 
+#include "Document.h"
 #include "Element.h"
+#include "SelectorNodeList.h"
 #include <wtf/Assertions.h>
 
 namespace WebCore {
@@ -50,4 +52,20 @@ bool TagNodeList::nodeMatches(Element* testNode) const
     return m_localName == starAtom || m_localName == testNode->localName();
 }
 
+bool TagNodeList::itemsVersion(uint64_t& version) const
+{
+    // The namespace is ignored, which at worst costs a few extra walks.
+    Document* document = m_rootNode->document();
+    version = m_localName == starAtom ? document->elementsVersion() : document->elementsWithLocalNameVersion(m_localName);
+    return true;
+}
+
+const Vector<Element*>* TagNodeList::indexedItems() const
+{
+    // The index holds elements of every namespace.
+    if (!m_rootNode->isDocumentNode() || m_namespaceURI != starAtom || m_localName == starAtom)
+        return 0;
+    return &static_cast<Document*>(m_rootNode.get())->selectorQueryCache()->elementsWithLocalName(m_localName);
+}
+
 } // namespace WebCore
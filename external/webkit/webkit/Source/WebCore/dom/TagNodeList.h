@@ -43,6 +43,8 @@ namespace WebCore {
         TagNodeList(PassRefPtr<Node> rootNode, const AtomicString& namespaceURI, const AtomicString& localName);
 
         virtual bool nodeMatches(Element*) const;
+        virtual bool itemsVersion(uint64_t&) const;
+        virtual const Vector<Element*>* indexedItems() const;
 
         AtomicString m_namespaceURI;
         AtomicString m_localName;
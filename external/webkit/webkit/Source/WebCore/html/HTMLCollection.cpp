@@ -29,6 +29,7 @@
 #include "HTMLObjectElement.h"
 #include "HTMLOptionElement.h"
 #include "NodeList.h"
+#include "SelectorNodeList.h"
 
 #include <utility>
 
@@ -202,6 +203,37 @@ Element* HTMLCollection::itemAfter(Element* previous) const
     return 0;
 }
 
+// Collections of the document's elements with one local name are exactly
+// the document's index of those elements, which is kept up to date as the
+// document changes; see SelectorQueryCache.
+const Vector<Element*>* HTMLCollection::indexedElements() const
+{
+    if (!m_base->isDocumentNode())
+        return 0;
+
+    const QualifiedName* tagName;
+    switch (m_type) {
+        case DocEmbeds:
+            tagName = &embedTag;
+            break;
+        case DocForms:
+            tagName = &formTag;
+            break;
+        case DocImages:
+            tagName = &imgTag;
+            break;
+        case DocObjects:
+            tagName = &objectTag;
+            break;
+        case DocScripts:
+            tagName = &scriptTag;
+            break;
+        default:
+            return 0;
+    }
+    return &static_cast<Document*>(m_base.get())->selectorQueryCache()->elementsWithLocalName(tagName->localName());
+}
+
 unsigned HTMLCollection::calcLength() const
 {
     unsigned len = 0;
@@ -214,6 +246,9 @@ unsigned HTMLCollection::calcLength() const
 // calculation every time if anything has changed
 unsigned HTMLCollection::length() const
 {
+    if (const Vector<Element*>* elements = indexedElements())
+        return elements->size();
+
     resetCollectionInfo();
     if (!m_info->hasLength) {
         m_info->length = calcLength();
@@ -225,6 +260,11 @@ unsigned HTMLCollection::length() const
 Node* HTMLCollection::item(unsigned index) const
 {
      resetCollectionInfo();
+     if (const Vector<Element*>* elements = indexedElements()) {
+         m_info->current = index < elements->size() ? elements->at(index) : 0;
+         m_info->position = index;
+         return m_info->current;
+     }
      if (m_info->current && m_info->position == index)
          return m_info->current;
      if (m_info->hasLength && m_info->length <= index)
@@ -74,6 +74,7 @@ private:
     virtual void updateNameCache() const;
 
     bool checkForNameMatch(Element*, bool checkName, const AtomicString& name) const;
+    const Vector<Element*>* indexedElements() const;
 
     RefPtr<Node> m_base;
     CollectionType m_type;
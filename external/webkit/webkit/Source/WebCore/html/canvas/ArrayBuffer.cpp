@@ -26,16 +26,34 @@
 #include "config.h"
 #include "ArrayBuffer.h"
 
+#include "ArrayBufferView.h"
 #include <wtf/RefPtr.h>
 
 namespace WebCore {
 
+ArrayBufferContents::~ArrayBufferContents()
+{
+    WTF::fastFree(m_data);
+}
+
+void ArrayBufferContents::transfer(ArrayBufferContents& other)
+{
+    ASSERT(!other.m_data);
+    other.m_data = m_data;
+    other.m_sizeInBytes = m_sizeInBytes;
+    m_data = 0;
+    m_sizeInBytes = 0;
+}
+
 PassRefPtr<ArrayBuffer> ArrayBuffer::create(unsigned numElements, unsigned elementByteSize)
 {
     void* data = tryAllocate(numElements, elementByteSize);
     if (!data)
         return 0;
-    return adoptRef(new ArrayBuffer(data, numElements * elementByteSize));
+    ArrayBufferContents contents;
+    contents.m_data = data;
+    contents.m_sizeInBytes = numElements * elementByteSize;
+    return adoptRef(new ArrayBuffer(contents));
 }
 
 PassRefPtr<ArrayBuffer> ArrayBuffer::create(ArrayBuffer* other)
@@ -45,38 +63,78 @@ PassRefPtr<ArrayBuffer> ArrayBuffer::create(ArrayBuffer* other)
 
 PassRefPtr<ArrayBuffer> ArrayBuffer::create(void* source, unsigned byteLength)
 {
-    void* data = tryAllocate(byteLength, 1);
-    if (!data)
+    RefPtr<ArrayBuffer> buffer = ArrayBuffer::create(byteLength, 1);
+    if (!buffer)
         return 0;
-    RefPtr<ArrayBuffer> buffer = adoptRef(new ArrayBuffer(data, byteLength));
     memcpy(buffer->data(), source, byteLength);
     return buffer.release();
 }
 
-ArrayBuffer::ArrayBuffer(void* data, unsigned sizeInBytes)
-    : m_sizeInBytes(sizeInBytes)
-    , m_data(data)
+PassRefPtr<ArrayBuffer> ArrayBuffer::create(ArrayBufferContents& contents)
+{
+    return adoptRef(new ArrayBuffer(contents));
+}
+
+ArrayBuffer::ArrayBuffer(ArrayBufferContents& contents)
+    : m_firstView(0)
+    , m_isNeutered(false)
 {
+    contents.transfer(m_contents);
 }
 
 void* ArrayBuffer::data()
 {
-    return m_data;
+    return m_contents.m_data;
 }
 
 const void* ArrayBuffer::data() const
 {
-    return m_data;
+    return m_contents.m_data;
 }
 
 unsigned ArrayBuffer::byteLength() const
 {
-    return m_sizeInBytes;
+    return m_contents.m_sizeInBytes;
+}
+
+bool ArrayBuffer::transfer(ArrayBufferContents& result)
+{
+    if (m_isNeutered)
+        return false;
+
+    m_contents.transfer(result);
+    m_isNeutered = true;
+    for (ArrayBufferView* view = m_firstView; view; view = view->m_nextView)
+        view->neuter();
+    return true;
+}
+
+void ArrayBuffer::addView(ArrayBufferView* view)
+{
+    view->m_prevView = 0;
+    view->m_nextView = m_firstView;
+    if (m_firstView)
+        m_firstView->m_prevView = view;
+    m_firstView = view;
+}
+
+void ArrayBuffer::removeView(ArrayBufferView* view)
+{
+    ASSERT(view->m_buffer == this);
+    if (view->m_nextView)
+        view->m_nextView->m_prevView = view->m_prevView;
+    if (view->m_prevView)
+        view->m_prevView->m_nextView = view->m_nextView;
+    else
+        m_firstView = view->m_nextView;
+    view->m_prevView = 0;
+    view->m_nextView = 0;
 }
 
 ArrayBuffer::~ArrayBuffer()
 {
-    WTF::fastFree(m_data);
+    // Views keep their buffer alive.
+    ASSERT(!m_firstView);
 }
 
 void* ArrayBuffer::tryAllocate(unsigned numElements, unsigned elementByteSize)
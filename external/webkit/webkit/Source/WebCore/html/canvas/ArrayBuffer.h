@@ -26,29 +26,77 @@
 #ifndef ArrayBuffer_h
 #define ArrayBuffer_h
 
+#include <wtf/Noncopyable.h>
 #include <wtf/PassRefPtr.h>
 #include <wtf/RefCounted.h>
+#include <wtf/RefPtr.h>
+#include <wtf/Vector.h>
 
 namespace WebCore {
 
+class ArrayBuffer;
+class ArrayBufferView;
+
+typedef Vector<RefPtr<ArrayBuffer>, 1> ArrayBufferArray;
+
+// The storage of an ArrayBuffer. It can be moved out of one ArrayBuffer and
+// into a new one, possibly on another thread, without copying the bytes.
+class ArrayBufferContents {
+    WTF_MAKE_NONCOPYABLE(ArrayBufferContents);
+  public:
+    ArrayBufferContents()
+        : m_data(0)
+        , m_sizeInBytes(0)
+    {
+    }
+
+    ~ArrayBufferContents();
+
+    void* data() const { return m_data; }
+    unsigned sizeInBytes() const { return m_sizeInBytes; }
+
+  private:
+    friend class ArrayBuffer;
+
+    void transfer(ArrayBufferContents& other);
+
+    void* m_data;
+    unsigned m_sizeInBytes;
+};
+
+// Fixed size; ArrayBufferContents cannot be copied as the vector grows.
+typedef Vector<ArrayBufferContents, 1> ArrayBufferContentsArray;
+
 class ArrayBuffer : public RefCounted<ArrayBuffer> {
   public:
     static PassRefPtr<ArrayBuffer> create(unsigned numElements, unsigned elementByteSize);
     static PassRefPtr<ArrayBuffer> create(ArrayBuffer*);
     static PassRefPtr<ArrayBuffer> create(void* source, unsigned byteLength);
+    // Takes over the storage in |contents|, leaving it empty.
+    static PassRefPtr<ArrayBuffer> create(ArrayBufferContents&);
 
     void* data();
     const void* data() const;
     unsigned byteLength() const;
 
+    // Moves the storage into |result| and neuters this buffer and every view
+    // on it: they all become zero length. Returns false if the buffer has
+    // already been neutered.
+    bool transfer(ArrayBufferContents& result);
+    bool isNeutered() const { return m_isNeutered; }
+
+    void addView(ArrayBufferView*);
+    void removeView(ArrayBufferView*);
+
     ~ArrayBuffer();
 
   private:
-    ArrayBuffer(void* data, unsigned sizeInBytes);
-    ArrayBuffer(unsigned numElements, unsigned elementByteSize);
+    ArrayBuffer(ArrayBufferContents&);
     static void* tryAllocate(unsigned numElements, unsigned elementByteSize);
-    unsigned m_sizeInBytes;
-    void* m_data;
+
+    ArrayBufferContents m_contents;
+    ArrayBufferView* m_firstView;
+    bool m_isNeutered;
 };
 
 } // namespace WebCore
@@ -34,12 +34,26 @@ ArrayBufferView::ArrayBufferView(PassRefPtr<ArrayBuffer> buffer,
                        unsigned byteOffset)
         : m_byteOffset(byteOffset)
         , m_buffer(buffer)
+        , m_prevView(0)
+        , m_nextView(0)
 {
     m_baseAddress = m_buffer ? (static_cast<char*>(m_buffer->data()) + m_byteOffset) : 0;
+    if (m_buffer)
+        m_buffer->addView(this);
 }
 
 ArrayBufferView::~ArrayBufferView()
 {
+    if (m_buffer)
+        m_buffer->removeView(this);
+}
+
+void ArrayBufferView::neuter()
+{
+    // Keep pointing at the now empty buffer, so that buffer() and subarray()
+    // still work on a neutered view.
+    m_baseAddress = 0;
+    m_byteOffset = 0;
 }
 
 void ArrayBufferView::setImpl(ArrayBufferView* array, unsigned byteOffset, ExceptionCode& ec)
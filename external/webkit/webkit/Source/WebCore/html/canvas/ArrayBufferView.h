@@ -71,6 +71,11 @@ class ArrayBufferView : public RefCounted<ArrayBufferView> {
   protected:
     ArrayBufferView(PassRefPtr<ArrayBuffer> buffer, unsigned byteOffset);
 
+    // Called when the buffer's storage is transferred away. The view keeps
+    // its now zero length buffer. Subclasses must also drop their length to
+    // zero.
+    virtual void neuter();
+
     void setImpl(ArrayBufferView* array, unsigned byteOffset, ExceptionCode& ec);
 
     void setRangeImpl(const char* data, size_t dataByteLength, unsigned byteOffset, ExceptionCode& ec);
@@ -125,7 +130,11 @@ class ArrayBufferView : public RefCounted<ArrayBufferView> {
     unsigned m_byteOffset;
 
   private:
+    friend class ArrayBuffer;
     RefPtr<ArrayBuffer> m_buffer;
+    // Links in the list of views on m_buffer.
+    ArrayBufferView* m_prevView;
+    ArrayBufferView* m_nextView;
 };
 
 } // namespace WebCore
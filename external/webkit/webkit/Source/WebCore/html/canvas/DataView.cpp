@@ -58,6 +58,12 @@ DataView::DataView(PassRefPtr<ArrayBuffer> buffer, unsigned byteOffset, unsigned
 {
 }
 
+void DataView::neuter()
+{
+    ArrayBufferView::neuter();
+    m_byteLength = 0;
+}
+
 static bool needToFlipBytes(bool littleEndian)
 {
 #if CPU(BIG_ENDIAN)
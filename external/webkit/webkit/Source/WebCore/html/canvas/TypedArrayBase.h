@@ -103,6 +103,12 @@ protected:
         return adoptRef(new Subclass(buf, byteOffset, length));
     }
 
+    virtual void neuter()
+    {
+        ArrayBufferView::neuter();
+        m_length = 0;
+    }
+
     template <class Subclass>
     PassRefPtr<Subclass> subarrayImpl(int start, int end) const
     {
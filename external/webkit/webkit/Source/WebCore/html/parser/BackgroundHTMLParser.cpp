@@ -0,0 +1,454 @@
+/*
+ * Copyright (C) 2011 Google, Inc. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "BackgroundHTMLParser.h"
+
+#include "HTMLDocumentParser.h"
+#include "HTMLTokenizer.h"
+#include <wtf/MainThread.h>
+
+namespace WebCore {
+
+// The background thread hands tokens to the main thread in batches of at
+// most this many tokens, so the tree builder can start before a large chunk
+// of source has been tokenized.
+static const size_t tokensPerBatch = 64;
+
+// The tag names are lower case by the time the tokenizer emits them, and we
+// cannot use HTMLNames here: AtomicStrings belong to the main thread.
+static bool isHTMLBreakoutTagName(const String& tagName)
+{
+    // http://www.whatwg.org/specs/web-apps/current-work/multipage/tokenization.html#parsing-main-inforeign
+    static const char* const breakoutTagNames[] = {
+        "b", "big", "blockquote", "body", "br", "center", "code", "dd", "div", "dl", "dt",
+        "em", "embed", "h1", "h2", "h3", "h4", "h5", "h6", "head", "hr", "i", "img", "li",
+        "listing", "menu", "meta", "nobr", "ol", "p", "pre", "ruby", "s", "small", "span",
+        "strong", "strike", "sub", "sup", "table", "tt", "u", "ul", "var",
+    };
+    for (size_t i = 0; i < WTF_ARRAY_LENGTH(breakoutTagNames); ++i) {
+        if (tagName == breakoutTagNames[i])
+            return true;
+    }
+    return false;
+}
+
+// Whether the tree builder would be in the "text" insertion mode, in which it
+// asks the tokenizer to replace U+0000 characters.
+static bool isTextModeState(HTMLTokenizer::State state)
+{
+    switch (state) {
+    case HTMLTokenizer::RCDATAState:
+    case HTMLTokenizer::CharacterReferenceInRCDATAState:
+    case HTMLTokenizer::RCDATALessThanSignState:
+    case HTMLTokenizer::RCDATAEndTagOpenState:
+    case HTMLTokenizer::RCDATAEndTagNameState:
+    case HTMLTokenizer::RAWTEXTState:
+    case HTMLTokenizer::RAWTEXTLessThanSignState:
+    case HTMLTokenizer::RAWTEXTEndTagOpenState:
+    case HTMLTokenizer::RAWTEXTEndTagNameState:
+    case HTMLTokenizer::ScriptDataState:
+    case HTMLTokenizer::ScriptDataLessThanSignState:
+    case HTMLTokenizer::ScriptDataEndTagOpenState:
+    case HTMLTokenizer::ScriptDataEndTagNameState:
+    case HTMLTokenizer::ScriptDataEscapeStartState:
+    case HTMLTokenizer::ScriptDataEscapeStartDashState:
+    case HTMLTokenizer::ScriptDataEscapedState:
+    case HTMLTokenizer::ScriptDataEscapedDashState:
+    case HTMLTokenizer::ScriptDataEscapedDashDashState:
+    case HTMLTokenizer::ScriptDataEscapedLessThanSignState:
+    case HTMLTokenizer::ScriptDataEscapedEndTagOpenState:
+    case HTMLTokenizer::ScriptDataEscapedEndTagNameState:
+    case HTMLTokenizer::ScriptDataDoubleEscapeStartState:
+    case HTMLTokenizer::ScriptDataDoubleEscapedState:
+    case HTMLTokenizer::ScriptDataDoubleEscapedDashState:
+    case HTMLTokenizer::ScriptDataDoubleEscapedDashDashState:
+    case HTMLTokenizer::ScriptDataDoubleEscapedLessThanSignState:
+    case HTMLTokenizer::ScriptDataDoubleEscapeEndState:
+        return true;
+    default:
+        return false;
+    }
+}
+
+PassRefPtr<BackgroundHTMLParser> BackgroundHTMLParser::create(HTMLDocumentParser* client, bool usePreHTML5ParserQuirks, bool scriptingEnabled, bool pluginsEnabled)
+{
+    return adoptRef(new BackgroundHTMLParser(client, usePreHTML5ParserQuirks, scriptingEnabled, pluginsEnabled));
+}
+
+BackgroundHTMLParser::BackgroundHTMLParser(HTMLDocumentParser* client, bool usePreHTML5ParserQuirks, bool scriptingEnabled, bool pluginsEnabled)
+    : m_client(client)
+    , m_retainedSourceOffset(0)
+    , m_finishWasCalled(false)
+    , m_isDecoding(false)
+    , m_pendingFlush(false)
+    , m_pendingFinish(false)
+    , m_stopped(false)
+    , m_hasTokenizedAllSource(false)
+    , m_notificationPending(false)
+    , m_threadID(0)
+    , m_tokenizer(HTMLTokenizer::create(usePreHTML5ParserQuirks))
+    , m_scriptingEnabled(scriptingEnabled)
+    , m_pluginsEnabled(pluginsEnabled)
+    , m_foreignContentDepth(0)
+{
+}
+
+BackgroundHTMLParser::~BackgroundHTMLParser()
+{
+}
+
+bool BackgroundHTMLParser::start()
+{
+    MutexLocker lock(m_threadCreationMutex);
+    ASSERT(!m_threadID);
+    // The thread keeps us alive until it exits.
+    m_selfRef = this;
+    m_threadID = createThread(BackgroundHTMLParser::threadEntryPoint, this, "WebCore: HTMLTokenizer");
+    if (!m_threadID)
+        m_selfRef = 0;
+    return m_threadID;
+}
+
+void BackgroundHTMLParser::stop()
+{
+    ASSERT(isMainThread());
+    m_client = 0;
+    m_retainedSource.clear();
+
+    MutexLocker locker(m_mutex);
+    m_stopped = true;
+    m_condition.signal();
+}
+
+void BackgroundHTMLParser::append(const String& source)
+{
+    ASSERT(isMainThread());
+    ASSERT(!m_finishWasCalled);
+    ASSERT(!m_isDecoding);
+    if (source.isEmpty())
+        return;
+    m_retainedSource.append(source);
+
+    MutexLocker locker(m_mutex);
+    m_pendingSource.append(source.crossThreadString());
+    m_condition.signal();
+}
+
+void BackgroundHTMLParser::finish()
+{
+    ASSERT(isMainThread());
+    m_finishWasCalled = true;
+
+    MutexLocker locker(m_mutex);
+    m_pendingFinish = true;
+    m_condition.signal();
+}
+
+void BackgroundHTMLParser::startDecoding(PassOwnPtr<TextCodec> codec)
+{
+    ASSERT(isMainThread());
+    ASSERT(!m_isDecoding);
+    m_isDecoding = true;
+
+    MutexLocker codecLocker(m_codecMutex);
+    m_codec = codec;
+}
+
+void BackgroundHTMLParser::appendBytes(const char* data, size_t length, bool flush)
+{
+    ASSERT(isMainThread());
+    ASSERT(m_isDecoding);
+    ASSERT(!m_finishWasCalled);
+
+    MutexLocker locker(m_mutex);
+    m_pendingBytes.append(data, length);
+    m_pendingFlush |= flush;
+    m_condition.signal();
+}
+
+PassOwnPtr<TextCodec> BackgroundHTMLParser::stopDecoding()
+{
+    ASSERT(isMainThread());
+    ASSERT(m_isDecoding);
+    m_isDecoding = false;
+
+    OwnPtr<TextCodec> codec;
+    Vector<char> bytes;
+    bool flush;
+    {
+        // Every byte is now either decoded in m_decodedSource or still
+        // waiting in m_pendingBytes.
+        MutexLocker codecLocker(m_codecMutex);
+        codec = m_codec.release();
+        MutexLocker locker(m_mutex);
+        takeDecodedSource();
+        bytes.swap(m_pendingBytes);
+        flush = m_pendingFlush;
+        m_pendingFlush = false;
+    }
+
+    bool sawError = false;
+    String decoded = codec->decode(bytes.data(), bytes.size(), flush, false, sawError);
+    if (!decoded.isEmpty())
+        m_retainedSource.append(decoded);
+    return codec.release();
+}
+
+void BackgroundHTMLParser::takeDecodedSource()
+{
+    for (size_t i = 0; i < m_decodedSource.size(); ++i)
+        m_retainedSource.append(m_decodedSource[i]);
+    m_decodedSource.clear();
+}
+
+bool BackgroundHTMLParser::takeTokens(Vector<CompactHTMLToken>& tokens)
+{
+    ASSERT(isMainThread());
+    ASSERT(tokens.isEmpty());
+    MutexLocker locker(m_mutex);
+    // The text comes before the tokens it holds.
+    takeDecodedSource();
+    tokens.swap(m_pendingTokens);
+    return m_hasTokenizedAllSource;
+}
+
+void BackgroundHTMLParser::didConsumeSource(int inputOffset)
+{
+    ASSERT(isMainThread());
+    while (!m_retainedSource.isEmpty()) {
+        int end = m_retainedSourceOffset + m_retainedSource.first().length();
+        if (end > inputOffset)
+            break;
+        m_retainedSourceOffset = end;
+        m_retainedSource.remove(0);
+    }
+}
+
+SegmentedString BackgroundHTMLParser::sourceFrom(int inputOffset) const
+{
+    ASSERT(isMainThread());
+    ASSERT(inputOffset >= m_retainedSourceOffset);
+    SegmentedString source;
+    int offset = m_retainedSourceOffset;
+    for (size_t i = 0; i < m_retainedSource.size(); ++i) {
+        const String& string = m_retainedSource[i];
+        int end = offset + string.length();
+        if (end > inputOffset)
+            source.append(SegmentedString(offset >= inputOffset ? string : string.substring(inputOffset - offset)));
+        offset = end;
+    }
+    return source;
+}
+
+void* BackgroundHTMLParser::threadEntryPoint(void* context)
+{
+    static_cast<BackgroundHTMLParser*>(context)->runLoop();
+    return 0;
+}
+
+void BackgroundHTMLParser::runLoop()
+{
+    {
+        // Wait for start() to complete to have m_threadID established.
+        MutexLocker lock(m_threadCreationMutex);
+    }
+
+    while (true) {
+        bool sawFinish;
+        {
+            MutexLocker locker(m_mutex);
+            while (!m_stopped && m_pendingSource.isEmpty() && m_pendingBytes.isEmpty() && !m_pendingFlush && !m_pendingFinish)
+                m_condition.wait(m_mutex);
+            if (m_stopped)
+                break;
+            for (size_t i = 0; i < m_pendingSource.size(); ++i)
+                m_source.append(SegmentedString(m_pendingSource[i]));
+            m_pendingSource.clear();
+            sawFinish = m_pendingFinish;
+            m_pendingFinish = false;
+        }
+        decodeAvailableBytes();
+        tokenizeAvailableSource();
+        if (sawFinish) {
+            // We never see the end of file ourselves. The main thread takes
+            // over for the last few characters (which may hold an unfinished
+            // token) so that its tokenizer emits the EndOfFile token.
+            {
+                MutexLocker locker(m_mutex);
+                m_hasTokenizedAllSource = true;
+            }
+            Vector<CompactHTMLToken> noTokens;
+            sendTokensToMainThread(noTokens);
+        }
+    }
+
+    // Strings we created must die on this thread.
+    m_token.clear();
+    m_source.clear();
+    m_tokenizer.clear();
+    {
+        MutexLocker codecLocker(m_codecMutex);
+        m_codec.clear();
+    }
+
+    detachThread(m_threadID);
+    m_selfRef = 0;
+}
+
+void BackgroundHTMLParser::decodeAvailableBytes()
+{
+    // stopDecoding() may have taken the codec, and the bytes with it.
+    MutexLocker codecLocker(m_codecMutex);
+    if (!m_codec)
+        return;
+
+    Vector<char> bytes;
+    bool flush;
+    {
+        MutexLocker locker(m_mutex);
+        bytes.swap(m_pendingBytes);
+        flush = m_pendingFlush;
+        m_pendingFlush = false;
+    }
+    if (bytes.isEmpty() && !flush)
+        return;
+
+    bool sawError = false;
+    String decoded = m_codec->decode(bytes.data(), bytes.size(), flush, false, sawError);
+    if (decoded.isEmpty())
+        return;
+    m_source.append(SegmentedString(decoded));
+
+    MutexLocker locker(m_mutex);
+    m_decodedSource.append(decoded.crossThreadString());
+}
+
+void BackgroundHTMLParser::tokenizeAvailableSource()
+{
+    Vector<CompactHTMLToken> tokens;
+    while (m_tokenizer->nextToken(m_source, m_token)) {
+        tokens.append(CompactHTMLToken(m_token, *m_tokenizer, m_source));
+        m_token.clear();
+        simulateTreeBuilder(tokens.last());
+        if (tokens.size() >= tokensPerBatch && !sendTokensToMainThread(tokens))
+            return;
+    }
+    if (!tokens.isEmpty())
+        sendTokensToMainThread(tokens);
+}
+
+// This is a rough copy of the tokenizer state changes HTMLTreeBuilder makes.
+// The main thread catches our mistakes, so we only need to be right for the
+// common cases.
+void BackgroundHTMLParser::simulateTreeBuilder(CompactHTMLToken& token)
+{
+    CompactHTMLToken::TokenizerSettings settings = token.predictedSettings();
+
+    if (token.type() == HTMLToken::StartTag) {
+        const String& tagName = token.data();
+        bool isForeignContentRoot = tagName == "svg" || tagName == "math";
+        if (m_foreignContentDepth) {
+            if (isHTMLBreakoutTagName(tagName))
+                m_foreignContentDepth = 0;
+            else if (isForeignContentRoot && !token.selfClosing())
+                ++m_foreignContentDepth;
+        } else if (isForeignContentRoot) {
+            if (!token.selfClosing())
+                m_foreignContentDepth = 1;
+        } else if (tagName == "textarea") {
+            settings.state = HTMLTokenizer::RCDATAState;
+            settings.skipLeadingNewLineForListing = true;
+        } else if (tagName == "title")
+            settings.state = HTMLTokenizer::RCDATAState;
+        else if (tagName == "plaintext")
+            settings.state = HTMLTokenizer::PLAINTEXTState;
+        else if (tagName == "script")
+            settings.state = HTMLTokenizer::ScriptDataState;
+        else if (tagName == "style"
+            || tagName == "iframe"
+            || tagName == "xmp"
+            || (tagName == "noembed" && m_pluginsEnabled)
+            || tagName == "noframes"
+            || (tagName == "noscript" && m_scriptingEnabled))
+            settings.state = HTMLTokenizer::RAWTEXTState;
+        else if (tagName == "pre" || tagName == "listing")
+            settings.skipLeadingNewLineForListing = true;
+    } else if (token.type() == HTMLToken::EndTag && m_foreignContentDepth) {
+        if (token.data() == "svg" || token.data() == "math")
+            --m_foreignContentDepth;
+    }
+
+    settings.forceNullCharacterReplacement = m_foreignContentDepth || isTextModeState(settings.state);
+    settings.shouldAllowCDATA = m_foreignContentDepth;
+
+    m_tokenizer->setState(settings.state);
+    m_tokenizer->setForceNullCharacterReplacement(settings.forceNullCharacterReplacement);
+    m_tokenizer->setShouldAllowCDATA(settings.shouldAllowCDATA);
+    m_tokenizer->setSkipLeadingNewLineForListing(settings.skipLeadingNewLineForListing);
+    token.setPredictedSettings(settings);
+}
+
+bool BackgroundHTMLParser::sendTokensToMainThread(Vector<CompactHTMLToken>& tokens)
+{
+    bool shouldNotify;
+    {
+        MutexLocker locker(m_mutex);
+        if (m_stopped) {
+            tokens.clear();
+            return false;
+        }
+        // The tokens' Strings must not be touched by this thread once the main
+        // thread can see them, so clear our copies while holding the lock.
+        if (m_pendingTokens.isEmpty())
+            m_pendingTokens.swap(tokens);
+        else {
+            m_pendingTokens.append(tokens);
+            tokens.clear();
+        }
+        shouldNotify = !m_notificationPending;
+        m_notificationPending = true;
+    }
+
+    if (shouldNotify) {
+        // Balanced in didProduceTokens().
+        ref();
+        callOnMainThread(didProduceTokens, this);
+    }
+    return true;
+}
+
+void BackgroundHTMLParser::didProduceTokens(void* context)
+{
+    RefPtr<BackgroundHTMLParser> parser = adoptRef(static_cast<BackgroundHTMLParser*>(context));
+    {
+        MutexLocker locker(parser->m_mutex);
+        parser->m_notificationPending = false;
+    }
+    if (parser->m_client)
+        parser->m_client->didReceiveTokensFromBackgroundParser();
+}
+
+}
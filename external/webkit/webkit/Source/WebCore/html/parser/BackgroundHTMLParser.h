@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2011 Google, Inc. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BackgroundHTMLParser_h
+#define BackgroundHTMLParser_h
+
+#include "CompactHTMLToken.h"
+#include "HTMLToken.h"
+#include "SegmentedString.h"
+#include "TextCodec.h"
+#include <wtf/OwnPtr.h>
+#include <wtf/PassOwnPtr.h>
+#include <wtf/PassRefPtr.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+
+namespace WebCore {
+
+class HTMLDocumentParser;
+class HTMLTokenizer;
+
+// Tokenizes network data for an HTMLDocumentParser on its own thread.
+//
+// The background thread runs a private HTMLTokenizer over a copy of the
+// source and hands batches of CompactHTMLTokens to the main thread, which
+// runs the tree builder. The tokenizer state changes the tree builder would
+// make (e.g., switching to the RAWTEXT state after <style>) are guessed here
+// and checked on the main thread. If a guess turns out to be wrong, or if
+// script calls document.write(), the main thread stops us and tokenizes the
+// rest of the document itself, starting from the last token it processed.
+//
+// Once the document's TextResourceDecoder has settled on an encoding, the
+// main thread hands us its codec and passes us network bytes instead of
+// decoded text. We then decode here too, and send the decoded text back
+// with the tokens, since the main thread needs it if it takes over.
+//
+// Unless noted otherwise, the public functions are called on the main thread.
+class BackgroundHTMLParser : public ThreadSafeRefCounted<BackgroundHTMLParser> {
+public:
+    static PassRefPtr<BackgroundHTMLParser> create(HTMLDocumentParser*, bool usePreHTML5ParserQuirks, bool scriptingEnabled, bool pluginsEnabled);
+    ~BackgroundHTMLParser();
+
+    bool start();
+    void stop();
+
+    void append(const String&);
+    void finish();
+
+    void startDecoding(PassOwnPtr<TextCodec>);
+    bool isDecoding() const { return m_isDecoding; }
+    void appendBytes(const char*, size_t length, bool flush);
+    // Decodes, on the main thread, whatever bytes we have not decoded yet,
+    // and returns the codec. Only called right before stop(), so the source
+    // is complete for sourceFrom().
+    PassOwnPtr<TextCodec> stopDecoding();
+    bool finishWasCalled() const { return m_finishWasCalled; }
+
+    // Moves the tokens produced so far into |tokens|. Returns true once the
+    // background thread has tokenized all the source passed to append() or
+    // appendBytes() before finish(), and every token has been handed over.
+    bool takeTokens(Vector<CompactHTMLToken>& tokens);
+
+    // The main thread has processed the tree for every token up to
+    // |inputOffset|, so we can forget the source before it.
+    void didConsumeSource(int inputOffset);
+
+    // The source that follows |inputOffset|, for the main thread's tokenizer.
+    SegmentedString sourceFrom(int inputOffset) const;
+
+private:
+    BackgroundHTMLParser(HTMLDocumentParser*, bool usePreHTML5ParserQuirks, bool scriptingEnabled, bool pluginsEnabled);
+
+    static void* threadEntryPoint(void*);
+    void runLoop();
+    void decodeAvailableBytes();
+    void tokenizeAvailableSource();
+    void takeDecodedSource();
+    void simulateTreeBuilder(CompactHTMLToken&);
+    bool sendTokensToMainThread(Vector<CompactHTMLToken>&);
+
+    static void didProduceTokens(void*);
+
+    // Main thread only.
+    HTMLDocumentParser* m_client;
+    Vector<String> m_retainedSource;
+    int m_retainedSourceOffset;
+    bool m_finishWasCalled;
+    bool m_isDecoding;
+
+    // Shared between the threads, guarded by m_mutex.
+    Mutex m_mutex;
+    ThreadCondition m_condition;
+    Vector<String> m_pendingSource;
+    Vector<char> m_pendingBytes;
+    bool m_pendingFlush;
+    // Copies of what we decoded, for m_retainedSource.
+    Vector<String> m_decodedSource;
+    bool m_pendingFinish;
+    bool m_stopped;
+    Vector<CompactHTMLToken> m_pendingTokens;
+    bool m_hasTokenizedAllSource;
+    bool m_notificationPending;
+
+    // Held by whichever thread decodes. Taken before m_mutex.
+    Mutex m_codecMutex;
+    OwnPtr<TextCodec> m_codec;
+
+    // Background thread only.
+    ThreadIdentifier m_threadID;
+    Mutex m_threadCreationMutex;
+    RefPtr<BackgroundHTMLParser> m_selfRef;
+    OwnPtr<HTMLTokenizer> m_tokenizer;
+    SegmentedString m_source;
+    HTMLToken m_token;
+    bool m_scriptingEnabled;
+    bool m_pluginsEnabled;
+    unsigned m_foreignContentDepth;
+};
+
+}
+
+#endif
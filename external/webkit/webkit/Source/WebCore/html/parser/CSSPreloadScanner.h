@@ -42,6 +42,7 @@ public:
 
     void reset();
     void scan(const HTMLToken&, bool scanningBody);
+    void scan(const String& characters, bool scanningBody);
 
 private:
     enum State {
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2011 Google, Inc. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "CompactHTMLToken.h"
+
+#include "SegmentedString.h"
+
+namespace WebCore {
+
+template<typename VectorType>
+static inline String stringFromVector(const VectorType& vector)
+{
+    return String(vector.data(), vector.size());
+}
+
+CompactHTMLToken::CompactHTMLToken(const HTMLToken& token, const HTMLTokenizer& tokenizer, const SegmentedString& source)
+    : m_type(token.type())
+    , m_selfClosing(false)
+    , m_forceQuirks(false)
+    , m_isSafeCheckpoint(!tokenizer.hasBufferedEndTag())
+    , m_inputOffset(source.numberOfCharactersConsumed())
+    , m_lineNumber(tokenizer.lineNumber())
+    , m_textPosition(source.currentLine(), source.currentColumn())
+    , m_tokenizerState(tokenizer.state())
+{
+    switch (token.type()) {
+    case HTMLToken::Uninitialized:
+        ASSERT_NOT_REACHED();
+        break;
+    case HTMLToken::DOCTYPE:
+        m_data = stringFromVector(token.name());
+        m_publicIdentifier = stringFromVector(token.publicIdentifier());
+        m_systemIdentifier = stringFromVector(token.systemIdentifier());
+        m_forceQuirks = token.forceQuirks();
+        break;
+    case HTMLToken::EndOfFile:
+        break;
+    case HTMLToken::StartTag:
+    case HTMLToken::EndTag: {
+        m_selfClosing = token.selfClosing();
+        m_data = stringFromVector(token.name());
+        const HTMLToken::AttributeList& attributes = token.attributes();
+        m_attributes.reserveInitialCapacity(attributes.size());
+        for (size_t i = 0; i < attributes.size(); ++i) {
+            const HTMLToken::Attribute& attribute = attributes[i];
+            if (attribute.m_name.isEmpty())
+                continue;
+            m_attributes.append(Attribute(stringFromVector(attribute.m_name), stringFromVector(attribute.m_value)));
+        }
+        break;
+    }
+    case HTMLToken::Comment:
+        m_data = stringFromVector(token.comment());
+        break;
+    case HTMLToken::Character:
+        m_data = stringFromVector(token.characters());
+        break;
+    }
+
+    m_predictedSettings.state = tokenizer.state();
+    m_predictedSettings.forceNullCharacterReplacement = tokenizer.forceNullCharacterReplacement();
+    m_predictedSettings.shouldAllowCDATA = tokenizer.shouldAllowCDATA();
+    m_predictedSettings.skipLeadingNewLineForListing = false;
+}
+
+AtomicHTMLToken::AtomicHTMLToken(CompactHTMLToken& token)
+    : m_type(token.type())
+    , m_externalCharacters(0)
+    , m_externalCharactersLength(0)
+    , m_selfClosing(false)
+{
+    switch (m_type) {
+    case HTMLToken::Uninitialized:
+        ASSERT_NOT_REACHED();
+        break;
+    case HTMLToken::DOCTYPE:
+        m_name = AtomicString(token.data());
+        m_doctypeData = adoptPtr(new HTMLToken::DoctypeData());
+        m_doctypeData->m_publicIdentifier.append(token.publicIdentifier().characters(), token.publicIdentifier().length());
+        m_doctypeData->m_systemIdentifier.append(token.systemIdentifier().characters(), token.systemIdentifier().length());
+        m_doctypeData->m_forceQuirks = token.forceQuirks();
+        break;
+    case HTMLToken::EndOfFile:
+        break;
+    case HTMLToken::StartTag:
+    case HTMLToken::EndTag: {
+        m_selfClosing = token.selfClosing();
+        m_name = AtomicString(token.data());
+        const Vector<CompactHTMLToken::Attribute>& attributes = token.attributes();
+        if (attributes.isEmpty())
+            break;
+        m_attributes = NamedNodeMap::create();
+        m_attributes->reserveInitialCapacity(attributes.size());
+        for (size_t i = 0; i < attributes.size(); ++i)
+            m_attributes->insertAttribute(Attribute::createMapped(attributes[i].name, attributes[i].value), false);
+        break;
+    }
+    case HTMLToken::Comment:
+        m_data = token.data();
+        break;
+    case HTMLToken::Character:
+        // The CompactHTMLToken owns the characters, just as an HTMLToken does
+        // for the other constructor.
+        m_externalCharacters = token.data().characters();
+        m_externalCharactersLength = token.data().length();
+        break;
+    }
+}
+
+}
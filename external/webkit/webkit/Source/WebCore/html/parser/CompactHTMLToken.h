@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2011 Google, Inc. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CompactHTMLToken_h
+#define CompactHTMLToken_h
+
+#include "HTMLToken.h"
+#include "HTMLTokenizer.h"
+#include <wtf/Vector.h>
+#include <wtf/text/TextPosition.h>
+#include <wtf/text/WTFString.h>
+
+namespace WebCore {
+
+// A copy of an HTMLToken that can be handed from the background tokenizer
+// thread to the main thread. It holds plain (non-atomic) Strings, which the
+// main thread atomizes when it builds an AtomicHTMLToken.
+//
+// Each token also remembers where the background tokenizer stood once it
+// emitted the token, and what the background parser guessed the tree builder
+// would do to the tokenizer afterwards. The main thread compares the guess
+// with what the tree builder actually did and, when they differ, resumes
+// tokenizing on the main thread from that point.
+class CompactHTMLToken {
+public:
+    struct Attribute {
+        Attribute(const String& name, const String& value)
+            : name(name)
+            , value(value)
+        {
+        }
+
+        String name;
+        String value;
+    };
+
+    struct TokenizerSettings {
+        HTMLTokenizer::State state;
+        bool forceNullCharacterReplacement;
+        bool shouldAllowCDATA;
+        bool skipLeadingNewLineForListing;
+    };
+
+    CompactHTMLToken(const HTMLToken&, const HTMLTokenizer&, const SegmentedString&);
+
+    HTMLToken::Type type() const { return static_cast<HTMLToken::Type>(m_type); }
+
+    // "name" for DOCTYPE, StartTag, and EndTag
+    // "characters" for Character
+    // "data" for Comment
+    const String& data() const { return m_data; }
+
+    bool selfClosing() const { return m_selfClosing; }
+    const Vector<Attribute>& attributes() const { return m_attributes; }
+
+    const String& publicIdentifier() const { return m_publicIdentifier; }
+    const String& systemIdentifier() const { return m_systemIdentifier; }
+    bool forceQuirks() const { return m_forceQuirks; }
+
+    // Number of source characters the background tokenizer had consumed once
+    // it emitted this token.
+    int inputOffset() const { return m_inputOffset; }
+    int lineNumber() const { return m_lineNumber; }
+    const TextPosition0& textPosition() const { return m_textPosition; }
+
+    // False if the tokenizer had already consumed part of the next token
+    // when it emitted this one (e.g., the "</script" after a script's text),
+    // in which case the main thread cannot resume tokenizing right after it.
+    bool isSafeCheckpoint() const { return m_isSafeCheckpoint; }
+
+    HTMLTokenizer::State tokenizerState() const { return m_tokenizerState; }
+
+    const TokenizerSettings& predictedSettings() const { return m_predictedSettings; }
+    void setPredictedSettings(const TokenizerSettings& settings) { m_predictedSettings = settings; }
+
+private:
+    unsigned m_type : 4;
+    bool m_selfClosing : 1;
+    bool m_forceQuirks : 1;
+    bool m_isSafeCheckpoint : 1;
+
+    String m_data;
+    Vector<Attribute> m_attributes;
+    String m_publicIdentifier;
+    String m_systemIdentifier;
+
+    int m_inputOffset;
+    int m_lineNumber;
+    TextPosition0 m_textPosition;
+    HTMLTokenizer::State m_tokenizerState;
+    TokenizerSettings m_predictedSettings;
+};
+
+}
+
+#endif
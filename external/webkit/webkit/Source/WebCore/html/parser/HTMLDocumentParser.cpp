@@ -26,8 +26,10 @@
 #include "config.h"
 #include "HTMLDocumentParser.h"
 
+#include "BackgroundHTMLParser.h"
 #include "ContentSecurityPolicy.h"
 #include "DocumentFragment.h"
+#include "DocumentWriter.h"
 #include "Element.h"
 #include "Frame.h"
 #include "HTMLNames.h"
@@ -40,6 +42,7 @@
 #include "InspectorInstrumentation.h"
 #include "NestingLevelIncrementer.h"
 #include "Settings.h"
+#include "TextResourceDecoder.h"
 
 namespace WebCore {
 
@@ -72,6 +75,14 @@ HTMLTokenizer::State tokenizerStateForContextElement(Element* contextElement, bo
     return HTMLTokenizer::DataState;
 }
 
+bool canUseBackgroundParser(Document* document)
+{
+    Settings* settings = document->settings();
+    // The XSSFilter needs the source of each token, which only the main
+    // thread's tokenizer keeps track of.
+    return settings && settings->threadedHTMLParserEnabled() && !settings->xssAuditorEnabled();
+}
+
 } // namespace
 
 HTMLDocumentParser::HTMLDocumentParser(HTMLDocument* document, bool reportErrors)
@@ -81,6 +92,8 @@ HTMLDocumentParser::HTMLDocumentParser(HTMLDocument* document, bool reportErrors
     , m_treeBuilder(HTMLTreeBuilder::create(this, document, reportErrors, usePreHTML5ParserQuirks(document)))
     , m_parserScheduler(HTMLParserScheduler::create(this))
     , m_xssFilter(this)
+    , m_speculativeInputOffset(0)
+    , m_canUseBackgroundParser(canUseBackgroundParser(document))
     , m_endWasDelayed(false)
     , m_pumpSessionNestingLevel(0)
 {
@@ -93,6 +106,8 @@ HTMLDocumentParser::HTMLDocumentParser(DocumentFragment* fragment, Element* cont
     , m_tokenizer(HTMLTokenizer::create(usePreHTML5ParserQuirks(fragment->document())))
     , m_treeBuilder(HTMLTreeBuilder::create(this, fragment, contextElement, scriptingPermission, usePreHTML5ParserQuirks(fragment->document())))
     , m_xssFilter(this)
+    , m_speculativeInputOffset(0)
+    , m_canUseBackgroundParser(false)
     , m_endWasDelayed(false)
     , m_pumpSessionNestingLevel(0)
 {
@@ -105,6 +120,7 @@ HTMLDocumentParser::~HTMLDocumentParser()
     ASSERT(!m_parserScheduler);
     ASSERT(!m_pumpSessionNestingLevel);
     ASSERT(!m_preloadScanner);
+    ASSERT(!m_backgroundParser);
 }
 
 void HTMLDocumentParser::detach()
@@ -117,12 +133,14 @@ void HTMLDocumentParser::detach()
     // Yet during fast/dom/HTMLScriptElement/script-load-events.html we do.
     m_preloadScanner.clear();
     m_parserScheduler.clear(); // Deleting the scheduler will clear any timers.
+    stopBackgroundParser();
 }
 
 void HTMLDocumentParser::stopParsing()
 {
     DocumentParser::stopParsing();
     m_parserScheduler.clear(); // Deleting the scheduler will clear any timers.
+    stopBackgroundParser();
 }
 
 // This kicks off "Once the user agent stops parsing" as described by:
@@ -259,6 +277,12 @@ void HTMLDocumentParser::pumpTokenizer(SynchronousMode mode)
     InspectorInstrumentationCookie cookie = InspectorInstrumentation::willWriteHTML(document(), m_input.current().length(), m_tokenizer->lineNumber());
 
     while (canTakeNextToken(mode, session) && !session.needsYield) {
+        if (m_backgroundParser) {
+            if (!processTokenFromBackgroundParser())
+                break;
+            continue;
+        }
+
         if (!isParsingFragment())
             m_sourceTracker.start(m_input, m_token);
 
@@ -288,12 +312,16 @@ void HTMLDocumentParser::pumpTokenizer(SynchronousMode mode)
         m_parserScheduler->scheduleForResume();
 
     if (isWaitingForScripts()) {
-        ASSERT(m_tokenizer->state() == HTMLTokenizer::DataState);
-        if (!m_preloadScanner) {
-            m_preloadScanner.set(new HTMLPreloadScanner(document()));
-            m_preloadScanner->appendToEnd(m_input.current());
+        if (m_backgroundParser)
+            preloadScanSpeculativeTokens();
+        else {
+            ASSERT(m_tokenizer->state() == HTMLTokenizer::DataState);
+            if (!m_preloadScanner) {
+                m_preloadScanner.set(new HTMLPreloadScanner(document()));
+                m_preloadScanner->appendToEnd(m_input.current());
+            }
+            m_preloadScanner->scan();
         }
-        m_preloadScanner->scan();
     }
 
     InspectorInstrumentation::didWriteHTML(cookie, m_tokenizer->lineNumber());
@@ -318,6 +346,12 @@ void HTMLDocumentParser::insert(const SegmentedString& source)
     // but we need to ensure it isn't deleted yet.
     RefPtr<HTMLDocumentParser> protect(this);
 
+    // The background tokenizer cannot see what document.write() inserts, so
+    // we tokenize everything from here on ourselves.
+    m_canUseBackgroundParser = false;
+    if (m_backgroundParser)
+        tokenizeRestOfDocumentOnMainThread();
+
     SegmentedString excludedLineNumberSource(source);
     excludedLineNumberSource.setExcludeLineNumbers();
     m_input.insertAtCurrentInsertionPoint(excludedLineNumberSource);
@@ -343,6 +377,23 @@ void HTMLDocumentParser::append(const SegmentedString& source)
     // but we need to ensure it isn't deleted yet.
     RefPtr<HTMLDocumentParser> protect(this);
 
+    if (m_canUseBackgroundParser) {
+        m_canUseBackgroundParser = false;
+        // Documents written by script, and text documents (which we tokenize
+        // in the PLAINTEXT state), stay on the main thread.
+        if (!wasCreatedByScript() && m_tokenizer->state() == HTMLTokenizer::DataState)
+            startBackgroundParser();
+    }
+
+    // The source has to follow the bytes the background parser is decoding.
+    if (m_backgroundParser && m_backgroundParser->isDecoding())
+        tokenizeRestOfDocumentOnMainThread();
+
+    if (m_backgroundParser) {
+        m_backgroundParser->append(source.toString());
+        return;
+    }
+
     if (m_preloadScanner) {
         if (m_input.current().isEmpty() && !isWaitingForScripts()) {
             // We have parsed until the end of the current input and so are now moving ahead of the preload scanner.
@@ -369,6 +420,33 @@ void HTMLDocumentParser::append(const SegmentedString& source)
     endIfDelayed();
 }
 
+void HTMLDocumentParser::appendBytes(DocumentWriter* writer, const char* data, int length, bool shouldFlush)
+{
+    if (!length && !shouldFlush)
+        return;
+
+    // The decoder keeps the bytes that start the document until it has found
+    // their encoding, so the background parser only decodes what follows.
+    if (m_backgroundParser && !isStopped()) {
+        TextResourceDecoder* decoder = writer->createDecoderIfNeeded();
+        if (!m_backgroundParser->isDecoding() && writer->receivedData() && decoder->canDecodeOnAnotherThread()) {
+            m_backgroundDecodingEncoding = decoder->encoding();
+            m_backgroundParser->startDecoding(decoder->takeCodec());
+        }
+        if (m_backgroundParser->isDecoding()) {
+            if (decoder->encoding() == m_backgroundDecodingEncoding) {
+                m_backgroundParser->appendBytes(data, length, shouldFlush);
+                return;
+            }
+            // Document::setCharset() has picked another encoding, which the
+            // decoder uses from here on.
+            tokenizeRestOfDocumentOnMainThread();
+        }
+    }
+
+    DecodedDataDocumentParser::appendBytes(writer, data, length, shouldFlush);
+}
+
 void HTMLDocumentParser::end()
 {
     ASSERT(!isDetached());
@@ -422,6 +500,14 @@ void HTMLDocumentParser::finish()
     // We're not going to get any more data off the network, so we tell the
     // input stream we've reached the end of file.  finish() can be called more
     // than once, if the first time does not call end().
+    if (m_backgroundParser) {
+        // The background parser tells us once it has tokenized everything,
+        // and we then end the document ourselves.
+        if (!m_backgroundParser->finishWasCalled())
+            m_backgroundParser->finish();
+        attemptToEnd();
+        return;
+    }
     if (!m_input.haveSeenEndOfFile())
         m_input.markEndOfFile();
     attemptToEnd();
@@ -429,6 +515,8 @@ void HTMLDocumentParser::finish()
 
 bool HTMLDocumentParser::finishWasCalled()
 {
+    if (m_backgroundParser)
+        return m_backgroundParser->finishWasCalled();
     return m_input.haveSeenEndOfFile();
 }
 
@@ -570,6 +658,164 @@ bool HTMLDocumentParser::usePreHTML5ParserQuirks(Document* document)
     return document->settings() && document->settings()->usePreHTML5ParserQuirks();
 }
 
+void HTMLDocumentParser::startBackgroundParser()
+{
+    ASSERT(!m_backgroundParser);
+    ASSERT(m_input.current().isEmpty());
+    Frame* frame = document()->frame();
+    RefPtr<BackgroundHTMLParser> parser = BackgroundHTMLParser::create(this, usePreHTML5ParserQuirks(document()), HTMLTreeBuilder::scriptEnabled(frame), HTMLTreeBuilder::pluginsEnabled(frame));
+    // If we cannot get a thread, we just tokenize on this one.
+    if (!parser->start())
+        return;
+    m_backgroundParser = parser.release();
+    m_speculativeInputOffset = 0;
+}
+
+void HTMLDocumentParser::stopBackgroundParser()
+{
+    if (!m_backgroundParser)
+        return;
+    m_backgroundParser->stop();
+    m_backgroundParser = 0;
+    m_speculativeTokens.clear();
+    m_speculativePreloadScanner.clear();
+}
+
+void HTMLDocumentParser::didReceiveTokensFromBackgroundParser()
+{
+    // pumpTokenizer can cause this parser to be detached from the Document,
+    // but we need to ensure it isn't deleted yet.
+    RefPtr<HTMLDocumentParser> protect(this);
+
+    // As with network data in append(), a less-nested pump will take the
+    // tokens if we're called from a nested event loop.
+    if (inPumpSession())
+        return;
+
+    // The tree builder has to wait for script, but the preload scanner can
+    // look ahead.
+    if (isWaitingForScripts()) {
+        preloadScanSpeculativeTokens();
+        return;
+    }
+
+    pumpTokenizerIfPossible(AllowYield);
+    endIfDelayed();
+}
+
+// Returns false if we have to wait for the background parser.
+bool HTMLDocumentParser::processTokenFromBackgroundParser()
+{
+    ASSERT(m_backgroundParser);
+
+    if (m_speculativeTokens.isEmpty()) {
+        // We are moving ahead of the preload scanner. A new one starts from
+        // the tokens that are left if we block again.
+        m_speculativePreloadScanner.clear();
+        bool hasTokenizedAllSource = takeTokensFromBackgroundParser();
+        if (m_speculativeTokens.isEmpty()) {
+            if (!hasTokenizedAllSource)
+                return false;
+            // Our own tokenizer finishes the document, so that it sees the end of file.
+            tokenizeRestOfDocumentOnMainThread();
+            return true;
+        }
+    }
+
+    CompactHTMLToken token = m_speculativeTokens.takeFirst();
+
+    // Put m_tokenizer where the background tokenizer was when it emitted the
+    // token. The tree builder adjusts it from there, and we compare the
+    // result with what the background parser guessed.
+    m_tokenizer->setState(token.tokenizerState());
+    m_tokenizer->setSkipLeadingNewLineForListing(false);
+    m_tokenizer->setLineNumber(token.lineNumber());
+    m_input.current().setCurrentPosition(token.textPosition().m_line, token.textPosition().m_column, 0);
+    m_speculativeInputOffset = token.inputOffset();
+    if (token.type() == HTMLToken::StartTag)
+        m_speculativeEndTagName = token.data();
+
+    AtomicHTMLToken atomicToken(token);
+    m_treeBuilder->constructTreeFromAtomicToken(atomicToken);
+
+    // Script run while building the tree may have called document.write(),
+    // in which case we have already taken over from the background parser.
+    if (!m_backgroundParser || !token.isSafeCheckpoint())
+        return true;
+
+    const CompactHTMLToken::TokenizerSettings& predicted = token.predictedSettings();
+    if (m_tokenizer->state() != predicted.state
+        || m_tokenizer->forceNullCharacterReplacement() != predicted.forceNullCharacterReplacement
+        || m_tokenizer->shouldAllowCDATA() != predicted.shouldAllowCDATA
+        || m_tokenizer->skipLeadingNewLineForListing() != predicted.skipLeadingNewLineForListing) {
+        // The background tokenizer went on in the wrong state. Its remaining
+        // tokens are useless.
+        tokenizeRestOfDocumentOnMainThread();
+        return true;
+    }
+
+    m_backgroundParser->didConsumeSource(token.inputOffset());
+    return true;
+}
+
+// Returns true once the background parser has tokenized all the source.
+bool HTMLDocumentParser::takeTokensFromBackgroundParser()
+{
+    ASSERT(m_backgroundParser);
+    Vector<CompactHTMLToken> tokens;
+    bool hasTokenizedAllSource = m_backgroundParser->takeTokens(tokens);
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        if (m_speculativePreloadScanner)
+            m_speculativePreloadScanner->scan(tokens[i]);
+        m_speculativeTokens.append(tokens[i]);
+    }
+    return hasTokenizedAllSource;
+}
+
+void HTMLDocumentParser::preloadScanSpeculativeTokens()
+{
+    ASSERT(m_backgroundParser);
+    ASSERT(isWaitingForScripts());
+    if (!m_speculativePreloadScanner) {
+        m_speculativePreloadScanner = adoptPtr(new HTMLPreloadScanner(document()));
+        for (Deque<CompactHTMLToken>::const_iterator it = m_speculativeTokens.begin(); it != m_speculativeTokens.end(); ++it)
+            m_speculativePreloadScanner->scan(*it);
+    }
+    takeTokensFromBackgroundParser();
+}
+
+void HTMLDocumentParser::tokenizeRestOfDocumentOnMainThread()
+{
+    ASSERT(m_backgroundParser);
+    ASSERT(m_token.isUninitialized());
+
+    if (m_backgroundParser->isDecoding()) {
+        OwnPtr<TextCodec> codec = m_backgroundParser->stopDecoding();
+        // The codec may hold the start of a character that the next network
+        // packet finishes.
+        TextResourceDecoder* decoder = document()->decoder();
+        if (decoder && decoder->encoding() == m_backgroundDecodingEncoding)
+            decoder->adoptCodec(codec.release());
+    }
+
+    SegmentedString source = m_backgroundParser->sourceFrom(m_speculativeInputOffset);
+    bool finishWasCalled = m_backgroundParser->finishWasCalled();
+    stopBackgroundParser();
+
+    // The tree builder has set m_tokenizer's state for the last token we
+    // processed, but m_tokenizer has not seen the start tag that an RCDATA or
+    // RAWTEXT section needs to be closed by.
+    m_tokenizer->setAppropriateEndTagName(m_speculativeEndTagName);
+
+    TextPosition0 position = textPosition();
+    m_input.appendToEnd(source);
+    // With an insertion point, the InsertionPointRecord restores the position.
+    if (!m_input.hasInsertionPoint())
+        m_input.current().setCurrentPosition(position.m_line, position.m_column, 0);
+    if (finishWasCalled)
+        m_input.markEndOfFile();
+}
+
 void HTMLDocumentParser::suspendScheduledTasks()
 {
     if (m_parserScheduler)
@@ -27,6 +27,7 @@
 #define HTMLDocumentParser_h
 
 #include "CachedResourceClient.h"
+#include "CompactHTMLToken.h"
 #include "FragmentScriptingPermission.h"
 #include "HTMLInputStream.h"
 #include "HTMLScriptRunnerHost.h"
@@ -34,14 +35,18 @@
 #include "HTMLToken.h"
 #include "ScriptableDocumentParser.h"
 #include "SegmentedString.h"
+#include "TextEncoding.h"
 #include "Timer.h"
 #include "XSSFilter.h"
+#include <wtf/Deque.h>
 #include <wtf/OwnPtr.h>
 
 namespace WebCore {
 
+class BackgroundHTMLParser;
 class Document;
 class DocumentFragment;
+class DocumentWriter;
 class HTMLDocument;
 class HTMLParserScheduler;
 class HTMLTokenizer;
@@ -70,6 +75,9 @@ public:
     // Exposed for HTMLParserScheduler
     void resumeParsingAfterYield();
 
+    // Exposed for BackgroundHTMLParser
+    void didReceiveTokensFromBackgroundParser();
+
     static void parseDocumentFragment(const String&, DocumentFragment*, Element* contextElement, FragmentScriptingPermission = FragmentScriptingAllowed);
     
     static bool usePreHTML5ParserQuirks(Document*);
@@ -86,6 +94,7 @@ public:
 protected:
     virtual void insert(const SegmentedString&);
     virtual void append(const SegmentedString&);
+    virtual void appendBytes(DocumentWriter*, const char* bytes, int length, bool flush);
     virtual void finish();
 
     HTMLDocumentParser(HTMLDocument*, bool reportErrors);
@@ -123,6 +132,13 @@ private:
     void pumpTokenizer(SynchronousMode);
     void pumpTokenizerIfPossible(SynchronousMode);
 
+    void startBackgroundParser();
+    void stopBackgroundParser();
+    bool processTokenFromBackgroundParser();
+    bool takeTokensFromBackgroundParser();
+    void preloadScanSpeculativeTokens();
+    void tokenizeRestOfDocumentOnMainThread();
+
     bool runScriptsForPausedTreeBuilder();
     void resumeParsingAfterScriptExecution();
 
@@ -136,7 +152,7 @@ private:
     bool isScheduledForResume() const;
     bool inScriptExecution() const;
     bool inPumpSession() const { return m_pumpSessionNestingLevel > 0; }
-    bool shouldDelayEnd() const { return inPumpSession() || isWaitingForScripts() || inScriptExecution() || isScheduledForResume(); }
+    bool shouldDelayEnd() const { return inPumpSession() || isWaitingForScripts() || inScriptExecution() || isScheduledForResume() || m_backgroundParser; }
 
     ScriptController* script() const;
 
@@ -153,6 +169,20 @@ private:
     HTMLSourceTracker m_sourceTracker;
     XSSFilter m_xssFilter;
 
+    // Network data is tokenized on another thread while we have a
+    // m_backgroundParser. See BackgroundHTMLParser.h.
+    RefPtr<BackgroundHTMLParser> m_backgroundParser;
+    Deque<CompactHTMLToken> m_speculativeTokens;
+    // While it exists, every token in m_speculativeTokens has been scanned.
+    OwnPtr<HTMLPreloadScanner> m_speculativePreloadScanner;
+    // What the document's decoder had settled on when m_backgroundParser
+    // took over decoding.
+    TextEncoding m_backgroundDecodingEncoding;
+    // Where m_tokenizer picks up if we stop using m_backgroundParser.
+    int m_speculativeInputOffset;
+    String m_speculativeEndTagName;
+    bool m_canUseBackgroundParser;
+
     bool m_endWasDelayed;
     unsigned m_pumpSessionNestingLevel;
 };
@@ -29,6 +29,7 @@
 #include "HTMLPreloadScanner.h"
 
 #include "CachedResourceLoader.h"
+#include "CompactHTMLToken.h"
 #include "Document.h"
 #include "InputType.h"
 #include "HTMLDocumentParser.h"
@@ -53,41 +54,57 @@ public:
         , m_linkMediaAttributeIsScreen(true)
         , m_inputIsImage(false)
     {
-        processAttributes(token.attributes());
+        if (!hasInterestingTagName())
+            return;
+
+        const HTMLToken::AttributeList& attributes = token.attributes();
+        for (HTMLToken::AttributeList::const_iterator iter = attributes.begin();
+             iter != attributes.end(); ++iter)
+            processAttribute(AtomicString(iter->m_name.data(), iter->m_name.size()), String(iter->m_value.data(), iter->m_value.size()));
     }
 
-    void processAttributes(const HTMLToken::AttributeList& attributes)
+    PreloadTask(const CompactHTMLToken& token)
+        : m_tagName(token.data())
+        , m_linkIsStyleSheet(false)
+        , m_linkMediaAttributeIsScreen(true)
+        , m_inputIsImage(false)
     {
-        if (m_tagName != imgTag
-            && m_tagName != inputTag
-            && m_tagName != linkTag
-            && m_tagName != scriptTag)
+        if (!hasInterestingTagName())
             return;
 
-        for (HTMLToken::AttributeList::const_iterator iter = attributes.begin();
-             iter != attributes.end(); ++iter) {
-            AtomicString attributeName(iter->m_name.data(), iter->m_name.size());
-            String attributeValue(iter->m_value.data(), iter->m_value.size());
-
-            if (attributeName == charsetAttr)
-                m_charset = attributeValue;
-
-            if (m_tagName == scriptTag || m_tagName == imgTag) {
-                if (attributeName == srcAttr)
-                    setUrlToLoad(attributeValue);
-            } else if (m_tagName == linkTag) {
-                if (attributeName == hrefAttr)
-                    setUrlToLoad(attributeValue);
-                else if (attributeName == relAttr)
-                    m_linkIsStyleSheet = relAttributeIsStyleSheet(attributeValue);
-                else if (attributeName == mediaAttr)
-                    m_linkMediaAttributeIsScreen = linkMediaAttributeIsScreen(attributeValue);
-            } else if (m_tagName == inputTag) {
-                if (attributeName == srcAttr)
-                    setUrlToLoad(attributeValue);
-                else if (attributeName == typeAttr)
-                    m_inputIsImage = equalIgnoringCase(attributeValue, InputTypeNames::image());
-            }
+        const Vector<CompactHTMLToken::Attribute>& attributes = token.attributes();
+        for (size_t i = 0; i < attributes.size(); ++i)
+            processAttribute(attributes[i].name, attributes[i].value);
+    }
+
+    bool hasInterestingTagName() const
+    {
+        return m_tagName == imgTag
+            || m_tagName == inputTag
+            || m_tagName == linkTag
+            || m_tagName == scriptTag;
+    }
+
+    void processAttribute(const AtomicString& attributeName, const String& attributeValue)
+    {
+        if (attributeName == charsetAttr)
+            m_charset = attributeValue;
+
+        if (m_tagName == scriptTag || m_tagName == imgTag) {
+            if (attributeName == srcAttr)
+                setUrlToLoad(attributeValue);
+        } else if (m_tagName == linkTag) {
+            if (attributeName == hrefAttr)
+                setUrlToLoad(attributeValue);
+            else if (attributeName == relAttr)
+                m_linkIsStyleSheet = relAttributeIsStyleSheet(attributeValue);
+            else if (attributeName == mediaAttr)
+                m_linkMediaAttributeIsScreen = linkMediaAttributeIsScreen(attributeValue);
+        } else if (m_tagName == inputTag) {
+            if (attributeName == srcAttr)
+                setUrlToLoad(attributeValue);
+            else if (attributeName == typeAttr)
+                m_inputIsImage = equalIgnoringCase(attributeValue, InputTypeNames::image());
         }
     }
 
@@ -187,16 +204,38 @@ void HTMLPreloadScanner::processToken()
 
     PreloadTask task(m_token);
     m_tokenizer->updateStateFor(task.tagName(), m_document->frame());
+    didSeeStartTag(task.tagName());
+    task.preload(m_document, scanningBody());
+}
 
-    if (task.tagName() == bodyTag)
-        m_bodySeen = true;
+void HTMLPreloadScanner::scan(const CompactHTMLToken& token)
+{
+    if (m_inStyle) {
+        if (token.type() == HTMLToken::Character)
+            m_cssScanner.scan(token.data(), scanningBody());
+        else if (token.type() == HTMLToken::EndTag) {
+            m_inStyle = false;
+            m_cssScanner.reset();
+        }
+    }
 
-    if (task.tagName() == styleTag)
-        m_inStyle = true;
+    if (token.type() != HTMLToken::StartTag)
+        return;
 
+    PreloadTask task(token);
+    didSeeStartTag(task.tagName());
     task.preload(m_document, scanningBody());
 }
 
+void HTMLPreloadScanner::didSeeStartTag(const AtomicString& tagName)
+{
+    if (tagName == bodyTag)
+        m_bodySeen = true;
+
+    if (tagName == styleTag)
+        m_inStyle = true;
+}
+
 bool HTMLPreloadScanner::scanningBody() const
 {
     return m_document->body() || m_bodySeen;
@@ -33,6 +33,7 @@
 
 namespace WebCore {
 
+class CompactHTMLToken;
 class Document;
 class HTMLToken;
 class HTMLTokenizer;
@@ -46,8 +47,14 @@ public:
     void appendToEnd(const SegmentedString&);
     void scan();
 
+    // Scans a token from the background parser instead of our own source.
+    // The background tokenizer has already made the state changes that
+    // processToken() makes to ours.
+    void scan(const CompactHTMLToken&);
+
 private:
     void processToken();
+    void didSeeStartTag(const AtomicString& tagName);
     bool scanningBody() const;
 
     Document* m_document;
@@ -32,6 +32,8 @@
 
 namespace WebCore {
 
+class CompactHTMLToken;
+
 class HTMLToken {
     WTF_MAKE_NONCOPYABLE(HTMLToken); WTF_MAKE_FAST_ALLOCATED;
 public:
@@ -407,11 +409,15 @@ public:
             m_data = String(token.comment().data(), token.comment().size());
             break;
         case HTMLToken::Character:
-            m_externalCharacters = &token.characters();
+            m_externalCharacters = token.characters().data();
+            m_externalCharactersLength = token.characters().size();
             break;
         }
     }
 
+    // Used when the token was produced by the background tokenizer.
+    explicit AtomicHTMLToken(CompactHTMLToken&);
+
     AtomicHTMLToken(HTMLToken::Type type, AtomicString name, PassRefPtr<NamedNodeMap> attributes = 0)
         : m_type(type)
         , m_name(name)
@@ -460,10 +466,16 @@ public:
         return m_attributes.release();
     }
 
-    const HTMLToken::DataVector& characters() const
+    const UChar* characters() const
+    {
+        ASSERT(m_type == HTMLToken::Character);
+        return m_externalCharacters;
+    }
+
+    size_t charactersLength() const
     {
         ASSERT(m_type == HTMLToken::Character);
-        return *m_externalCharacters;
+        return m_externalCharactersLength;
     }
 
     const String& comment() const
@@ -517,11 +529,13 @@ private:
     //
     // We don't want to copy the the characters out of the HTMLToken, so we
     // keep a pointer to its buffer instead.  This buffer is owned by the
-    // HTMLToken and causes a lifetime dependence between these objects.
+    // HTMLToken (or CompactHTMLToken) and causes a lifetime dependence
+    // between these objects.
     //
     // FIXME: Add a mechanism for "internalizing" the characters when the
     //        HTMLToken is destructed.
-    const HTMLToken::DataVector* m_externalCharacters;
+    const UChar* m_externalCharacters;
+    size_t m_externalCharactersLength;
 
     // For DOCTYPE
     OwnPtr<HTMLToken::DoctypeData> m_doctypeData;
@@ -74,14 +74,19 @@ inline void advanceStringAndASSERT(SegmentedString& source, const char* expected
         source.advanceAndASSERT(*expectedCharacters++);
 }
 
-inline bool vectorEqualsString(const Vector<UChar, 32>& vector, const String& string)
+// Compares with an ASCII literal rather than an HTMLNames AtomicString, since
+// the tokenizer also runs on the background parser thread, and HTMLNames
+// belong to the main thread.
+inline bool vectorEqualsString(const Vector<UChar, 32>& vector, const char* string)
 {
-    if (vector.size() != string.length())
+    size_t length = strlen(string);
+    if (vector.size() != length)
         return false;
-    const UChar* stringData = string.characters();
-    const UChar* vectorData = vector.data();
-    // FIXME: Is there a higher-level function we should be calling here?
-    return !memcmp(stringData, vectorData, vector.size() * sizeof(UChar));
+    for (size_t i = 0; i < length; ++i) {
+        if (vector[i] != static_cast<unsigned char>(string[i]))
+            return false;
+    }
+    return true;
 }
 
 inline bool isEndTagBufferingState(HTMLTokenizer::State state)
@@ -772,7 +777,7 @@ bool HTMLTokenizer::nextToken(SegmentedString& source, HTMLToken& token)
     BEGIN_STATE(ScriptDataDoubleEscapeStartState) {
         if (isTokenizerWhitespace(cc) || cc == '/' || cc == '>') {
             bufferCharacter(cc);
-            if (temporaryBufferIs(scriptTag.localName()))
+            if (temporaryBufferIs("script"))
                 ADVANCE_TO(ScriptDataDoubleEscapedState);
             else
                 ADVANCE_TO(ScriptDataEscapedState);
@@ -856,7 +861,7 @@ bool HTMLTokenizer::nextToken(SegmentedString& source, HTMLToken& token)
     BEGIN_STATE(ScriptDataDoubleEscapeEndState) {
         if (isTokenizerWhitespace(cc) || cc == '/' || cc == '>') {
             bufferCharacter(cc);
-            if (temporaryBufferIs(scriptTag.localName()))
+            if (temporaryBufferIs("script"))
                 ADVANCE_TO(ScriptDataEscapedState);
             else
                 ADVANCE_TO(ScriptDataDoubleEscapedState);
@@ -1662,7 +1667,13 @@ void HTMLTokenizer::updateStateFor(const AtomicString& tagName, Frame* frame)
         setState(RAWTEXTState);
 }
 
-inline bool HTMLTokenizer::temporaryBufferIs(const String& expectedString)
+void HTMLTokenizer::setAppropriateEndTagName(const String& tagName)
+{
+    m_appropriateEndTagName.clear();
+    m_appropriateEndTagName.append(tagName.characters(), tagName.length());
+}
+
+inline bool HTMLTokenizer::temporaryBufferIs(const char* expectedString)
 {
     return vectorEqualsString(m_temporaryBuffer, expectedString);
 }
@@ -133,6 +133,15 @@ public:
     int lineNumber() const { return m_lineNumber; }
     int columnNumber() const { return 1; } // Matches LegacyHTMLDocumentParser.h behavior.
 
+    // Used when the main thread takes over from the background tokenizer
+    // (see BackgroundHTMLParser.h) and needs to pick up where it left off.
+    void setLineNumber(int lineNumber) { m_lineNumber = lineNumber; }
+    void setAppropriateEndTagName(const String&);
+
+    // True if we have consumed the start of an end tag that has not been
+    // emitted yet, e.g. after emitting the character token for a script.
+    bool hasBufferedEndTag() const { return !m_bufferedEndTagName.isEmpty(); }
+
     State state() const { return m_state; }
     void setState(State state) { m_state = state; }
 
@@ -154,6 +163,7 @@ public:
 
     // Hack to skip leading newline in <pre>/<listing> for authoring ease.
     // http://www.whatwg.org/specs/web-apps/current-work/multipage/tokenization.html#parsing-main-inbody
+    bool skipLeadingNewLineForListing() const { return m_skipLeadingNewLineForListing; }
     void setSkipLeadingNewLineForListing(bool value) { m_skipLeadingNewLineForListing = value; }
 
     bool forceNullCharacterReplacement() const { return m_forceNullCharacterReplacement; }
@@ -272,7 +282,7 @@ private:
     // Return whether we need to emit a character token before dealing with
     // the buffered end tag.
     inline bool flushBufferedEndTag(SegmentedString&);
-    inline bool temporaryBufferIs(const String&);
+    inline bool temporaryBufferIs(const char*);
 
     // Sometimes we speculatively consume input characters and we don't
     // know whether they represent end tags or RCDATA, etc. These
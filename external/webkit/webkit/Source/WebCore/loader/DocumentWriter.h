@@ -72,12 +72,9 @@ public:
     // Exposed for DoucmentParser::appendBytes
     TextResourceDecoder* createDecoderIfNeeded();
     void reportDataReceived();
+    bool receivedData() { return m_receivedData; }
 
     void setDocumentWasLoadedAsPartOfNavigation();
-#if ENABLE(WML)
-    // M: Workaround for: XML Declaration allowed only at the start of the document.
-    bool receivedData() { return m_receivedData; }
-#endif
 
 private:
     PassRefPtr<Document> createDocument(const KURL&);
@@ -622,6 +622,34 @@ bool TextResourceDecoder::shouldAutoDetect() const
         && (m_source == DefaultEncoding || (m_source == EncodingFromParentFrame && m_hintEncoding)); 
 }
 
+bool TextResourceDecoder::canDecodeOnAnotherThread() const
+{
+    if (!m_codec || !m_checkedForBOM || !m_buffer.isEmpty() || shouldAutoDetect())
+        return false;
+    if ((m_contentType == HTML || m_contentType == XML) && !m_checkedForHeadCharset)
+        return false;
+    if (m_contentType == CSS && !m_checkedForCSSCharset)
+        return false;
+
+    // The ICU and platform codecs share converter caches between instances.
+    return m_encoding == UTF8Encoding()
+        || m_encoding == WindowsLatin1Encoding()
+        || m_encoding == Latin1Encoding()
+        || m_encoding == ASCIIEncoding();
+}
+
+PassOwnPtr<TextCodec> TextResourceDecoder::takeCodec()
+{
+    ASSERT(canDecodeOnAnotherThread());
+    return m_codec.release();
+}
+
+void TextResourceDecoder::adoptCodec(PassOwnPtr<TextCodec> codec)
+{
+    ASSERT(!m_codec);
+    m_codec = codec;
+}
+
 String TextResourceDecoder::decode(const char* data, size_t len)
 {
     size_t lengthOfBOM = 0;
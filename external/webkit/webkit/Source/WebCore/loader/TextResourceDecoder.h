@@ -65,6 +65,14 @@ public:
     void useLenientXMLDecoding() { m_useLenientXMLDecoding = true; }
     bool sawError() const { return m_sawError; }
 
+    // True once decode() has nothing left to sniff and only runs a codec
+    // that keeps no state outside itself. The HTML parser then takes the
+    // codec to decode on its tokenizer thread, and gives it back with
+    // adoptCodec() if it goes back to decoding on the main thread.
+    bool canDecodeOnAnotherThread() const;
+    PassOwnPtr<TextCodec> takeCodec();
+    void adoptCodec(PassOwnPtr<TextCodec>);
+
 private:
     TextResourceDecoder(const String& mimeType, const TextEncoding& defaultEncoding,
                         bool usesEncodingDetector);
@@ -53,6 +53,7 @@ class PurgeableBuffer;
 class CachedResource {
     WTF_MAKE_NONCOPYABLE(CachedResource); WTF_MAKE_FAST_ALLOCATED;
     friend class MemoryCache;
+    friend class DiskCache;
     friend class InspectorResource;
     
 public:
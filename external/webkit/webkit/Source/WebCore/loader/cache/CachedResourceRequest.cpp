@@ -35,6 +35,7 @@
 #include "ResourceLoadScheduler.h"
 #include "ResourceRequest.h"
 #include "ResourceResponse.h"
+#include "Settings.h"
 #include "SharedBuffer.h"
 #include <wtf/Assertions.h>
 #include <wtf/Vector.h>
@@ -70,40 +71,68 @@ static ResourceRequest::TargetType cachedResourceTypeToTargetType(CachedResource
     return ResourceRequest::TargetIsSubresource;
 }
 
-CachedResourceRequest::CachedResourceRequest(CachedResourceLoader* cachedResourceLoader, CachedResource* resource, bool incremental)
+CachedResourceRequest::CachedResourceRequest(CachedResourceLoader* cachedResourceLoader, CachedResource* resource, bool incremental, SecurityCheckPolicy securityCheck, bool sendResourceLoadCallbacks)
     : m_cachedResourceLoader(cachedResourceLoader)
     , m_resource(resource)
+    , m_securityCheck(securityCheck)
+    , m_sendResourceLoadCallbacks(sendResourceLoadCallbacks)
     , m_incremental(incremental)
     , m_multipart(false)
     , m_finishing(false)
+    , m_readingFromDiskCache(false)
 {
     m_resource->setRequest(this);
 }
 
 CachedResourceRequest::~CachedResourceRequest()
 {
+    if (m_readingFromDiskCache)
+        diskCache()->cancel(this);
     m_resource->setRequest(0);
 }
 
 PassRefPtr<CachedResourceRequest> CachedResourceRequest::load(CachedResourceLoader* cachedResourceLoader, CachedResource* resource, bool incremental, SecurityCheckPolicy securityCheck, bool sendResourceLoadCallbacks)
 {
-    RefPtr<CachedResourceRequest> request = adoptRef(new CachedResourceRequest(cachedResourceLoader, resource, incremental));
+    RefPtr<CachedResourceRequest> request = adoptRef(new CachedResourceRequest(cachedResourceLoader, resource, incremental, securityCheck, sendResourceLoadCallbacks));
 
-    ResourceRequest resourceRequest(resource->url());
-    resourceRequest.setTargetType(cachedResourceTypeToTargetType(resource->type(), resource->loadPriority()));
+    // A fresh copy on disk is as good as the network's. If reading it fails
+    // we go to the network after all.
+    if (request->canUseDiskCache() && diskCache()->retrieve(KURL(ParsedURLString, resource->url()), request.get())) {
+        request->m_readingFromDiskCache = true;
+        return request.release();
+    }
+
+    if (!request->startNetworkLoad()) {
+        // FIXME: What if resources in other frames were waiting for this revalidation?
+        LOG(ResourceLoading, "Cannot start loading '%s'", resource->url().latin1().data());
+        cachedResourceLoader->decrementRequestCount(resource);
+        cachedResourceLoader->loadFinishing();
+        if (resource->resourceToRevalidate()) 
+            memoryCache()->revalidationFailed(resource); 
+        resource->error(CachedResource::LoadError);
+        cachedResourceLoader->loadDone(0);
+        return 0;
+    }
+    return request.release();
+}
 
-    if (!resource->accept().isEmpty())
-        resourceRequest.setHTTPAccept(resource->accept());
+bool CachedResourceRequest::startNetworkLoad()
+{
+    ResourceRequest resourceRequest(m_resource->url());
+    resourceRequest.setTargetType(cachedResourceTypeToTargetType(m_resource->type(), m_resource->loadPriority()));
+
+    if (!m_resource->accept().isEmpty())
+        resourceRequest.setHTTPAccept(m_resource->accept());
 
-    if (resource->isCacheValidator()) {
-        CachedResource* resourceToRevalidate = resource->resourceToRevalidate();
+    if (m_resource->isCacheValidator()) {
+        CachedResource* resourceToRevalidate = m_resource->resourceToRevalidate();
         ASSERT(resourceToRevalidate->canUseCacheValidator());
         ASSERT(resourceToRevalidate->isLoaded());
         const String& lastModified = resourceToRevalidate->response().httpHeaderField("Last-Modified");
         const String& eTag = resourceToRevalidate->response().httpHeaderField("ETag");
         if (!lastModified.isEmpty() || !eTag.isEmpty()) {
-            ASSERT(cachedResourceLoader->cachePolicy() != CachePolicyReload);
-            if (cachedResourceLoader->cachePolicy() == CachePolicyRevalidate)
+            ASSERT(m_cachedResourceLoader->cachePolicy() != CachePolicyReload);
+            if (m_cachedResourceLoader->cachePolicy() == CachePolicyRevalidate)
                 resourceRequest.setHTTPHeaderField("Cache-Control", "max-age=0");
             if (!lastModified.isEmpty())
                 resourceRequest.setHTTPHeaderField("If-Modified-Since", lastModified);
@@ -113,28 +142,37 @@ PassRefPtr<CachedResourceRequest> CachedResourceRequest::load(CachedResourceLoad
     }
     
 #if ENABLE(LINK_PREFETCH)
-    if (resource->type() == CachedResource::LinkResource)
+    if (m_resource->type() == CachedResource::LinkResource)
         resourceRequest.setHTTPHeaderField("Purpose", "prefetch");
 #endif
 
-    ResourceLoadPriority priority = resource->loadPriority();
+    ResourceLoadPriority priority = m_resource->loadPriority();
     resourceRequest.setPriority(priority);
 
-    RefPtr<SubresourceLoader> loader = resourceLoadScheduler()->scheduleSubresourceLoad(cachedResourceLoader->document()->frame(),
-        request.get(), resourceRequest, priority, securityCheck, sendResourceLoadCallbacks);
-    if (!loader || loader->reachedTerminalState()) {
-        // FIXME: What if resources in other frames were waiting for this revalidation?
-        LOG(ResourceLoading, "Cannot start loading '%s'", resource->url().latin1().data());
-        cachedResourceLoader->decrementRequestCount(resource);
-        cachedResourceLoader->loadFinishing();
-        if (resource->resourceToRevalidate()) 
-            memoryCache()->revalidationFailed(resource); 
-        resource->error(CachedResource::LoadError);
-        cachedResourceLoader->loadDone(0);
-        return 0;
-    }
-    request->m_loader = loader;
-    return request.release();
+    RefPtr<SubresourceLoader> loader = resourceLoadScheduler()->scheduleSubresourceLoad(m_cachedResourceLoader->document()->frame(),
+        this, resourceRequest, priority, m_securityCheck, m_sendResourceLoadCallbacks);
+    if (!loader || loader->reachedTerminalState())
+        return false;
+    m_loader = loader.release();
+    return true;
+}
+
+static bool diskCacheAllowed(CachedResourceLoader* cachedResourceLoader)
+{
+    if (!diskCache()->isOpen())
+        return false;
+    Frame* frame = cachedResourceLoader->frame();
+    return frame && frame->settings() && !frame->settings()->privateBrowsingEnabled();
+}
+
+bool CachedResourceRequest::canUseDiskCache() const
+{
+    if (m_resource->isCacheValidator() || !diskCacheAllowed(m_cachedResourceLoader))
+        return false;
+
+    // Reloads have to go to the network.
+    CachePolicy cachePolicy = m_cachedResourceLoader->cachePolicy();
+    return cachePolicy != CachePolicyReload && cachePolicy != CachePolicyRevalidate;
 }
 
 void CachedResourceRequest::willSendRequest(SubresourceLoader*, ResourceRequest&, const ResourceResponse&)
@@ -151,6 +189,11 @@ void CachedResourceRequest::didFinishLoading(SubresourceLoader* loader, double)
     ASSERT(!m_resource->resourceToRevalidate());
     LOG(ResourceLoading, "Received '%s'.", m_resource->url().latin1().data());
 
+    finishLoading(loader->resourceData(), false);
+}
+
+void CachedResourceRequest::finishLoading(PassRefPtr<SharedBuffer> data, bool fromDiskCache)
+{
     // Prevent the document from being destroyed before we are done with
     // the cachedResourceLoader that it will delete when the document gets deleted.
     RefPtr<Document> protector(m_cachedResourceLoader->document());
@@ -162,9 +205,16 @@ void CachedResourceRequest::didFinishLoading(SubresourceLoader* loader, double)
     // error, so we can't send the successful data() and finish() callbacks.
     if (!m_resource->errorOccurred()) {
         m_cachedResourceLoader->loadFinishing();
-        m_resource->data(loader->resourceData(), true);
-        if (!m_resource->errorOccurred())
+        m_resource->data(data, true);
+        if (!m_resource->errorOccurred()) {
             m_resource->finish();
+            if (fromDiskCache) {
+                // The client hears about it the same way as about a memory cache hit.
+                if (Frame* frame = m_cachedResourceLoader->frame())
+                    frame->loader()->loadedResourceFromMemoryCache(m_resource);
+            } else if (!m_multipart && diskCacheAllowed(m_cachedResourceLoader))
+                diskCache()->store(m_resource);
+        }
     }
     m_cachedResourceLoader->loadDone(this);
 }
@@ -189,7 +239,12 @@ void CachedResourceRequest::didFail(bool cancelled)
     if (!m_multipart)
         m_cachedResourceLoader->decrementRequestCount(m_resource);
     m_finishing = true;
-    m_loader->clearClient();
+    if (m_readingFromDiskCache) {
+        diskCache()->cancel(this);
+        m_readingFromDiskCache = false;
+    }
+    if (m_loader)
+        m_loader->clearClient();
 
     if (m_resource->resourceToRevalidate())
         memoryCache()->revalidationFailed(m_resource);
@@ -277,6 +332,31 @@ void CachedResourceRequest::didReceiveData(SubresourceLoader* loader, const char
         m_resource->data(loader->resourceData(), false);
 }
 
+void CachedResourceRequest::didRetrieveFromDiskCache(const ResourceResponse& response, PassRefPtr<SharedBuffer> data)
+{
+    ASSERT(m_readingFromDiskCache);
+    m_readingFromDiskCache = false;
+    LOG(ResourceLoading, "Received '%s' from the disk cache.", m_resource->url().latin1().data());
+
+    m_resource->setResponse(response);
+    String encoding = response.textEncodingName();
+    if (!encoding.isNull())
+        m_resource->setEncoding(encoding);
+
+    finishLoading(data, true);
+}
+
+void CachedResourceRequest::didFailToRetrieveFromDiskCache()
+{
+    ASSERT(m_readingFromDiskCache);
+    m_readingFromDiskCache = false;
+    if (startNetworkLoad())
+        return;
+
+    LOG(ResourceLoading, "Cannot start loading '%s'", m_resource->url().latin1().data());
+    didFail();
+}
+
 void CachedResourceRequest::didReceiveCachedMetadata(SubresourceLoader*, const char* data, int size)
 {
     ASSERT(!m_resource->isCacheValidator());
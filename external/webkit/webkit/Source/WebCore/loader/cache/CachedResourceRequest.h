@@ -22,6 +22,7 @@
 #ifndef CachedResourceRequest_h
 #define CachedResourceRequest_h
 
+#include "DiskCache.h"
 #include "FrameLoaderTypes.h"
 #include "SubresourceLoader.h"
 #include "SubresourceLoaderClient.h"
@@ -35,7 +36,7 @@ namespace WebCore {
     class CachedResourceLoader;
     class Request;
 
-    class CachedResourceRequest : public RefCounted<CachedResourceRequest>, private SubresourceLoaderClient {
+    class CachedResourceRequest : public RefCounted<CachedResourceRequest>, private SubresourceLoaderClient, private DiskCacheClient {
     public:
         static PassRefPtr<CachedResourceRequest> load(CachedResourceLoader*, CachedResource*, bool incremental, SecurityCheckPolicy, bool sendResourceLoadCallbacks);
         ~CachedResourceRequest();
@@ -44,7 +45,11 @@ namespace WebCore {
         CachedResourceLoader* cachedResourceLoader() const { return m_cachedResourceLoader; }
 
     private:
-        CachedResourceRequest(CachedResourceLoader*, CachedResource*, bool incremental);
+        CachedResourceRequest(CachedResourceLoader*, CachedResource*, bool incremental, SecurityCheckPolicy, bool sendResourceLoadCallbacks);
+        bool startNetworkLoad();
+        bool canUseDiskCache() const;
+        void finishLoading(PassRefPtr<SharedBuffer>, bool fromDiskCache);
+
         virtual void willSendRequest(SubresourceLoader*, ResourceRequest&, const ResourceResponse&);
         virtual void didReceiveResponse(SubresourceLoader*, const ResourceResponse&);
         virtual void didReceiveData(SubresourceLoader*, const char*, int);
@@ -52,12 +57,18 @@ namespace WebCore {
         virtual void didFinishLoading(SubresourceLoader*, double);
         virtual void didFail(SubresourceLoader*, const ResourceError&);
 
+        virtual void didRetrieveFromDiskCache(const ResourceResponse&, PassRefPtr<SharedBuffer>);
+        virtual void didFailToRetrieveFromDiskCache();
+
         RefPtr<SubresourceLoader> m_loader;
         CachedResourceLoader* m_cachedResourceLoader;
         CachedResource* m_resource;
+        SecurityCheckPolicy m_securityCheck;
+        bool m_sendResourceLoadCallbacks;
         bool m_incremental;
         bool m_multipart;
         bool m_finishing;
+        bool m_readingFromDiskCache;
     };
 
 }
@@ -0,0 +1,862 @@
+/*
+ * Copyright (C) 2011 Google, Inc. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "DiskCache.h"
+
+#include "CachedResource.h"
+#include "FileSystem.h"
+#include "KURL.h"
+#include "ResourceResponse.h"
+#include "SharedBuffer.h"
+#include <wtf/CurrentTime.h>
+#include <wtf/MainThread.h>
+#include <wtf/OwnPtr.h>
+#include <wtf/PassOwnPtr.h>
+#include <wtf/text/CString.h>
+#include <algorithm>
+
+#if OS(UNIX)
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace WebCore {
+
+static const uint32_t indexMagic = 0x57434458; // 'WCDX'
+static const uint32_t recordMagic = 0x57434452; // 'WCDR'
+static const uint32_t indexVersion = 2;
+
+// The index is a set associative hash table: an entry for a URL lives in one
+// of |associativity| consecutive slots starting at its hash.
+static const unsigned tableSize = 8192;
+static const unsigned associativity = 4;
+
+// Large resources would push out everything else.
+static const unsigned maxEntryFraction = 8;
+
+struct DiskCache::IndexHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t tableSize;
+    uint32_t blockSize;
+    uint64_t useCounter;
+    uint32_t nextID;
+    uint32_t reserved;
+};
+
+struct DiskCache::IndexEntry {
+    uint32_t hash; // 0 if the slot is free.
+    uint32_t id; // Also written into the record, so that a record left over from an older entry is never mistaken for this one.
+    uint32_t firstBlock;
+    uint32_t blockCount;
+    uint64_t lastUse;
+    double expirationTime;
+
+    static bool precedesInBlockFile(const IndexEntry* a, const IndexEntry* b) { return a->firstBlock < b->firstBlock; }
+    static bool wasUsedEarlier(const IndexEntry* a, const IndexEntry* b) { return a->lastUse < b->lastUse; }
+};
+
+struct RecordHeader {
+    uint32_t magic;
+    uint32_t id;
+    uint32_t keyLength;
+    uint32_t responseLength;
+    uint32_t bodyLength;
+    uint32_t checksum; // Of everything after the header.
+};
+
+// Adler-32, as in zlib. Cheap enough to run over every body, and it catches a
+// record that was only partly written when the process died.
+class RecordChecksum {
+public:
+    RecordChecksum()
+        : m_a(1)
+        , m_b(0)
+    {
+    }
+
+    void add(const char* data, size_t length)
+    {
+        static const uint32_t modulus = 65521;
+        // The largest run for which m_b cannot overflow before it is reduced.
+        static const size_t maxRun = 5552;
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+        while (length) {
+            size_t run = std::min(length, maxRun);
+            length -= run;
+            while (run--) {
+                m_a += *bytes++;
+                m_b += m_a;
+            }
+            m_a %= modulus;
+            m_b %= modulus;
+        }
+    }
+
+    uint32_t value() const { return (m_b << 16) | m_a; }
+
+private:
+    uint32_t m_a;
+    uint32_t m_b;
+};
+
+struct DiskCache::Job {
+    WTF_MAKE_NONCOPYABLE(Job); WTF_MAKE_FAST_ALLOCATED;
+public:
+    enum Type { Read, Write, Truncate };
+
+    Job(Type type, long long offset)
+        : type(type)
+        , offset(offset)
+        , id(0)
+        , maxLength(0)
+        , client(0)
+        , startTime(0)
+        , cancelled(false)
+        , succeeded(false)
+    {
+    }
+
+    Type type;
+    long long offset; // Where the record starts, or for Truncate the new length of the block file.
+    uint32_t id;
+    uint32_t maxLength;
+    Vector<char> key;
+    Vector<char> data; // The record for Write, the serialized response for Read.
+    Vector<char> body;
+
+    // Only touched on the main thread; |client| is 0 once the read has been cancelled.
+    DiskCacheClient* client;
+    String url;
+    double startTime;
+
+    bool cancelled; // Guarded by m_mutex.
+    bool succeeded;
+};
+
+static inline uint32_t hashForURL(const String& url)
+{
+    uint32_t hash = url.impl()->hash();
+    return hash ? hash : 1;
+}
+
+static void appendNumber(Vector<char>& buffer, uint32_t value)
+{
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void appendString(Vector<char>& buffer, const String& string)
+{
+    CString utf8 = string.utf8();
+    appendNumber(buffer, utf8.length());
+    buffer.append(utf8.data(), utf8.length());
+}
+
+static bool readNumber(const char*& position, const char* end, uint32_t& value)
+{
+    if (static_cast<size_t>(end - position) < sizeof(value))
+        return false;
+    memcpy(&value, position, sizeof(value));
+    position += sizeof(value);
+    return true;
+}
+
+static bool readString(const char*& position, const char* end, String& string)
+{
+    uint32_t length;
+    if (!readNumber(position, end, length) || static_cast<size_t>(end - position) < length)
+        return false;
+    string = length ? String::fromUTF8(position, length) : String();
+    position += length;
+    return true;
+}
+
+static void encodeResponse(const ResourceResponse& response, Vector<char>& buffer)
+{
+    appendNumber(buffer, response.httpStatusCode());
+    appendString(buffer, response.httpStatusText());
+    appendString(buffer, response.mimeType());
+    appendString(buffer, response.textEncodingName());
+    appendString(buffer, response.suggestedFilename());
+
+    const HTTPHeaderMap& headers = response.httpHeaderFields();
+    appendNumber(buffer, headers.size());
+    HTTPHeaderMap::const_iterator end = headers.end();
+    for (HTTPHeaderMap::const_iterator it = headers.begin(); it != end; ++it) {
+        appendString(buffer, it->first);
+        appendString(buffer, it->second);
+    }
+}
+
+static bool decodeResponse(const String& url, const Vector<char>& buffer, long long bodyLength, ResourceResponse& response)
+{
+    const char* position = buffer.data();
+    const char* end = position + buffer.size();
+
+    uint32_t statusCode;
+    String statusText;
+    String mimeType;
+    String textEncodingName;
+    String suggestedFilename;
+    uint32_t headerCount;
+    if (!readNumber(position, end, statusCode) || !readString(position, end, statusText) || !readString(position, end, mimeType)
+        || !readString(position, end, textEncodingName) || !readString(position, end, suggestedFilename) || !readNumber(position, end, headerCount))
+        return false;
+
+    response = ResourceResponse(KURL(ParsedURLString, url), mimeType, bodyLength, textEncodingName, suggestedFilename);
+    response.setHTTPStatusCode(statusCode);
+    response.setHTTPStatusText(statusText);
+    for (uint32_t i = 0; i < headerCount; ++i) {
+        String name;
+        String value;
+        if (!readString(position, end, name) || !readString(position, end, value) || name.isEmpty())
+            return false;
+        response.setHTTPHeaderField(name, value);
+    }
+    response.setWasCached(true);
+    return position == end;
+}
+
+#if OS(UNIX)
+static bool readFully(int file, char* buffer, size_t length, long long offset)
+{
+    while (length) {
+        ssize_t result = pread(file, buffer, length, offset);
+        if (result < 0 && errno == EINTR)
+            continue;
+        if (result <= 0)
+            return false;
+        buffer += result;
+        length -= result;
+        offset += result;
+    }
+    return true;
+}
+
+static bool writeFully(int file, const char* buffer, size_t length, long long offset)
+{
+    while (length) {
+        ssize_t result = pwrite(file, buffer, length, offset);
+        if (result < 0 && errno == EINTR)
+            continue;
+        if (result <= 0)
+            return false;
+        buffer += result;
+        length -= result;
+        offset += result;
+    }
+    return true;
+}
+
+static void shrinkFile(int file, long long length)
+{
+    struct stat status;
+    if (!fstat(file, &status) && status.st_size > length)
+        ftruncate(file, length);
+}
+#else
+static bool readFully(int, char*, size_t, long long) { return false; }
+static bool writeFully(int, const char*, size_t, long long) { return false; }
+static void shrinkFile(int, long long) { }
+#endif
+
+DiskCache* diskCache()
+{
+    ASSERT(isMainThread());
+    static DiskCache* staticCache = new DiskCache;
+    return staticCache;
+}
+
+DiskCache::DiskCache()
+    : m_capacity(0)
+    , m_index(0)
+    , m_indexSize(0)
+    , m_dataFile(-1)
+    , m_usedBlocks(0)
+    , m_ioThreadStarted(false)
+    , m_ioThreadBusy(false)
+    , m_dispatchPending(false)
+{
+}
+
+bool DiskCache::open(const String& directory, unsigned capacity)
+{
+    if (m_index)
+        return true;
+
+#if OS(UNIX)
+    if (directory.isEmpty() || !makeAllDirectories(directory))
+        return false;
+
+    CString dataPath = fileSystemRepresentation(pathByAppendingComponent(directory, "data"));
+    m_dataFile = ::open(dataPath.data(), O_RDWR | O_CREAT, 0600);
+    if (m_dataFile < 0)
+        return false;
+
+    if (!openIndex(pathByAppendingComponent(directory, "index"))) {
+        ::close(m_dataFile);
+        m_dataFile = -1;
+        return false;
+    }
+
+    m_statistics = Statistics();
+    setCapacity(capacity);
+    return true;
+#else
+    UNUSED_PARAM(directory);
+    UNUSED_PARAM(capacity);
+    return false;
+#endif
+}
+
+void DiskCache::close()
+{
+    ASSERT(isMainThread());
+    if (!m_index)
+        return;
+
+    // Their records may not be read before the files go away, so send the
+    // requests to the network.
+    Vector<DiskCacheClient*> clients;
+    copyKeysToVector(m_reads, clients);
+    for (size_t i = 0; i < clients.size(); ++i) {
+        cancel(clients[i]);
+        clients[i]->didFailToRetrieveFromDiskCache();
+    }
+
+    if (m_ioThreadStarted) {
+        MutexLocker locker(m_mutex);
+        while (!m_pendingJobs.isEmpty() || m_ioThreadBusy)
+            m_idleCondition.wait(m_mutex);
+    }
+
+#if OS(UNIX)
+    munmap(m_index, m_indexSize);
+    ::close(m_dataFile);
+#endif
+    m_index = 0;
+    m_indexSize = 0;
+    m_dataFile = -1;
+    m_freeRuns.clear();
+    m_recentlyUsedEntries.clear();
+    m_usedBlocks = 0;
+}
+
+bool DiskCache::openIndex(const String& path)
+{
+#if OS(UNIX)
+    int file = ::open(fileSystemRepresentation(path).data(), O_RDWR | O_CREAT, 0600);
+    if (file < 0)
+        return false;
+
+    m_indexSize = sizeof(IndexHeader) + tableSize * sizeof(IndexEntry);
+    struct stat status;
+    bool isNew = fstat(file, &status) || static_cast<size_t>(status.st_size) != m_indexSize;
+    if (isNew && (ftruncate(file, 0) || ftruncate(file, m_indexSize))) {
+        ::close(file);
+        return false;
+    }
+
+    void* mapping = mmap(0, m_indexSize, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    ::close(file);
+    if (mapping == MAP_FAILED)
+        return false;
+    m_index = static_cast<IndexHeader*>(mapping);
+
+    if (isNew || m_index->magic != indexMagic || m_index->version != indexVersion || m_index->tableSize != tableSize || m_index->blockSize != blockSize)
+        resetIndex();
+    return true;
+#else
+    UNUSED_PARAM(path);
+    return false;
+#endif
+}
+
+void DiskCache::resetIndex()
+{
+    memset(m_index, 0, m_indexSize);
+    m_index->magic = indexMagic;
+    m_index->version = indexVersion;
+    m_index->tableSize = tableSize;
+    m_index->blockSize = blockSize;
+
+    // Entry ids start over, so old records must not survive.
+    postJob(new Job(Job::Truncate, 0));
+}
+
+void DiskCache::rebuildAllocationState()
+{
+    unsigned capacityBlocks = capacityInBlocks();
+    m_freeRuns.clear();
+    m_recentlyUsedEntries.clear();
+    m_usedBlocks = 0;
+
+    Vector<IndexEntry*> liveEntries;
+    IndexEntry* entries = reinterpret_cast<IndexEntry*>(m_index + 1);
+    for (unsigned i = 0; i < tableSize; ++i) {
+        IndexEntry& entry = entries[i];
+        if (!entry.hash)
+            continue;
+        if (entry.blockCount && entry.firstBlock < capacityBlocks && entry.blockCount <= capacityBlocks - entry.firstBlock)
+            liveEntries.append(&entry);
+        else {
+            // The capacity shrank.
+            memset(&entry, 0, sizeof(entry));
+        }
+    }
+
+    // Walk the entries in block order; the gaps between them are free.
+    std::sort(liveEntries.begin(), liveEntries.end(), IndexEntry::precedesInBlockFile);
+    Vector<IndexEntry*> keptEntries;
+    unsigned nextBlock = 0;
+    for (size_t i = 0; i < liveEntries.size(); ++i) {
+        IndexEntry* entry = liveEntries[i];
+        if (entry->firstBlock < nextBlock) {
+            // Overlaps the previous entry, so the index is damaged.
+            memset(entry, 0, sizeof(*entry));
+            continue;
+        }
+        if (entry->firstBlock > nextBlock)
+            m_freeRuns.append(BlockRun(nextBlock, entry->firstBlock - nextBlock));
+        nextBlock = entry->firstBlock + entry->blockCount;
+        m_usedBlocks += entry->blockCount;
+        keptEntries.append(entry);
+    }
+    if (nextBlock < capacityBlocks)
+        m_freeRuns.append(BlockRun(nextBlock, capacityBlocks - nextBlock));
+
+    std::sort(keptEntries.begin(), keptEntries.end(), IndexEntry::wasUsedEarlier);
+    for (size_t i = 0; i < keptEntries.size(); ++i)
+        m_recentlyUsedEntries.add(keptEntries[i]);
+}
+
+void DiskCache::setCapacity(unsigned bytes)
+{
+    m_capacity = bytes;
+    if (!m_index)
+        return;
+
+    rebuildAllocationState();
+    postJob(new Job(Job::Truncate, static_cast<long long>(capacityInBlocks()) * blockSize));
+}
+
+DiskCache::IndexEntry* DiskCache::findEntry(const String& url)
+{
+    uint32_t hash = hashForURL(url);
+    IndexEntry* entries = reinterpret_cast<IndexEntry*>(m_index + 1);
+    for (unsigned i = 0; i < associativity; ++i) {
+        IndexEntry& entry = entries[(hash + i) % tableSize];
+        if (entry.hash == hash)
+            return &entry;
+    }
+    return 0;
+}
+
+void DiskCache::touchEntry(IndexEntry* entry)
+{
+    entry->lastUse = ++m_index->useCounter;
+    m_recentlyUsedEntries.remove(entry);
+    m_recentlyUsedEntries.add(entry);
+}
+
+size_t DiskCache::removeEntry(IndexEntry* entry)
+{
+    m_recentlyUsedEntries.remove(entry);
+    size_t run = freeBlocks(entry->firstBlock, entry->blockCount);
+    memset(entry, 0, sizeof(*entry));
+    return run;
+}
+
+bool DiskCache::allocateBlocks(unsigned count, unsigned& firstBlock)
+{
+    if (!count || count > capacityInBlocks())
+        return false;
+
+    size_t run = notFound;
+    for (size_t i = 0; i < m_freeRuns.size(); ++i) {
+        if (m_freeRuns[i].count >= count) {
+            run = i;
+            break;
+        }
+    }
+
+    // Either out of space or too fragmented for a run this long. Nothing fits
+    // yet, so only the run that an eviction frees blocks into can start to.
+    while (run == notFound) {
+        if (m_recentlyUsedEntries.isEmpty())
+            return false;
+        size_t grownRun = removeEntry(m_recentlyUsedEntries.first());
+        ++m_statistics.evictions;
+        if (m_freeRuns[grownRun].count >= count)
+            run = grownRun;
+    }
+
+    BlockRun& freeRun = m_freeRuns[run];
+    firstBlock = freeRun.firstBlock;
+    freeRun.firstBlock += count;
+    freeRun.count -= count;
+    if (!freeRun.count)
+        m_freeRuns.remove(run);
+    m_usedBlocks += count;
+    return true;
+}
+
+size_t DiskCache::freeBlocks(unsigned firstBlock, unsigned count)
+{
+    ASSERT(m_usedBlocks >= count);
+    m_usedBlocks -= count;
+
+    size_t next = std::lower_bound(m_freeRuns.begin(), m_freeRuns.end(), BlockRun(firstBlock, count)) - m_freeRuns.begin();
+    ASSERT(next == m_freeRuns.size() || m_freeRuns[next].firstBlock >= firstBlock + count);
+    bool joinsPrevious = next && m_freeRuns[next - 1].firstBlock + m_freeRuns[next - 1].count == firstBlock;
+    bool joinsNext = next < m_freeRuns.size() && m_freeRuns[next].firstBlock == firstBlock + count;
+
+    if (joinsPrevious && joinsNext) {
+        m_freeRuns[next - 1].count += count + m_freeRuns[next].count;
+        m_freeRuns.remove(next);
+        return next - 1;
+    }
+    if (joinsPrevious) {
+        m_freeRuns[next - 1].count += count;
+        return next - 1;
+    }
+    if (joinsNext) {
+        m_freeRuns[next].firstBlock = firstBlock;
+        m_freeRuns[next].count += count;
+        return next;
+    }
+    m_freeRuns.insert(next, BlockRun(firstBlock, count));
+    return next;
+}
+
+void DiskCache::store(CachedResource* resource)
+{
+    ASSERT(isMainThread());
+    if (!m_index || resource->errorOccurred() || resource->isPurgeable() || !resource->data())
+        return;
+
+    store(KURL(ParsedURLString, resource->url()), resource->response(), resource->data(), resource->freshnessLifetime() - resource->currentAge());
+}
+
+void DiskCache::store(const KURL& url, const ResourceResponse& response, SharedBuffer* body, double lifetime)
+{
+    ASSERT(isMainThread());
+    if (!m_index)
+        return;
+
+    if (!url.protocolInHTTPFamily() || response.httpStatusCode() != 200 || response.isMultipart())
+        return;
+    if (response.cacheControlContainsNoStore() || response.cacheControlContainsNoCache())
+        return;
+
+    // Entries are looked up by URL alone.
+    String vary = response.httpHeaderField("Vary").stripWhiteSpace();
+    if (!vary.isEmpty() && !equalIgnoringCase(vary, "Accept-Encoding"))
+        return;
+
+    String urlString = url.string();
+    if (IndexEntry* existing = findEntry(urlString))
+        removeEntry(existing);
+
+    if (!(lifetime > 0))
+        return;
+
+    Vector<char> serializedResponse;
+    encodeResponse(response, serializedResponse);
+    CString key = urlString.utf8();
+    unsigned long long recordLength = sizeof(RecordHeader) + key.length() + serializedResponse.size() + body->size();
+    if (recordLength > m_capacity / maxEntryFraction)
+        return;
+
+    unsigned blockCount = (recordLength + blockSize - 1) / blockSize;
+    unsigned firstBlock;
+    if (!allocateBlocks(blockCount, firstBlock))
+        return;
+
+    // Use a free slot in the URL's set, or take the least recently used one.
+    uint32_t hash = hashForURL(urlString);
+    IndexEntry* entries = reinterpret_cast<IndexEntry*>(m_index + 1);
+    IndexEntry* entry = 0;
+    for (unsigned i = 0; i < associativity; ++i) {
+        IndexEntry& candidate = entries[(hash + i) % tableSize];
+        if (!candidate.hash) {
+            entry = &candidate;
+            break;
+        }
+        if (!entry || candidate.lastUse < entry->lastUse)
+            entry = &candidate;
+    }
+    if (entry->hash) {
+        removeEntry(entry);
+        ++m_statistics.evictions;
+    }
+
+    if (!++m_index->nextID)
+        ++m_index->nextID;
+    entry->hash = hash;
+    entry->id = m_index->nextID;
+    entry->firstBlock = firstBlock;
+    entry->blockCount = blockCount;
+    entry->expirationTime = currentTime() + lifetime;
+    touchEntry(entry);
+
+    // The index now points at blocks that have not been written yet. That is
+    // fine: any read of them is queued behind this write, and if the write
+    // never happens the record's id will not match. The checksum is filled in
+    // on the I/O thread.
+    RecordHeader header = { recordMagic, entry->id, static_cast<uint32_t>(key.length()), static_cast<uint32_t>(serializedResponse.size()), static_cast<uint32_t>(body->size()), 0 };
+    Job* job = new Job(Job::Write, static_cast<long long>(firstBlock) * blockSize);
+    job->data.reserveInitialCapacity(recordLength);
+    job->data.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    job->data.append(key.data(), key.length());
+    job->data.append(serializedResponse);
+    job->data.append(body->data(), body->size());
+    if (!postJob(job)) {
+        removeEntry(entry);
+        return;
+    }
+
+    ++m_statistics.stores;
+}
+
+bool DiskCache::retrieve(const KURL& url, DiskCacheClient* client)
+{
+    ASSERT(isMainThread());
+    if (!m_index || m_reads.contains(client))
+        return false;
+
+    ++m_statistics.lookups;
+    String urlString = url.string();
+    IndexEntry* entry = findEntry(urlString);
+    if (!entry)
+        return false;
+    if (entry->expirationTime <= currentTime()) {
+        removeEntry(entry);
+        return false;
+    }
+    touchEntry(entry);
+
+    Job* job = new Job(Job::Read, static_cast<long long>(entry->firstBlock) * blockSize);
+    job->id = entry->id;
+    job->maxLength = entry->blockCount * blockSize;
+    CString key = urlString.utf8();
+    job->key.append(key.data(), key.length());
+    job->client = client;
+    job->url = urlString;
+    job->startTime = currentTime();
+    // Without an I/O thread the read would never finish; the caller goes to
+    // the network instead.
+    if (!postJob(job))
+        return false;
+    m_reads.set(client, job);
+    return true;
+}
+
+void DiskCache::cancel(DiskCacheClient* client)
+{
+    ASSERT(isMainThread());
+    Job* job = m_reads.take(client);
+    if (!job)
+        return;
+
+    // The job is deleted by dispatchFinishedReads() once the I/O thread has
+    // let go of it.
+    job->client = 0;
+    MutexLocker locker(m_mutex);
+    job->cancelled = true;
+}
+
+void DiskCache::remove(const KURL& url)
+{
+    if (!m_index)
+        return;
+    if (IndexEntry* entry = findEntry(url.string()))
+        removeEntry(entry);
+}
+
+void DiskCache::clear()
+{
+    if (!m_index)
+        return;
+    resetIndex();
+    rebuildAllocationState();
+}
+
+bool DiskCache::startIOThreadIfNeeded()
+{
+    if (m_ioThreadStarted)
+        return true;
+    ThreadIdentifier thread = createThread(DiskCache::ioThreadEntryPoint, this, "WebCore: DiskCache");
+    if (!thread)
+        return false;
+    detachThread(thread);
+    m_ioThreadStarted = true;
+    return true;
+}
+
+bool DiskCache::postJob(Job* job)
+{
+    if (!startIOThreadIfNeeded()) {
+        delete job;
+        return false;
+    }
+    MutexLocker locker(m_mutex);
+    m_pendingJobs.append(job);
+    m_condition.signal();
+    return true;
+}
+
+void* DiskCache::ioThreadEntryPoint(void* context)
+{
+    static_cast<DiskCache*>(context)->runIOThread();
+    return 0;
+}
+
+void DiskCache::runIOThread()
+{
+    // The cache is never destroyed, so neither is its thread.
+    while (true) {
+        Job* job;
+        bool cancelled;
+        {
+            MutexLocker locker(m_mutex);
+            m_ioThreadBusy = false;
+            while (m_pendingJobs.isEmpty()) {
+                m_idleCondition.signal();
+                m_condition.wait(m_mutex);
+            }
+            job = m_pendingJobs.takeFirst();
+            cancelled = job->cancelled;
+            m_ioThreadBusy = true;
+        }
+
+        if (!cancelled)
+            performJob(job);
+        if (job->type != Job::Read) {
+            delete job;
+            continue;
+        }
+
+        MutexLocker locker(m_mutex);
+        m_finishedReads.append(job);
+        if (!m_dispatchPending) {
+            m_dispatchPending = true;
+            callOnMainThread(DiskCache::didFinishReads, this);
+        }
+    }
+}
+
+void DiskCache::performJob(Job* job)
+{
+    switch (job->type) {
+    case Job::Write: {
+        RecordChecksum checksum;
+        checksum.add(job->data.data() + sizeof(RecordHeader), job->data.size() - sizeof(RecordHeader));
+        uint32_t value = checksum.value();
+        memcpy(job->data.data() + OBJECT_OFFSETOF(RecordHeader, checksum), &value, sizeof(value));
+        writeFully(m_dataFile, job->data.data(), job->data.size(), job->offset);
+        return;
+    }
+    case Job::Truncate:
+        shrinkFile(m_dataFile, job->offset);
+        return;
+    case Job::Read: {
+        RecordHeader header;
+        if (!readFully(m_dataFile, reinterpret_cast<char*>(&header), sizeof(header), job->offset))
+            return;
+        unsigned long long length = sizeof(header) + static_cast<unsigned long long>(header.keyLength) + header.responseLength + header.bodyLength;
+        if (header.magic != recordMagic || header.id != job->id || header.keyLength != job->key.size() || length > job->maxLength)
+            return;
+
+        long long offset = job->offset + sizeof(header);
+        Vector<char> key(header.keyLength);
+        if (!readFully(m_dataFile, key.data(), key.size(), offset) || memcmp(key.data(), job->key.data(), key.size()))
+            return;
+        offset += key.size();
+
+        job->data.resize(header.responseLength);
+        job->body.resize(header.bodyLength);
+        if (!readFully(m_dataFile, job->data.data(), job->data.size(), offset)
+            || !readFully(m_dataFile, job->body.data(), job->body.size(), offset + job->data.size()))
+            return;
+
+        RecordChecksum checksum;
+        checksum.add(key.data(), key.size());
+        checksum.add(job->data.data(), job->data.size());
+        checksum.add(job->body.data(), job->body.size());
+        job->succeeded = checksum.value() == header.checksum;
+        return;
+    }
+    }
+    ASSERT_NOT_REACHED();
+}
+
+void DiskCache::didFinishReads(void* context)
+{
+    static_cast<DiskCache*>(context)->dispatchFinishedReads();
+}
+
+void DiskCache::dispatchFinishedReads()
+{
+    ASSERT(isMainThread());
+    Vector<Job*> jobs;
+    {
+        MutexLocker locker(m_mutex);
+        m_dispatchPending = false;
+        jobs.swap(m_finishedReads);
+    }
+
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        OwnPtr<Job> job = adoptPtr(jobs[i]);
+        // A client called back earlier in this loop may have cancelled it.
+        DiskCacheClient* client = job->client;
+        if (!client)
+            continue;
+        m_reads.remove(client);
+
+        ResourceResponse response;
+        if (!job->succeeded || !decodeResponse(job->url, job->data, job->body.size(), response)) {
+            ++m_statistics.readFailures;
+            IndexEntry* entry = findEntry(job->url);
+            if (entry && entry->id == job->id)
+                removeEntry(entry);
+            client->didFailToRetrieveFromDiskCache();
+            continue;
+        }
+
+        double readTime = currentTime() - job->startTime;
+        ++m_statistics.hits;
+        m_statistics.bytesRead += job->body.size();
+        m_statistics.totalReadTime += readTime;
+        m_statistics.maxReadTime = std::max(m_statistics.maxReadTime, readTime);
+        client->didRetrieveFromDiskCache(response, SharedBuffer::adoptVector(job->body));
+    }
+}
+
+} // namespace WebCore
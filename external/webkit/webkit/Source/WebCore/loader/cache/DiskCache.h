@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2011 Google, Inc. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DiskCache_h
+#define DiskCache_h
+
+#include "PlatformString.h"
+#include <wtf/Deque.h>
+#include <wtf/HashMap.h>
+#include <wtf/ListHashSet.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/PassRefPtr.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+
+namespace WebCore {
+
+class CachedResource;
+class KURL;
+class ResourceResponse;
+class SharedBuffer;
+
+class DiskCacheClient {
+public:
+    virtual ~DiskCacheClient() { }
+
+    // Exactly one of these is called, on the main thread, for each successful
+    // DiskCache::retrieve() that is not cancelled.
+    virtual void didRetrieveFromDiskCache(const ResourceResponse&, PassRefPtr<SharedBuffer>) = 0;
+    virtual void didFailToRetrieveFromDiskCache() = 0;
+};
+
+// A persistent second tier behind the MemoryCache. It keeps the responses and
+// bodies of fresh HTTP subresources on disk, so that they can be loaded again
+// without going to the network, including after the process restarts.
+//
+// The cache directory holds two files:
+//  - "index", a fixed size hash table that is mapped into memory and only
+//    ever touched on the main thread, and
+//  - "data", a block file holding one record per entry in a run of
+//    consecutive blocks.
+// All reads and writes of the block file happen, in order, on a single I/O
+// thread; that ordering is what keeps a read of an evicted entry from seeing
+// blocks that have already been handed to a newer one.
+//
+// The total size of the block file is bounded by the capacity; the least
+// recently used entries are evicted to make room. Entries that are no longer
+// fresh are dropped rather than revalidated. Each record carries a checksum,
+// so a record that was only partly written when the process died reads as a
+// miss.
+//
+// If the I/O thread cannot be started, nothing is stored and every lookup
+// misses, so loads go to the network.
+class DiskCache {
+    WTF_MAKE_NONCOPYABLE(DiskCache); WTF_MAKE_FAST_ALLOCATED;
+public:
+    friend DiskCache* diskCache();
+
+    struct Statistics {
+        unsigned lookups;
+        unsigned hits;
+        unsigned readFailures;
+        unsigned stores;
+        unsigned evictions;
+        unsigned long long bytesRead;
+        // Time from a lookup to its response being handed back, in seconds.
+        double totalReadTime;
+        double maxReadTime;
+        Statistics() : lookups(0), hits(0), readFailures(0), stores(0), evictions(0), bytesRead(0), totalReadTime(0), maxReadTime(0) { }
+    };
+
+    // Opens the cache in |directory|, creating it if needed. The cache stays
+    // open for the lifetime of the process; until it is opened, it stores
+    // nothing and finds nothing.
+    bool open(const String& directory, unsigned capacity);
+    bool isOpen() const { return m_index; }
+
+    // Fails any reads in progress, waits for queued writes to reach the disk
+    // and closes the files. Opening the cache again starts the statistics
+    // over, as a new process would.
+    void close();
+
+    void setCapacity(unsigned bytes);
+    unsigned capacity() const { return m_capacity; }
+
+    // Stores a finished resource if its response can be reused without
+    // revalidation.
+    void store(CachedResource*);
+    // Stores |body| as the response for |url|, to be served for the next
+    // |lifetime| seconds. The response has to be storable, as above.
+    void store(const KURL&, const ResourceResponse&, SharedBuffer* body, double lifetime);
+
+    // Returns false if there is no fresh entry for |url| or the entry cannot be
+    // read. Otherwise the entry is read on the I/O thread and the client is
+    // called back with it.
+    bool retrieve(const KURL&, DiskCacheClient*);
+    void cancel(DiskCacheClient*);
+
+    void remove(const KURL&);
+    void clear();
+
+    // Counted since the cache was opened, which for a new process is exactly
+    // the cold start behaviour.
+    const Statistics& statistics() const { return m_statistics; }
+    unsigned entryCount() const { return m_recentlyUsedEntries.size(); }
+    unsigned size() const { return m_usedBlocks * blockSize; }
+
+private:
+    struct IndexHeader;
+    struct IndexEntry;
+    struct Job;
+
+    struct BlockRun {
+        BlockRun(unsigned firstBlock, unsigned count)
+            : firstBlock(firstBlock)
+            , count(count)
+        {
+        }
+
+        bool operator<(const BlockRun& other) const { return firstBlock < other.firstBlock; }
+
+        unsigned firstBlock;
+        unsigned count;
+    };
+
+    static const unsigned blockSize = 1024;
+
+    DiskCache();
+
+    bool openIndex(const String& path);
+    void resetIndex();
+    void rebuildAllocationState();
+
+    IndexEntry* findEntry(const String& url);
+    void touchEntry(IndexEntry*);
+    // Returns the index of the free run that the entry's blocks joined.
+    size_t removeEntry(IndexEntry*);
+    bool allocateBlocks(unsigned count, unsigned& firstBlock);
+    size_t freeBlocks(unsigned firstBlock, unsigned count);
+    unsigned capacityInBlocks() const { return m_capacity / blockSize; }
+
+    bool startIOThreadIfNeeded();
+    // Deletes the job and returns false if there is no I/O thread to run it.
+    bool postJob(Job*);
+    static void* ioThreadEntryPoint(void*);
+    void runIOThread();
+    void performJob(Job*);
+
+    static void didFinishReads(void*);
+    void dispatchFinishedReads();
+
+    // Only touched on the main thread.
+    unsigned m_capacity;
+    IndexHeader* m_index;
+    size_t m_indexSize;
+    int m_dataFile;
+    // The unused parts of the block file, sorted and never adjacent.
+    Vector<BlockRun> m_freeRuns;
+    unsigned m_usedBlocks;
+    // Every live entry, least recently used first.
+    ListHashSet<IndexEntry*> m_recentlyUsedEntries;
+    HashMap<DiskCacheClient*, Job*> m_reads;
+    Statistics m_statistics;
+    bool m_ioThreadStarted;
+
+    // Guards everything below.
+    Mutex m_mutex;
+    ThreadCondition m_condition;
+    ThreadCondition m_idleCondition;
+    Deque<Job*> m_pendingJobs;
+    bool m_ioThreadBusy;
+    Vector<Job*> m_finishedReads;
+    bool m_dispatchPending;
+};
+
+DiskCache* diskCache();
+
+} // namespace WebCore
+
+#endif // DiskCache_h
@@ -176,6 +176,10 @@ Settings::Settings(Page* page)
     , m_memoryInfoEnabled(false)
     , m_interactiveFormValidation(false)
     , m_usePreHTML5ParserQuirks(false)
+    , m_threadedHTMLParserEnabled(false)
+    , m_asynchronousImageDecodingEnabled(false)
+    , m_layerDisplayListsEnabled(false)
+    , m_databaseTransactionBatchingEnabled(false)
     , m_hyperlinkAuditingEnabled(false)
     , m_crossOriginCheckInGetMatchedCSSRulesDisabled(false)
     , m_useQuickLookResourceCachingQuirks(false)
@@ -448,6 +448,28 @@ namespace WebCore {
         void setUsePreHTML5ParserQuirks(bool flag) { m_usePreHTML5ParserQuirks = flag; }
         bool usePreHTML5ParserQuirks() const { return m_usePreHTML5ParserQuirks; }
 
+        // Decode and tokenize network-loaded HTML documents on a background
+        // thread.
+        void setThreadedHTMLParserEnabled(bool flag) { m_threadedHTMLParserEnabled = flag; }
+        bool threadedHTMLParserEnabled() const { return m_threadedHTMLParserEnabled; }
+
+        // Paint <img> elements whose image is not decoded yet as blank, and
+        // decode the image on another thread, instead of decoding it during
+        // painting.
+        void setAsynchronousImageDecodingEnabled(bool flag) { m_asynchronousImageDecodingEnabled = flag; }
+        bool asynchronousImageDecodingEnabled() const { return m_asynchronousImageDecodingEnabled; }
+
+        // Keep a recording of what each layer painted and replay it, instead
+        // of walking the render tree, until one of the layer's renderers
+        // repaints. Only supported on Android.
+        void setLayerDisplayListsEnabled(bool flag) { m_layerDisplayListsEnabled = flag; }
+        bool layerDisplayListsEnabled() const { return m_layerDisplayListsEnabled; }
+
+        // Let read-write Web SQL transactions that are queued back to back on
+        // one database handle share a single commit.
+        void setDatabaseTransactionBatchingEnabled(bool flag) { m_databaseTransactionBatchingEnabled = flag; }
+        bool databaseTransactionBatchingEnabled() const { return m_databaseTransactionBatchingEnabled; }
+
         void setHyperlinkAuditingEnabled(bool flag) { m_hyperlinkAuditingEnabled = flag; }
         bool hyperlinkAuditingEnabled() const { return m_hyperlinkAuditingEnabled; }
 
@@ -599,6 +621,10 @@ namespace WebCore {
         bool m_memoryInfoEnabled: 1;
         bool m_interactiveFormValidation: 1;
         bool m_usePreHTML5ParserQuirks: 1;
+        bool m_threadedHTMLParserEnabled : 1;
+        bool m_asynchronousImageDecodingEnabled : 1;
+        bool m_layerDisplayListsEnabled : 1;
+        bool m_databaseTransactionBatchingEnabled : 1;
         bool m_hyperlinkAuditingEnabled : 1;
         bool m_crossOriginCheckInGetMatchedCSSRulesDisabled : 1;
         bool m_useQuickLookResourceCachingQuirks : 1;
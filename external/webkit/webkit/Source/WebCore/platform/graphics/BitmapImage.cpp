@@ -27,6 +27,7 @@
 #include "config.h"
 #include "BitmapImage.h"
 
+#include "DecodedFrameCache.h"
 #include "FloatRect.h"
 #include "ImageObserver.h"
 #include "IntRect.h"
@@ -34,6 +35,7 @@
 #include "PlatformString.h"
 #include "Timer.h"
 #include <wtf/CurrentTime.h>
+#include <wtf/UnusedParam.h>
 #include <wtf/Vector.h>
 
 namespace WebCore {
@@ -43,6 +45,12 @@ static int frameBytes(const IntSize& frameSize)
     return frameSize.width() * frameSize.height() * 4;
 }
 
+#if USE(IMAGE_DECODING_SERVICE)
+// Below this size handing the decode to another thread costs more than it
+// saves.
+static const int minimumPixelsForAsynchronousDecoding = 128 * 128;
+#endif
+
 BitmapImage::BitmapImage(ImageObserver* observer)
     : Image(observer)
     , m_currentFrame(0)
@@ -63,12 +71,21 @@ BitmapImage::BitmapImage(ImageObserver* observer)
     , m_decodedPropertiesSize(0)
     , m_haveFrameCount(false)
     , m_frameCount(0)
+#if USE(IMAGE_DECODING_SERVICE)
+    , m_asynchronousDecodingFailed(false)
+    , m_pendingDecodePixels(0)
+    , m_firstFrameDecodePixels(0)
+#endif
 {
     initPlatformData();
 }
 
 BitmapImage::~BitmapImage()
 {
+#if USE(IMAGE_DECODING_SERVICE)
+    ImageDecodingService::shared().cancel(this);
+#endif
+    decodedFrameCache()->removeImage(this);
     invalidatePlatformData();
     stopAnimation();
 }
@@ -108,6 +125,7 @@ void BitmapImage::destroyMetadataAndNotify(int framesCleared)
 
     int deltaBytes = framesCleared * -frameBytes(m_size);
     m_decodedSize += deltaBytes;
+    decodedFrameCache()->decodedSizeChanged(this, deltaBytes);
     if (framesCleared > 0) {
         deltaBytes -= m_decodedPropertiesSize;
         m_decodedPropertiesSize = 0;
@@ -146,8 +164,75 @@ void BitmapImage::cacheFrame(size_t index)
         m_decodedPropertiesSize = 0;
         if (imageObserver())
             imageObserver()->decodedSizeChanged(this, deltaBytes);
+        // This may destroy the frames of other images, but never our own.
+        decodedFrameCache()->decodedSizeChanged(this, frameBytes(frameSize));
+    }
+#if USE(IMAGE_DECODING_SERVICE)
+    if (!index)
+        m_firstFrameDecodePixels = 0;
+#endif
+}
+
+bool BitmapImage::prepareCurrentFrameForPainting(const IntSize& paintedSize)
+{
+#if USE(IMAGE_DECODING_SERVICE)
+    // Only the first frame of complete, single frame images is decoded
+    // elsewhere; animations need their decoder's state from frame to frame.
+    if (m_currentFrame || !m_allDataReceived || m_asynchronousDecodingFailed)
+        return true;
+
+    ImageDecodingService& service = ImageDecodingService::shared();
+    unsigned maxPixels = ImageSource::maxPixelsToDecode(paintedSize);
+    if (!m_frames.isEmpty() && m_frames[0].m_frame) {
+        // Painted larger than it was decoded for: decode it again, and draw
+        // the smaller frame until then.
+        if (m_firstFrameDecodePixels && (!maxPixels || maxPixels > m_firstFrameDecodePixels) && !service.isDecoding(this)) {
+            m_pendingDecodePixels = maxPixels;
+            m_source.decodeFirstFrameAsynchronously(this, data(), paintedSize);
+        }
+        return true;
+    }
+    if (frameCount() != 1)
+        return true;
+    IntSize imageSize = size();
+    if (imageSize.width() * imageSize.height() < minimumPixelsForAsynchronousDecoding)
+        return true;
+
+    if (!service.isDecoding(this)) {
+        m_pendingDecodePixels = maxPixels;
+        m_source.decodeFirstFrameAsynchronously(this, data(), paintedSize);
+    }
+    // The service may not have been able to start its threads.
+    return !service.isDecoding(this);
+#else
+    UNUSED_PARAM(paintedSize);
+    return true;
+#endif
+}
+
+#if USE(IMAGE_DECODING_SERVICE)
+void BitmapImage::didDecodeFrame(const ImageFrame* frame)
+{
+    bool haveFrame = !m_frames.isEmpty() && m_frames[0].m_frame;
+    if (!frame) {
+        if (!haveFrame)
+            m_asynchronousDecodingFailed = true;
+    } else if (!haveFrame || (m_firstFrameDecodePixels && (!m_pendingDecodePixels || m_pendingDecodePixels > m_firstFrameDecodePixels))) {
+        // Someone who could not wait (a canvas, say) may have decoded the
+        // frame on the main thread in the meantime, at full size.
+        if (haveFrame) {
+            m_frames[0].clear(false);
+            destroyMetadataAndNotify(1);
+        }
+        m_source.setFirstFrameBuffer(*frame);
+        cacheFrame(0);
+        m_firstFrameDecodePixels = m_pendingDecodePixels;
     }
+
+    if (imageObserver())
+        imageObserver()->changedInRect(this, rect());
 }
+#endif
 
 void BitmapImage::didDecodeProperties() const
 {
@@ -195,6 +280,11 @@ bool BitmapImage::getHotSpot(IntPoint& hotSpot) const
 
 bool BitmapImage::dataChanged(bool allDataReceived)
 {
+#if USE(IMAGE_DECODING_SERVICE)
+    ImageDecodingService::shared().cancel(this);
+    m_asynchronousDecodingFailed = false;
+#endif
+
     // Because we're modifying the current frame, clear its (now possibly
     // inaccurate) metadata as well.
     destroyMetadataAndNotify((!m_frames.isEmpty() && m_frames[m_frames.size() - 1].clear(true)) ? 1 : 0);
@@ -247,6 +337,8 @@ NativeImagePtr BitmapImage::frameAtIndex(size_t index)
     if (index >= m_frames.size() || !m_frames[index].m_frame)
         cacheFrame(index);
 
+    if (m_frames[index].m_frame)
+        decodedFrameCache()->didUseImage(this);
     return m_frames[index].m_frame;
 }
 
@@ -32,6 +32,10 @@
 #include "Color.h"
 #include "IntSize.h"
 
+#if USE(IMAGE_DECODING_SERVICE)
+#include "ImageDecodingService.h"
+#endif
+
 #if PLATFORM(MAC)
 #include <wtf/RetainPtr.h>
 #ifdef __OBJC__
@@ -100,7 +104,12 @@ public:
 // BitmapImage Class
 // =================================================
 
-class BitmapImage : public Image {
+class BitmapImage : public Image
+#if USE(IMAGE_DECODING_SERVICE)
+                  , private ImageDecodingClient
+#endif
+{
+    friend class DecodedFrameCache;
     friend class GeneratedImage;
     friend class GraphicsContext;
 public:
@@ -133,6 +142,8 @@ public:
     
     virtual unsigned decodedSize() const { return m_decodedSize; }
 
+    virtual bool prepareCurrentFrameForPainting(const IntSize& paintedSize);
+
 #if PLATFORM(MAC)
     // Accessors for native image formats.
     virtual NSImage* getNSImage();
@@ -203,6 +214,11 @@ protected:
     // Decodes and caches a frame. Never accessed except internally.
     void cacheFrame(size_t index);
 
+#if USE(IMAGE_DECODING_SERVICE)
+    // ImageDecodingClient
+    virtual void didDecodeFrame(const ImageFrame*);
+#endif
+
     // Called to invalidate cached data.  When |destroyAll| is true, we wipe out
     // the entire frame buffer cache and tell the image source to destroy
     // everything; this is used when e.g. we want to free some room in the image
@@ -299,6 +315,14 @@ protected:
 
     mutable bool m_haveFrameCount;
     size_t m_frameCount;
+
+#if USE(IMAGE_DECODING_SERVICE)
+    bool m_asynchronousDecodingFailed; // Whether the ImageDecodingService could not decode the first frame.
+    // Pixel budgets (see ImageSource::maxPixelsToDecode()) of the decode in
+    // flight and of the first frame in m_frames; 0 means full size.
+    unsigned m_pendingDecodePixels;
+    unsigned m_firstFrameDecodePixels;
+#endif
 };
 
 }
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2011 Google, Inc. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "DecodedFrameCache.h"
+
+#include "BitmapImage.h"
+#include <algorithm>
+#include <wtf/Vector.h>
+
+namespace WebCore {
+
+static const unsigned defaultCapacity = 32 * 1024 * 1024;
+
+DecodedFrameCache* decodedFrameCache()
+{
+    static DecodedFrameCache* staticCache = new DecodedFrameCache;
+    return staticCache;
+}
+
+DecodedFrameCache::DecodedFrameCache()
+    : m_capacity(defaultCapacity)
+    , m_size(0)
+    , m_pruning(false)
+{
+}
+
+void DecodedFrameCache::setCapacity(unsigned bytes)
+{
+    m_capacity = bytes;
+    prune(0);
+}
+
+void DecodedFrameCache::decodedSizeChanged(BitmapImage* image, int delta)
+{
+    if (delta > 0) {
+        // Newly decoded frames count as a use.
+        m_size += delta;
+        m_images.remove(image);
+        m_images.add(image);
+        prune(image);
+        return;
+    }
+
+    // Images created from a native image start out with frames we were never
+    // told about; only count what we saw being added.
+    if (!delta || !m_images.contains(image))
+        return;
+    m_size -= std::min(m_size, static_cast<unsigned>(-delta));
+    if (!image->decodedSize())
+        m_images.remove(image);
+}
+
+void DecodedFrameCache::didUseImage(BitmapImage* image)
+{
+    if (m_images.isEmpty() || m_images.last() == image || !m_images.contains(image))
+        return;
+    m_images.remove(image);
+    m_images.add(image);
+}
+
+void DecodedFrameCache::removeImage(BitmapImage* image)
+{
+    if (!m_images.contains(image))
+        return;
+    m_images.remove(image);
+    m_size -= std::min(m_size, image->decodedSize());
+}
+
+void DecodedFrameCache::prune(BitmapImage* imageInUse)
+{
+    if (!m_capacity || m_size <= m_capacity || m_pruning)
+        return;
+    m_pruning = true;
+
+    // Destroying an image's frames calls back into decodedSizeChanged(), and
+    // through the image's observer may destroy other images, so walk a copy
+    // of the list and skip anything that has left it in the meantime.
+    Vector<BitmapImage*> images;
+    images.reserveInitialCapacity(m_images.size());
+    ListHashSet<BitmapImage*>::iterator end = m_images.end();
+    for (ListHashSet<BitmapImage*>::iterator it = m_images.begin(); it != end; ++it)
+        images.uncheckedAppend(*it);
+    for (size_t i = 0; i < images.size() && m_size > m_capacity; ++i) {
+        BitmapImage* image = images[i];
+        if (image == imageInUse || !m_images.contains(image))
+            continue;
+        image->destroyDecodedData(true);
+    }
+
+    m_pruning = false;
+}
+
+} // namespace WebCore
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2011 Google, Inc. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DecodedFrameCache_h
+#define DecodedFrameCache_h
+
+#include <wtf/ListHashSet.h>
+#include <wtf/Noncopyable.h>
+
+namespace WebCore {
+
+class BitmapImage;
+
+// Keeps the decoded frames of all BitmapImages, across every document, under
+// one byte budget. Images are kept in least recently drawn order, and as soon
+// as the total goes over the budget the least recently drawn ones are told to
+// throw their frames away.
+//
+// The MemoryCache also prunes decoded data, but only for images that belong
+// to a CachedImage and only when it gets around to pruning; this cache is
+// what bounds the memory decoded frames can take at any moment.
+class DecodedFrameCache {
+    WTF_MAKE_NONCOPYABLE(DecodedFrameCache); WTF_MAKE_FAST_ALLOCATED;
+public:
+    friend DecodedFrameCache* decodedFrameCache();
+
+    // 0 means no limit.
+    void setCapacity(unsigned bytes);
+    unsigned capacity() const { return m_capacity; }
+    unsigned size() const { return m_size; }
+
+    // Called by BitmapImage when it decodes or destroys frames.
+    void decodedSizeChanged(BitmapImage*, int delta);
+    // Called by BitmapImage when one of its frames is about to be drawn.
+    void didUseImage(BitmapImage*);
+    void removeImage(BitmapImage*);
+
+private:
+    DecodedFrameCache();
+
+    // Evicts least recently used images other than |imageInUse| until the
+    // cache is within its budget.
+    void prune(BitmapImage* imageInUse);
+
+    ListHashSet<BitmapImage*> m_images;
+    unsigned m_capacity;
+    unsigned m_size;
+    bool m_pruning;
+};
+
+DecodedFrameCache* decodedFrameCache();
+
+} // namespace WebCore
+
+#endif // DecodedFrameCache_h
@@ -31,6 +31,7 @@
 #include "GlyphBuffer.h"
 #include "TextRun.h"
 #include "WidthIterator.h"
+#include "WordWidthCache.h"
 #include <wtf/MathExtras.h>
 #include <wtf/UnusedParam.h>
 
@@ -177,12 +178,35 @@ float Font::width(const TextRun& run, HashSet<const SimpleFontData*>* fallbackFo
         // If the complex text implementation cannot return fallback fonts, avoid
         // returning them for simple text as well.
         static bool returnFallbackFonts = canReturnFallbackFontsForComplexText();
+        if (!glyphOverflow && codePathToUse == Simple && !isSmallCaps() && m_fontDescription.orientation() == Horizontal && WordWidthCache::canCache(run))
+            return floatWidthForSimpleTextUsingWordWidthCache(run, returnFallbackFonts ? fallbackFonts : 0);
         return floatWidthForSimpleText(run, 0, returnFallbackFonts ? fallbackFonts : 0, codePathToUse == SimpleWithGlyphOverflow || (glyphOverflow && glyphOverflow->computeBounds) ? glyphOverflow : 0);
     }
 
     return floatWidthForComplexText(run, fallbackFonts, glyphOverflow);
 }
 
+float Font::floatWidthForSimpleTextUsingWordWidthCache(const TextRun& run, HashSet<const SimpleFontData*>* fallbackFonts) const
+{
+    WordWidthCache* cache = primaryFont()->wordWidthCache();
+    float width;
+    if (cache->lookup(run, letterSpacing(), wordSpacing(), width))
+        return width;
+
+    // A width that needed other fonts would change with the rest of the
+    // fallback list, which the cache of the primary font knows nothing about.
+    HashSet<const SimpleFontData*> usedFallbackFonts;
+    width = floatWidthForSimpleText(run, 0, &usedFallbackFonts);
+    if (usedFallbackFonts.isEmpty())
+        cache->add(run, letterSpacing(), wordSpacing(), width);
+    else if (fallbackFonts) {
+        HashSet<const SimpleFontData*>::const_iterator end = usedFallbackFonts.end();
+        for (HashSet<const SimpleFontData*>::const_iterator it = usedFallbackFonts.begin(); it != end; ++it)
+            fallbackFonts->add(*it);
+    }
+    return width;
+}
+
 float Font::width(const TextRun& run, int extraCharsAvailable, int& charsConsumed, String& glyphName) const
 {
 #if !ENABLE(SVG_FONTS)
@@ -115,6 +115,13 @@ public:
     virtual void destroyDecodedData(bool destroyAll = true) = 0;
     virtual unsigned decodedSize() const = 0;
 
+    // Returns false if the current frame is not decoded yet and is being
+    // decoded on another thread instead of by the next draw() call. The
+    // observer's changedInRect() is called once the frame can be drawn.
+    // |paintedSize| is the size the frame will cover in device pixels; ports
+    // that can draw down-sampled frames decode no more pixels than that.
+    virtual bool prepareCurrentFrameForPainting(const IntSize&) { return true; }
+
     SharedBuffer* data() { return m_data.get(); }
 
     // Animation begins whenever someone draws the image, so startAnimation() is not normally called.
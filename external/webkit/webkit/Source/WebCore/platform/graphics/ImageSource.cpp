@@ -35,6 +35,11 @@
 #include "ImageDecoder.h"
 #endif
 
+#if USE(IMAGE_DECODING_SERVICE)
+#include "ImageDecodingService.h"
+#include <wtf/UnusedParam.h>
+#endif
+
 namespace WebCore {
 
 #if ENABLE(IMAGE_DECODER_DOWN_SAMPLING)
@@ -189,4 +194,33 @@ bool ImageSource::frameIsCompleteAtIndex(size_t index)
     return buffer && buffer->status() == ImageFrame::FrameComplete;
 }
 
+#if USE(IMAGE_DECODING_SERVICE)
+void ImageSource::decodeFirstFrameAsynchronously(ImageDecodingClient* client, SharedBuffer* data, const IntSize& paintedSize)
+{
+    ImageDecodingService::shared().decode(client, data, m_alphaOption, m_gammaAndColorProfileOption, maxPixelsToDecode(paintedSize));
+}
+
+unsigned ImageSource::maxPixelsToDecode(const IntSize& paintedSize)
+{
+#if ENABLE(IMAGE_DECODER_DOWN_SAMPLING)
+    // Decoders only ever scale down, so a larger budget than the image
+    // itself does no harm.
+    unsigned paintedPixels = std::max(paintedSize.width(), 1) * std::max(paintedSize.height(), 1);
+    if (s_maxPixelsPerDecodedImage && s_maxPixelsPerDecodedImage < paintedPixels)
+        return s_maxPixelsPerDecodedImage;
+    return paintedPixels;
+#else
+    // Other ports draw frames as if they had the image's size.
+    UNUSED_PARAM(paintedSize);
+    return 0;
+#endif
+}
+
+void ImageSource::setFirstFrameBuffer(const ImageFrame& frame)
+{
+    if (m_decoder)
+        m_decoder->setFrameBufferAtIndex(0, frame);
+}
+#endif
+
 }
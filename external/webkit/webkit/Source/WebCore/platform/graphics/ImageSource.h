@@ -118,6 +118,16 @@ typedef RefPtr<SharedBitmap> NativeImagePtr;
 #endif
 #endif
 
+// Ports whose ImageSource drives one of our ImageDecoders can decode frames on
+// the ImageDecodingService's threads. Android does not need to: it paints
+// into recorded pictures, and its SkImageRefs decode their pixels lazily when
+// the texture generator threads play those back.
+#if (USE(CG) && USE(WEBKIT_IMAGE_DECODERS)) || PLATFORM(OPENVG) || (!USE(CG) && !PLATFORM(QT) && !PLATFORM(ANDROID))
+#define WTF_USE_IMAGE_DECODING_SERVICE 1
+class ImageDecodingClient;
+class ImageFrame;
+#endif
+
 // Right now GIFs are the only recognized image format that supports animation.
 // The animation system and the constants below are designed with this in mind.
 // GIFs have an optional 16-bit unsigned loop count that describes how an
@@ -207,6 +217,20 @@ public:
     static void setMaxPixelsPerDecodedImage(unsigned maxPixels) { s_maxPixelsPerDecodedImage = maxPixels; }
 #endif
 
+#if USE(IMAGE_DECODING_SERVICE)
+    // Starts decoding the first frame of |data| on one of the
+    // ImageDecodingService's threads. The client gets the frame back on the
+    // main thread and should hand it to setFirstFrameBuffer(), after which
+    // createFrameAtIndex(0) no longer needs to decode anything. The frame is
+    // down-sampled to at most maxPixelsToDecode(paintedSize) pixels.
+    void decodeFirstFrameAsynchronously(ImageDecodingClient*, SharedBuffer* data, const IntSize& paintedSize);
+    void setFirstFrameBuffer(const ImageFrame&);
+
+    // 0 if the frame is decoded at full size, which is always the case
+    // unless the port draws down-sampled frames.
+    static unsigned maxPixelsToDecode(const IntSize& paintedSize);
+#endif
+
 #if PLATFORM(ANDROID)
     void clearURL();
     void setURL(const String& url);
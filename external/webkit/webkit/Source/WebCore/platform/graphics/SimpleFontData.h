@@ -32,6 +32,7 @@
 #include "GlyphMetricsMap.h"
 #include "GlyphPageTreeNode.h"
 #include "TypesettingFeatures.h"
+#include "WordWidthCache.h"
 #include <wtf/OwnPtr.h>
 #include <wtf/PassOwnPtr.h>
 
@@ -113,6 +114,8 @@ public:
     FloatRect platformBoundsForGlyph(Glyph) const;
     float platformWidthForGlyph(Glyph) const;
 
+    WordWidthCache* wordWidthCache() const;
+
     float spaceWidth() const { return m_spaceWidth; }
 
 #if USE(CG) || USE(CAIRO) || PLATFORM(WX) || USE(SKIA_ON_MAC_CHROME)
@@ -211,6 +214,7 @@ private:
 
     mutable OwnPtr<GlyphMetricsMap<FloatRect> > m_glyphToBoundsMap;
     mutable GlyphMetricsMap<float> m_glyphToWidthMap;
+    mutable OwnPtr<WordWidthCache> m_wordWidthCache;
 
     bool m_treatAsFixedPitch;
 
@@ -287,6 +291,13 @@ private:
 };
     
     
+inline WordWidthCache* SimpleFontData::wordWidthCache() const
+{
+    if (!m_wordWidthCache)
+        m_wordWidthCache = WordWidthCache::create();
+    return m_wordWidthCache.get();
+}
+
 #if !PLATFORM(QT)
 ALWAYS_INLINE FloatRect SimpleFontData::boundsForGlyph(Glyph glyph) const
 {
@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2011 Google, Inc. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "WordWidthCache.h"
+
+#include "TextRun.h"
+#include <wtf/StdLibExtras.h>
+#include <wtf/StringHasher.h>
+
+namespace WebCore {
+
+// Longer runs are rarely measured twice, and hashing them costs about as much
+// as measuring them.
+static const int maximumCachedRunLength = 32;
+
+// Per generation, so a cache holds at most twice this many entries.
+static const unsigned maximumGenerationSize = 2048;
+
+enum {
+    RTLFlag = 1 << 0,
+    SpacingDisabledFlag = 1 << 1
+};
+
+WordWidthCache::Statistics WordWidthCache::s_statistics;
+
+static inline unsigned floatHashBits(float value)
+{
+    // Makes 0 and -0 hash alike, since they compare equal.
+    return value ? bitwise_cast<unsigned>(value) : 0;
+}
+
+static inline unsigned flagsForRun(const TextRun& run)
+{
+    return (run.rtl() ? RTLFlag : 0) | (run.spacingDisabled() ? SpacingDisabledFlag : 0);
+}
+
+static inline unsigned computeHash(unsigned textHash, float letterSpacing, float wordSpacing, unsigned flags)
+{
+    unsigned hashCodes[4] = { textHash, floatHashBits(letterSpacing), floatHashBits(wordSpacing), flags };
+    return StringHasher::hashMemory<sizeof(hashCodes)>(hashCodes);
+}
+
+unsigned WordWidthCache::KeyHash::hash(const Key& key)
+{
+    return computeHash(key.text.impl()->hash(), key.letterSpacing, key.wordSpacing, key.flags);
+}
+
+// Lets lookups hash and compare the characters of a run in place, so that a
+// String is only created when a width is added.
+struct WordWidthCache::LookupKey {
+    LookupKey(const TextRun& run, float letterSpacing, float wordSpacing)
+        : characters(run.characters())
+        , length(run.length())
+        , letterSpacing(letterSpacing)
+        , wordSpacing(wordSpacing)
+        , flags(flagsForRun(run))
+    {
+    }
+
+    const UChar* characters;
+    unsigned length;
+    float letterSpacing;
+    float wordSpacing;
+    unsigned flags;
+};
+
+struct WordWidthCache::LookupKeyTranslator {
+    static unsigned hash(const LookupKey& key)
+    {
+        return computeHash(StringHasher::computeHash(key.characters, key.length), key.letterSpacing, key.wordSpacing, key.flags);
+    }
+
+    static bool equal(const Key& a, const LookupKey& b)
+    {
+        return a.letterSpacing == b.letterSpacing && a.wordSpacing == b.wordSpacing && a.flags == b.flags
+            && a.text.length() == b.length && !memcmp(a.text.characters(), b.characters, b.length * sizeof(UChar));
+    }
+
+    static void translate(Key& location, const LookupKey& key, unsigned)
+    {
+        location.text = String(key.characters, key.length);
+        location.letterSpacing = key.letterSpacing;
+        location.wordSpacing = key.wordSpacing;
+        location.flags = key.flags;
+    }
+};
+
+bool WordWidthCache::canCache(const TextRun& run)
+{
+    // Tabs and justification make the width depend on where the run is
+    // placed, and stretched glyphs on the box it is fitted into.
+    return run.length() && run.length() <= maximumCachedRunLength
+        && !run.allowTabs() && !run.expansion() && run.horizontalGlyphStretch() == 1;
+}
+
+bool WordWidthCache::lookup(const TextRun& run, float letterSpacing, float wordSpacing, float& width)
+{
+    ASSERT(canCache(run));
+    ++s_statistics.lookups;
+
+    LookupKey key(run, letterSpacing, wordSpacing);
+    WidthMap::iterator it = m_currentGeneration.find<LookupKey, LookupKeyTranslator>(key);
+    if (it != m_currentGeneration.end()) {
+        width = it->second;
+        ++s_statistics.hits;
+        return true;
+    }
+
+    it = m_oldGeneration.find<LookupKey, LookupKeyTranslator>(key);
+    if (it == m_oldGeneration.end())
+        return false;
+
+    width = it->second;
+    ++s_statistics.hits;
+
+    // Words that are still in use survive the next time the current
+    // generation is retired.
+    Key promotedKey = it->first;
+    m_oldGeneration.remove(it);
+    retireCurrentGenerationIfFull();
+    m_currentGeneration.set(promotedKey, width);
+    return true;
+}
+
+void WordWidthCache::retireCurrentGenerationIfFull()
+{
+    if (m_currentGeneration.size() < maximumGenerationSize)
+        return;
+    m_oldGeneration.swap(m_currentGeneration);
+    m_currentGeneration.clear();
+}
+
+void WordWidthCache::add(const TextRun& run, float letterSpacing, float wordSpacing, float width)
+{
+    ASSERT(canCache(run));
+
+    retireCurrentGenerationIfFull();
+    m_currentGeneration.add<LookupKey, LookupKeyTranslator>(LookupKey(run, letterSpacing, wordSpacing), width);
+}
+
+} // namespace WebCore
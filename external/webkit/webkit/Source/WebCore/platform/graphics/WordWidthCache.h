@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2011 Google, Inc. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WordWidthCache_h
+#define WordWidthCache_h
+
+#include "PlatformString.h"
+#include <wtf/HashMap.h>
+#include <wtf/HashTraits.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/PassOwnPtr.h>
+
+namespace WebCore {
+
+class TextRun;
+
+// Remembers the widths of short runs of text, which in practice are words,
+// measured on the simple text path with a given primary font. Line layout
+// measures the same words again on every pass, and most of them in the same
+// few fonts.
+//
+// A width is only stored if measuring it used nothing but the primary font,
+// so it does not depend on the rest of the font's fallback list. What else
+// it depends on, the spacing and direction, is part of the key.
+//
+// Memory is bounded by keeping two generations of entries: when the current
+// one fills up, it becomes the old one and the previous old one is dropped.
+// Hits in the old generation move back into the current one.
+class WordWidthCache {
+    WTF_MAKE_NONCOPYABLE(WordWidthCache); WTF_MAKE_FAST_ALLOCATED;
+public:
+    struct Statistics {
+        unsigned long long lookups;
+        unsigned long long hits;
+        Statistics() : lookups(0), hits(0) { }
+    };
+
+    static PassOwnPtr<WordWidthCache> create() { return adoptPtr(new WordWidthCache); }
+
+    // Whether the width of |run| depends on nothing but its text, spacing and
+    // direction, and the run is short enough to be worth caching.
+    static bool canCache(const TextRun&);
+
+    bool lookup(const TextRun&, float letterSpacing, float wordSpacing, float& width);
+    void add(const TextRun&, float letterSpacing, float wordSpacing, float width);
+
+    // Counted over all fonts since the process started.
+    static const Statistics& statistics() { return s_statistics; }
+    static void resetStatistics() { s_statistics = Statistics(); }
+
+private:
+    struct Key {
+        Key() : letterSpacing(0), wordSpacing(0), flags(0) { }
+        Key(WTF::HashTableDeletedValueType) : text(WTF::HashTableDeletedValue), letterSpacing(0), wordSpacing(0), flags(0) { }
+        bool isHashTableDeletedValue() const { return text.isHashTableDeletedValue(); }
+
+        bool operator==(const Key& other) const
+        {
+            return letterSpacing == other.letterSpacing && wordSpacing == other.wordSpacing && flags == other.flags && text == other.text;
+        }
+
+        String text;
+        float letterSpacing;
+        float wordSpacing;
+        unsigned flags;
+    };
+
+    struct KeyHash {
+        static unsigned hash(const Key&);
+        static bool equal(const Key& a, const Key& b) { return a == b; }
+        static const bool safeToCompareToEmptyOrDeleted = false;
+    };
+    struct KeyTraits : WTF::SimpleClassHashTraits<Key> { };
+    struct LookupKey;
+    struct LookupKeyTranslator;
+    typedef HashMap<Key, float, KeyHash, KeyTraits> WidthMap;
+
+    WordWidthCache() { }
+
+    void retireCurrentGenerationIfFull();
+
+    WidthMap m_currentGeneration;
+    WidthMap m_oldGeneration;
+
+    static Statistics s_statistics;
+};
+
+} // namespace WebCore
+
+#endif // WordWidthCache_h
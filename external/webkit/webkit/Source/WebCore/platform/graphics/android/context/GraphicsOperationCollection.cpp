@@ -15,6 +15,7 @@ namespace WebCore {
 
 GraphicsOperationCollection::GraphicsOperationCollection(const IntRect& drawArea)
     : m_drawArea(drawArea)
+    , m_isIncomplete(false)
 {
 }
 
@@ -34,9 +35,25 @@ void GraphicsOperationCollection::apply(PlatformGraphicsContext* context)
     }
 }
 
+void GraphicsOperationCollection::apply(PlatformGraphicsContext* context, const IntRect& dirty)
+{
+    for (unsigned int i = 0; i < m_operations.size(); i++) {
+        if (!m_bounds[i].isEmpty() && !m_bounds[i].intersects(dirty))
+            continue;
+        m_operations[i]->apply(context);
+    }
+}
+
 void GraphicsOperationCollection::append(GraphicsOperation::Operation* operation)
 {
     m_operations.append(operation);
+    m_bounds.append(IntRect());
+}
+
+void GraphicsOperationCollection::appendDrawing(GraphicsOperation::Operation* operation, const IntRect& bounds)
+{
+    m_operations.append(operation);
+    m_bounds.append(bounds);
 }
 
 bool GraphicsOperationCollection::isEmpty()
@@ -43,13 +43,30 @@ public:
     ~GraphicsOperationCollection();
 
     void apply(PlatformGraphicsContext* context);
+    // Only replays the drawing operations whose bounds intersect |dirty|,
+    // along with every state, matrix and clip operation. |dirty| is in the
+    // coordinates the collection was recorded in.
+    void apply(PlatformGraphicsContext* context, const IntRect& dirty);
+
     void append(GraphicsOperation::Operation* operation);
+    // |bounds| is where the operation draws, in the coordinates the
+    // collection is recorded in. An empty rect means unknown bounds, in
+    // which case the operation is always replayed.
+    void appendDrawing(GraphicsOperation::Operation* operation, const IntRect& bounds);
 
     bool isEmpty();
+    // Set when something was drawn that the recording could not capture, in
+    // which case replaying it would not reproduce the original drawing.
+    bool isIncomplete() const { return m_isIncomplete; }
+    void setIncomplete() { m_isIncomplete = true; }
 
 private:
     IntRect m_drawArea;
     Vector<GraphicsOperation::Operation*> m_operations;
+    // Parallel to m_operations; empty for the operations that are always
+    // replayed.
+    Vector<IntRect> m_bounds;
+    bool m_isIncomplete;
 };
 
 class AutoGraphicsOperationCollection {
@@ -139,7 +139,8 @@ public:
     virtual void strokeRect(const FloatRect& rect, float lineWidth) = 0;
 
     virtual SkCanvas* recordingCanvas() = 0;
-    virtual void endRecording(int type = 0) = 0;
+    // |bounds|, if known, is where the recorded drawing went in user space.
+    virtual void endRecording(const SkRect* bounds = 0) = 0;
 
 protected:
 
@@ -21,6 +21,7 @@ PlatformGraphicsContextRecording::PlatformGraphicsContextRecording(GraphicsOpera
     , mGraphicsOperationCollection(picture)
     , mPicture(0)
 {
+    mCurrentMatrix.reset();
 }
 
 bool PlatformGraphicsContextRecording::isPaintingDisabled()
@@ -28,6 +29,34 @@ bool PlatformGraphicsContextRecording::isPaintingDisabled()
     return !mGraphicsOperationCollection;
 }
 
+SkCanvas* PlatformGraphicsContextRecording::getCanvas()
+{
+    setIncomplete();
+    return 0;
+}
+
+void PlatformGraphicsContextRecording::setIncomplete()
+{
+    if (mGraphicsOperationCollection)
+        mGraphicsOperationCollection->setIncomplete();
+}
+
+void PlatformGraphicsContextRecording::appendDrawingOperation(GraphicsOperation::Operation* operation,
+                                                              const FloatRect& bounds, bool stroked)
+{
+    // Antialiasing and strokes spill out of the geometry, and shadows may be
+    // drawn well away from it.
+    SkRect deviceBounds = bounds;
+    SkScalar outset = SK_Scalar1;
+    if (stroked)
+        outset += SkFloatToScalar(m_state->strokeThickness * std::max(m_state->miterLimit, 1.0f));
+    if (SkColorGetA(m_state->shadow.color))
+        outset += m_state->shadow.blur + std::max(SkScalarAbs(m_state->shadow.dx), SkScalarAbs(m_state->shadow.dy));
+    deviceBounds.outset(outset, outset);
+    mCurrentMatrix.mapRect(&deviceBounds);
+    mGraphicsOperationCollection->appendDrawing(operation, enclosingIntRect(deviceBounds));
+}
+
 SkCanvas* PlatformGraphicsContextRecording::recordingCanvas()
 {
     SkSafeUnref(mPicture);
@@ -35,13 +64,16 @@ SkCanvas* PlatformGraphicsContextRecording::recordingCanvas()
     return mPicture->beginRecording(0, 0, 0);
 }
 
-void PlatformGraphicsContextRecording::endRecording(int type)
+void PlatformGraphicsContextRecording::endRecording(const SkRect* bounds)
 {
     if (!mPicture)
         return;
     mPicture->endRecording();
     GraphicsOperation::DrawComplexText* text = new GraphicsOperation::DrawComplexText(mPicture);
-    mGraphicsOperationCollection->append(text);
+    if (bounds)
+        appendDrawingOperation(text, *bounds);
+    else
+        mGraphicsOperationCollection->append(text);
     mPicture = 0;
 }
 
@@ -52,23 +84,30 @@ void PlatformGraphicsContextRecording::endRecording(int type)
 
 void PlatformGraphicsContextRecording::beginTransparencyLayer(float opacity)
 {
+    // Transparency layers save and restore the matrix like save() and restore().
+    mMatrixStack.append(mCurrentMatrix);
     mGraphicsOperationCollection->append(new GraphicsOperation::BeginTransparencyLayer(opacity));
 }
 
 void PlatformGraphicsContextRecording::endTransparencyLayer()
 {
+    mCurrentMatrix = mMatrixStack.last();
+    mMatrixStack.removeLast();
     mGraphicsOperationCollection->append(new GraphicsOperation::EndTransparencyLayer());
 }
 
 void PlatformGraphicsContextRecording::save()
 {
     PlatformGraphicsContext::save();
+    mMatrixStack.append(mCurrentMatrix);
     mGraphicsOperationCollection->append(new GraphicsOperation::Save());
 }
 
 void PlatformGraphicsContextRecording::restore()
 {
     PlatformGraphicsContext::restore();
+    mCurrentMatrix = mMatrixStack.last();
+    mMatrixStack.removeLast();
     mGraphicsOperationCollection->append(new GraphicsOperation::Restore());
 }
 
@@ -224,6 +263,7 @@ void PlatformGraphicsContextRecording::clipConvexPolygon(size_t numPoints,
                                                 const FloatPoint*, bool antialias)
 {
     // TODO
+    setIncomplete();
 }
 
 void PlatformGraphicsContextRecording::clipOut(const IntRect& r)
@@ -245,7 +285,7 @@ void PlatformGraphicsContextRecording::clipPath(const Path& pathToClip, WindRule
 
 void PlatformGraphicsContextRecording::clearRect(const FloatRect& rect)
 {
-    mGraphicsOperationCollection->append(new GraphicsOperation::ClearRect(rect));
+    appendDrawingOperation(new GraphicsOperation::ClearRect(rect), rect);
 }
 
 //**************************************
@@ -256,14 +296,14 @@ void PlatformGraphicsContextRecording::drawBitmapPattern(
         const SkBitmap& bitmap, const SkMatrix& matrix,
         CompositeOperator compositeOp, const FloatRect& destRect)
 {
-    mGraphicsOperationCollection->append(new GraphicsOperation::DrawBitmapPattern(bitmap, matrix, compositeOp, destRect));
+    appendDrawingOperation(new GraphicsOperation::DrawBitmapPattern(bitmap, matrix, compositeOp, destRect), destRect);
 }
 
 void PlatformGraphicsContextRecording::drawBitmapRect(const SkBitmap& bitmap,
                                    const SkIRect* src, const SkRect& dst,
                                    CompositeOperator op)
 {
-    mGraphicsOperationCollection->append(new GraphicsOperation::DrawBitmapRect(bitmap, *src, dst, op));
+    appendDrawingOperation(new GraphicsOperation::DrawBitmapRect(bitmap, *src, dst, op), dst);
 }
 
 void PlatformGraphicsContextRecording::drawConvexPolygon(size_t numPoints,
@@ -271,11 +311,12 @@ void PlatformGraphicsContextRecording::drawConvexPolygon(size_t numPoints,
                                                 bool shouldAntialias)
 {
     // TODO
+    setIncomplete();
 }
 
 void PlatformGraphicsContextRecording::drawEllipse(const IntRect& rect)
 {
-    mGraphicsOperationCollection->append(new GraphicsOperation::DrawEllipse(rect));
+    appendDrawingOperation(new GraphicsOperation::DrawEllipse(rect), rect, true);
 }
 
 void PlatformGraphicsContextRecording::drawFocusRing(const Vector<IntRect>& rects,
@@ -283,6 +324,7 @@ void PlatformGraphicsContextRecording::drawFocusRing(const Vector<IntRect>& rect
                                             const Color& color)
 {
     // TODO
+    setIncomplete();
 }
 
 void PlatformGraphicsContextRecording::drawHighlightForText(
@@ -307,33 +349,37 @@ void PlatformGraphicsContextRecording::drawHighlightForText(
 void PlatformGraphicsContextRecording::drawLine(const IntPoint& point1,
                              const IntPoint& point2)
 {
-    mGraphicsOperationCollection->append(new GraphicsOperation::DrawLine(point1, point2));
+    FloatRect bounds(std::min(point1.x(), point2.x()), std::min(point1.y(), point2.y()),
+                     abs(point2.x() - point1.x()), abs(point2.y() - point1.y()));
+    appendDrawingOperation(new GraphicsOperation::DrawLine(point1, point2), bounds, true);
 }
 
 void PlatformGraphicsContextRecording::drawLineForText(const FloatPoint& pt, float width)
 {
-    mGraphicsOperationCollection->append(new GraphicsOperation::DrawLineForText(pt, width));
+    appendDrawingOperation(new GraphicsOperation::DrawLineForText(pt, width),
+                           FloatRect(pt.x(), pt.y(), width, 0), true);
 }
 
 void PlatformGraphicsContextRecording::drawLineForTextChecking(const FloatPoint& pt,
         float width, GraphicsContext::TextCheckingLineStyle lineStyle)
 {
-    mGraphicsOperationCollection->append(new GraphicsOperation::DrawLineForTextChecking(pt, width, lineStyle));
+    appendDrawingOperation(new GraphicsOperation::DrawLineForTextChecking(pt, width, lineStyle),
+                           FloatRect(pt.x(), pt.y(), width, 0), true);
 }
 
 void PlatformGraphicsContextRecording::drawRect(const IntRect& rect)
 {
-    mGraphicsOperationCollection->append(new GraphicsOperation::DrawRect(rect));
+    appendDrawingOperation(new GraphicsOperation::DrawRect(rect), rect, true);
 }
 
 void PlatformGraphicsContextRecording::fillPath(const Path& pathToFill, WindRule fillRule)
 {
-    mGraphicsOperationCollection->append(new GraphicsOperation::FillPath(pathToFill, fillRule));
+    appendDrawingOperation(new GraphicsOperation::FillPath(pathToFill, fillRule), pathToFill.boundingRect());
 }
 
 void PlatformGraphicsContextRecording::fillRect(const FloatRect& rect)
 {
-    mGraphicsOperationCollection->append(new GraphicsOperation::FillRect(rect));
+    appendDrawingOperation(new GraphicsOperation::FillRect(rect), rect);
 }
 
 void PlatformGraphicsContextRecording::fillRect(const FloatRect& rect,
@@ -341,7 +387,7 @@ void PlatformGraphicsContextRecording::fillRect(const FloatRect& rect,
 {
     GraphicsOperation::FillRect* operation = new GraphicsOperation::FillRect(rect);
     operation->setColor(color);
-    mGraphicsOperationCollection->append(operation);
+    appendDrawingOperation(operation, rect);
 }
 
 void PlatformGraphicsContextRecording::fillRoundedRect(
@@ -349,24 +395,26 @@ void PlatformGraphicsContextRecording::fillRoundedRect(
         const IntSize& bottomLeft, const IntSize& bottomRight,
         const Color& color)
 {
-    mGraphicsOperationCollection->append(new GraphicsOperation::FillRoundedRect(rect, topLeft,
-                 topRight, bottomLeft, bottomRight, color));
+    appendDrawingOperation(new GraphicsOperation::FillRoundedRect(rect, topLeft,
+                 topRight, bottomLeft, bottomRight, color), rect);
 }
 
 void PlatformGraphicsContextRecording::strokeArc(const IntRect& r, int startAngle,
                               int angleSpan)
 {
-    mGraphicsOperationCollection->append(new GraphicsOperation::StrokeArc(r, startAngle, angleSpan));
+    appendDrawingOperation(new GraphicsOperation::StrokeArc(r, startAngle, angleSpan), r, true);
 }
 
 void PlatformGraphicsContextRecording::strokePath(const Path& pathToStroke)
 {
-    mGraphicsOperationCollection->append(new GraphicsOperation::StrokePath(pathToStroke));
+    appendDrawingOperation(new GraphicsOperation::StrokePath(pathToStroke), pathToStroke.boundingRect(), true);
 }
 
 void PlatformGraphicsContextRecording::strokeRect(const FloatRect& rect, float lineWidth)
 {
-    mGraphicsOperationCollection->append(new GraphicsOperation::StrokeRect(rect, lineWidth));
+    FloatRect bounds = rect;
+    bounds.inflate(lineWidth);
+    appendDrawingOperation(new GraphicsOperation::StrokeRect(rect, lineWidth), bounds);
 }
 
 
@@ -31,18 +31,23 @@
 namespace WebCore {
 class GraphicsOperationCollection;
 
+namespace GraphicsOperation {
+class Operation;
+}
+
 class PlatformGraphicsContextRecording : public PlatformGraphicsContext {
 public:
     PlatformGraphicsContextRecording(GraphicsOperationCollection* picture);
     virtual ~PlatformGraphicsContextRecording() {}
     virtual bool isPaintingDisabled();
-    virtual SkCanvas* getCanvas() { return 0; }
+    // Anything that needs the canvas, like plugins, cannot be recorded.
+    virtual SkCanvas* getCanvas();
 
     GraphicsOperationCollection* mGraphicsOperationCollection;
     SkMatrix mCurrentMatrix;
 
     virtual SkCanvas* recordingCanvas();
-    virtual void endRecording(int type = 0);
+    virtual void endRecording(const SkRect* bounds = 0);
 
     virtual ContextType type() { return RecordingContext; }
 
@@ -121,7 +126,13 @@ private:
         return false;
     }
 
+    // Appends an operation that draws within |bounds|, in user space.
+    void appendDrawingOperation(GraphicsOperation::Operation* operation,
+                                const FloatRect& bounds, bool stroked = false);
+    void setIncomplete();
+
     SkPicture* mPicture;
+    WTF::Vector<SkMatrix> mMatrixStack;
 };
 
 }
@@ -39,7 +39,7 @@ public:
 
     virtual ContextType type() { return PaintingContext; }
     virtual SkCanvas* recordingCanvas() { return mCanvas; }
-    virtual void endRecording(int type = 0) {}
+    virtual void endRecording(const SkRect* bounds = 0) {}
 
     // FIXME: This is used by ImageBufferAndroid, which should really be
     //        managing the canvas lifecycle itself
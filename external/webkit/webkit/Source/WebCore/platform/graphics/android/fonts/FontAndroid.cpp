@@ -261,7 +261,25 @@ void Font::drawGlyphs(GraphicsContext* gc, const SimpleFontData* font,
         if (font->platformData().orientation() == Vertical)
             canvas->restore();
     }
-    gc->platformContext()->endRecording();
+
+    if (font->platformData().orientation() == Vertical) {
+        gc->platformContext()->endRecording();
+        return;
+    }
+
+    // Let recording contexts know where the run draws so that it can be
+    // skipped when replaying into an unrelated part of the page. Glyphs may
+    // overhang their advances and the font's ascent, hence the slack.
+    SkRect bounds;
+    bounds.set(SkFloatToScalar(point.x()),
+               SkFloatToScalar(point.y() - font->fontMetrics().floatAscent()),
+               x, y + SkFloatToScalar(font->fontMetrics().floatDescent()));
+    bounds.sort();
+    SkScalar slack = SkFloatToScalar(font->platformData().size()) / 2;
+    if (paint.getStyle() != SkPaint::kFill_Style)
+        slack += paint.getStrokeWidth();
+    bounds.outset(slack, slack);
+    gc->platformContext()->endRecording(&bounds);
 }
 
 void Font::drawEmphasisMarksForComplexText(WebCore::GraphicsContext*, WebCore::TextRun const&, WTF::AtomicString const&, WebCore::FloatPoint const&, int, int) const
@@ -55,20 +55,25 @@ BaseRenderer::RendererType BaseRenderer::g_currentType = BaseRenderer::Raster;
 
 BaseRenderer* BaseRenderer::createRenderer()
 {
-    if (g_currentType == Raster)
+    return createRenderer(g_currentType);
+}
+
+BaseRenderer* BaseRenderer::createRenderer(RendererType type)
+{
+    if (type == Raster)
         return new RasterRenderer();
-    else if (g_currentType == Ganesh)
+    else if (type == Ganesh)
         return new GaneshRenderer();
     return NULL;
 }
 
-void BaseRenderer::swapRendererIfNeeded(BaseRenderer*& renderer)
+void BaseRenderer::swapRendererIfNeeded(BaseRenderer*& renderer, RendererType type)
 {
-    if (renderer->getType() == g_currentType)
+    if (renderer->getType() == type)
         return;
 
     delete renderer;
-    renderer = createRenderer();
+    renderer = createRenderer(type);
 }
 
 void BaseRenderer::drawTileInfo(SkCanvas* canvas,
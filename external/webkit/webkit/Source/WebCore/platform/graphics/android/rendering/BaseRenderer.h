@@ -79,7 +79,10 @@ public:
     RendererType getType() { return m_type; }
 
     static BaseRenderer* createRenderer();
-    static void swapRendererIfNeeded(BaseRenderer*& renderer);
+    static BaseRenderer* createRenderer(RendererType type);
+    // Raster threads pass the type they read before taking an operation, as
+    // the current type can change while they paint.
+    static void swapRendererIfNeeded(BaseRenderer*& renderer, RendererType type);
     static RendererType getCurrentRendererType() { return g_currentType; }
     static void setCurrentRendererType(RendererType type) { g_currentType = type; }
 
@@ -79,12 +79,21 @@ bool PaintTileOperation::operator==(const QueuedOperation* operation)
     return op->m_tile == m_tile;
 }
 
-void PaintTileOperation::run()
+void PaintTileOperation::willRun()
+{
+    // Taken off the queue, so a newer operation for the tile now waits in
+    // the queue until this paint is done.
+    if (m_tile)
+        m_tile->setPainting(true);
+}
+
+void PaintTileOperation::run(BaseRenderer::RendererType rendererType)
 {
     TRACE_METHOD();
 
     if (m_tile) {
-        m_tile->paintBitmap(m_painter);
+        m_tile->paintBitmap(m_painter, rendererType);
+        m_tile->setPainting(false);
         m_tile->setRepaintPending(false);
         m_tile = 0;
     }
@@ -110,10 +119,14 @@ int PaintTileOperation::priority()
     if (m_tile->frontTexture())
         priority += 50000;
 
-    // for base tiles, prioritize based on position
+    // for base tiles, prioritize based on position, favoring the tiles that
+    // are about to scroll into view
     if (!m_tile->isLayerTile()) {
         bool goingDown = m_state->goingDown();
-        priority += m_tile->x();
+        if (m_state->goingLeft())
+            priority += std::min(m_tile->x(), 999);
+        else
+            priority += 999 - std::min(m_tile->x(), 999);
 
         if (goingDown)
             priority += 100000 - (1 + m_tile->y()) * 1000;
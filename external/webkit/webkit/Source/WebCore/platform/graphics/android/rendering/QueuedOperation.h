@@ -26,12 +26,18 @@
 #ifndef QueuedOperation_h
 #define QueuedOperation_h
 
+#include "BaseRenderer.h"
+
 namespace WebCore {
 
 class QueuedOperation {
 public:
     virtual ~QueuedOperation() {}
-    virtual void run() = 0;
+    virtual void run(BaseRenderer::RendererType rendererType) = 0;
+    // Called with the queue locked. An operation that cannot start yet stays
+    // queued, and willRun() is called on the one taken off the queue.
+    virtual bool canRun() { return true; }
+    virtual void willRun() { }
     virtual bool operator==(const QueuedOperation* operation) = 0;
     virtual void* uniquePtr() = 0;
     virtual int priority() = 0;
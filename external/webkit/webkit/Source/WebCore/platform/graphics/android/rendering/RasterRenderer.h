@@ -52,8 +52,8 @@ protected:
     virtual void checkForPureColor(TileRenderInfo& renderInfo, SkCanvas* canvas);
 
 private:
-    static SkBitmap* g_bitmap;
-
+    // Each raster thread paints into its own bitmap.
+    static SkBitmap& threadBitmap();
 };
 
 } // namespace WebCore
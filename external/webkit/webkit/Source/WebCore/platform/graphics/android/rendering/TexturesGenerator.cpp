@@ -32,13 +32,34 @@
 #if USE(ACCELERATED_COMPOSITING)
 
 #include "AndroidLog.h"
+#include "BaseRenderer.h"
 #include "GLUtils.h"
 #include "PaintTileOperation.h"
 #include "TilesManager.h"
 #include "TransferQueue.h"
+#include <unistd.h>
+#include <wtf/CurrentTime.h>
 
 namespace WebCore {
 
+TexturesGenerator::TexturesGenerator(TilesManager* instance)
+    : m_tilesManager(instance)
+    , m_deferredMode(false)
+{
+}
+
+void TexturesGenerator::start()
+{
+    long cores = sysconf(_SC_NPROCESSORS_CONF);
+    unsigned count = std::min(static_cast<unsigned>(std::max(cores, 1L)), gMaxRasterThreads);
+    for (unsigned i = 0; i < count; i++) {
+        sp<RasterThread> thread = new RasterThread(this, !i);
+        thread->run("TexturesGenerator");
+        m_rasterThreads.append(thread);
+    }
+    ALOGV("started %u raster threads", count);
+}
+
 bool TexturesGenerator::tryUpdateOperationWithPainter(Tile* tile, TilePainter* painter)
 {
     android::Mutex::Autolock lock(mRequestedOperationsLock);
@@ -63,8 +84,10 @@ void TexturesGenerator::scheduleOperation(QueuedOperation* operation)
         // signal if we weren't in deferred mode, or if we can no longer defer
         signal = !m_deferredMode || !deferrable;
     }
+    // Wake every raster thread, since one that cannot paint with the current
+    // renderer may be waiting too.
     if (signal)
-        mRequestedOperationsCond.signal();
+        mRequestedOperationsCond.broadcast();
 }
 
 void TexturesGenerator::removeOperationsForFilter(OperationFilter* filter)
@@ -86,45 +109,57 @@ void TexturesGenerator::removeOperationsForFilter(OperationFilter* filter)
     delete filter;
 }
 
-status_t TexturesGenerator::readyToRun()
+status_t TexturesGenerator::RasterThread::readyToRun()
 {
     ALOGV("Thread ready to run");
     return NO_ERROR;
 }
 
+bool TexturesGenerator::RasterThread::threadLoop()
+{
+    m_generator->runOperations(m_isPrimary);
+    return true;
+}
+
 // Must be called from within a lock!
-QueuedOperation* TexturesGenerator::popNext()
+QueuedOperation* TexturesGenerator::popNext(bool allowDeferred, bool& blocked)
 {
     // Priority can change between when it was added and now
     // Hence why the entire queue is rescanned
-    QueuedOperation* current = mRequestedOperations.last();
-    int currentPriority = current->priority();
-    if (currentPriority < 0) {
-        mRequestedOperations.removeLast();
-        mRequestedOperationsHash.remove(current->uniquePtr());
-        return current;
-    }
-    int currentIndex = mRequestedOperations.size() - 1;
+    QueuedOperation* current = 0;
+    int currentPriority = 0;
+    int currentIndex = -1;
+    blocked = false;
     // Scan from the back to make removing faster (less items to copy)
-    for (int i = mRequestedOperations.size() - 2; i >= 0; i--) {
+    for (int i = mRequestedOperations.size() - 1; i >= 0; i--) {
         QueuedOperation *next = mRequestedOperations[i];
+        // Another raster thread is still painting the same tile, leave this
+        // one queued so that the newer paint lands last.
+        if (!next->canRun())
+            continue;
         int nextPriority = next->priority();
         if (nextPriority < 0) {
             // Found a very high priority item, go ahead and just handle it now
             mRequestedOperations.remove(i);
             mRequestedOperationsHash.remove(next->uniquePtr());
+            next->willRun();
             return next;
         }
         // pick items preferrably by priority, or if equal, by order of
         // insertion (as we add items at the back of the queue)
-        if (nextPriority <= currentPriority) {
+        if (!current || nextPriority <= currentPriority) {
             current = next;
             currentPriority = nextPriority;
             currentIndex = i;
         }
     }
 
-    if (!m_deferredMode && currentPriority >= gDeferPriorityCutoff) {
+    if (!current) {
+        blocked = true;
+        return 0;
+    }
+
+    if (!allowDeferred && currentPriority >= gDeferPriorityCutoff) {
         // finished with non-deferred rendering, enter deferred mode to wait
         m_deferredMode = true;
         return 0;
@@ -132,14 +167,23 @@ QueuedOperation* TexturesGenerator::popNext()
 
     mRequestedOperations.remove(currentIndex);
     mRequestedOperationsHash.remove(current->uniquePtr());
+    current->willRun();
     return current;
 }
 
-bool TexturesGenerator::threadLoop()
+void TexturesGenerator::runOperations(bool isPrimary)
 {
     // Check if we have any pending operations.
     mRequestedOperationsLock.lock();
 
+    // The Ganesh renderer paints through a GL context that is only current on
+    // one thread, so only the primary raster thread may use it.
+    if (!isPrimary && BaseRenderer::getCurrentRendererType() != BaseRenderer::Raster) {
+        mRequestedOperationsCond.waitRelative(mRequestedOperationsLock, gDeferNsecs);
+        mRequestedOperationsLock.unlock();
+        return;
+    }
+
     if (!m_deferredMode) {
         // if we aren't currently deferring work, wait for new work to arrive
         while (!mRequestedOperations.size())
@@ -149,27 +193,47 @@ bool TexturesGenerator::threadLoop()
         mRequestedOperationsCond.waitRelative(mRequestedOperationsLock, gDeferNsecs);
     }
 
+    // Still deferring after the wait means nothing better came in, so the
+    // deferred work is ours to paint now.
+    bool allowDeferred = m_deferredMode;
+
     mRequestedOperationsLock.unlock();
 
     bool stop = false;
     while (!stop) {
         QueuedOperation* currentOperation = 0;
+        bool blocked = false;
+
+        // The renderer type can be switched while we paint, so read it again
+        // for every operation and hand the same value down to the paint.
+        BaseRenderer::RendererType rendererType = BaseRenderer::getCurrentRendererType();
+        if (!isPrimary && rendererType != BaseRenderer::Raster)
+            break;
 
         mRequestedOperationsLock.lock();
-        ALOGV("threadLoop, %d operations in the queue", mRequestedOperations.size());
+        ALOGV("runOperations, %d operations in the queue", mRequestedOperations.size());
 
         if (mRequestedOperations.size())
-            currentOperation = popNext();
+            currentOperation = popNext(allowDeferred, blocked);
+        if (blocked) {
+            // Every queued tile is being painted by another raster thread,
+            // wait for one of them to finish rather than spinning.
+            mPaintFinishedCond.waitRelative(mRequestedOperationsLock, gDeferNsecs);
+        }
         mRequestedOperationsLock.unlock();
 
         if (currentOperation) {
-            ALOGV("threadLoop, painting the request with priority %d",
+            ALOGV("runOperations, painting the request with priority %d",
                   currentOperation->priority());
-            currentOperation->run();
+            double startTime = currentTimeMS();
+            currentOperation->run(rendererType);
+            didRunOperation(startTime, currentTimeMS());
         }
 
         mRequestedOperationsLock.lock();
-        if (m_deferredMode && !currentOperation)
+        if (currentOperation)
+            mPaintFinishedCond.broadcast();
+        else if (!blocked)
             stop = true;
         if (!mRequestedOperations.size()) {
             m_deferredMode = false;
@@ -180,9 +244,26 @@ bool TexturesGenerator::threadLoop()
         if (currentOperation)
             delete currentOperation; // delete outside lock
     }
-    ALOGV("threadLoop empty");
+    ALOGV("runOperations empty");
+}
 
-    return true;
+void TexturesGenerator::didRunOperation(double startTime, double endTime)
+{
+    android::Mutex::Autolock lock(m_statisticsLock);
+    m_statistics.paintedOperations++;
+    m_statistics.totalPaintTime += endTime - startTime;
+}
+
+TexturesGenerator::Statistics TexturesGenerator::statistics()
+{
+    android::Mutex::Autolock lock(m_statisticsLock);
+    return m_statistics;
+}
+
+void TexturesGenerator::resetStatistics()
+{
+    android::Mutex::Autolock lock(m_statisticsLock);
+    m_statistics = Statistics();
 }
 
 } // namespace WebCore
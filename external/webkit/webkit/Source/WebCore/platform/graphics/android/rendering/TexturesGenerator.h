@@ -41,13 +41,22 @@ using namespace android;
 
 class TilesManager;
 
-class TexturesGenerator : public Thread {
+// Paints queued tiles on a pool of raster threads, one per core up to
+// gMaxRasterThreads. All threads share a single queue and always take the
+// operation with the best priority next.
+class TexturesGenerator {
 public:
-    TexturesGenerator(TilesManager* instance) : Thread(false)
-        , m_tilesManager(instance)
-        , m_deferredMode(false) { }
-    virtual ~TexturesGenerator() { }
-    virtual status_t readyToRun();
+    struct Statistics {
+        unsigned paintedOperations;
+        // Summed over all raster threads, in ms.
+        double totalPaintTime;
+        Statistics() : paintedOperations(0), totalPaintTime(0) { }
+    };
+
+    // Lives as long as the TilesManager, that is for the whole process.
+    TexturesGenerator(TilesManager* instance);
+
+    void start();
 
     bool tryUpdateOperationWithPainter(Tile* tile, TilePainter* painter);
 
@@ -55,24 +64,52 @@ public:
 
     void scheduleOperation(QueuedOperation* operation);
 
+    Statistics statistics();
+    void resetStatistics();
+    unsigned rasterThreadCount() const { return m_rasterThreads.size(); }
+
     // low res tiles are put at or above this cutoff when not scrolling,
     // signifying that they should be deferred
     static const int gDeferPriorityCutoff = 500000000;
 
 private:
-    QueuedOperation* popNext();
-    virtual bool threadLoop();
+    class RasterThread : public Thread {
+    public:
+        RasterThread(TexturesGenerator* generator, bool isPrimary) : Thread(false)
+            , m_generator(generator)
+            , m_isPrimary(isPrimary) { }
+        virtual status_t readyToRun();
+    private:
+        virtual bool threadLoop();
+        TexturesGenerator* m_generator;
+        bool m_isPrimary;
+    };
+
+    // Sets blocked when every queued operation has to wait for another
+    // raster thread to finish.
+    QueuedOperation* popNext(bool allowDeferred, bool& blocked);
+    void runOperations(bool isPrimary);
+    void didRunOperation(double startTime, double endTime);
+
     WTF::Vector<QueuedOperation*> mRequestedOperations;
     WTF::HashMap<void*, QueuedOperation*> mRequestedOperationsHash;
     android::Mutex mRequestedOperationsLock;
     android::Condition mRequestedOperationsCond;
+    android::Condition mPaintFinishedCond;
     TilesManager* m_tilesManager;
+    WTF::Vector<sp<RasterThread> > m_rasterThreads;
 
     bool m_deferredMode;
 
+    android::Mutex m_statisticsLock;
+    Statistics m_statistics;
+
     // defer painting for one second if best in queue has priority
     // QueuedOperation::gDeferPriorityCutoff or higher
     static const nsecs_t gDeferNsecs = 1000000000;
+
+    // Each raster thread has its own tile sized bitmap to paint into.
+    static const unsigned gMaxRasterThreads = 4;
 };
 
 } // namespace WebCore
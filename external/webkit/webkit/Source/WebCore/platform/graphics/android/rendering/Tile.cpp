@@ -56,6 +56,7 @@ Tile::Tile(bool isLayerTile)
     , m_scale(1)
     , m_dirty(true)
     , m_repaintsPending(0)
+    , m_isPainting(false)
     , m_fullRepaint(true)
     , m_isLayerTile(isLayerTile)
     , m_drawCount(0)
@@ -222,6 +223,18 @@ void Tile::setRepaintPending(bool pending)
     m_repaintsPending += pending ? 1 : -1;
 }
 
+bool Tile::isPainting()
+{
+    android::AutoMutex lock(m_atomicSync);
+    return m_isPainting;
+}
+
+void Tile::setPainting(bool painting)
+{
+    android::AutoMutex lock(m_atomicSync);
+    m_isPainting = painting;
+}
+
 bool Tile::drawGL(float opacity, const SkRect& rect, float scale,
                   const TransformationMatrix* transform,
                   bool forceBlending, bool usePointSampling,
@@ -297,7 +310,7 @@ bool Tile::isTileVisible(const IntRect& viewTileBounds)
 }
 
 // This is called from the texture generation thread
-void Tile::paintBitmap(TilePainter* painter)
+void Tile::paintBitmap(TilePainter* painter, BaseRenderer::RendererType rendererType)
 {
     // We acquire the values below atomically. This ensures that we are reading
     // values correctly across cores. Further, once we have these values they
@@ -329,7 +342,7 @@ void Tile::paintBitmap(TilePainter* painter)
     }
 
     // swap out the renderer if necessary
-    BaseRenderer::swapRendererIfNeeded(m_renderer);
+    BaseRenderer::swapRendererIfNeeded(m_renderer, rendererType);
     // setup the common renderInfo fields;
     TileRenderInfo renderInfo;
     renderInfo.x = x;
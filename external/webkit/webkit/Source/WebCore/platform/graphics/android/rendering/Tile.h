@@ -107,7 +107,7 @@ public:
                 const FloatRect& fillPortion);
 
     // the only thread-safe function called by the background thread
-    void paintBitmap(TilePainter* painter);
+    void paintBitmap(TilePainter* painter, BaseRenderer::RendererType rendererType);
 
     bool intersectWithRect(int x, int y, int tileWidth, int tileHeight,
                            float scale, const SkRect& dirtyRect,
@@ -120,6 +120,10 @@ public:
     const SkRegion& dirtyArea() { return m_dirtyArea; }
     virtual bool isRepaintPending();
     void setRepaintPending(bool pending);
+    // Set while a raster thread paints the tile, so that no other raster
+    // thread starts painting it before that paint is done.
+    bool isPainting();
+    void setPainting(bool painting);
     float scale() const { return m_scale; }
     TextureState textureState() const { return m_state; }
 
@@ -162,6 +166,8 @@ private:
     // number of repaints pending
     int m_repaintsPending;
 
+    bool m_isPainting;
+
     // store the dirty region
     SkRegion m_dirtyArea;
     bool m_fullRepaint;
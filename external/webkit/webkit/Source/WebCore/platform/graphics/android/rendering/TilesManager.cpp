@@ -105,8 +105,8 @@ TilesManager::TilesManager()
     m_availableTextures.reserveCapacity(MAX_TEXTURE_ALLOCATION);
     m_tilesTextures.reserveCapacity(MAX_TEXTURE_ALLOCATION);
     m_availableTilesTextures.reserveCapacity(MAX_TEXTURE_ALLOCATION);
-    m_pixmapsGenerationThread = new TexturesGenerator(this);
-    m_pixmapsGenerationThread->run("TexturesGenerator");
+    m_texturesGenerator = new TexturesGenerator(this);
+    m_texturesGenerator->start();
 }
 
 void TilesManager::allocateTextures()
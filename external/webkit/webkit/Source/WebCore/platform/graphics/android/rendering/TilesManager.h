@@ -55,19 +55,21 @@ public:
 
     void removeOperationsForFilter(OperationFilter* filter)
     {
-        m_pixmapsGenerationThread->removeOperationsForFilter(filter);
+        m_texturesGenerator->removeOperationsForFilter(filter);
     }
 
     bool tryUpdateOperationWithPainter(Tile* tile, TilePainter* painter)
     {
-        return m_pixmapsGenerationThread->tryUpdateOperationWithPainter(tile, painter);
+        return m_texturesGenerator->tryUpdateOperationWithPainter(tile, painter);
     }
 
     void scheduleOperation(QueuedOperation* operation)
     {
-        m_pixmapsGenerationThread->scheduleOperation(operation);
+        m_texturesGenerator->scheduleOperation(operation);
     }
 
+    TexturesGenerator* texturesGenerator() { return m_texturesGenerator; }
+
     ShaderProgram* shader() { return &m_shader; }
     TransferQueue* transferQueue();
     VideoLayerManager* videoLayerManager() { return &m_videoLayerManager; }
@@ -198,7 +200,7 @@ private:
     unsigned int m_contentUpdates; // nr of successful tiled paints
     unsigned int m_webkitContentUpdates; // nr of paints from webkit
 
-    sp<TexturesGenerator> m_pixmapsGenerationThread;
+    TexturesGenerator* m_texturesGenerator;
 
     android::Mutex m_texturesLock;
 
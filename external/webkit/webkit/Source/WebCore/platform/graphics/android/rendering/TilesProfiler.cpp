@@ -43,6 +43,9 @@
 namespace WebCore {
 TilesProfiler::TilesProfiler()
     : m_enabled(false)
+    , m_frameHasCheckerboard(false)
+    , m_checkerboardTime(0)
+    , m_tilesPerSecond(0)
 {
 }
 
@@ -53,16 +56,42 @@ void TilesProfiler::start()
     m_badTiles = 0;
     m_records.clear();
     m_time = currentTimeMS();
+    m_startTime = m_time;
+    m_frameHasCheckerboard = false;
+    m_checkerboardTime = 0;
+    m_tilesPerSecond = 0;
+    TilesManager::instance()->texturesGenerator()->resetStatistics();
     ALOGV("initializing tileprofiling");
 }
 
 float TilesProfiler::stop()
 {
     m_enabled = false;
+    double currentTime = currentTimeMS();
+    didShowFrame(currentTime - m_time);
+
+    TexturesGenerator* generator = TilesManager::instance()->texturesGenerator();
+    TexturesGenerator::Statistics statistics = generator->statistics();
+    double duration = currentTime - m_startTime;
+    if (duration > 0)
+        m_tilesPerSecond = statistics.paintedOperations * 1000 / duration;
+
     ALOGV("completed tile profiling, observed %d frames", m_records.size());
+    ALOGD("painted %u tiles in %.0f ms on %u threads (%.1f tiles/s, %.2f ms per tile), checkerboarded for %.0f ms",
+          statistics.paintedOperations, duration, generator->rasterThreadCount(), m_tilesPerSecond,
+          statistics.paintedOperations ? statistics.totalPaintTime / statistics.paintedOperations : 0,
+          m_checkerboardTime);
     return (1.0 * m_goodTiles) / (m_goodTiles + m_badTiles);
 }
 
+void TilesProfiler::didShowFrame(double timeDelta)
+{
+    // The previous frame stayed on screen until now.
+    if (m_frameHasCheckerboard)
+        m_checkerboardTime += timeDelta;
+    m_frameHasCheckerboard = false;
+}
+
 void TilesProfiler::clear()
 {
     ALOGV("clearing tile profiling of its %d frames", m_records.size());
@@ -71,13 +100,17 @@ void TilesProfiler::clear()
 
 void TilesProfiler::nextFrame(int left, int top, int right, int bottom, float scale)
 {
-    if (!m_enabled || (m_records.size() > MAX_PROF_FRAMES))
+    if (!m_enabled)
         return;
 
     double currentTime = currentTimeMS();
     double timeDelta = currentTime - m_time;
+    didShowFrame(timeDelta);
     m_time = currentTime;
 
+    if (m_records.size() > MAX_PROF_FRAMES)
+        return;
+
 #ifdef DEBUG
     if (m_records.size() != 0) {
         ALOGD("completed tile profiling frame, observed %d tiles. %f ms since last",
@@ -95,10 +128,15 @@ void TilesProfiler::nextFrame(int left, int top, int right, int bottom, float sc
 
 void TilesProfiler::nextTile(Tile* tile, float scale, bool inView)
 {
-    if (!m_enabled || (m_records.size() > MAX_PROF_FRAMES) || (m_records.size() == 0))
+    if (!m_enabled)
         return;
 
     bool isReady = tile->isTileReady();
+    if (inView && !isReady)
+        m_frameHasCheckerboard = true;
+
+    if ((m_records.size() > MAX_PROF_FRAMES) || (m_records.size() == 0))
+        return;
     int left = tile->x() * TilesManager::tileWidth();
     int top = tile->y() * TilesManager::tileWidth();
     int right = left + TilesManager::tileWidth();
@@ -76,12 +76,24 @@ public:
 
     bool enabled() { return m_enabled; }
 
+    // Measured over the last profiling session, once stop() is called.
+    // Checkerboard time is how long frames with unpainted tiles in view were
+    // on screen, in ms.
+    double checkerboardTime() { return m_checkerboardTime; }
+    float tilesPerSecond() { return m_tilesPerSecond; }
+
 private:
+    void didShowFrame(double timeDelta);
+
     bool m_enabled;
     unsigned int m_goodTiles;
     unsigned int m_badTiles;
     WTF::Vector<WTF::Vector<TileProfileRecord> > m_records;
     double m_time;
+    double m_startTime;
+    bool m_frameHasCheckerboard;
+    double m_checkerboardTime;
+    float m_tilesPerSecond;
 };
 
 } // namespace WebCore
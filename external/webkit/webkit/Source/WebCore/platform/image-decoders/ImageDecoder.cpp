@@ -34,6 +34,18 @@
 #include "WEBPImageDecoder.h"
 #include "SharedBuffer.h"
 
+// The vector row kernels write pixels as (a << 24 | r << 16 | g << 8 | b) in
+// native byte order, which is what setRGBA() writes on these configurations.
+#if CPU(X86_SSE2) && COMPILER(GCC) && !PLATFORM(QT) \
+    && (!USE(SKIA) || (SK_A32_SHIFT == 24 && SK_R32_SHIFT == 16 && SK_G32_SHIFT == 8 && SK_B32_SHIFT == 0))
+#define IMAGE_DECODER_SSE2_ROWS 1
+#include <emmintrin.h>
+#if defined(__SSSE3__)
+#define IMAGE_DECODER_SSSE3_ROWS 1
+#include <tmmintrin.h>
+#endif
+#endif
+
 using namespace std;
 
 namespace WebCore {
@@ -239,6 +251,64 @@ int ImageFrame::height() const
 
 #endif
 
+void ImageFrame::setRGBRow(int x, int y, const unsigned char* rgb, int count)
+{
+    PixelData* dest = getAddr(x, y);
+    int i = 0;
+#if defined(IMAGE_DECODER_SSSE3_ROWS)
+    // Each step loads 16 bytes but uses only the 12 that make up four pixels,
+    // so stop while the extra bytes still belong to the row.
+    const __m128i toBGRA = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+    const __m128i opaque = _mm_set1_epi32(static_cast<int>(0xFF000000));
+    for (; i + 6 <= count; i += 4) {
+        __m128i source = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + 3 * i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_or_si128(_mm_shuffle_epi8(source, toBGRA), opaque));
+    }
+#endif
+    for (; i < count; ++i) {
+        const unsigned char* pixel = rgb + 3 * i;
+        setRGBA(dest + i, pixel[0], pixel[1], pixel[2], 0xFF);
+    }
+}
+
+bool ImageFrame::setRGBARow(int x, int y, const unsigned char* rgba, int count)
+{
+    PixelData* dest = getAddr(x, y);
+    bool sawTranslucentPixel = false;
+    int i = 0;
+#if defined(IMAGE_DECODER_SSE2_ROWS)
+    const __m128i byteMask = _mm_set1_epi32(0xFF);
+    const __m128 maxAlpha = _mm_set1_ps(255.0f);
+    for (; i + 4 <= count; i += 4) {
+        __m128i source = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + 4 * i));
+        __m128i r = _mm_and_si128(source, byteMask);
+        __m128i g = _mm_and_si128(_mm_srli_epi32(source, 8), byteMask);
+        __m128i b = _mm_and_si128(_mm_srli_epi32(source, 16), byteMask);
+        __m128i a = _mm_srli_epi32(source, 24);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(a, byteMask)) != 0xFFFF) {
+            sawTranslucentPixel = true;
+            if (m_premultiplyAlpha) {
+                // The same single precision arithmetic as setRGBA(), so that
+                // both produce identical pixels.  A zero alpha zeroes the
+                // whole pixel, as it does there.
+                __m128 alphaPercent = _mm_div_ps(_mm_cvtepi32_ps(a), maxAlpha);
+                r = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(r), alphaPercent));
+                g = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(g), alphaPercent));
+                b = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(b), alphaPercent));
+            }
+        }
+        __m128i pixels = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(a, 24), _mm_slli_epi32(r, 16)), _mm_or_si128(_mm_slli_epi32(g, 8), b));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), pixels);
+    }
+#endif
+    for (; i < count; ++i) {
+        const unsigned char* pixel = rgba + 4 * i;
+        setRGBA(dest + i, pixel[0], pixel[1], pixel[2], pixel[3]);
+        sawTranslucentPixel |= pixel[3] < 255;
+    }
+    return sawTranslucentPixel;
+}
+
 namespace {
 
 enum MatchType {
@@ -142,6 +142,16 @@ namespace WebCore {
             setRGBA(getAddr(x, y), r, g, b, a);
         }
 
+        // Sets |count| pixels of row |y|, starting at column |x|, from packed
+        // 8-bit RGB samples.  The result is the same as calling setRGBA() with
+        // an alpha of 255 for each pixel, but whole rows can be converted
+        // several pixels at a time.
+        void setRGBRow(int x, int y, const unsigned char* rgb, int count);
+
+        // Likewise for packed RGBA samples.  Returns whether any of the pixels
+        // had an alpha below 255.
+        bool setRGBARow(int x, int y, const unsigned char* rgba, int count);
+
 #if PLATFORM(QT)
         void setPixmap(const QPixmap& pixmap);
 #endif
@@ -320,6 +330,16 @@ namespace WebCore {
         // compositing).
         virtual void clearFrameBufferCache(size_t) { }
 
+        // Installs a frame that another decoder produced from the same data
+        // (see ImageDecodingService), so that frameBufferAtIndex() does not
+        // decode it again.
+        void setFrameBufferAtIndex(size_t index, const ImageFrame& frame)
+        {
+            if (m_frameBufferCache.size() <= index)
+                m_frameBufferCache.resize(index + 1);
+            m_frameBufferCache[index] = frame;
+        }
+
 #if ENABLE(IMAGE_DECODER_DOWN_SAMPLING)
         void setMaxNumPixels(int m) { m_maxNumPixels = m; }
 #endif
@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2011 Google, Inc. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "ImageDecodingService.h"
+
+#if USE(IMAGE_DECODING_SERVICE)
+
+#include "ImageDecoder.h"
+#include "SharedBuffer.h"
+#include <wtf/MainThread.h>
+#include <wtf/OwnPtr.h>
+#include <wtf/PassOwnPtr.h>
+#include <wtf/StdLibExtras.h>
+
+namespace WebCore {
+
+// Decoding is mostly memory bound, and the main thread and the compositor
+// still need a core, so more threads than this rarely help.
+static const unsigned maxWorkerThreads = 2;
+
+struct ImageDecodingService::Job {
+    WTF_MAKE_NONCOPYABLE(Job); WTF_MAKE_FAST_ALLOCATED;
+public:
+    Job(ImageDecodingClient* client, PassRefPtr<SharedBuffer> data, ImageSource::AlphaOption alphaOption, ImageSource::GammaAndColorProfileOption gammaAndColorProfileOption, unsigned maxPixels)
+        : client(client)
+        , data(data)
+        , alphaOption(alphaOption)
+        , gammaAndColorProfileOption(gammaAndColorProfileOption)
+        , maxPixels(maxPixels)
+        , cancelled(false)
+        , succeeded(false)
+    {
+    }
+
+    // Only touched on the main thread; 0 once the job has been cancelled.
+    ImageDecodingClient* client;
+
+    // Owned by whichever thread has the job; the mutex hands it over.
+    RefPtr<SharedBuffer> data;
+    ImageSource::AlphaOption alphaOption;
+    ImageSource::GammaAndColorProfileOption gammaAndColorProfileOption;
+    unsigned maxPixels;
+    bool cancelled; // Guarded by m_mutex.
+    bool succeeded;
+    ImageFrame frame;
+};
+
+ImageDecodingService& ImageDecodingService::shared()
+{
+    ASSERT(isMainThread());
+    DEFINE_STATIC_LOCAL(ImageDecodingService, service, ());
+    return service;
+}
+
+ImageDecodingService::ImageDecodingService()
+    : m_workerThreadCount(0)
+    , m_dispatchPending(false)
+{
+}
+
+void ImageDecodingService::decode(ImageDecodingClient* client, SharedBuffer* data, ImageSource::AlphaOption alphaOption, ImageSource::GammaAndColorProfileOption gammaAndColorProfileOption, unsigned maxPixels)
+{
+    ASSERT(isMainThread());
+    if (!data || m_jobs.contains(client))
+        return;
+
+    startWorkerThreadsIfNeeded();
+    if (!m_workerThreadCount)
+        return;
+
+    // The worker gets its own copy of the encoded data: SharedBuffer merges
+    // its segments lazily and is not safe to read from two threads.
+    Job* job = new Job(client, SharedBuffer::create(data->data(), data->size()), alphaOption, gammaAndColorProfileOption, maxPixels);
+    m_jobs.set(client, job);
+
+    MutexLocker locker(m_mutex);
+    m_pendingJobs.append(job);
+    m_condition.signal();
+}
+
+void ImageDecodingService::cancel(ImageDecodingClient* client)
+{
+    ASSERT(isMainThread());
+    Job* job = m_jobs.take(client);
+    if (!job)
+        return;
+
+    // The job is deleted by dispatchFinishedJobs() once a worker has let go
+    // of it; a worker that has not started on it yet skips the decode.
+    job->client = 0;
+    MutexLocker locker(m_mutex);
+    job->cancelled = true;
+}
+
+void ImageDecodingService::startWorkerThreadsIfNeeded()
+{
+    while (m_workerThreadCount < maxWorkerThreads) {
+        ThreadIdentifier thread = createThread(ImageDecodingService::workerThreadEntryPoint, this, "WebCore: ImageDecoder");
+        if (!thread)
+            return;
+        detachThread(thread);
+        ++m_workerThreadCount;
+    }
+}
+
+void* ImageDecodingService::workerThreadEntryPoint(void* context)
+{
+    static_cast<ImageDecodingService*>(context)->runWorkerThread();
+    return 0;
+}
+
+void ImageDecodingService::runWorkerThread()
+{
+    // The service is never destroyed, so neither are its threads.
+    while (true) {
+        Job* job;
+        bool cancelled;
+        {
+            MutexLocker locker(m_mutex);
+            while (m_pendingJobs.isEmpty())
+                m_condition.wait(m_mutex);
+            job = m_pendingJobs.takeFirst();
+            cancelled = job->cancelled;
+        }
+
+        if (!cancelled)
+            decodeJob(job);
+        job->data.clear();
+
+        MutexLocker locker(m_mutex);
+        m_finishedJobs.append(job);
+        if (!m_dispatchPending) {
+            m_dispatchPending = true;
+            callOnMainThread(ImageDecodingService::didFinishJobs, this);
+        }
+    }
+}
+
+void ImageDecodingService::decodeJob(Job* job)
+{
+    OwnPtr<ImageDecoder> decoder = adoptPtr(ImageDecoder::create(*job->data, job->alphaOption, job->gammaAndColorProfileOption));
+    if (!decoder)
+        return;
+
+    // ImageSource::maxPixelsToDecode() has already applied the port's limit.
+#if ENABLE(IMAGE_DECODER_DOWN_SAMPLING)
+    if (job->maxPixels)
+        decoder->setMaxNumPixels(job->maxPixels);
+#endif
+    decoder->setData(job->data.get(), true);
+
+    ImageFrame* buffer = decoder->frameBufferAtIndex(0);
+    if (!buffer || buffer->status() != ImageFrame::FrameComplete || decoder->failed())
+        return;
+
+    // For ports that refcount their pixels this only takes a reference.
+    job->frame = *buffer;
+    job->succeeded = true;
+}
+
+void ImageDecodingService::didFinishJobs(void* context)
+{
+    static_cast<ImageDecodingService*>(context)->dispatchFinishedJobs();
+}
+
+void ImageDecodingService::dispatchFinishedJobs()
+{
+    ASSERT(isMainThread());
+    Vector<Job*> jobs;
+    {
+        MutexLocker locker(m_mutex);
+        m_dispatchPending = false;
+        jobs.swap(m_finishedJobs);
+    }
+
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        OwnPtr<Job> job = adoptPtr(jobs[i]);
+        // A client called back earlier in this loop may have cancelled it.
+        if (!job->client)
+            continue;
+        m_jobs.remove(job->client);
+        job->client->didDecodeFrame(job->succeeded ? &job->frame : 0);
+    }
+}
+
+} // namespace WebCore
+
+#endif // USE(IMAGE_DECODING_SERVICE)
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2011 Google, Inc. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ImageDecodingService_h
+#define ImageDecodingService_h
+
+#include "ImageSource.h"
+
+#if USE(IMAGE_DECODING_SERVICE)
+
+#include <wtf/Deque.h>
+#include <wtf/HashMap.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+
+namespace WebCore {
+
+class ImageFrame;
+class SharedBuffer;
+
+class ImageDecodingClient {
+public:
+    virtual ~ImageDecodingClient() { }
+
+    // Called on the main thread. |frame| is 0 if the image could not be
+    // decoded; it is only valid for the duration of the call.
+    virtual void didDecodeFrame(const ImageFrame* frame) = 0;
+};
+
+// Decodes single frame images on a small pool of worker threads, so that the
+// main thread does not stall the first time a large image is painted.
+//
+// Each request gets its own ImageDecoder and its own copy of the encoded data,
+// since neither ImageDecoder nor SharedBuffer may be shared between threads.
+// All public functions must be called on the main thread.
+class ImageDecodingService {
+    WTF_MAKE_NONCOPYABLE(ImageDecodingService); WTF_MAKE_FAST_ALLOCATED;
+public:
+    static ImageDecodingService& shared();
+
+    // A client has at most one decode in flight; asking again while one is
+    // pending does nothing. Unless |maxPixels| is 0, decoders that support it
+    // down-sample the frame to at most that many pixels.
+    void decode(ImageDecodingClient*, SharedBuffer* data, ImageSource::AlphaOption, ImageSource::GammaAndColorProfileOption, unsigned maxPixels);
+    bool isDecoding(ImageDecodingClient* client) const { return m_jobs.contains(client); }
+
+    // The client will not be called back. Must be called before the client
+    // is destroyed.
+    void cancel(ImageDecodingClient*);
+
+private:
+    struct Job;
+
+    ImageDecodingService();
+
+    void startWorkerThreadsIfNeeded();
+    static void* workerThreadEntryPoint(void*);
+    void runWorkerThread();
+    static void decodeJob(Job*);
+
+    static void didFinishJobs(void*);
+    void dispatchFinishedJobs();
+
+    // Only touched on the main thread.
+    HashMap<ImageDecodingClient*, Job*> m_jobs;
+    unsigned m_workerThreadCount;
+
+    // Guards everything below.
+    Mutex m_mutex;
+    ThreadCondition m_condition;
+    Deque<Job*> m_pendingJobs;
+    Vector<Job*> m_finishedJobs;
+    bool m_dispatchPending;
+};
+
+} // namespace WebCore
+
+#endif // USE(IMAGE_DECODING_SERVICE)
+
+#endif // ImageDecodingService_h
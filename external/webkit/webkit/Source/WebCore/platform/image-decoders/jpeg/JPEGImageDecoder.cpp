@@ -60,6 +60,8 @@ extern "C" {
 
 }
 
+#include <algorithm>
+#include <limits>
 #include <setjmp.h>
 
 namespace WebCore {
@@ -237,6 +239,16 @@ public:
             // image is a sequential JPEG.
             m_info.buffered_image = jpeg_has_multiple_scans(&m_info);
 
+            // We can fill in the size now that the header is available.  This
+            // also works out how far the image is to be scaled down.
+            if (!m_decoder->setSize(m_info.image_width, m_info.image_height))
+                return false;
+
+            // Let the IDCT do as much of the scaling as it can; it is far
+            // cheaper than decoding every pixel and dropping most of them.
+            m_info.scale_num = 1;
+            m_info.scale_denom = m_decoder->dctScaleDenominator();
+
             // Used to set up image size so arrays can be allocated.
             jpeg_calc_output_dimensions(&m_info);
 
@@ -248,10 +260,6 @@ public:
 
             m_state = JPEG_START_DECOMPRESS;
 
-            // We can fill in the size now that the header is available.
-            if (!m_decoder->setSize(m_info.image_width, m_info.image_height))
-                return false;
-
             if (!m_decoder->ignoresGammaAndColorProfile())
                 m_decoder->setColorProfile(readColorProfile(info()));
 
@@ -407,6 +415,7 @@ void term_source(j_decompress_ptr jd)
 JPEGImageDecoder::JPEGImageDecoder(ImageSource::AlphaOption alphaOption,
                                    ImageSource::GammaAndColorProfileOption gammaAndColorProfileOption)
     : ImageDecoder(alphaOption, gammaAndColorProfileOption)
+    , m_dctScaleDenominator(1)
 {
 }
 
@@ -422,12 +431,30 @@ bool JPEGImageDecoder::isSizeAvailable()
     return ImageDecoder::isSizeAvailable();
 }
 
+static int minimumSpacing(const Vector<int>& values)
+{
+    int spacing = std::numeric_limits<int>::max();
+    for (size_t i = 1; i < values.size(); ++i)
+        spacing = std::min(spacing, values[i] - values[i - 1]);
+    return spacing;
+}
+
 bool JPEGImageDecoder::setSize(unsigned width, unsigned height)
 {
     if (!ImageDecoder::setSize(width, height))
         return false;
 
     prepareScaleDataIfNecessary();
+
+    // libjpeg can scale by 1/2, 1/4 or 1/8 while decoding.  Any of these that
+    // is no bigger than the gap between the rows and columns we keep still
+    // leaves a distinct decoded pixel for each of them.
+    m_dctScaleDenominator = 1;
+    if (m_scaled) {
+        int spacing = std::min(minimumSpacing(m_scaledColumns), minimumSpacing(m_scaledRows));
+        while (m_dctScaleDenominator < 8 && static_cast<int>(m_dctScaleDenominator * 2) <= spacing)
+            m_dctScaleDenominator *= 2;
+    }
     return true;
 }
 
@@ -453,6 +480,20 @@ bool JPEGImageDecoder::setFailed()
     return ImageDecoder::setFailed();
 }
 
+int JPEGImageDecoder::destinationRow(int sourceY)
+{
+    if (m_dctScaleDenominator == 1)
+        return scaledY(sourceY);
+
+    // Decoded row |sourceY| covers rows [sourceY * d, (sourceY + 1) * d) of
+    // the full size image; it is used for the kept row in that range, if any.
+    int denominator = m_dctScaleDenominator;
+    int destY = upperBoundScaledY(sourceY * denominator);
+    if (destY < 0 || m_scaledRows[destY] >= (sourceY + 1) * denominator)
+        return -1;
+    return destY;
+}
+
 bool JPEGImageDecoder::outputScanlines()
 {
     if (m_frameBufferCache.isEmpty())
@@ -482,12 +523,17 @@ bool JPEGImageDecoder::outputScanlines()
         if (jpeg_read_scanlines(info, samples, 1) != 1)
             return false;
 
-        int destY = scaledY(sourceY);
+        int destY = destinationRow(sourceY);
         if (destY < 0)
             continue;
+        if (!m_scaled && info->out_color_space == JCS_RGB) {
+            buffer.setRGBRow(0, destY, *samples, info->output_width);
+            continue;
+        }
         int width = m_scaled ? m_scaledColumns.size() : info->output_width;
         for (int x = 0; x < width; ++x) {
-            JSAMPLE* jsample = *samples + (m_scaled ? m_scaledColumns[x] : x) * ((info->out_color_space == JCS_RGB) ? 3 : 4);
+            int sourceX = m_scaled ? m_scaledColumns[x] / static_cast<int>(m_dctScaleDenominator) : x;
+            JSAMPLE* jsample = *samples + sourceX * ((info->out_color_space == JCS_RGB) ? 3 : 4);
             if (info->out_color_space == JCS_RGB)
                 buffer.setRGBA(x, destY, jsample[0], jsample[1], jsample[2], 0xFF);
             else if (info->out_color_space == JCS_CMYK) {
@@ -53,6 +53,10 @@ namespace WebCore {
         bool outputScanlines();
         void jpegComplete();
 
+        // The libjpeg scale_denom to decode at; the rest of any downsampling
+        // is done by picking rows and columns as usual.
+        unsigned dctScaleDenominator() const { return m_dctScaleDenominator; }
+
         void setColorProfile(const ColorProfile& colorProfile) { m_colorProfile = colorProfile; }
 
     private:
@@ -61,7 +65,12 @@ namespace WebCore {
         // data coming, sets the "decode failure" flag.
         void decode(bool onlySize);
 
+        // Maps a scanline from libjpeg to a row of the frame, or -1 if it is
+        // not kept.
+        int destinationRow(int sourceY);
+
         OwnPtr<JPEGImageReader> m_reader;
+        unsigned m_dctScaleDenominator;
     };
 
 } // namespace WebCore
@@ -402,11 +402,18 @@ void PNGImageDecoder::rowAvailable(unsigned char* rowBuffer, unsigned rowIndex,
     if (destY < 0 || destY >= scaledSize().height())
         return;
     bool nonTrivialAlpha = false;
-    for (int x = 0; x < width; ++x) {
-        png_bytep pixel = row + (m_scaled ? m_scaledColumns[x] : x) * colorChannels;
-        unsigned alpha = hasAlpha ? pixel[3] : 255;
-        buffer.setRGBA(x, destY, pixel[0], pixel[1], pixel[2], alpha);
-        nonTrivialAlpha |= alpha < 255;
+    if (!m_scaled) {
+        if (hasAlpha)
+            nonTrivialAlpha = buffer.setRGBARow(0, destY, row, width);
+        else
+            buffer.setRGBRow(0, destY, row, width);
+    } else {
+        for (int x = 0; x < width; ++x) {
+            png_bytep pixel = row + m_scaledColumns[x] * colorChannels;
+            unsigned alpha = hasAlpha ? pixel[3] : 255;
+            buffer.setRGBA(x, destY, pixel[0], pixel[1], pixel[2], alpha);
+            nonTrivialAlpha |= alpha < 255;
+        }
     }
     if (nonTrivialAlpha && !buffer.hasAlpha())
         buffer.setHasAlpha(nonTrivialAlpha);
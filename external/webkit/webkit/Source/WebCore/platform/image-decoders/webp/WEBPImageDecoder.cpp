@@ -90,8 +90,11 @@ bool WEBPImageDecoder::decode(bool onlySize)
     const uint8_t* dataBytes = reinterpret_cast<const uint8_t*>(m_data->data());
     if (!WebPGetInfo(dataBytes, dataSize, &width, &height))
         return setFailed();
-    if (!ImageDecoder::isSizeAvailable() && !setSize(width, height))
-        return setFailed();
+    if (!ImageDecoder::isSizeAvailable()) {
+        if (!setSize(width, height))
+            return setFailed();
+        prepareScaleDataIfNecessary();
+    }
     if (onlySize)
         return true;
 
@@ -102,7 +105,7 @@ bool WEBPImageDecoder::decode(bool onlySize)
     if (buffer.status() == ImageFrame::FrameEmpty) {
         ASSERT(width == size().width());
         ASSERT(height == size().height());
-        if (!buffer.setSize(width, height))
+        if (!buffer.setSize(scaledSize().width(), scaledSize().height()))
             return setFailed();
         buffer.setStatus(allDataReceived ? ImageFrame::FrameComplete : ImageFrame::FramePartial);
         // FIXME: We currently hard code false below because libwebp doesn't support alpha yet.
@@ -132,8 +135,17 @@ bool WEBPImageDecoder::decode(bool onlySize)
     // FIXME: remove this data copy.
     for (int y = m_lastVisibleRow; y < newLastVisibleRow; ++y) {
         const uint8_t* const src = &m_rgbOutput[y * stride];
-        for (int x = 0; x < width; ++x)
-            buffer.setRGBA(x, y, src[bytesPerPixel * x + 0], src[bytesPerPixel * x + 1], src[bytesPerPixel * x + 2], 0xff);
+        if (!m_scaled) {
+            buffer.setRGBRow(0, y, src, width);
+            continue;
+        }
+        int destY = scaledY(y);
+        if (destY < 0)
+            continue;
+        for (size_t x = 0; x < m_scaledColumns.size(); ++x) {
+            const uint8_t* const pixel = src + bytesPerPixel * m_scaledColumns[x];
+            buffer.setRGBA(x, destY, pixel[0], pixel[1], pixel[2], 0xff);
+        }
     }
     m_lastVisibleRow = newLastVisibleRow;
     if (m_lastVisibleRow == height)
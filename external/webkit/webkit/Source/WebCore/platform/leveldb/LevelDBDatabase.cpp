@@ -31,9 +31,11 @@
 #include "LevelDBComparator.h"
 #include "LevelDBIterator.h"
 #include "LevelDBSlice.h"
+#include "LevelDBWriteBatch.h"
 #include <leveldb/comparator.h>
 #include <leveldb/db.h>
 #include <leveldb/slice.h>
+#include <leveldb/write_batch.h>
 #include <string>
 #include <wtf/PassOwnPtr.h>
 #include <wtf/text/CString.h>
@@ -146,6 +148,14 @@ bool LevelDBDatabase::get(const LevelDBSlice& key, Vector<char>& value)
     return true;
 }
 
+bool LevelDBDatabase::write(LevelDBWriteBatch& writeBatch)
+{
+    leveldb::WriteOptions writeOptions;
+    writeOptions.sync = false;
+
+    return m_db->Write(writeOptions, writeBatch.m_writeBatch.get()).ok();
+}
+
 LevelDBIterator* LevelDBDatabase::newIterator()
 {
     leveldb::Iterator* i = m_db->NewIterator(leveldb::ReadOptions());
@@ -42,6 +42,7 @@ namespace WebCore {
 class LevelDBComparator;
 class LevelDBIterator;
 class LevelDBSlice;
+class LevelDBWriteBatch;
 
 class LevelDBDatabase {
 public:
@@ -51,6 +52,7 @@ public:
     bool put(const LevelDBSlice& key, const Vector<char>& value);
     bool remove(const LevelDBSlice& key);
     bool get(const LevelDBSlice& key, Vector<char>& value);
+    bool write(LevelDBWriteBatch&);
     LevelDBIterator* newIterator();
 
 private:
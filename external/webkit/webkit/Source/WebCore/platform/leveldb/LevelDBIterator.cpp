@@ -44,9 +44,9 @@ LevelDBIterator::LevelDBIterator(leveldb::Iterator* it)
 {
 }
 
-static leveldb::Slice makeSlice(const Vector<char>& value)
+static leveldb::Slice makeSlice(const LevelDBSlice& s)
 {
-    return leveldb::Slice(value.data(), value.size());
+    return leveldb::Slice(s.begin(), s.end() - s.begin());
 }
 
 static LevelDBSlice makeLevelDBSlice(leveldb::Slice s)
@@ -64,7 +64,7 @@ void LevelDBIterator::seekToLast()
     m_iterator->SeekToLast();
 }
 
-void LevelDBIterator::seek(const Vector<char>& target)
+void LevelDBIterator::seek(const LevelDBSlice& target)
 {
     m_iterator->Seek(makeSlice(target));
 }
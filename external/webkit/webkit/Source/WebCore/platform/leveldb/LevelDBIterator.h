@@ -45,7 +45,7 @@ public:
 
     bool isValid() const;
     void seekToLast();
-    void seek(const Vector<char>& target);
+    void seek(const LevelDBSlice& target);
     void next();
     void prev();
     LevelDBSlice key() const;
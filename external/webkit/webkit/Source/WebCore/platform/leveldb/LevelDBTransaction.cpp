@@ -0,0 +1,363 @@
+/*
+ * Copyright (C) 2011 Google Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ * 2.  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE AND ITS CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL APPLE OR ITS CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "LevelDBTransaction.h"
+
+#if ENABLE(LEVELDB)
+
+#include "LevelDBComparator.h"
+#include "LevelDBDatabase.h"
+#include "LevelDBIterator.h"
+#include "LevelDBWriteBatch.h"
+
+namespace WebCore {
+
+PassRefPtr<LevelDBTransaction> LevelDBTransaction::create(LevelDBDatabase* db, const LevelDBComparator* comparator)
+{
+    return adoptRef(new LevelDBTransaction(db, comparator));
+}
+
+LevelDBTransaction::LevelDBTransaction(LevelDBDatabase* db, const LevelDBComparator* comparator)
+    : m_db(db)
+    , m_comparator(comparator)
+    , m_treeGeneration(0)
+{
+    m_tree.abstractor().m_comparator = comparator;
+}
+
+LevelDBTransaction::~LevelDBTransaction()
+{
+    ASSERT(m_iterators.isEmpty());
+    clearTree();
+}
+
+int LevelDBTransaction::TreeAbstractor::compare_key_key(const key& a, const key& b)
+{
+    return m_comparator->compare(a, b);
+}
+
+void LevelDBTransaction::clearTree()
+{
+    Vector<TreeNode*> nodes;
+    Tree::Iterator iterator;
+    for (iterator.start_iter_least(m_tree); *iterator; ++iterator)
+        nodes.append(*iterator);
+
+    m_tree.purge();
+    ++m_treeGeneration;
+
+    HashSet<Iterator*>::iterator end = m_iterators.end();
+    for (HashSet<Iterator*>::iterator it = m_iterators.begin(); it != end; ++it)
+        (*it)->treeWasCleared();
+
+    deleteAllValues(nodes);
+}
+
+bool LevelDBTransaction::put(const LevelDBSlice& key, const Vector<char>& value)
+{
+    TreeNode* node = m_tree.search(key);
+    if (!node) {
+        node = new TreeNode;
+        node->key.append(key.begin(), key.end() - key.begin());
+        m_tree.insert(node);
+        ++m_treeGeneration;
+    }
+    node->value = value;
+    node->deleted = false;
+    return true;
+}
+
+bool LevelDBTransaction::remove(const LevelDBSlice& key)
+{
+    TreeNode* node = m_tree.search(key);
+    if (!node) {
+        node = new TreeNode;
+        node->key.append(key.begin(), key.end() - key.begin());
+        m_tree.insert(node);
+        ++m_treeGeneration;
+    }
+    node->value.clear();
+    node->deleted = true;
+    return true;
+}
+
+bool LevelDBTransaction::get(const LevelDBSlice& key, Vector<char>& value)
+{
+    if (TreeNode* node = m_tree.search(key)) {
+        if (node->deleted)
+            return false;
+        value = node->value;
+        return true;
+    }
+    return m_db->get(key, value);
+}
+
+bool LevelDBTransaction::commit()
+{
+    if (m_tree.is_empty())
+        return true;
+
+    OwnPtr<LevelDBWriteBatch> writeBatch = LevelDBWriteBatch::create();
+    Tree::Iterator iterator;
+    for (iterator.start_iter_least(m_tree); *iterator; ++iterator) {
+        TreeNode* node = *iterator;
+        if (node->deleted)
+            writeBatch->remove(node->key);
+        else
+            writeBatch->put(node->key, node->value);
+    }
+
+    bool ok = m_db->write(*writeBatch);
+    clearTree();
+    return ok;
+}
+
+void LevelDBTransaction::rollback()
+{
+    clearTree();
+}
+
+PassOwnPtr<LevelDBTransaction::Iterator> LevelDBTransaction::createIterator()
+{
+    return adoptPtr(new Iterator(this));
+}
+
+LevelDBTransaction::Iterator::Iterator(LevelDBTransaction* transaction)
+    : m_transaction(transaction)
+    , m_databaseIterator(adoptPtr(transaction->m_db->newIterator()))
+    , m_treeGeneration(transaction->m_treeGeneration)
+    , m_forward(true)
+    , m_currentTreeNode(0)
+{
+    m_treeIterator.start_iter_least(m_transaction->m_tree);
+    m_transaction->m_iterators.add(this);
+}
+
+LevelDBTransaction::Iterator::~Iterator()
+{
+    m_transaction->m_iterators.remove(this);
+}
+
+bool LevelDBTransaction::Iterator::databaseIteratorIsValid() const
+{
+    return m_databaseIterator->isValid();
+}
+
+bool LevelDBTransaction::Iterator::treeIteratorIsValid() const
+{
+    return *m_treeIterator;
+}
+
+bool LevelDBTransaction::Iterator::isValid() const
+{
+    return m_currentTreeNode || databaseIteratorIsValid();
+}
+
+int LevelDBTransaction::Iterator::compare(const LevelDBSlice& a, const LevelDBSlice& b) const
+{
+    return m_transaction->m_comparator->compare(a, b);
+}
+
+void LevelDBTransaction::Iterator::seek(const LevelDBSlice& target)
+{
+    m_databaseIterator->seek(target);
+    m_treeIterator.start_iter(m_transaction->m_tree, target, Tree::GREATER_EQUAL);
+    m_treeGeneration = m_transaction->m_treeGeneration;
+    m_forward = true;
+
+    handleConflictsAndDeletes();
+    setCurrentIteratorToBestKey();
+}
+
+void LevelDBTransaction::Iterator::seekToLast()
+{
+    m_databaseIterator->seekToLast();
+    m_treeIterator.start_iter_greatest(m_transaction->m_tree);
+    m_treeGeneration = m_transaction->m_treeGeneration;
+    m_forward = false;
+
+    handleConflictsAndDeletes();
+    setCurrentIteratorToBestKey();
+}
+
+void LevelDBTransaction::Iterator::next()
+{
+    ASSERT(isValid());
+    refreshTreeIteratorIfNeeded();
+
+    if (!m_forward) {
+        // The other iterator is just before the current key; move it to just after it.
+        if (m_currentTreeNode) {
+            LevelDBSlice currentKey = key();
+            m_databaseIterator->seek(currentKey);
+            if (databaseIteratorIsValid() && !compare(m_databaseIterator->key(), currentKey))
+                m_databaseIterator->next();
+        } else
+            m_treeIterator.start_iter(m_transaction->m_tree, m_databaseIterator->key(), Tree::GREATER);
+        m_forward = true;
+    }
+
+    if (m_currentTreeNode)
+        stepTreeIterator(true);
+    else
+        stepDatabaseIterator(true);
+
+    handleConflictsAndDeletes();
+    setCurrentIteratorToBestKey();
+}
+
+void LevelDBTransaction::Iterator::prev()
+{
+    ASSERT(isValid());
+    refreshTreeIteratorIfNeeded();
+
+    if (m_forward) {
+        // The other iterator is just after the current key; move it to just before it.
+        if (m_currentTreeNode) {
+            LevelDBSlice currentKey = key();
+            m_databaseIterator->seek(currentKey);
+            if (databaseIteratorIsValid())
+                m_databaseIterator->prev();
+            else
+                m_databaseIterator->seekToLast();
+        } else
+            m_treeIterator.start_iter(m_transaction->m_tree, m_databaseIterator->key(), Tree::LESS);
+        m_forward = false;
+    }
+
+    if (m_currentTreeNode)
+        stepTreeIterator(false);
+    else
+        stepDatabaseIterator(false);
+
+    handleConflictsAndDeletes();
+    setCurrentIteratorToBestKey();
+}
+
+LevelDBSlice LevelDBTransaction::Iterator::key() const
+{
+    ASSERT(isValid());
+    if (m_currentTreeNode)
+        return m_currentTreeNode->key;
+    return m_databaseIterator->key();
+}
+
+LevelDBSlice LevelDBTransaction::Iterator::value() const
+{
+    ASSERT(isValid());
+    if (m_currentTreeNode)
+        return m_currentTreeNode->value;
+    return m_databaseIterator->value();
+}
+
+void LevelDBTransaction::Iterator::stepDatabaseIterator(bool forward)
+{
+    if (forward)
+        m_databaseIterator->next();
+    else
+        m_databaseIterator->prev();
+}
+
+void LevelDBTransaction::Iterator::stepTreeIterator(bool forward)
+{
+    if (forward)
+        ++m_treeIterator;
+    else
+        --m_treeIterator;
+}
+
+void LevelDBTransaction::Iterator::handleConflictsAndDeletes()
+{
+    bool loop = true;
+    while (loop) {
+        loop = false;
+
+        // The transaction's write to a key hides the database's record for it.
+        if (treeIteratorIsValid() && databaseIteratorIsValid() && !compare((*m_treeIterator)->key, m_databaseIterator->key())) {
+            stepDatabaseIterator(m_forward);
+            loop = true;
+        }
+
+        // A removed key is skipped once the database iterator has moved past it, so that it still hides the
+        // database's record.
+        if (treeIteratorIsValid() && (*m_treeIterator)->deleted) {
+            if (!databaseIteratorIsValid()
+                || (m_forward && compare((*m_treeIterator)->key, m_databaseIterator->key()) < 0)
+                || (!m_forward && compare((*m_treeIterator)->key, m_databaseIterator->key()) > 0)) {
+                stepTreeIterator(m_forward);
+                loop = true;
+            }
+        }
+    }
+}
+
+void LevelDBTransaction::Iterator::setCurrentIteratorToBestKey()
+{
+    m_currentTreeNode = 0;
+    if (!treeIteratorIsValid())
+        return;
+    if (databaseIteratorIsValid()) {
+        int result = compare((*m_treeIterator)->key, m_databaseIterator->key());
+        if (m_forward ? result >= 0 : result <= 0)
+            return;
+    }
+    m_currentTreeNode = *m_treeIterator;
+}
+
+void LevelDBTransaction::Iterator::refreshTreeIteratorIfNeeded()
+{
+    if (m_treeGeneration == m_transaction->m_treeGeneration)
+        return;
+    m_treeGeneration = m_transaction->m_treeGeneration;
+
+    // Inserting may have rebalanced the tree, so the path the tree iterator recorded is stale. Nodes are not
+    // freed until the tree is cleared, so the current node can still be used to find the way back.
+    if (m_currentTreeNode) {
+        m_treeIterator.start_iter(m_transaction->m_tree, m_currentTreeNode->key);
+        return;
+    }
+
+    LevelDBSlice currentKey = m_databaseIterator->key();
+    m_treeIterator.start_iter(m_transaction->m_tree, currentKey, m_forward ? Tree::GREATER_EQUAL : Tree::LESS_EQUAL);
+    if (treeIteratorIsValid() && !compare((*m_treeIterator)->key, currentKey)) {
+        // The current key was written to since the last step; the write now hides the database's record.
+        m_currentTreeNode = *m_treeIterator;
+        stepDatabaseIterator(m_forward);
+    }
+}
+
+void LevelDBTransaction::Iterator::treeWasCleared()
+{
+    // The transaction has ended; start over with a fresh view of the database at the next seek.
+    m_databaseIterator = adoptPtr(m_transaction->m_db->newIterator());
+    m_treeIterator.start_iter_least(m_transaction->m_tree);
+    m_treeGeneration = m_transaction->m_treeGeneration;
+    m_currentTreeNode = 0;
+}
+
+} // namespace WebCore
+
+#endif // ENABLE(LEVELDB)
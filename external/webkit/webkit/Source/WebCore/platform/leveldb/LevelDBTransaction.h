@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2011 Google Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ * 2.  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE AND ITS CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL APPLE OR ITS CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LevelDBTransaction_h
+#define LevelDBTransaction_h
+
+#if ENABLE(LEVELDB)
+
+#include "LevelDBSlice.h"
+#include <wtf/AVLTree.h>
+#include <wtf/HashSet.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/OwnPtr.h>
+#include <wtf/PassOwnPtr.h>
+#include <wtf/PassRefPtr.h>
+#include <wtf/RefCounted.h>
+#include <wtf/Vector.h>
+
+namespace WebCore {
+
+class LevelDBComparator;
+class LevelDBDatabase;
+class LevelDBIterator;
+
+// Keeps the writes made to a LevelDBDatabase in memory, ordered by the database's comparator, until they are
+// committed as one write batch. Reads and iterators see the transaction's own writes on top of the database.
+class LevelDBTransaction : public RefCounted<LevelDBTransaction> {
+public:
+    static PassRefPtr<LevelDBTransaction> create(LevelDBDatabase*, const LevelDBComparator*);
+    ~LevelDBTransaction();
+
+    bool put(const LevelDBSlice& key, const Vector<char>& value);
+    bool remove(const LevelDBSlice& key);
+    bool get(const LevelDBSlice& key, Vector<char>& value);
+    bool commit();
+    void rollback();
+
+private:
+    struct TreeNode {
+        WTF_MAKE_FAST_ALLOCATED;
+    public:
+        Vector<char> key;
+        Vector<char> value;
+        bool deleted;
+
+        TreeNode* less;
+        TreeNode* greater;
+        int balanceFactor;
+    };
+
+    struct TreeAbstractor {
+        typedef TreeNode* handle;
+        typedef size_t size;
+        typedef LevelDBSlice key;
+
+        handle get_less(handle h) { return h->less; }
+        void set_less(handle h, handle less) { h->less = less; }
+        handle get_greater(handle h) { return h->greater; }
+        void set_greater(handle h, handle greater) { h->greater = greater; }
+
+        int get_balance_factor(handle h) { return h->balanceFactor; }
+        void set_balance_factor(handle h, int balanceFactor) { h->balanceFactor = balanceFactor; }
+
+        int compare_key_key(const key& a, const key& b);
+        int compare_key_node(const key& k, handle h) { return compare_key_key(k, h->key); }
+        int compare_node_node(handle a, handle b) { return compare_key_key(a->key, b->key); }
+
+        static handle null() { return 0; }
+
+        const LevelDBComparator* m_comparator;
+    };
+
+    typedef WTF::AVLTree<TreeAbstractor> Tree;
+
+public:
+    // Iterates over the database and the transaction's writes merged together. Writes made to the transaction
+    // while the iterator is in use are seen from the next step on.
+    class Iterator {
+        WTF_MAKE_NONCOPYABLE(Iterator); WTF_MAKE_FAST_ALLOCATED;
+    public:
+        ~Iterator();
+
+        bool isValid() const;
+        void seekToLast();
+        void seek(const LevelDBSlice& target);
+        void next();
+        void prev();
+        LevelDBSlice key() const;
+        LevelDBSlice value() const;
+
+    private:
+        friend class LevelDBTransaction;
+        Iterator(LevelDBTransaction*);
+
+        bool databaseIteratorIsValid() const;
+        bool treeIteratorIsValid() const;
+        int compare(const LevelDBSlice&, const LevelDBSlice&) const;
+        void stepDatabaseIterator(bool forward);
+        void stepTreeIterator(bool forward);
+        void handleConflictsAndDeletes();
+        void setCurrentIteratorToBestKey();
+        void refreshTreeIteratorIfNeeded();
+        void treeWasCleared();
+
+        RefPtr<LevelDBTransaction> m_transaction;
+        OwnPtr<LevelDBIterator> m_databaseIterator;
+        mutable Tree::Iterator m_treeIterator;
+        unsigned m_treeGeneration;
+        bool m_forward;
+        // The transaction's write the iterator is at, or 0 if it is at a database record. Kept apart from the
+        // tree iterator, which only finds its way back to the node at the next step after the tree changed.
+        TreeNode* m_currentTreeNode;
+    };
+
+    PassOwnPtr<Iterator> createIterator();
+
+private:
+    LevelDBTransaction(LevelDBDatabase*, const LevelDBComparator*);
+
+    void clearTree();
+
+    LevelDBDatabase* m_db;
+    const LevelDBComparator* m_comparator;
+    Tree m_tree;
+    HashSet<Iterator*> m_iterators;
+    // Bumped whenever a node is added to or removed from the tree, so that iterators know to find their place in it again.
+    unsigned m_treeGeneration;
+};
+
+} // namespace WebCore
+
+#endif // ENABLE(LEVELDB)
+#endif // LevelDBTransaction_h
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2011 Google Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ * 2.  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE AND ITS CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL APPLE OR ITS CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "LevelDBWriteBatch.h"
+
+#if ENABLE(LEVELDB)
+
+#include "LevelDBSlice.h"
+#include <leveldb/slice.h>
+#include <leveldb/write_batch.h>
+
+namespace WebCore {
+
+static leveldb::Slice makeSlice(const LevelDBSlice& s)
+{
+    return leveldb::Slice(s.begin(), s.end() - s.begin());
+}
+
+PassOwnPtr<LevelDBWriteBatch> LevelDBWriteBatch::create()
+{
+    return adoptPtr(new LevelDBWriteBatch);
+}
+
+LevelDBWriteBatch::LevelDBWriteBatch()
+    : m_writeBatch(adoptPtr(new leveldb::WriteBatch))
+{
+}
+
+LevelDBWriteBatch::~LevelDBWriteBatch()
+{
+}
+
+void LevelDBWriteBatch::put(const LevelDBSlice& key, const LevelDBSlice& value)
+{
+    m_writeBatch->Put(makeSlice(key), makeSlice(value));
+}
+
+void LevelDBWriteBatch::remove(const LevelDBSlice& key)
+{
+    m_writeBatch->Delete(makeSlice(key));
+}
+
+void LevelDBWriteBatch::clear()
+{
+    m_writeBatch->Clear();
+}
+
+} // namespace WebCore
+
+#endif // ENABLE(LEVELDB)
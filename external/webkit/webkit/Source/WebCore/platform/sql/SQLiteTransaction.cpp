@@ -36,6 +36,7 @@ SQLiteTransaction::SQLiteTransaction(SQLiteDatabase& db, bool readOnly)
     : m_db(db)
     , m_inProgress(false)
     , m_readOnly(readOnly)
+    , m_isSavepoint(false)
 {
 }
 
@@ -64,8 +65,22 @@ void SQLiteTransaction::begin()
     }
 }
 
+void SQLiteTransaction::beginSavepoint()
+{
+    if (!m_inProgress) {
+        ASSERT(m_db.m_transactionInProgress);
+        m_isSavepoint = true;
+        m_inProgress = m_db.executeCommand("SAVEPOINT WebKitSavepoint");
+    }
+}
+
 void SQLiteTransaction::commit()
 {
+    if (m_inProgress && m_isSavepoint) {
+        m_inProgress = !m_db.executeCommand("RELEASE WebKitSavepoint");
+        return;
+    }
+
     if (m_inProgress) {
         ASSERT(m_db.m_transactionInProgress);
         m_inProgress = !m_db.executeCommand("COMMIT");
@@ -79,6 +94,13 @@ void SQLiteTransaction::rollback()
     // because m_inProgress should always be set to false after a ROLLBACK, and
     // m_db.executeCommand("ROLLBACK") can sometimes harmlessly fail, thus returning
     // a non-zero/true result (http://www.sqlite.org/lang_transaction.html).
+    if (m_inProgress && m_isSavepoint) {
+        m_db.executeCommand("ROLLBACK TO WebKitSavepoint");
+        m_db.executeCommand("RELEASE WebKitSavepoint");
+        m_inProgress = false;
+        return;
+    }
+
     if (m_inProgress) {
         ASSERT(m_db.m_transactionInProgress);
         m_db.executeCommand("ROLLBACK");
@@ -91,7 +113,8 @@ void SQLiteTransaction::stop()
 {
     if (m_inProgress) {
         m_inProgress = false;
-        m_db.m_transactionInProgress = false;
+        if (!m_isSavepoint)
+            m_db.m_transactionInProgress = false;
     }
 }
 
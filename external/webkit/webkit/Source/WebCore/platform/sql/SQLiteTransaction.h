@@ -40,6 +40,10 @@ public:
     ~SQLiteTransaction();
     
     void begin();
+    // Opens a savepoint inside the transaction that is already in progress on
+    // the database, instead of a transaction of its own. commit() releases
+    // the savepoint and rollback() undoes only what was done since it opened.
+    void beginSavepoint();
     void commit();
     void rollback();
     void stop();
@@ -50,6 +54,7 @@ private:
     SQLiteDatabase& m_db;
     bool m_inProgress;
     bool m_readOnly;
+    bool m_isSavepoint;
 };
 
 } // namespace WebCore
@@ -32,20 +32,30 @@ class SegmentedSubstring {
 public:
     SegmentedSubstring()
         : m_length(0)
-        , m_current(0)
+        , m_is8Bit(false)
         , m_doNotExcludeLineNumbers(true)
     {
+        m_data.string16Ptr = 0;
     }
 
     SegmentedSubstring(const String& str)
         : m_length(str.length())
-        , m_current(str.isEmpty() ? 0 : str.characters())
+        , m_is8Bit(false)
         , m_string(str)
         , m_doNotExcludeLineNumbers(true)
     {
+        // Latin-1 input is read in place, so the tokenizer never forces the
+        // string to build a UTF-16 copy of itself.
+        if (!m_length)
+            m_data.string16Ptr = 0;
+        else if (str.is8Bit()) {
+            m_is8Bit = true;
+            m_data.string8Ptr = str.characters8();
+        } else
+            m_data.string16Ptr = str.characters();
     }
 
-    void clear() { m_length = 0; m_current = 0; }
+    void clear() { m_length = 0; m_is8Bit = false; m_data.string16Ptr = 0; }
     
     bool excludeLineNumbers() const { return !m_doNotExcludeLineNumbers; }
     bool doNotExcludeLineNumbers() const { return m_doNotExcludeLineNumbers; }
@@ -54,22 +64,43 @@ public:
 
     int numberOfCharactersConsumed() const { return m_string.length() - m_length; }
 
+    bool is8Bit() const { return m_is8Bit; }
+    const LChar* characters8() const { ASSERT(m_is8Bit); return m_data.string8Ptr; }
+    const UChar* characters16() const { ASSERT(!m_is8Bit); return m_data.string16Ptr; }
+
+    UChar getCurrentChar() const
+    {
+        ASSERT(m_length);
+        return m_is8Bit ? *m_data.string8Ptr : *m_data.string16Ptr;
+    }
+
+    UChar incrementAndGetCurrentChar()
+    {
+        ASSERT(m_length);
+        return m_is8Bit ? *++m_data.string8Ptr : *++m_data.string16Ptr;
+    }
+
     void appendTo(String& str) const
     {
-        if (m_string.characters() == m_current) {
+        int offset = numberOfCharactersConsumed();
+        if (!offset) {
             if (str.isEmpty())
                 str = m_string;
             else
                 str.append(m_string);
         } else
-            str.append(String(m_current, m_length));
+            str.append(m_string.substring(offset, m_length));
     }
 
 public:
     int m_length;
-    const UChar* m_current;
 
 private:
+    union {
+        const LChar* string8Ptr;
+        const UChar* string16Ptr;
+    } m_data;
+    bool m_is8Bit;
     String m_string;
     bool m_doNotExcludeLineNumbers;
 };
@@ -91,7 +122,7 @@ public:
         : m_pushedChar1(0)
         , m_pushedChar2(0)
         , m_currentString(str)
-        , m_currentChar(m_currentString.m_current)
+        , m_currentChar(m_currentString.m_length ? m_currentString.getCurrentChar() : 0)
         , m_numberOfCharactersConsumedPriorToCurrentString(0)
         , m_numberOfCharactersConsumedPriorToCurrentLine(0)
         , m_currentLine(0)
@@ -116,14 +147,14 @@ public:
     {
         if (!m_pushedChar1) {
             m_pushedChar1 = c;
-            m_currentChar = m_pushedChar1 ? &m_pushedChar1 : m_currentString.m_current;
+            m_currentChar = m_pushedChar1 ? m_pushedChar1 : (m_currentString.m_length ? m_currentString.getCurrentChar() : 0);
         } else {
             ASSERT(!m_pushedChar2);
             m_pushedChar2 = c;
         }
     }
 
-    bool isEmpty() const { return !current(); }
+    bool isEmpty() const { return !m_pushedChar1 && !m_currentString.m_length; }
     unsigned length() const;
 
     bool isClosed() const { return m_closed; }
@@ -134,14 +165,14 @@ public:
         NotEnoughCharacters,
     };
 
-    LookAheadResult lookAhead(const String& string) { return lookAheadInline<SegmentedString::equalsLiterally>(string); }
-    LookAheadResult lookAheadIgnoringCase(const String& string) { return lookAheadInline<SegmentedString::equalsIgnoringCase>(string); }
+    LookAheadResult lookAhead(const String& string) { return lookAheadInline(string, true); }
+    LookAheadResult lookAheadIgnoringCase(const String& string) { return lookAheadInline(string, false); }
 
     void advance()
     {
         if (!m_pushedChar1 && m_currentString.m_length > 1) {
             --m_currentString.m_length;
-            m_currentChar = ++m_currentString.m_current;
+            m_currentChar = m_currentString.incrementAndGetCurrentChar();
             return;
         }
         advanceSlowCase();
@@ -149,19 +180,19 @@ public:
 
     void advanceAndASSERT(UChar expectedCharacter)
     {
-        ASSERT_UNUSED(expectedCharacter, *current() == expectedCharacter);
+        ASSERT_UNUSED(expectedCharacter, currentChar() == expectedCharacter);
         advance();
     }
 
     void advanceAndASSERTIgnoringCase(UChar expectedCharacter)
     {
-        ASSERT_UNUSED(expectedCharacter, WTF::Unicode::foldCase(*current()) == WTF::Unicode::foldCase(expectedCharacter));
+        ASSERT_UNUSED(expectedCharacter, WTF::Unicode::foldCase(currentChar()) == WTF::Unicode::foldCase(expectedCharacter));
         advance();
     }
 
     void advancePastNewline(int& lineNumber)
     {
-        ASSERT(*current() == '\n');
+        ASSERT(currentChar() == '\n');
         if (!m_pushedChar1 && m_currentString.m_length > 1) {
             int newLineFlag = m_currentString.doNotExcludeLineNumbers();
             lineNumber += newLineFlag;
@@ -169,7 +200,7 @@ public:
             if (newLineFlag)
                 m_numberOfCharactersConsumedPriorToCurrentLine = numberOfCharactersConsumed() + 1;
             --m_currentString.m_length;
-            m_currentChar = ++m_currentString.m_current;
+            m_currentChar = m_currentString.incrementAndGetCurrentChar();
             return;
         }
         advanceSlowCase(lineNumber);
@@ -177,10 +208,10 @@ public:
     
     void advancePastNonNewline()
     {
-        ASSERT(*current() != '\n');
+        ASSERT(currentChar() != '\n');
         if (!m_pushedChar1 && m_currentString.m_length > 1) {
             --m_currentString.m_length;
-            m_currentChar = ++m_currentString.m_current;
+            m_currentChar = m_currentString.incrementAndGetCurrentChar();
             return;
         }
         advanceSlowCase();
@@ -189,13 +220,13 @@ public:
     void advance(int& lineNumber)
     {
         if (!m_pushedChar1 && m_currentString.m_length > 1) {
-            int newLineFlag = (*m_currentString.m_current == '\n') & m_currentString.doNotExcludeLineNumbers();
+            int newLineFlag = (m_currentChar == '\n') & m_currentString.doNotExcludeLineNumbers();
             lineNumber += newLineFlag;
             m_currentLine += newLineFlag;
             if (newLineFlag)
                 m_numberOfCharactersConsumedPriorToCurrentLine = numberOfCharactersConsumed() + 1;
             --m_currentString.m_length;
-            m_currentChar = ++m_currentString.m_current;
+            m_currentChar = m_currentString.incrementAndGetCurrentChar();
             return;
         }
         advanceSlowCase(lineNumber);
@@ -220,8 +251,7 @@ public:
 
     String toString() const;
 
-    const UChar& operator*() const { return *current(); }
-    const UChar* operator->() const { return current(); }
+    UChar operator*() const { return currentChar(); }
     
 
     // The method is moderately slow, comparing to currentLine method.
@@ -238,24 +268,37 @@ private:
     void advanceSlowCase();
     void advanceSlowCase(int& lineNumber);
     void advanceSubstring();
-    const UChar* current() const { return m_currentChar; }
+    UChar currentChar() const { return m_currentChar; }
+    void updateCurrentChar() { m_currentChar = m_pushedChar1 ? m_pushedChar1 : (m_currentString.m_length ? m_currentString.getCurrentChar() : 0); }
+
+    static bool equals(const UChar* str1, const UChar* str2, size_t count, bool caseSensitive)
+    {
+        if (caseSensitive)
+            return !memcmp(str1, str2, count * sizeof(UChar));
+        return !WTF::Unicode::umemcasecmp(str1, str2, count);
+    }
 
-    static bool equalsLiterally(const UChar* str1, const UChar* str2, size_t count) { return !memcmp(str1, str2, count * sizeof(UChar)); }
-    static bool equalsIgnoringCase(const UChar* str1, const UChar* str2, size_t count) { return !WTF::Unicode::umemcasecmp(str1, str2, count); }
+    static bool equals(const UChar* str1, const LChar* str2, size_t count, bool caseSensitive)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            if (caseSensitive ? str1[i] != str2[i] : WTF::Unicode::foldCase(str1[i]) != WTF::Unicode::foldCase(str2[i]))
+                return false;
+        }
+        return true;
+    }
 
-    template<bool equals(const UChar* str1, const UChar* str2, size_t count)>
-    inline LookAheadResult lookAheadInline(const String& string)
+    inline LookAheadResult lookAheadInline(const String& string, bool caseSensitive)
     {
         if (!m_pushedChar1 && string.length() <= static_cast<unsigned>(m_currentString.m_length)) {
-            if (equals(string.characters(), m_currentString.m_current, string.length()))
-                return DidMatch;
-            return DidNotMatch;
+            bool matched = m_currentString.is8Bit()
+                ? equals(string.characters(), m_currentString.characters8(), string.length(), caseSensitive)
+                : equals(string.characters(), m_currentString.characters16(), string.length(), caseSensitive);
+            return matched ? DidMatch : DidNotMatch;
         }
-        return lookAheadSlowCase<equals>(string);
+        return lookAheadSlowCase(string, caseSensitive);
     }
 
-    template<bool equals(const UChar* str1, const UChar* str2, size_t count)>
-    LookAheadResult lookAheadSlowCase(const String& string)
+    LookAheadResult lookAheadSlowCase(const String& string, bool caseSensitive)
     {
         unsigned count = string.length();
         if (count > length())
@@ -264,7 +307,7 @@ private:
         String consumedString = String::createUninitialized(count, consumedCharacters);
         advance(count, consumedCharacters);
         LookAheadResult result = DidNotMatch;
-        if (equals(string.characters(), consumedCharacters, count))
+        if (equals(string.characters(), consumedCharacters, count, caseSensitive))
             result = DidMatch;
         prepend(SegmentedString(consumedString));
         return result;
@@ -275,7 +318,7 @@ private:
     UChar m_pushedChar1;
     UChar m_pushedChar2;
     SegmentedSubstring m_currentString;
-    const UChar* m_currentChar;
+    UChar m_currentChar;
     int m_numberOfCharactersConsumedPriorToCurrentString;
     int m_numberOfCharactersConsumedPriorToCurrentLine;
     int m_currentLine;
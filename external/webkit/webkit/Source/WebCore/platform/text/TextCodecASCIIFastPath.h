@@ -28,6 +28,11 @@
 #define TextCodecASCIIFastPath_h
 
 #include <stdint.h>
+#include <wtf/ASCIICType.h>
+
+#if CPU(X86_SSE2) && COMPILER(GCC)
+#include <emmintrin.h>
+#endif
 
 namespace WebCore {
 
@@ -91,6 +96,61 @@ template<typename T> inline T* alignToMachineWord(T* pointer)
     return reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(pointer) & ~machineWordAlignmentMask);
 }
 
+// Widens the run of ASCII characters at the start of [source, end) into
+// |destination| and returns its length. With SSE2 this goes 16 bytes at a
+// time and widens whole blocks before knowing where in them the run ends, so
+// |destination| must have room for one character per byte in [source, end);
+// anything written past the run is for the caller to overwrite.
+inline size_t copyASCIIRun(UChar* destination, const uint8_t* source, const uint8_t* end)
+{
+    const uint8_t* start = source;
+#if CPU(X86_SSE2) && COMPILER(GCC)
+    const __m128i zero = _mm_setzero_si128();
+    while (end - source >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination), _mm_unpacklo_epi8(chunk, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + 8), _mm_unpackhi_epi8(chunk, zero));
+        if (int nonASCIIMask = _mm_movemask_epi8(chunk))
+            return source - start + __builtin_ctz(nonASCIIMask);
+        source += 16;
+        destination += 16;
+    }
+#else
+    const uint8_t* alignedEnd = alignToMachineWord(end);
+    while (source < alignedEnd && !isAlignedToMachineWord(source) && isASCII(*source))
+        *destination++ = *source++;
+    if (isAlignedToMachineWord(source)) {
+        while (source < alignedEnd) {
+            MachineWord chunk = *reinterpret_cast_ptr<const MachineWord*>(source);
+            if (!isAllASCII(chunk))
+                break;
+            copyASCIIMachineWord(destination, source);
+            source += sizeof(MachineWord);
+            destination += sizeof(MachineWord);
+        }
+    }
+#endif
+    while (source < end && isASCII(*source))
+        *destination++ = *source++;
+    return source - start;
+}
+
+// Returns the length of the run of ASCII characters at the start of [source, end).
+inline size_t asciiRunLength(const uint8_t* source, const uint8_t* end)
+{
+    const uint8_t* start = source;
+    const uint8_t* alignedEnd = alignToMachineWord(end);
+    while (source < alignedEnd && !isAlignedToMachineWord(source) && isASCII(*source))
+        ++source;
+    if (isAlignedToMachineWord(source)) {
+        while (source < alignedEnd && isAllASCII(*reinterpret_cast_ptr<const MachineWord*>(source)))
+            source += sizeof(MachineWord);
+    }
+    while (source < end && isASCII(*source))
+        ++source;
+    return source - start;
+}
+
 } // namespace WebCore
 
 #endif // TextCodecASCIIFastPath_h
@@ -69,6 +69,35 @@ static const UChar table[256] = {
     0x00F8, 0x00F9, 0x00FA, 0x00FB, 0x00FC, 0x00FD, 0x00FE, 0x00FF  // F8-FF
 };
 
+// Windows Latin-1 only differs from ISO-8859-1 in 0x80-0x9F; every other byte
+// decodes to the code point of the same value. Widens the run of such bytes at
+// the start of [source, end) into |destination| and returns its length, with
+// the same contract as copyASCIIRun().
+static inline size_t copyUnmappedRun(UChar* destination, const uint8_t* source, const uint8_t* end)
+{
+#if CPU(X86_SSE2) && COMPILER(GCC)
+    const uint8_t* start = source;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i topThreeBits = _mm_set1_epi8(static_cast<char>(0xE0));
+    const __m128i mappedRangeStart = _mm_set1_epi8(static_cast<char>(0x80));
+    while (end - source >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination), _mm_unpacklo_epi8(chunk, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + 8), _mm_unpackhi_epi8(chunk, zero));
+        if (int mappedMask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(chunk, topThreeBits), mappedRangeStart)))
+            return source - start + __builtin_ctz(mappedMask);
+        source += 16;
+        destination += 16;
+    }
+    while (source < end && (*source & 0xE0) != 0x80)
+        *destination++ = *source++;
+    return source - start;
+#else
+    // Bytes above 0x9F go through the table, which maps them to themselves.
+    return copyASCIIRun(destination, source, end);
+#endif
+}
+
 void TextCodecLatin1::registerEncodingNames(EncodingNameRegistrar registrar)
 {
     registrar("windows-1252", "windows-1252");
@@ -118,40 +147,32 @@ void TextCodecLatin1::registerCodecs(TextCodecRegistrar registrar)
 
 String TextCodecLatin1::decode(const char* bytes, size_t length, bool, bool, bool&)
 {
-    UChar* characters;
-    String result = String::createUninitialized(length, characters);
-
     const uint8_t* source = reinterpret_cast<const uint8_t*>(bytes);
     const uint8_t* end = reinterpret_cast<const uint8_t*>(bytes + length);
-    const uint8_t* alignedEnd = alignToMachineWord(end);
+
+    // Unless the text uses one of the Windows-only characters in 0x80-0x9F,
+    // every byte decodes to itself and the bytes can be kept as an 8-bit string.
+    const uint8_t* firstWideCharacter = source;
+    while (firstWideCharacter < end && table[*firstWideCharacter] <= 0xFF)
+        ++firstWideCharacter;
+    if (firstWideCharacter == end) {
+        LChar* characters8;
+        String result = String::createUninitialized(length, characters8);
+        memcpy(characters8, bytes, length);
+        return result;
+    }
+
+    UChar* characters;
+    String result = String::createUninitialized(length, characters);
     UChar* destination = characters;
 
     while (source < end) {
-        if (isASCII(*source)) {
-            // Fast path for ASCII. Most Latin-1 text will be ASCII.
-            if (isAlignedToMachineWord(source)) {
-                while (source < alignedEnd) {
-                    MachineWord chunk = *reinterpret_cast_ptr<const MachineWord*>(source);
-
-                    if (!isAllASCII(chunk))
-                        goto useLookupTable;
-
-                    copyASCIIMachineWord(destination, source);
-                    source += sizeof(MachineWord);
-                    destination += sizeof(MachineWord);
-                }
-
-                if (source == end)
-                    break;
-            }
-            *destination = *source;
-        } else {
-useLookupTable:
-            *destination = table[*source];
-        }
-
-        ++source;
-        ++destination;
+        size_t count = copyUnmappedRun(destination, source, end);
+        source += count;
+        destination += count;
+        if (source == end)
+            break;
+        *destination++ = table[*source++];
     }
 
     return result;
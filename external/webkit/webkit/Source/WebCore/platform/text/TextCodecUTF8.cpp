@@ -150,6 +150,29 @@ static inline UChar* appendCharacter(UChar* destination, int character)
     return destination;
 }
 
+// Decodes a run of two and three byte sequences, which is what most non-Latin
+// text is made of, with only the checks those need. Stops at the first byte
+// that starts anything else, including a sequence that is invalid, truncated
+// or needs the general path's checks (0xE0 and 0xED).
+static inline void decodeMultibyteRun(UChar*& destination, const uint8_t*& source, const uint8_t* end)
+{
+    while (source < end) {
+        uint8_t first = *source;
+        if (first >= 0xC2 && first <= 0xDF) {
+            if (end - source < 2 || (source[1] & 0xC0) != 0x80)
+                return;
+            *destination++ = ((first & 0x1F) << 6) | (source[1] & 0x3F);
+            source += 2;
+        } else if (first >= 0xE1 && first <= 0xEF && first != 0xED) {
+            if (end - source < 3 || (source[1] & 0xC0) != 0x80 || (source[2] & 0xC0) != 0x80)
+                return;
+            *destination++ = ((first & 0x0F) << 12) | ((source[1] & 0x3F) << 6) | (source[2] & 0x3F);
+            source += 3;
+        } else
+            return;
+    }
+}
+
 void TextCodecUTF8::consumePartialSequenceByte()
 {
     --m_partialSequenceSize;
@@ -215,6 +238,15 @@ void TextCodecUTF8::handlePartialSequence(UChar*& destination, const uint8_t*& s
 
 String TextCodecUTF8::decode(const char* bytes, size_t length, bool flush, bool stopOnError, bool& sawError)
 {
+    // ASCII decodes to the same bytes, so a chunk that is all ASCII becomes an
+    // 8-bit string that the tokenizer reads without widening.
+    if (!m_partialSequenceSize && asciiRunLength(reinterpret_cast<const uint8_t*>(bytes), reinterpret_cast<const uint8_t*>(bytes + length)) == length) {
+        LChar* characters;
+        String result = String::createUninitialized(length, characters);
+        memcpy(characters, bytes, length);
+        return result;
+    }
+
     // Each input byte might turn into a character.
     // That includes all bytes in the partial-sequence buffer because
     // each byte in an invalid sequence will turn into a replacement character.
@@ -222,7 +254,6 @@ String TextCodecUTF8::decode(const char* bytes, size_t length, bool flush, bool
 
     const uint8_t* source = reinterpret_cast<const uint8_t*>(bytes);
     const uint8_t* end = source + length;
-    const uint8_t* alignedEnd = alignToMachineWord(end);
     UChar* destination = buffer.characters();
 
     do {
@@ -241,24 +272,18 @@ String TextCodecUTF8::decode(const char* bytes, size_t length, bool flush, bool
 
         while (source < end) {
             if (isASCII(*source)) {
-                // Fast path for ASCII. Most UTF-8 text will be ASCII.
-                if (isAlignedToMachineWord(source)) {
-                    while (source < alignedEnd) {
-                        MachineWord chunk = *reinterpret_cast_ptr<const MachineWord*>(source);
-                        if (!isAllASCII(chunk))
-                            break;
-                        copyASCIIMachineWord(destination, source);
-                        source += sizeof(MachineWord);
-                        destination += sizeof(MachineWord);
-                    }
-                    if (source == end)
-                        break;
-                    if (!isASCII(*source))
-                        continue;
-                }
-                *destination++ = *source++;
+                // Fast path for ASCII. Most UTF-8 text will be ASCII. Each
+                // byte turns into at most one character, so the buffer always
+                // has room for the kernel's whole-block writes.
+                size_t asciiCount = copyASCIIRun(destination, source, end);
+                source += asciiCount;
+                destination += asciiCount;
                 continue;
             }
+            const uint8_t* runStart = source;
+            decodeMultibyteRun(destination, source, end);
+            if (source != runStart)
+                continue;
             int count = nonASCIISequenceLength(*source);
             int character;
             if (!count)
@@ -2171,12 +2171,16 @@ void RenderBlock::simplifiedNormalFlowLayout()
 
 bool RenderBlock::simplifiedLayout()
 {
-    if ((!posChildNeedsLayout() && !needsSimplifiedNormalFlowLayout()) || normalChildNeedsLayout() || selfNeedsLayout())
+    if ((!posChildNeedsLayout() && !needsSimplifiedNormalFlowLayout() && !needsPositionedMovementLayout()) || normalChildNeedsLayout() || selfNeedsLayout())
         return false;
 
     LayoutStateMaintainer statePusher(view(), this, IntSize(x(), y()), hasColumns() || hasTransform() || hasReflection() || style()->isFlippedBlocksWritingMode());
     
-    if (needsPositionedMovementLayout() && !tryLayoutDoingPositionedMovementOnly())
+    // Only positioned objects compute their position along with their size. The other
+    // boxes that just moved, because of their relative offsets or their transform,
+    // keep the size they have.
+    IntSize oldSize = size();
+    if (needsPositionedMovementLayout() && isPositioned() && !tryLayoutDoingPositionedMovementOnly())
         return false;
 
     // Lay out positioned descendants or objects that just need to recompute overflow.
@@ -2192,8 +2196,11 @@ bool RenderBlock::simplifiedLayout()
     // updating our overflow if we either used to have overflow or if the new temporary object has overflow.
     // For now just always recompute overflow.  This is no worse performance-wise than the old code that called rightmostPosition and
     // lowestPosition on every relayout so it's not a regression.
-    m_overflow.clear();
-    computeOverflow(clientLogicalBottom(), true);
+    // A box that only moved, and kept its size, keeps its overflow as well.
+    if (posChildNeedsLayout() || needsSimplifiedNormalFlowLayout() || size() != oldSize) {
+        m_overflow.clear();
+        computeOverflow(clientLogicalBottom(), true);
+    }
 
     statePusher.pop();
     
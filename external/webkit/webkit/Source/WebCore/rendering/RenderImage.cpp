@@ -39,13 +39,10 @@
 #include "RenderLayer.h"
 #include "RenderView.h"
 #include "SelectionController.h"
+#include "Settings.h"
 #include "TextRun.h"
 #include <wtf/UnusedParam.h>
 
-#ifdef ANDROID_LAYOUT
-#include "Settings.h"
-#endif
-
 #if ENABLE(WML)
 #include "WMLImageElement.h"
 #include "WMLNames.h"
@@ -390,6 +387,12 @@ void RenderImage::paintIntoRect(GraphicsContext* context, const IntRect& rect)
     if (!img || img->isNull())
         return;
 
+    // Printing cannot wait for the image to be decoded elsewhere.
+    Settings* settings = document()->settings();
+    if (settings && settings->asynchronousImageDecodingEnabled() && !document()->printing()
+        && !img->prepareCurrentFrameForPainting(context->getCTM().mapRect(rect).size()))
+        return;
+
     HTMLImageElement* imageElt = (node() && node()->hasTagName(imgTag)) ? static_cast<HTMLImageElement*>(node()) : 0;
     CompositeOperator compositeOperator = imageElt ? imageElt->compositeOperator() : CompositeSourceOver;
     Image* image = m_imageResource->image().get();
@@ -98,6 +98,12 @@
 #include "RenderLayerCompositor.h"
 #endif
 
+#if PLATFORM(ANDROID) && USE(ACCELERATED_COMPOSITING)
+#include "PlatformGraphicsContext.h"
+#include "RenderLayerDisplayList.h"
+#include "Settings.h"
+#endif
+
 #if ENABLE(SVG)
 #include "SVGNames.h"
 #endif
@@ -2607,6 +2613,53 @@ static bool shouldDoSoftwarePaint(const RenderLayer* layer, bool paintingReflect
 }
 #endif
 
+#if PLATFORM(ANDROID) && USE(ACCELERATED_COMPOSITING)
+bool RenderLayer::shouldPaintWithDisplayList(GraphicsContext* p, PaintBehavior paintBehavior,
+                                             RenderObject* paintingRootForRenderer, PaintLayerFlags paintFlags) const
+{
+    Frame* frame = renderer()->frame();
+    if (!frame || !frame->settings() || !frame->settings()->layerDisplayListsEnabled())
+        return false;
+
+    // Recordings can only be replayed into a canvas.
+    if (p->paintingDisabled() || p->updatingControlTints() || p->platformContext()->type() != PlatformGraphicsContext::PaintingContext)
+        return false;
+
+    // Only the ordinary painting of the whole layer is recorded.
+    if (paintBehavior != PaintBehaviorNormal || paintingRootForRenderer
+        || (paintFlags & (PaintLayerTemporaryClipRects | PaintLayerPaintingReflection | PaintLayerPaintingOverlayScrollbars)))
+        return false;
+
+    // The view's background fills whatever is being painted, and scrollbars
+    // and marquees change without their renderers repainting.
+    if (renderer()->isRenderView() || hasOverflowControls() || m_marquee)
+        return false;
+
+    // Widgets, carets and fixed backgrounds are painted differently without
+    // the renderers that paint them being repainted.
+    RenderView* view = renderer()->view();
+    if (view->printing() || !view->widgets().isEmpty() || view->frameView()->hasSlowRepaintObjects())
+        return false;
+    if (frame->selection()->isCaret() || (frame->page() && frame->page()->dragCaretController()->isCaret()))
+        return false;
+
+    return true;
+}
+
+void RenderLayer::invalidateDisplayList()
+{
+    if (m_displayList)
+        m_displayList->invalidate();
+}
+
+void RenderLayer::invalidateDisplayListsIncludingDescendants()
+{
+    invalidateDisplayList();
+    for (RenderLayer* child = firstChild(); child; child = child->nextSibling())
+        child->invalidateDisplayListsIncludingDescendants();
+}
+#endif
+
 void RenderLayer::paintLayer(RenderLayer* rootLayer, GraphicsContext* p,
                         const IntRect& paintDirtyRect, PaintBehavior paintBehavior,
                         RenderObject* paintingRoot, OverlapTestRequestMap* overlapTestRequests,
@@ -2723,6 +2776,18 @@ void RenderLayer::paintLayer(RenderLayer* rootLayer, GraphicsContext* p,
 
     // We want to paint our layer, but only if we intersect the damage rect.
     bool shouldPaint = intersectsDamageRect(layerBounds, damageRect, rootLayer) && m_hasVisibleContent && isSelfPaintingLayer();
+
+#if PLATFORM(ANDROID) && USE(ACCELERATED_COMPOSITING)
+    // Replay what our renderers painted last time instead of painting them
+    // again, if nothing they paint has been repainted since.
+    RenderLayerDisplayList* displayList = 0;
+    if (shouldPaint && shouldPaintWithDisplayList(p, paintBehavior, paintingRootForRenderer, localPaintFlags)) {
+        if (!m_displayList)
+            m_displayList = RenderLayerDisplayList::create();
+        if (m_displayList->update(this, rootLayer, tx, ty))
+            displayList = m_displayList.get();
+    }
+#endif
     if (shouldPaint && !selectionOnly && !damageRect.isEmpty() && !paintingOverlayScrollbars) {
         // Begin transparency layers lazily now that we know we have to paint something.
         if (haveTransparency)
@@ -2733,8 +2798,15 @@ void RenderLayer::paintLayer(RenderLayer* rootLayer, GraphicsContext* p,
         setClip(p, paintDirtyRect, damageRect);
 
         // Paint the background.
-        PaintInfo paintInfo(p, damageRect, PaintPhaseBlockBackground, false, paintingRootForRenderer, 0);
-        renderer()->paint(paintInfo, tx, ty);
+#if PLATFORM(ANDROID) && USE(ACCELERATED_COMPOSITING)
+        if (displayList)
+            displayList->replay(RenderLayerDisplayList::BackgroundPhase, p, damageRect);
+        else
+#endif
+        {
+            PaintInfo paintInfo(p, damageRect, PaintPhaseBlockBackground, false, paintingRootForRenderer, 0);
+            renderer()->paint(paintInfo, tx, ty);
+        }
 
         // Restore the clip.
         restoreClip(p, paintDirtyRect, damageRect);
@@ -2751,18 +2823,25 @@ void RenderLayer::paintLayer(RenderLayer* rootLayer, GraphicsContext* p,
 
         // Set up the clip used when painting our children.
         setClip(p, paintDirtyRect, clipRectToApply);
-        PaintInfo paintInfo(p, clipRectToApply, 
-                                          selectionOnly ? PaintPhaseSelection : PaintPhaseChildBlockBackgrounds,
-                                          forceBlackText, paintingRootForRenderer, 0);
-        renderer()->paint(paintInfo, tx, ty);
-        if (!selectionOnly) {
-            paintInfo.phase = PaintPhaseFloat;
-            renderer()->paint(paintInfo, tx, ty);
-            paintInfo.phase = PaintPhaseForeground;
-            paintInfo.overlapTestRequests = overlapTestRequests;
-            renderer()->paint(paintInfo, tx, ty);
-            paintInfo.phase = PaintPhaseChildOutlines;
+#if PLATFORM(ANDROID) && USE(ACCELERATED_COMPOSITING)
+        if (displayList)
+            displayList->replay(RenderLayerDisplayList::ForegroundPhase, p, clipRectToApply);
+        else
+#endif
+        {
+            PaintInfo paintInfo(p, clipRectToApply, 
+                                              selectionOnly ? PaintPhaseSelection : PaintPhaseChildBlockBackgrounds,
+                                              forceBlackText, paintingRootForRenderer, 0);
             renderer()->paint(paintInfo, tx, ty);
+            if (!selectionOnly) {
+                paintInfo.phase = PaintPhaseFloat;
+                renderer()->paint(paintInfo, tx, ty);
+                paintInfo.phase = PaintPhaseForeground;
+                paintInfo.overlapTestRequests = overlapTestRequests;
+                renderer()->paint(paintInfo, tx, ty);
+                paintInfo.phase = PaintPhaseChildOutlines;
+                renderer()->paint(paintInfo, tx, ty);
+            }
         }
 
         // Now restore our clip.
@@ -2771,9 +2850,16 @@ void RenderLayer::paintLayer(RenderLayer* rootLayer, GraphicsContext* p,
     
     if (!outlineRect.isEmpty() && isSelfPaintingLayer() && !paintingOverlayScrollbars) {
         // Paint our own outline
-        PaintInfo paintInfo(p, outlineRect, PaintPhaseSelfOutline, false, paintingRootForRenderer, 0);
         setClip(p, paintDirtyRect, outlineRect);
-        renderer()->paint(paintInfo, tx, ty);
+#if PLATFORM(ANDROID) && USE(ACCELERATED_COMPOSITING)
+        if (displayList)
+            displayList->replay(RenderLayerDisplayList::OutlinePhase, p, outlineRect);
+        else
+#endif
+        {
+            PaintInfo paintInfo(p, outlineRect, PaintPhaseSelfOutline, false, paintingRootForRenderer, 0);
+            renderer()->paint(paintInfo, tx, ty);
+        }
         restoreClip(p, paintDirtyRect, outlineRect);
     }
     
@@ -68,6 +68,10 @@ class RenderLayerBacking;
 class RenderLayerCompositor;
 #endif
 
+#if PLATFORM(ANDROID) && USE(ACCELERATED_COMPOSITING)
+class RenderLayerDisplayList;
+#endif
+
 class ClipRects {
 public:
     ClipRects()
@@ -185,6 +189,12 @@ public:
     void repaintIncludingNonCompositingDescendants(RenderBoxModelObject* repaintContainer);
 #endif
 
+#if PLATFORM(ANDROID) && USE(ACCELERATED_COMPOSITING)
+    // Drops the recording of what this layer's renderers painted, if any.
+    void invalidateDisplayList();
+    void invalidateDisplayListsIncludingDescendants();
+#endif
+
     void styleChanged(StyleDifference, const RenderStyle* oldStyle);
 
     RenderMarquee* marquee() const { return m_marquee; }
@@ -518,6 +528,9 @@ private:
     void paintLayer(RenderLayer* rootLayer, GraphicsContext*, const IntRect& paintDirtyRect,
                     PaintBehavior, RenderObject* paintingRoot, OverlapTestRequestMap* = 0,
                     PaintLayerFlags = 0);
+#if PLATFORM(ANDROID) && USE(ACCELERATED_COMPOSITING)
+    bool shouldPaintWithDisplayList(GraphicsContext*, PaintBehavior, RenderObject* paintingRootForRenderer, PaintLayerFlags) const;
+#endif
     void paintList(Vector<RenderLayer*>*, RenderLayer* rootLayer, GraphicsContext* p,
                    const IntRect& paintDirtyRect, PaintBehavior,
                    RenderObject* paintingRoot, OverlapTestRequestMap*,
@@ -772,6 +785,10 @@ private:
     OwnPtr<RenderLayerBacking> m_backing;
 #endif
 
+#if PLATFORM(ANDROID) && USE(ACCELERATED_COMPOSITING)
+    OwnPtr<RenderLayerDisplayList> m_displayList;
+#endif
+
     Page* m_page;
 };
 
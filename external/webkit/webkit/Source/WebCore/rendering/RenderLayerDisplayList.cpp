@@ -0,0 +1,156 @@
+/*
+ * Copyright 2012, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "RenderLayerDisplayList.h"
+
+#if PLATFORM(ANDROID) && USE(ACCELERATED_COMPOSITING)
+
+#include "GraphicsContext.h"
+#include "GraphicsOperationCollection.h"
+#include "PaintInfo.h"
+#include "RenderLayer.h"
+#include "RenderView.h"
+
+namespace WebCore {
+
+// Recording a huge layer costs more memory than replaying it saves time.
+static const int maximumRecordedArea = 4096 * 4096;
+
+RenderLayerDisplayList::RenderLayerDisplayList()
+    : m_rootLayer(0)
+    , m_isValid(false)
+    , m_isUnrecordable(false)
+{
+    for (int i = 0; i < PhaseCount; ++i)
+        m_recordings[i] = 0;
+}
+
+RenderLayerDisplayList::~RenderLayerDisplayList()
+{
+    clearRecordings();
+}
+
+bool RenderLayerDisplayList::update(RenderLayer* layer, RenderLayer* rootLayer, int tx, int ty)
+{
+    IntPoint offset(tx, ty);
+    if (m_isValid && (m_rootLayer != rootLayer || m_offset != offset))
+        clearRecordings();
+
+    if (m_isUnrecordable)
+        return false;
+    if (m_isValid)
+        return true;
+
+    IntRect bounds = layer->boundingBox(rootLayer);
+    // The root element's background covers the whole canvas, not just the
+    // root element's box.
+    if (layer->renderer()->isRoot())
+        bounds.unite(layer->renderer()->view()->layer()->boundingBox(rootLayer));
+    if (static_cast<long long>(bounds.width()) * bounds.height() > maximumRecordedArea) {
+        m_isUnrecordable = true;
+        return false;
+    }
+
+    m_rootLayer = rootLayer;
+    m_offset = offset;
+    record(layer, bounds, tx, ty);
+    return m_isValid;
+}
+
+void RenderLayerDisplayList::record(RenderLayer* layer, const IntRect& bounds, int tx, int ty)
+{
+    RenderBoxModelObject* renderer = layer->renderer();
+
+    // These mirror the renderer()->paint() calls of RenderLayer::paintLayer(),
+    // except that the whole layer is painted instead of the damaged part.
+    for (int phase = 0; phase < PhaseCount; ++phase) {
+        AutoGraphicsOperationCollection recording(bounds);
+        GraphicsContext* context = recording.context();
+        switch (phase) {
+        case BackgroundPhase: {
+            PaintInfo paintInfo(context, bounds, PaintPhaseBlockBackground, false, 0, 0);
+            renderer->paint(paintInfo, tx, ty);
+            break;
+        }
+        case ForegroundPhase: {
+            PaintInfo paintInfo(context, bounds, PaintPhaseChildBlockBackgrounds, false, 0, 0);
+            renderer->paint(paintInfo, tx, ty);
+            paintInfo.phase = PaintPhaseFloat;
+            renderer->paint(paintInfo, tx, ty);
+            paintInfo.phase = PaintPhaseForeground;
+            renderer->paint(paintInfo, tx, ty);
+            paintInfo.phase = PaintPhaseChildOutlines;
+            renderer->paint(paintInfo, tx, ty);
+            break;
+        }
+        case OutlinePhase: {
+            PaintInfo paintInfo(context, bounds, PaintPhaseSelfOutline, false, 0, 0);
+            renderer->paint(paintInfo, tx, ty);
+            break;
+        }
+        }
+
+        if (recording.picture()->isIncomplete()) {
+            clearRecordings();
+            m_isUnrecordable = true;
+            return;
+        }
+        m_recordings[phase] = recording.picture();
+        SkSafeRef(m_recordings[phase]);
+    }
+    m_isValid = true;
+}
+
+void RenderLayerDisplayList::replay(Phase phase, GraphicsContext* context, const IntRect& dirtyRect)
+{
+    ASSERT(m_isValid);
+    // The recording changes the platform context's state the way painting
+    // would have; keep that from leaking into the GraphicsContext's own
+    // state.
+    context->save();
+    m_recordings[phase]->apply(context->platformContext(), dirtyRect);
+    context->restore();
+}
+
+void RenderLayerDisplayList::invalidate()
+{
+    clearRecordings();
+    m_isUnrecordable = false;
+}
+
+void RenderLayerDisplayList::clearRecordings()
+{
+    for (int i = 0; i < PhaseCount; ++i) {
+        SkSafeUnref(m_recordings[i]);
+        m_recordings[i] = 0;
+    }
+    m_rootLayer = 0;
+    m_isValid = false;
+}
+
+} // namespace WebCore
+
+#endif // PLATFORM(ANDROID) && USE(ACCELERATED_COMPOSITING)
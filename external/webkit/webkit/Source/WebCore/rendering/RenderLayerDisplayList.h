@@ -0,0 +1,96 @@
+/*
+ * Copyright 2012, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RenderLayerDisplayList_h
+#define RenderLayerDisplayList_h
+
+#if PLATFORM(ANDROID) && USE(ACCELERATED_COMPOSITING)
+
+#include "IntPoint.h"
+#include "IntRect.h"
+#include <wtf/Noncopyable.h>
+#include <wtf/PassOwnPtr.h>
+
+namespace WebCore {
+
+class GraphicsContext;
+class GraphicsOperationCollection;
+class RenderLayer;
+
+// What a self painting layer's own renderers painted the last time the
+// layer was painted: its background, its normal flow content and its
+// outline, as separate recordings. Child layers are not included, and
+// neither are transforms, opacity or the clips of the layer and its
+// ancestors; RenderLayer::paintLayer() still applies those around the
+// recordings.
+//
+// Each recorded drawing operation keeps its bounds, so that repainting a
+// small part of the page only replays what intersects it. The recording is
+// thrown away as soon as one of the layer's renderers repaints.
+class RenderLayerDisplayList {
+    WTF_MAKE_NONCOPYABLE(RenderLayerDisplayList); WTF_MAKE_FAST_ALLOCATED;
+public:
+    enum Phase {
+        BackgroundPhase,
+        ForegroundPhase,
+        OutlinePhase,
+        PhaseCount
+    };
+
+    static PassOwnPtr<RenderLayerDisplayList> create() { return adoptPtr(new RenderLayerDisplayList); }
+    ~RenderLayerDisplayList();
+
+    // Records the layer's content as it paints at (tx, ty) relative to
+    // |rootLayer|, unless a usable recording for that position already
+    // exists. Returns false if the content cannot be recorded, in which case
+    // the layer has to be painted normally until the next invalidation.
+    bool update(RenderLayer*, RenderLayer* rootLayer, int tx, int ty);
+
+    // Replays one phase into |context|. Only the drawing operations that
+    // intersect |dirtyRect|, in |rootLayer| coordinates, are replayed.
+    void replay(Phase, GraphicsContext*, const IntRect& dirtyRect);
+
+    void invalidate();
+
+private:
+    RenderLayerDisplayList();
+
+    void record(RenderLayer*, const IntRect& bounds, int tx, int ty);
+    void clearRecordings();
+
+    GraphicsOperationCollection* m_recordings[PhaseCount];
+    const RenderLayer* m_rootLayer;
+    IntPoint m_offset;
+    bool m_isValid;
+    // Set when the layer painted something the recording context could not
+    // capture. Recording is not attempted again until the next invalidation.
+    bool m_isUnrecordable;
+};
+
+} // namespace WebCore
+
+#endif // PLATFORM(ANDROID) && USE(ACCELERATED_COMPOSITING)
+
+#endif // RenderLayerDisplayList_h
@@ -1156,6 +1156,10 @@ RenderBoxModelObject* RenderObject::containerForRepaint() const
 
 void RenderObject::repaintUsingContainer(RenderBoxModelObject* repaintContainer, const IntRect& r, bool immediate)
 {
+#if PLATFORM(ANDROID) && USE(ACCELERATED_COMPOSITING)
+    invalidateLayerDisplayList();
+#endif
+
     if (!repaintContainer) {
         view()->repaintViewRectangle(r, immediate);
         return;
@@ -1181,6 +1185,31 @@ void RenderObject::repaintUsingContainer(RenderBoxModelObject* repaintContainer,
 #endif
 }
 
+#if PLATFORM(ANDROID) && USE(ACCELERATED_COMPOSITING)
+void RenderObject::invalidateLayerDisplayList()
+{
+    Settings* settings = document()->settings();
+    if (!settings || !settings->layerDisplayListsEnabled())
+        return;
+
+    // A full repaint of the view is not followed by repaints of the
+    // renderers that changed.
+    if (isRenderView()) {
+        if (hasLayer())
+            toRenderView(this)->layer()->invalidateDisplayListsIncludingDescendants();
+        return;
+    }
+
+    // Layers that are not self painting are painted by the first ancestor
+    // layer that is.
+    RenderLayer* layer = enclosingLayer();
+    while (layer && !layer->isSelfPaintingLayer())
+        layer = layer->parent();
+    if (layer)
+        layer->invalidateDisplayList();
+}
+#endif
+
 void RenderObject::repaint(bool immediate)
 {
     // Don't repaint if we're unrooted (note that view() still returns the view when unrooted)
@@ -1569,8 +1598,11 @@ StyleDifference RenderObject::adjustStyleDifference(StyleDifference diff, unsign
         if (!isText() && (!hasLayer() || !toRenderBoxModelObject(this)->layer()->isComposited())) {
             if (!hasLayer())
                 diff = StyleDifferenceLayout; // FIXME: Do this for now since SimplifiedLayout cannot handle updating floating objects lists.
-            else if (diff < StyleDifferenceSimplifiedLayout)
-                diff = StyleDifferenceSimplifiedLayout;
+            else if (diff < StyleDifferenceLayoutPositionedMovementOnly) {
+                // A transform doesn't affect the box or its overflow, so the layer can be updated
+                // the same way as when it moves, without laying out its descendants.
+                diff = StyleDifferenceLayoutPositionedMovementOnly;
+            }
         } else if (diff < StyleDifferenceRecompositeLayer)
             diff = StyleDifferenceRecompositeLayer;
     }
@@ -1595,6 +1627,12 @@ StyleDifference RenderObject::adjustStyleDifference(StyleDifference diff, unsign
     UNUSED_PARAM(contextSensitiveProperties);
 #endif
 
+    // Only boxes with a layer can move without a layout of the lines or the table
+    // that contain them. Text shares its parent's style and ignores the hint.
+    if (diff == StyleDifferenceLayoutPositionedMovementOnly && !isText() && style() && style()->position() == RelativePosition
+        && (!isBox() || !hasLayer() || isTableCell() || isTableRow() || isTableSection()))
+        diff = StyleDifferenceLayout;
+
     // If we have no layer(), just treat a RepaintLayer hint as a normal Repaint.
     if (diff == StyleDifferenceRepaintLayer && !hasLayer())
         diff = StyleDifferenceRepaint;
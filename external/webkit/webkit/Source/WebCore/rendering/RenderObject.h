@@ -835,6 +835,10 @@ private:
     StyleDifference adjustStyleDifference(StyleDifference, unsigned contextSensitiveProperties) const;
 
     Color selectionColor(int colorProperty) const;
+
+#if PLATFORM(ANDROID) && USE(ACCELERATED_COMPOSITING)
+    void invalidateLayerDisplayList();
+#endif
     
     RefPtr<RenderStyle> m_style;
 
@@ -1011,7 +1015,8 @@ inline void RenderObject::markContainingBlocksForLayout(bool scheduleRelayout, R
     RenderObject* o = container();
     RenderObject* last = this;
 
-    bool simplifiedNormalFlowLayout = needsSimplifiedNormalFlowLayout() && !selfNeedsLayout() && !normalChildNeedsLayout();
+    // A box that only moved or changed its transform doesn't dirty the lines around it.
+    bool simplifiedNormalFlowLayout = (needsSimplifiedNormalFlowLayout() || needsPositionedMovementLayout()) && !selfNeedsLayout() && !normalChildNeedsLayout();
 
     while (o) {
         // Don't mark the outermost object of an unrooted subtree. That object will be 
@@ -169,6 +169,44 @@ void RenderStyle::inheritFrom(const RenderStyle* inheritParent)
 #endif
 }
 
+void RenderStyle::copyNonInheritedFrom(const RenderStyle* other)
+{
+    m_box = other->m_box;
+    visual = other->visual;
+    m_background = other->m_background;
+    surround = other->surround;
+    rareNonInheritedData = other->rareNonInheritedData;
+    // noninherited_flags also holds the state of the element (e.g., whether it is a link) and
+    // the results of selector matching, so only copy the bits that come from properties.
+    noninherited_flags._effectiveDisplay = other->noninherited_flags._effectiveDisplay;
+    noninherited_flags._originalDisplay = other->noninherited_flags._originalDisplay;
+    noninherited_flags._overflowX = other->noninherited_flags._overflowX;
+    noninherited_flags._overflowY = other->noninherited_flags._overflowY;
+    noninherited_flags._vertical_align = other->noninherited_flags._vertical_align;
+    noninherited_flags._clear = other->noninherited_flags._clear;
+    noninherited_flags._position = other->noninherited_flags._position;
+    noninherited_flags._floating = other->noninherited_flags._floating;
+    noninherited_flags._table_layout = other->noninherited_flags._table_layout;
+    noninherited_flags._page_break_before = other->noninherited_flags._page_break_before;
+    noninherited_flags._page_break_after = other->noninherited_flags._page_break_after;
+    noninherited_flags._page_break_inside = other->noninherited_flags._page_break_inside;
+    noninherited_flags._unicodeBidi = other->noninherited_flags._unicodeBidi;
+#if ENABLE(SVG)
+    if (m_svgStyle != other->m_svgStyle)
+        m_svgStyle.access()->copyNonInheritedFrom(other->m_svgStyle.get());
+#endif
+}
+
+bool RenderStyle::inheritedDataShared(const RenderStyle* other) const
+{
+    return inherited_flags == other->inherited_flags
+        && inherited.get() == other->inherited.get()
+#if ENABLE(SVG)
+        && m_svgStyle.get() == other->m_svgStyle.get()
+#endif
+        && rareInheritedData.get() == other->rareInheritedData.get();
+}
+
 RenderStyle::~RenderStyle()
 {
 }
@@ -520,12 +558,16 @@ StyleDifference RenderStyle::diff(const RenderStyle* other, unsigned& changedCon
     if (position() != StaticPosition) {
         if (surround->offset != other->surround->offset) {
              // Optimize for the case where a positioned layer is moving but not changing size.
-            if (position() == AbsolutePosition && positionedObjectMoved(surround->offset, other->surround->offset))
+            if ((position() == AbsolutePosition || position() == FixedPosition) && positionedObjectMoved(surround->offset, other->surround->offset))
+                return StyleDifferenceLayoutPositionedMovementOnly;
+
+            // Relative offsets only move the layer; they never change the size of the box.
+            // RenderObject::adjustStyleDifference() asks for a full layout for the renderers
+            // that can't be moved that way, like RenderInlines, whose lines would have to be
+            // laid out again.
+            if (position() == RelativePosition)
                 return StyleDifferenceLayoutPositionedMovementOnly;
 
-            // FIXME: We would like to use SimplifiedLayout for relative positioning, but we can't quite do that yet.
-            // We need to make sure SimplifiedLayout can operate correctly on RenderInlines (we will need
-            // to add a selfNeedsSimplifiedLayout bit in order to not get confused and taint every line).
             return StyleDifferenceLayout;
         } else if (m_box->zIndex() != other->m_box->zIndex() || m_box->hasAutoZIndex() != other->m_box->hasAutoZIndex()
                  || visual->clip != other->visual->clip || visual->hasClip != other->visual->hasClip)
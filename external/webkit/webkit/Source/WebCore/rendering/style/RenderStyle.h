@@ -320,6 +320,10 @@ public:
     ~RenderStyle();
 
     void inheritFrom(const RenderStyle* inheritParent);
+    // Copies the style data that is not inherited, but not the flags set by selector matching.
+    void copyNonInheritedFrom(const RenderStyle*);
+    // A fast check for identical inherited style that only looks at whether the data is shared.
+    bool inheritedDataShared(const RenderStyle*) const;
 
     PseudoId styleType() const { return static_cast<PseudoId>(noninherited_flags._styleType); }
     void setStyleType(PseudoId styleType) { noninherited_flags._styleType = styleType; }
@@ -216,6 +216,7 @@ void AbstractDatabase::closeDatabase()
     if (!m_opened)
         return;
 
+    m_statementCache.clear();
     m_sqliteDatabase.close();
     m_opened = false;
     {
@@ -468,6 +469,18 @@ void AbstractDatabase::resetAuthorizer()
         m_databaseAuthorizer->reset();
 }
 
+DatabaseAuthorizer::Actions AbstractDatabase::lastAuthorizerActions()
+{
+    ASSERT(m_databaseAuthorizer);
+    return m_databaseAuthorizer->lastActions();
+}
+
+void AbstractDatabase::replayAuthorizerActions(const DatabaseAuthorizer::Actions& actions)
+{
+    ASSERT(m_databaseAuthorizer);
+    m_databaseAuthorizer->replayActions(actions);
+}
+
 unsigned long long AbstractDatabase::maximumSize() const
 {
     return DatabaseTracker::tracker().getMaxSizeForDatabase(this);
@@ -33,6 +33,7 @@
 
 #include "ExceptionCode.h"
 #include "PlatformString.h"
+#include "SQLStatementCache.h"
 #include "SQLiteDatabase.h"
 #include <wtf/Forward.h>
 #include <wtf/ThreadSafeRefCounted.h>
@@ -65,6 +66,7 @@ public:
     virtual unsigned long estimatedSize() const;
     virtual String fileName() const;
     SQLiteDatabase& sqliteDatabase() { return m_sqliteDatabase; }
+    SQLStatementCache& statementCache() { return m_statementCache; }
 
     unsigned long long maximumSize() const;
     void incrementalVacuumIfNeeded();
@@ -86,6 +88,8 @@ public:
     void resetDeletes();
     bool hadDeletes();
     void resetAuthorizer();
+    DatabaseAuthorizer::Actions lastAuthorizerActions();
+    void replayAuthorizerActions(const DatabaseAuthorizer::Actions&);
 
     virtual void markAsDeletedAndClose() = 0;
     virtual void closeImmediately() = 0;
@@ -121,6 +125,8 @@ private:
     bool m_new;
 
     SQLiteDatabase m_sqliteDatabase;
+    // Destroyed before m_sqliteDatabase, which cannot close while statements are still prepared.
+    SQLStatementCache m_statementCache;
 
     RefPtr<DatabaseAuthorizer> m_databaseAuthorizer;
 };
@@ -45,9 +45,11 @@
 #include "SQLTransactionCoordinator.h"
 #include "SQLTransactionErrorCallback.h"
 #include "SQLiteStatement.h"
+#include "SQLiteTransaction.h"
 #include "ScriptController.h"
 #include "ScriptExecutionContext.h"
 #include "SecurityOrigin.h"
+#include "Settings.h"
 #include "VoidCallback.h"
 #include <wtf/OwnPtr.h>
 #include <wtf/PassOwnPtr.h>
@@ -126,10 +128,18 @@ Database::Database(ScriptExecutionContext* context, const String& name, const St
     : AbstractDatabase(context, name, expectedVersion, displayName, estimatedSize)
     , m_transactionInProgress(false)
     , m_isTransactionQueueEnabled(true)
+    , m_batchModifiedDatabase(false)
+    , m_transactionBatchingEnabled(false)
     , m_deleted(false)
 {
     m_databaseThreadSecurityOrigin = m_contextThreadSecurityOrigin->threadsafeCopy();
 
+    // Read on the context thread, so the database thread never touches Settings.
+    if (context->isDocument()) {
+        if (Settings* settings = static_cast<Document*>(context)->settings())
+            m_transactionBatchingEnabled = settings->databaseTransactionBatchingEnabled();
+    }
+
     ScriptController::initializeThreading();
     ASSERT(m_scriptExecutionContext->databaseThread());
 }
@@ -221,6 +231,17 @@ void Database::close()
         m_transactionInProgress = false;
     }
 
+    if (m_batchTransaction) {
+        // The transactions waiting for the batch lose their changes, like
+        // the transaction that is in progress when a database closes does.
+        if (!m_transactionsAwaitingCommit.isEmpty())
+            transactionCoordinator()->releaseDeferredLock(m_transactionsAwaitingCommit.last().get());
+        m_transactionsAwaitingCommit.clear();
+        disableAuthorizer();
+        m_batchTransaction.clear();
+        enableAuthorizer();
+    }
+
     closeDatabase();
 
     // Must ref() before calling databaseThread()->recordDatabaseClosed().
@@ -325,6 +346,70 @@ void Database::scheduleTransactionStep(SQLTransaction* transaction, bool immedia
         m_scriptExecutionContext->databaseThread()->scheduleTask(task.release());
 }
 
+static const size_t maximumBatchedTransactions = 16;
+
+bool Database::openBatch()
+{
+    if (m_batchTransaction)
+        return true;
+
+    OwnPtr<SQLiteTransaction> batchTransaction = adoptPtr(new SQLiteTransaction(sqliteDatabase()));
+    batchTransaction->begin();
+    if (!batchTransaction->inProgress())
+        return false;
+
+    m_batchTransaction = batchTransaction.release();
+    m_batchModifiedDatabase = false;
+    return true;
+}
+
+bool Database::shouldDeferCommit(SQLTransaction* transaction)
+{
+    ASSERT(m_batchTransaction);
+    if (!transactionBatchingEnabled() || m_transactionsAwaitingCommit.size() + 1 >= maximumBatchedTransactions)
+        return false;
+
+    // Other handles on this database would have to wait for the whole batch.
+    if (transactionCoordinator()->hasPendingTransactions(transaction))
+        return false;
+
+    // Only defer when the next transaction is known to join the batch and
+    // commit it eventually.
+    MutexLocker locker(m_transactionInProgressMutex);
+    return m_isTransactionQueueEnabled && !m_transactionQueue.isEmpty() && m_transactionQueue.first()->isBatchable();
+}
+
+void Database::deferCommit(SQLTransaction* transaction, bool modifiedDatabase)
+{
+    ASSERT(m_batchTransaction);
+    m_transactionsAwaitingCommit.append(transaction);
+    if (modifiedDatabase)
+        m_batchModifiedDatabase = true;
+}
+
+bool Database::commitBatch(bool& modifiedDatabase)
+{
+    ASSERT(m_batchTransaction);
+
+    disableAuthorizer();
+    m_batchTransaction->commit();
+    bool committed = !m_batchTransaction->inProgress();
+    if (!committed)
+        m_batchTransaction->rollback();
+    enableAuthorizer();
+    m_batchTransaction.clear();
+
+    if (committed && m_batchModifiedDatabase)
+        modifiedDatabase = true;
+
+    Vector<RefPtr<SQLTransaction> > transactions;
+    transactions.swap(m_transactionsAwaitingCommit);
+    for (size_t i = 0; i < transactions.size(); ++i)
+        transactions[i]->deferredCommitCompleted(committed);
+
+    return committed;
+}
+
 class DeliverPendingCallbackTask : public ScriptExecutionContext::Task {
 public:
     static PassOwnPtr<DeliverPendingCallbackTask> create(PassRefPtr<SQLTransaction> transaction)
@@ -36,12 +36,15 @@
 
 #include <wtf/Deque.h>
 #include <wtf/Forward.h>
+#include <wtf/OwnPtr.h>
+#include <wtf/Vector.h>
 
 namespace WebCore {
 
 class DatabaseCallback;
 class ScriptExecutionContext;
 class SecurityOrigin;
+class SQLiteTransaction;
 class SQLTransaction;
 class SQLTransactionCallback;
 class SQLTransactionClient;
@@ -82,6 +85,23 @@ public:
     SQLTransactionClient* transactionClient() const;
     SQLTransactionCoordinator* transactionCoordinator() const;
 
+    // When Settings::databaseTransactionBatchingEnabled() was set for the
+    // page that opened this handle, read-write transactions that are queued
+    // back to back on it share a single commit. Each of them runs in a
+    // savepoint of a batch transaction; a transaction that succeeds while the
+    // next one is already waiting leaves the commit, and its success or error
+    // callback, to the end of the batch.
+    bool transactionBatchingEnabled() const { return m_transactionBatchingEnabled; }
+
+    bool hasOpenBatch() const { return m_batchTransaction; }
+    bool openBatch();
+    bool shouldDeferCommit(SQLTransaction*);
+    void deferCommit(SQLTransaction*, bool modifiedDatabase);
+    // Commits the batch, and completes the transactions that deferred their
+    // commit to it. |modifiedDatabase| is set if any of them changed the
+    // database.
+    bool commitBatch(bool& modifiedDatabase);
+
 private:
     class DatabaseOpenTask;
     class DatabaseCloseTask;
@@ -110,6 +130,12 @@ private:
 
     RefPtr<SecurityOrigin> m_databaseThreadSecurityOrigin;
 
+    // Only used on the database thread.
+    OwnPtr<SQLiteTransaction> m_batchTransaction;
+    Vector<RefPtr<SQLTransaction> > m_transactionsAwaitingCommit;
+    bool m_batchModifiedDatabase;
+    bool m_transactionBatchingEnabled;
+
     bool m_deleted;
 };
 
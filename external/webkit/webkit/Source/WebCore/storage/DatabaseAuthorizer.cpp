@@ -53,9 +53,28 @@ void DatabaseAuthorizer::reset()
 {
     m_lastActionWasInsert = false;
     m_lastActionChangedDatabase = false;
+    m_lastActionHadDeletes = false;
     m_permissions = ReadWriteMask;
 }
 
+DatabaseAuthorizer::Actions DatabaseAuthorizer::lastActions() const
+{
+    Actions actions;
+    actions.wasInsert = m_lastActionWasInsert;
+    actions.changedDatabase = m_lastActionChangedDatabase;
+    actions.hadDeletes = m_lastActionHadDeletes;
+    return actions;
+}
+
+void DatabaseAuthorizer::replayActions(const Actions& actions)
+{
+    m_lastActionWasInsert = actions.wasInsert;
+    m_lastActionChangedDatabase = actions.changedDatabase;
+    m_lastActionHadDeletes = actions.hadDeletes;
+    if (actions.hadDeletes)
+        m_hadDeletes = true;
+}
+
 void DatabaseAuthorizer::resetDeletes()
 {
     m_hadDeletes = false;
@@ -270,6 +289,7 @@ int DatabaseAuthorizer::dropView(const String&)
         return SQLAuthDeny;
 
     m_hadDeletes = true;
+    m_lastActionHadDeletes = true;
     return SQLAuthAllow;
 }
 
@@ -282,6 +302,7 @@ int DatabaseAuthorizer::dropTempView(const String&)
         return SQLAuthDeny;
 
     m_hadDeletes = true;
+    m_lastActionHadDeletes = true;
     return SQLAuthAllow;
 }
 
@@ -428,8 +449,10 @@ int DatabaseAuthorizer::denyBasedOnTableName(const String& tableName) const
 int DatabaseAuthorizer::updateDeletesBasedOnTableName(const String& tableName)
 {
     int allow = denyBasedOnTableName(tableName);
-    if (allow)
+    if (allow) {
         m_hadDeletes = true;
+        m_lastActionHadDeletes = true;
+    }
     return allow;
 }
 
@@ -103,6 +103,18 @@ public:
     bool lastActionChangedDatabase() const { return m_lastActionChangedDatabase; }
     bool hadDeletes() const { return m_hadDeletes; }
 
+    // SQLite only asks the authorizer about a statement while preparing it.
+    // A prepared statement that is executed again has to report what it was
+    // authorized to do itself.
+    struct Actions {
+        Actions() : wasInsert(false), changedDatabase(false), hadDeletes(false) { }
+        bool wasInsert;
+        bool changedDatabase;
+        bool hadDeletes;
+    };
+    Actions lastActions() const;
+    void replayActions(const Actions&);
+
 private:
     DatabaseAuthorizer(const String& databaseInfoTableName);
     void addWhitelistedFunctions();
@@ -115,6 +127,7 @@ private:
     bool m_lastActionWasInsert : 1;
     bool m_lastActionChangedDatabase : 1;
     bool m_hadDeletes : 1;
+    bool m_lastActionHadDeletes : 1;
 
     const String m_databaseInfoTableName;
 
@@ -74,7 +74,8 @@ IDBDatabaseBackendImpl::IDBDatabaseBackendImpl(const String& name, IDBBackingSto
 
     bool success = m_backingStore->extractIDBDatabaseMetaData(m_name, m_version, m_id);
     ASSERT_UNUSED(success, success == (m_id != InvalidId));
-    if (!m_backingStore->setIDBDatabaseMetaData(m_name, m_version, m_id, m_id == InvalidId))
+    // Only a database that does not exist yet has metadata to write.
+    if (m_id == InvalidId && !m_backingStore->setIDBDatabaseMetaData(m_name, m_version, m_id, true))
         ASSERT_NOT_REACHED(); // FIXME: Need better error handling.
     loadObjectStores();
 }
@@ -35,8 +35,8 @@
 #include "IDBKeyRange.h"
 #include "LevelDBComparator.h"
 #include "LevelDBDatabase.h"
-#include "LevelDBIterator.h"
 #include "LevelDBSlice.h"
+#include "LevelDBTransaction.h"
 #include "SecurityOrigin.h"
 
 #ifndef INT64_MAX
@@ -415,21 +415,33 @@ static const char* extractEncodedIDBKey(const char* start, const char* limit, Ve
     return 0;
 }
 
-static int compareEncodedIDBKeys(const Vector<char>& keyA, const Vector<char>& keyB)
+static int compareEncodedStringsWithLength(const char*& p, const char* limitP, const char*& q, const char* limitQ)
 {
-    ASSERT(keyA.size() >= 1);
-    ASSERT(keyB.size() >= 1);
+    int64_t lenP, lenQ;
+    p = decodeVarInt(p, limitP, lenP);
+    ASSERT(p && p + lenP * 2 <= limitP);
+    q = decodeVarInt(q, limitQ, lenQ);
+    ASSERT(q && q + lenQ * 2 <= limitQ);
 
-    const char* p = keyA.data();
-    const char* limitA = p + keyA.size();
-    const char* q = keyB.data();
-    const char* limitB = q + keyB.size();
+    // Strings are stored as big-endian UTF-16, so comparing the bytes compares the code units, like codePointCompare().
+    int x = memcmp(p, q, std::min(lenP, lenQ) * 2);
+    p += lenP * 2;
+    q += lenQ * 2;
+    if (x)
+        return x;
+    if (lenP == lenQ)
+        return 0;
+    return lenP > lenQ ? 1 : -1;
+}
 
-    unsigned char typeA = *p++;
-    unsigned char typeB = *q++;
+// Compares two encoded IDBKeys where they are stored, and advances both pointers past them.
+static int compareEncodedIDBKeys(const char*& ptrA, const char* limitA, const char*& ptrB, const char* limitB)
+{
+    ASSERT(ptrA < limitA);
+    ASSERT(ptrB < limitB);
 
-    String s, t;
-    double d, e;
+    unsigned char typeA = *ptrA++;
+    unsigned char typeB = *ptrB++;
 
     if (int x = typeB - typeA) // FIXME: Note the subtleness!
         return x;
@@ -441,57 +453,65 @@ static int compareEncodedIDBKeys(const Vector<char>& keyA, const Vector<char>& k
         return 0;
     case kIDBKeyStringTypeByte:
         // String type.
-        p = decodeStringWithLength(p, limitA, s); // FIXME: Compare without actually decoding the String!
-        ASSERT(p);
-        q = decodeStringWithLength(q, limitB, t);
-        ASSERT(q);
-        return codePointCompare(s, t);
+        return compareEncodedStringsWithLength(ptrA, limitA, ptrB, limitB);
     case kIDBKeyDateTypeByte:
-    case kIDBKeyNumberTypeByte:
+    case kIDBKeyNumberTypeByte: {
         // Date or number.
-        p = decodeDouble(p, limitA, &d);
-        ASSERT(p);
-        q = decodeDouble(q, limitB, &e);
-        ASSERT(q);
+        double d, e;
+        ptrA = decodeDouble(ptrA, limitA, &d);
+        ASSERT(ptrA);
+        ptrB = decodeDouble(ptrB, limitB, &e);
+        ASSERT(ptrB);
         if (d < e)
             return -1;
         if (d > e)
             return 1;
         return 0;
     }
+    }
 
     ASSERT_NOT_REACHED();
     return 0;
 }
 
-static bool getInt(LevelDBDatabase* db, const Vector<char>& key, int64_t& foundInt)
+static int compareEncodedIDBKeys(const Vector<char>& keyA, const Vector<char>& keyB)
+{
+    ASSERT(keyA.size() >= 1);
+    ASSERT(keyB.size() >= 1);
+
+    const char* ptrA = keyA.data();
+    const char* ptrB = keyB.data();
+    return compareEncodedIDBKeys(ptrA, ptrA + keyA.size(), ptrB, ptrB + keyB.size());
+}
+
+static bool getInt(LevelDBTransaction* transaction, const Vector<char>& key, int64_t& foundInt)
 {
     Vector<char> result;
-    if (!db->get(key, result))
+    if (!transaction->get(key, result))
         return false;
 
     foundInt = decodeInt(result.begin(), result.end());
     return true;
 }
 
-static bool putInt(LevelDBDatabase* db, const Vector<char>& key, int64_t value)
+static bool putInt(LevelDBTransaction* transaction, const Vector<char>& key, int64_t value)
 {
-    return db->put(key, encodeInt(value));
+    return transaction->put(key, encodeInt(value));
 }
 
-static bool getString(LevelDBDatabase* db, const Vector<char>& key, String& foundString)
+static bool getString(LevelDBTransaction* transaction, const Vector<char>& key, String& foundString)
 {
     Vector<char> result;
-    if (!db->get(key, result))
+    if (!transaction->get(key, result))
         return false;
 
     foundString = decodeString(result.begin(), result.end());
     return true;
 }
 
-static bool putString(LevelDBDatabase* db, const Vector<char> key, const String& value)
+static bool putString(LevelDBTransaction* transaction, const Vector<char> key, const String& value)
 {
-    if (!db->put(key, encodeString(value)))
+    if (!transaction->put(key, encodeString(value)))
         return false;
     return true;
 }
@@ -1388,7 +1408,8 @@ static int realCompare(const LevelDBSlice& a, const LevelDBSlice& b, bool indexK
         if (ptrB == endB)
             return 1; // FIXME: This case of non-existing user keys should not have to be handled this way.
 
-        return decodeAndCompare<ObjectStoreDataKey>(a, b);
+        // The user keys are compared where they are stored; this is by far the most common comparison.
+        return compareEncodedIDBKeys(ptrA, endA, ptrB, endB);
     }
     if (prefixA.type() == KeyPrefix::kExistsEntry) {
         if (ptrA == endA && ptrB == endB)
@@ -1398,7 +1419,7 @@ static int realCompare(const LevelDBSlice& a, const LevelDBSlice& b, bool indexK
         if (ptrB == endB)
             return 1; // FIXME: This case of non-existing user keys should not have to be handled this way.
 
-        return decodeAndCompare<ExistsEntryKey>(a, b);
+        return compareEncodedIDBKeys(ptrA, endA, ptrB, endB);
     }
     if (prefixA.type() == KeyPrefix::kIndexData) {
         if (ptrA == endA && ptrB == endB)
@@ -1408,16 +1429,19 @@ static int realCompare(const LevelDBSlice& a, const LevelDBSlice& b, bool indexK
         if (ptrB == endB)
             return 1; // FIXME: This case of non-existing user keys should not have to be handled this way.
 
-        IndexDataKey indexDataKeyA;
-        IndexDataKey indexDataKeyB;
-
-        ptrA = IndexDataKey::decode(a.begin(), endA, &indexDataKeyA);
-        ptrB = IndexDataKey::decode(b.begin(), endB, &indexDataKeyB);
-        ASSERT(ptrA);
-        ASSERT(ptrB);
+        if (int x = compareEncodedIDBKeys(ptrA, endA, ptrB, endB))
+            return x;
+        if (indexKeys)
+            return 0;
 
-        bool ignoreSequenceNumber = indexKeys;
-        return indexDataKeyA.compare(indexDataKeyB, ignoreSequenceNumber);
+        // The sequence number is optional; see IndexDataKey::decode().
+        int64_t sequenceNumberA = -1;
+        int64_t sequenceNumberB = -1;
+        if (ptrA != endA && !decodeVarInt(ptrA, endA, sequenceNumberA))
+            return 0;
+        if (ptrB != endB && !decodeVarInt(ptrB, endB, sequenceNumberB))
+            return 0;
+        return sequenceNumberA - sequenceNumberB;
     }
 
     ASSERT_NOT_REACHED();
@@ -1441,14 +1465,14 @@ public:
 };
 }
 
-static bool setUpMetadata(LevelDBDatabase* db)
+static bool setUpMetadata(LevelDBTransaction* transaction)
 {
     const Vector<char> metaDataKey = SchemaVersionKey::encode();
 
     int64_t schemaVersion;
-    if (!getInt(db, metaDataKey, schemaVersion)) {
+    if (!getInt(transaction, metaDataKey, schemaVersion)) {
         schemaVersion = 0;
-        if (!putInt(db, metaDataKey, schemaVersion))
+        if (!putInt(transaction, metaDataKey, schemaVersion))
             return false;
     }
 
@@ -1498,33 +1522,70 @@ PassRefPtr<IDBBackingStore> IDBLevelDBBackingStore::open(SecurityOrigin* securit
     RefPtr<IDBLevelDBBackingStore> backingStore(adoptRef(new IDBLevelDBBackingStore(fileIdentifier, factory, db)));
     backingStore->m_comparator = comparator.release();
 
-    if (!setUpMetadata(backingStore->m_db.get()))
+    RefPtr<LevelDBTransaction> transaction = LevelDBTransaction::create(backingStore->m_db.get(), backingStore->m_comparator.get());
+    if (!setUpMetadata(transaction.get()) || !transaction->commit())
         return 0;
 
     return backingStore.release();
 }
 
+// Calls made while no IndexedDB transaction is running get a LevelDB transaction of their own, which commits when the
+// call returns. The backing store is shared by all the databases of an origin, so calls that are never part of an
+// IndexedDB transaction, like the ones made when a database is opened, ask for their own transaction even when one is
+// running: that one may belong to another database, and would take their writes with it if it were aborted. It is put
+// back when the call returns.
+class IDBLevelDBBackingStore::ImplicitTransactionScope {
+    WTF_MAKE_NONCOPYABLE(ImplicitTransactionScope);
+public:
+    enum Mode { UseRunningTransaction, IgnoreRunningTransaction };
+
+    ImplicitTransactionScope(IDBLevelDBBackingStore* backingStore, Mode mode = UseRunningTransaction)
+        : m_backingStore(backingStore)
+        , m_isImplicit(mode == IgnoreRunningTransaction || !backingStore->m_currentTransaction)
+    {
+        if (!m_isImplicit)
+            return;
+        m_runningTransaction = m_backingStore->m_currentTransaction.release();
+        m_backingStore->m_currentTransaction = LevelDBTransaction::create(m_backingStore->m_db.get(), m_backingStore->m_comparator.get());
+    }
+
+    ~ImplicitTransactionScope()
+    {
+        if (!m_isImplicit)
+            return;
+        bool ok = m_backingStore->m_currentTransaction->commit();
+        ASSERT_UNUSED(ok, ok);
+        m_backingStore->m_currentTransaction = m_runningTransaction.release();
+    }
+
+private:
+    IDBLevelDBBackingStore* m_backingStore;
+    bool m_isImplicit;
+    RefPtr<LevelDBTransaction> m_runningTransaction;
+};
+
 bool IDBLevelDBBackingStore::extractIDBDatabaseMetaData(const String& name, String& foundVersion, int64_t& foundId)
 {
+    ImplicitTransactionScope scope(this, ImplicitTransactionScope::IgnoreRunningTransaction);
     const Vector<char> key = DatabaseNameKey::encode(m_identifier, name);
 
-    bool ok = getInt(m_db.get(), key, foundId);
+    bool ok = getInt(m_currentTransaction.get(), key, foundId);
     if (!ok)
         return false;
 
-    ok = getString(m_db.get(), DatabaseMetaDataKey::encode(foundId, DatabaseMetaDataKey::kUserVersion), foundVersion);
+    ok = getString(m_currentTransaction.get(), DatabaseMetaDataKey::encode(foundId, DatabaseMetaDataKey::kUserVersion), foundVersion);
     if (!ok)
         return false;
 
     return true;
 }
 
-static int64_t getNewDatabaseId(LevelDBDatabase* db)
+static int64_t getNewDatabaseId(LevelDBTransaction* transaction)
 {
     const Vector<char> freeListStartKey = DatabaseFreeListKey::encode(0);
     const Vector<char> freeListStopKey = DatabaseFreeListKey::encode(INT64_MAX);
 
-    OwnPtr<LevelDBIterator> it(db->newIterator());
+    OwnPtr<LevelDBTransaction::Iterator> it(transaction->createIterator());
     for (it->seek(freeListStartKey); it->isValid() && compareKeys(it->key(), freeListStopKey) < 0; it->next()) {
         const char *p = it->key().begin();
         const char *limit = it->key().end();
@@ -1533,7 +1594,7 @@ static int64_t getNewDatabaseId(LevelDBDatabase* db)
         p = DatabaseFreeListKey::decode(p, limit, &freeListKey);
         ASSERT(p);
 
-        bool ok = db->remove(it->key());
+        bool ok = transaction->remove(it->key());
         ASSERT_UNUSED(ok, ok);
 
         return freeListKey.databaseId();
@@ -1541,13 +1602,13 @@ static int64_t getNewDatabaseId(LevelDBDatabase* db)
 
     // If we got here, there was no free-list.
     int64_t maxDatabaseId = -1;
-    if (!getInt(db, MaxDatabaseIdKey::encode(), maxDatabaseId))
+    if (!getInt(transaction, MaxDatabaseIdKey::encode(), maxDatabaseId))
         maxDatabaseId = 0;
 
     ASSERT(maxDatabaseId >= 0);
 
     int64_t databaseId = maxDatabaseId + 1;
-    bool ok = putInt(db, MaxDatabaseIdKey::encode(), databaseId);
+    bool ok = putInt(transaction, MaxDatabaseIdKey::encode(), databaseId);
     ASSERT_UNUSED(ok, ok);
 
     return databaseId;
@@ -1556,15 +1617,18 @@ static int64_t getNewDatabaseId(LevelDBDatabase* db)
 
 bool IDBLevelDBBackingStore::setIDBDatabaseMetaData(const String& name, const String& version, int64_t& rowId, bool invalidRowId)
 {
+    // A database is only created when it is opened, outside of any IndexedDB transaction. Changing its version is
+    // part of a setVersion transaction.
+    ImplicitTransactionScope scope(this, invalidRowId ? ImplicitTransactionScope::IgnoreRunningTransaction : ImplicitTransactionScope::UseRunningTransaction);
     if (invalidRowId) {
-        rowId = getNewDatabaseId(m_db.get());
+        rowId = getNewDatabaseId(m_currentTransaction.get());
 
         const Vector<char> key = DatabaseNameKey::encode(m_identifier, name);
-        if (!putInt(m_db.get(), key, rowId))
+        if (!putInt(m_currentTransaction.get(), key, rowId))
             return false;
     }
 
-    if (!putString(m_db.get(), DatabaseMetaDataKey::encode(rowId, DatabaseMetaDataKey::kUserVersion), version))
+    if (!putString(m_currentTransaction.get(), DatabaseMetaDataKey::encode(rowId, DatabaseMetaDataKey::kUserVersion), version))
         return false;
 
     return true;
@@ -1572,10 +1636,11 @@ bool IDBLevelDBBackingStore::setIDBDatabaseMetaData(const String& name, const St
 
 void IDBLevelDBBackingStore::getObjectStores(int64_t databaseId, Vector<int64_t>& foundIds, Vector<String>& foundNames, Vector<String>& foundKeyPaths, Vector<bool>& foundAutoIncrementFlags)
 {
+    ImplicitTransactionScope scope(this, ImplicitTransactionScope::IgnoreRunningTransaction);
     const Vector<char> startKey = ObjectStoreMetaDataKey::encode(databaseId, 1, 0);
     const Vector<char> stopKey = ObjectStoreMetaDataKey::encode(databaseId, INT64_MAX, 0);
 
-    OwnPtr<LevelDBIterator> it(m_db->newIterator());
+    OwnPtr<LevelDBTransaction::Iterator> it(m_currentTransaction->createIterator());
     for (it->seek(startKey); it->isValid() && compareKeys(it->key(), stopKey) < 0; it->next()) {
         const char *p = it->key().begin();
         const char *limit = it->key().end();
@@ -1627,12 +1692,12 @@ void IDBLevelDBBackingStore::getObjectStores(int64_t databaseId, Vector<int64_t>
     }
 }
 
-static int64_t getNewObjectStoreId(LevelDBDatabase* db, int64_t databaseId)
+static int64_t getNewObjectStoreId(LevelDBTransaction* transaction, int64_t databaseId)
 {
     const Vector<char> freeListStartKey = ObjectStoreFreeListKey::encode(databaseId, 0);
     const Vector<char> freeListStopKey = ObjectStoreFreeListKey::encode(databaseId, INT64_MAX);
 
-    OwnPtr<LevelDBIterator> it(db->newIterator());
+    OwnPtr<LevelDBTransaction::Iterator> it(transaction->createIterator());
     for (it->seek(freeListStartKey); it->isValid() && compareKeys(it->key(), freeListStopKey) < 0; it->next()) {
         const char* p = it->key().begin();
         const char* limit = it->key().end();
@@ -1641,7 +1706,7 @@ static int64_t getNewObjectStoreId(LevelDBDatabase* db, int64_t databaseId)
         p = ObjectStoreFreeListKey::decode(p, limit, &freeListKey);
         ASSERT(p);
 
-        bool ok = db->remove(it->key());
+        bool ok = transaction->remove(it->key());
         ASSERT_UNUSED(ok, ok);
 
         return freeListKey.objectStoreId();
@@ -1649,11 +1714,11 @@ static int64_t getNewObjectStoreId(LevelDBDatabase* db, int64_t databaseId)
 
     int64_t maxObjectStoreId;
     const Vector<char> maxObjectStoreIdKey = DatabaseMetaDataKey::encode(databaseId, DatabaseMetaDataKey::kMaxObjectStoreId);
-    if (!getInt(db, maxObjectStoreIdKey, maxObjectStoreId))
+    if (!getInt(transaction, maxObjectStoreIdKey, maxObjectStoreId))
         maxObjectStoreId = 0;
 
     int64_t objectStoreId = maxObjectStoreId + 1;
-    bool ok = putInt(db, maxObjectStoreIdKey, objectStoreId);
+    bool ok = putInt(transaction, maxObjectStoreIdKey, objectStoreId);
     ASSERT_UNUSED(ok, ok);
 
     return objectStoreId;
@@ -1661,7 +1726,8 @@ static int64_t getNewObjectStoreId(LevelDBDatabase* db, int64_t databaseId)
 
 bool IDBLevelDBBackingStore::createObjectStore(int64_t databaseId, const String& name, const String& keyPath, bool autoIncrement, int64_t& assignedObjectStoreId)
 {
-    int64_t objectStoreId = getNewObjectStoreId(m_db.get(), databaseId);
+    ImplicitTransactionScope scope(this);
+    int64_t objectStoreId = getNewObjectStoreId(m_currentTransaction.get(), databaseId);
 
     const Vector<char> nameKey = ObjectStoreMetaDataKey::encode(databaseId, objectStoreId, 0);
     const Vector<char> keyPathKey = ObjectStoreMetaDataKey::encode(databaseId, objectStoreId, 1);
@@ -1671,43 +1737,43 @@ bool IDBLevelDBBackingStore::createObjectStore(int64_t databaseId, const String&
     const Vector<char> maxIndexIdKey = ObjectStoreMetaDataKey::encode(databaseId, objectStoreId, 5);
     const Vector<char> namesKey = ObjectStoreNamesKey::encode(databaseId, name);
 
-    bool ok = putString(m_db.get(), nameKey, name);
+    bool ok = putString(m_currentTransaction.get(), nameKey, name);
     if (!ok) {
         LOG_ERROR("Internal Indexed DB error.");
         return false;
     }
 
-    ok = putString(m_db.get(), keyPathKey, keyPath);
+    ok = putString(m_currentTransaction.get(), keyPathKey, keyPath);
     if (!ok) {
         LOG_ERROR("Internal Indexed DB error.");
         return false;
     }
 
-    ok = putInt(m_db.get(), autoIncrementKey, autoIncrement);
+    ok = putInt(m_currentTransaction.get(), autoIncrementKey, autoIncrement);
     if (!ok) {
         LOG_ERROR("Internal Indexed DB error.");
         return false;
     }
 
-    ok = putInt(m_db.get(), evictableKey, false);
+    ok = putInt(m_currentTransaction.get(), evictableKey, false);
     if (!ok) {
         LOG_ERROR("Internal Indexed DB error.");
         return false;
     }
 
-    ok = putInt(m_db.get(), lastVersionKey, 1);
+    ok = putInt(m_currentTransaction.get(), lastVersionKey, 1);
     if (!ok) {
         LOG_ERROR("Internal Indexed DB error.");
         return false;
     }
 
-    ok = putInt(m_db.get(), maxIndexIdKey, kMinimumIndexId);
+    ok = putInt(m_currentTransaction.get(), maxIndexIdKey, kMinimumIndexId);
     if (!ok) {
         LOG_ERROR("Internal Indexed DB error.");
         return false;
     }
 
-    ok = putInt(m_db.get(), namesKey, objectStoreId);
+    ok = putInt(m_currentTransaction.get(), namesKey, objectStoreId);
     if (!ok) {
         LOG_ERROR("Internal Indexed DB error.");
         return false;
@@ -1718,12 +1784,12 @@ bool IDBLevelDBBackingStore::createObjectStore(int64_t databaseId, const String&
     return true;
 }
 
-static bool deleteRange(LevelDBDatabase* db, const Vector<char>& begin, const Vector<char>& end)
+static bool deleteRange(LevelDBTransaction* transaction, const Vector<char>& begin, const Vector<char>& end)
 {
     // FIXME: LevelDB may be able to provide a bulk operation that we can do first.
-    OwnPtr<LevelDBIterator> it(db->newIterator());
+    OwnPtr<LevelDBTransaction::Iterator> it(transaction->createIterator());
     for (it->seek(begin); it->isValid() && compareKeys(it->key(), end) < 0; it->next()) {
-        if (!db->remove(it->key()))
+        if (!transaction->remove(it->key()))
             return false;
     }
 
@@ -1732,18 +1798,19 @@ static bool deleteRange(LevelDBDatabase* db, const Vector<char>& begin, const Ve
 
 void IDBLevelDBBackingStore::deleteObjectStore(int64_t databaseId, int64_t objectStoreId)
 {
+    ImplicitTransactionScope scope(this);
     String objectStoreName;
-    getString(m_db.get(), ObjectStoreMetaDataKey::encode(databaseId, objectStoreId, 0), objectStoreName);
+    getString(m_currentTransaction.get(), ObjectStoreMetaDataKey::encode(databaseId, objectStoreId, 0), objectStoreName);
 
-    if (!deleteRange(m_db.get(), ObjectStoreMetaDataKey::encode(databaseId, objectStoreId, 0), ObjectStoreMetaDataKey::encode(databaseId, objectStoreId, 6)))
+    if (!deleteRange(m_currentTransaction.get(), ObjectStoreMetaDataKey::encode(databaseId, objectStoreId, 0), ObjectStoreMetaDataKey::encode(databaseId, objectStoreId, 6)))
         return; // FIXME: Report error.
 
-    putString(m_db.get(), ObjectStoreFreeListKey::encode(databaseId, objectStoreId), "");
-    m_db->remove(ObjectStoreNamesKey::encode(databaseId, objectStoreName));
+    putString(m_currentTransaction.get(), ObjectStoreFreeListKey::encode(databaseId, objectStoreId), "");
+    m_currentTransaction->remove(ObjectStoreNamesKey::encode(databaseId, objectStoreName));
 
-    if (!deleteRange(m_db.get(), IndexFreeListKey::encode(databaseId, objectStoreId, 0), IndexFreeListKey::encode(databaseId, objectStoreId, INT64_MAX)))
+    if (!deleteRange(m_currentTransaction.get(), IndexFreeListKey::encode(databaseId, objectStoreId, 0), IndexFreeListKey::encode(databaseId, objectStoreId, INT64_MAX)))
         return; // FIXME: Report error.
-    if (!deleteRange(m_db.get(), IndexMetaDataKey::encode(databaseId, objectStoreId, 0, 0), IndexMetaDataKey::encode(databaseId, objectStoreId, INT64_MAX, 0)))
+    if (!deleteRange(m_currentTransaction.get(), IndexMetaDataKey::encode(databaseId, objectStoreId, 0, 0), IndexMetaDataKey::encode(databaseId, objectStoreId, INT64_MAX, 0)))
         return; // FIXME: Report error.
 
     clearObjectStore(databaseId, objectStoreId);
@@ -1751,10 +1818,11 @@ void IDBLevelDBBackingStore::deleteObjectStore(int64_t databaseId, int64_t objec
 
 String IDBLevelDBBackingStore::getObjectStoreRecord(int64_t databaseId, int64_t objectStoreId, const IDBKey& key)
 {
+    ImplicitTransactionScope scope(this);
     const Vector<char> leveldbKey = ObjectStoreDataKey::encode(databaseId, objectStoreId, key);
     Vector<char> data;
 
-    if (!m_db->get(leveldbKey, data))
+    if (!m_currentTransaction->get(leveldbKey, data))
         return String();
 
     int64_t version;
@@ -1787,18 +1855,18 @@ private:
 };
 }
 
-static int64_t getNewVersionNumber(LevelDBDatabase* db, int64_t databaseId, int64_t objectStoreId)
+static int64_t getNewVersionNumber(LevelDBTransaction* transaction, int64_t databaseId, int64_t objectStoreId)
 {
     const Vector<char> lastVersionKey = ObjectStoreMetaDataKey::encode(databaseId, objectStoreId, 4);
 
     int64_t lastVersion = -1;
-    if (!getInt(db, lastVersionKey, lastVersion))
+    if (!getInt(transaction, lastVersionKey, lastVersion))
         lastVersion = 0;
 
     ASSERT(lastVersion >= 0);
 
     int64_t version = lastVersion + 1;
-    bool ok = putInt(db, lastVersionKey, version);
+    bool ok = putInt(transaction, lastVersionKey, version);
     ASSERT_UNUSED(ok, ok);
 
     ASSERT(version > lastVersion); // FIXME: Think about how we want to handle the overflow scenario.
@@ -1808,18 +1876,19 @@ static int64_t getNewVersionNumber(LevelDBDatabase* db, int64_t databaseId, int6
 
 bool IDBLevelDBBackingStore::putObjectStoreRecord(int64_t databaseId, int64_t objectStoreId, const IDBKey& key, const String& value, ObjectStoreRecordIdentifier* recordIdentifier)
 {
-    int64_t version = getNewVersionNumber(m_db.get(), databaseId, objectStoreId);
+    ImplicitTransactionScope scope(this);
+    int64_t version = getNewVersionNumber(m_currentTransaction.get(), databaseId, objectStoreId);
     const Vector<char> objectStoredataKey = ObjectStoreDataKey::encode(databaseId, objectStoreId, key);
 
     Vector<char> v;
     v.append(encodeVarInt(version));
     v.append(encodeString(value));
 
-    if (!m_db->put(objectStoredataKey, v))
+    if (!m_currentTransaction->put(objectStoredataKey, v))
         return false;
 
     const Vector<char> existsEntryKey = ExistsEntryKey::encode(databaseId, objectStoreId, key);
-    if (!m_db->put(existsEntryKey, encodeInt(version)))
+    if (!m_currentTransaction->put(existsEntryKey, encodeInt(version)))
         return false;
 
     LevelDBRecordIdentifier* levelDBRecordIdentifier = static_cast<LevelDBRecordIdentifier*>(recordIdentifier);
@@ -1830,10 +1899,11 @@ bool IDBLevelDBBackingStore::putObjectStoreRecord(int64_t databaseId, int64_t ob
 
 void IDBLevelDBBackingStore::clearObjectStore(int64_t databaseId, int64_t objectStoreId)
 {
+    ImplicitTransactionScope scope(this);
     const Vector<char> startKey = KeyPrefix(databaseId, objectStoreId, 0).encode();
     const Vector<char> stopKey = KeyPrefix(databaseId, objectStoreId + 1, 0).encode();
 
-    deleteRange(m_db.get(), startKey, stopKey);
+    deleteRange(m_currentTransaction.get(), startKey, stopKey);
 }
 
 PassRefPtr<IDBBackingStore::ObjectStoreRecordIdentifier> IDBLevelDBBackingStore::createInvalidRecordIdentifier()
@@ -1843,17 +1913,19 @@ PassRefPtr<IDBBackingStore::ObjectStoreRecordIdentifier> IDBLevelDBBackingStore:
 
 void IDBLevelDBBackingStore::deleteObjectStoreRecord(int64_t databaseId, int64_t objectStoreId, const ObjectStoreRecordIdentifier* recordIdentifier)
 {
+    ImplicitTransactionScope scope(this);
     const LevelDBRecordIdentifier* levelDBRecordIdentifier = static_cast<const LevelDBRecordIdentifier*>(recordIdentifier);
     const Vector<char> key = ObjectStoreDataKey::encode(databaseId, objectStoreId, levelDBRecordIdentifier->primaryKey());
-    m_db->remove(key);
+    m_currentTransaction->remove(key);
 }
 
 double IDBLevelDBBackingStore::nextAutoIncrementNumber(int64_t databaseId, int64_t objectStoreId)
 {
+    ImplicitTransactionScope scope(this);
     const Vector<char> startKey = ObjectStoreDataKey::encode(databaseId, objectStoreId, minIDBKey());
     const Vector<char> stopKey = ObjectStoreDataKey::encode(databaseId, objectStoreId, maxIDBKey());
 
-    OwnPtr<LevelDBIterator> it(m_db->newIterator());
+    OwnPtr<LevelDBTransaction::Iterator> it(m_currentTransaction->createIterator());
 
     int maxNumericKey = 0;
 
@@ -1879,10 +1951,11 @@ double IDBLevelDBBackingStore::nextAutoIncrementNumber(int64_t databaseId, int64
 
 bool IDBLevelDBBackingStore::keyExistsInObjectStore(int64_t databaseId, int64_t objectStoreId, const IDBKey& key, ObjectStoreRecordIdentifier* foundRecordIdentifier)
 {
+    ImplicitTransactionScope scope(this);
     const Vector<char> leveldbKey = ObjectStoreDataKey::encode(databaseId, objectStoreId, key);
     Vector<char> data;
 
-    if (!m_db->get(leveldbKey, data))
+    if (!m_currentTransaction->get(leveldbKey, data))
         return false;
 
     int64_t version;
@@ -1897,10 +1970,11 @@ bool IDBLevelDBBackingStore::keyExistsInObjectStore(int64_t databaseId, int64_t
 
 bool IDBLevelDBBackingStore::forEachObjectStoreRecord(int64_t databaseId, int64_t objectStoreId, ObjectStoreRecordCallback& callback)
 {
+    ImplicitTransactionScope scope(this);
     const Vector<char> startKey = ObjectStoreDataKey::encode(databaseId, objectStoreId, minIDBKey());
     const Vector<char> stopKey = ObjectStoreDataKey::encode(databaseId, objectStoreId, maxIDBKey());
 
-    OwnPtr<LevelDBIterator> it(m_db->newIterator());
+    OwnPtr<LevelDBTransaction::Iterator> it(m_currentTransaction->createIterator());
     for (it->seek(startKey); it->isValid() && compareKeys(it->key(), stopKey) < 0; it->next()) {
         const char *p = it->key().begin();
         const char *limit = it->key().end();
@@ -1926,10 +2000,11 @@ bool IDBLevelDBBackingStore::forEachObjectStoreRecord(int64_t databaseId, int64_
 
 void IDBLevelDBBackingStore::getIndexes(int64_t databaseId, int64_t objectStoreId, Vector<int64_t>& foundIds, Vector<String>& foundNames, Vector<String>& foundKeyPaths, Vector<bool>& foundUniqueFlags)
 {
+    ImplicitTransactionScope scope(this);
     const Vector<char> startKey = IndexMetaDataKey::encode(databaseId, objectStoreId, 0, 0);
     const Vector<char> stopKey = IndexMetaDataKey::encode(databaseId, objectStoreId + 1, 0, 0);
 
-    OwnPtr<LevelDBIterator> it(m_db->newIterator());
+    OwnPtr<LevelDBTransaction::Iterator> it(m_currentTransaction->createIterator());
     for (it->seek(startKey); it->isValid() && compareKeys(it->key(), stopKey) < 0; it->next()) {
         const char* p = it->key().begin();
         const char* limit = it->key().end();
@@ -1964,12 +2039,12 @@ void IDBLevelDBBackingStore::getIndexes(int64_t databaseId, int64_t objectStoreI
     }
 }
 
-static int64_t getNewIndexId(LevelDBDatabase* db, int64_t databaseId, int64_t objectStoreId)
+static int64_t getNewIndexId(LevelDBTransaction* transaction, int64_t databaseId, int64_t objectStoreId)
 {
     const Vector<char> startKey = IndexFreeListKey::encode(databaseId, objectStoreId, 0);
     const Vector<char> stopKey = IndexFreeListKey::encode(databaseId, objectStoreId, INT64_MAX);
 
-    OwnPtr<LevelDBIterator> it(db->newIterator());
+    OwnPtr<LevelDBTransaction::Iterator> it(transaction->createIterator());
     for (it->seek(startKey); it->isValid() && compareKeys(it->key(), stopKey) < 0; it->next()) {
         const char* p = it->key().begin();
         const char* limit = it->key().end();
@@ -1978,7 +2053,7 @@ static int64_t getNewIndexId(LevelDBDatabase* db, int64_t databaseId, int64_t ob
         p = IndexFreeListKey::decode(p, limit, &freeListKey);
         ASSERT(p);
 
-        bool ok = db->remove(it->key());
+        bool ok = transaction->remove(it->key());
         ASSERT_UNUSED(ok, ok);
 
         ASSERT(freeListKey.indexId() >= kMinimumIndexId);
@@ -1987,11 +2062,11 @@ static int64_t getNewIndexId(LevelDBDatabase* db, int64_t databaseId, int64_t ob
 
     int64_t maxIndexId;
     const Vector<char> maxIndexIdKey = ObjectStoreMetaDataKey::encode(databaseId, objectStoreId, 5);
-    if (!getInt(db, maxIndexIdKey, maxIndexId))
+    if (!getInt(transaction, maxIndexIdKey, maxIndexId))
         maxIndexId = kMinimumIndexId;
 
     int64_t indexId = maxIndexId + 1;
-    bool ok = putInt(db, maxIndexIdKey, indexId);
+    bool ok = putInt(transaction, maxIndexIdKey, indexId);
     if (!ok)
         return false;
 
@@ -2000,25 +2075,26 @@ static int64_t getNewIndexId(LevelDBDatabase* db, int64_t databaseId, int64_t ob
 
 bool IDBLevelDBBackingStore::createIndex(int64_t databaseId, int64_t objectStoreId, const String& name, const String& keyPath, bool isUnique, int64_t& indexId)
 {
-    indexId = getNewIndexId(m_db.get(), databaseId, objectStoreId);
+    ImplicitTransactionScope scope(this);
+    indexId = getNewIndexId(m_currentTransaction.get(), databaseId, objectStoreId);
 
     const Vector<char> nameKey = IndexMetaDataKey::encode(databaseId, objectStoreId, indexId, 0);
     const Vector<char> uniqueKey = IndexMetaDataKey::encode(databaseId, objectStoreId, indexId, 1);
     const Vector<char> keyPathKey = IndexMetaDataKey::encode(databaseId, objectStoreId, indexId, 2);
 
-    bool ok = putString(m_db.get(), nameKey, name);
+    bool ok = putString(m_currentTransaction.get(), nameKey, name);
     if (!ok) {
         LOG_ERROR("Internal Indexed DB error.");
         return false;
     }
 
-    ok = putInt(m_db.get(), uniqueKey, isUnique);
+    ok = putInt(m_currentTransaction.get(), uniqueKey, isUnique);
     if (!ok) {
         LOG_ERROR("Internal Indexed DB error.");
         return false;
     }
 
-    ok = putString(m_db.get(), keyPathKey, keyPath);
+    ok = putString(m_currentTransaction.get(), keyPathKey, keyPath);
     if (!ok) {
         LOG_ERROR("Internal Indexed DB error.");
         return false;
@@ -2035,22 +2111,23 @@ void IDBLevelDBBackingStore::deleteIndex(int64_t, int64_t, int64_t)
 
 bool IDBLevelDBBackingStore::putIndexDataForRecord(int64_t databaseId, int64_t objectStoreId, int64_t indexId, const IDBKey& key, const ObjectStoreRecordIdentifier* recordIdentifier)
 {
+    ImplicitTransactionScope scope(this);
     ASSERT(indexId >= kMinimumIndexId);
     const LevelDBRecordIdentifier* levelDBRecordIdentifier = static_cast<const LevelDBRecordIdentifier*>(recordIdentifier);
 
-    const int64_t globalSequenceNumber = getNewVersionNumber(m_db.get(), databaseId, objectStoreId);
+    const int64_t globalSequenceNumber = getNewVersionNumber(m_currentTransaction.get(), databaseId, objectStoreId);
     const Vector<char> indexDataKey = IndexDataKey::encode(databaseId, objectStoreId, indexId, key, globalSequenceNumber);
 
     Vector<char> data;
     data.append(encodeVarInt(levelDBRecordIdentifier->version()));
     data.append(levelDBRecordIdentifier->primaryKey());
 
-    return m_db->put(indexDataKey, data);
+    return m_currentTransaction->put(indexDataKey, data);
 }
 
-static bool findGreatestKeyLessThan(LevelDBDatabase* db, const Vector<char>& target, Vector<char>& foundKey)
+static bool findGreatestKeyLessThan(LevelDBTransaction* transaction, const Vector<char>& target, Vector<char>& foundKey)
 {
-    OwnPtr<LevelDBIterator> it(db->newIterator());
+    OwnPtr<LevelDBTransaction::Iterator> it(transaction->createIterator());
     it->seek(target);
 
     if (!it->isValid()) {
@@ -2085,12 +2162,12 @@ String IDBLevelDBBackingStore::getObjectViaIndex(int64_t databaseId, int64_t obj
     return getObjectStoreRecord(databaseId, objectStoreId, *primaryKey);
 }
 
-static bool versionExists(LevelDBDatabase* db, int64_t databaseId, int64_t objectStoreId, int64_t version, const Vector<char>& encodedPrimaryKey)
+static bool versionExists(LevelDBTransaction* transaction, int64_t databaseId, int64_t objectStoreId, int64_t version, const Vector<char>& encodedPrimaryKey)
 {
     const Vector<char> key = ExistsEntryKey::encode(databaseId, objectStoreId, encodedPrimaryKey);
     Vector<char> data;
 
-    if (!db->get(key, data))
+    if (!transaction->get(key, data))
         return false;
 
     return decodeInt(data.begin(), data.end()) == version;
@@ -2098,8 +2175,9 @@ static bool versionExists(LevelDBDatabase* db, int64_t databaseId, int64_t objec
 
 PassRefPtr<IDBKey> IDBLevelDBBackingStore::getPrimaryKeyViaIndex(int64_t databaseId, int64_t objectStoreId, int64_t indexId, const IDBKey& key)
 {
+    ImplicitTransactionScope scope(this);
     const Vector<char> leveldbKey = IndexDataKey::encode(databaseId, objectStoreId, indexId, key, 0);
-    OwnPtr<LevelDBIterator> it(m_db->newIterator());
+    OwnPtr<LevelDBTransaction::Iterator> it(m_currentTransaction->createIterator());
     it->seek(leveldbKey);
 
     for (;;) {
@@ -2115,9 +2193,9 @@ PassRefPtr<IDBKey> IDBLevelDBBackingStore::getPrimaryKeyViaIndex(int64_t databas
         Vector<char> encodedPrimaryKey;
         encodedPrimaryKey.append(p, it->value().end() - p);
 
-        if (!versionExists(m_db.get(), databaseId, objectStoreId, version, encodedPrimaryKey)) {
+        if (!versionExists(m_currentTransaction.get(), databaseId, objectStoreId, version, encodedPrimaryKey)) {
             // Delete stale index data entry and continue.
-            m_db->remove(it->key());
+            m_currentTransaction->remove(it->key());
             it->next();
             continue;
         }
@@ -2130,8 +2208,9 @@ PassRefPtr<IDBKey> IDBLevelDBBackingStore::getPrimaryKeyViaIndex(int64_t databas
 
 bool IDBLevelDBBackingStore::keyExistsInIndex(int64_t databaseId, int64_t objectStoreId, int64_t indexId, const IDBKey& key)
 {
+    ImplicitTransactionScope scope(this);
     const Vector<char> levelDBKey = IndexDataKey::encode(databaseId, objectStoreId, indexId, key, 0);
-    OwnPtr<LevelDBIterator> it(m_db->newIterator());
+    OwnPtr<LevelDBTransaction::Iterator> it(m_currentTransaction->createIterator());
 
     bool found = false;
 
@@ -2157,8 +2236,8 @@ public:
     bool firstSeek();
 
 protected:
-    CursorImplCommon(LevelDBDatabase* db, const Vector<char>& lowKey, bool lowOpen, const Vector<char>& highKey, bool highOpen, bool forward)
-        : m_db(db)
+    CursorImplCommon(LevelDBTransaction* transaction, const Vector<char>& lowKey, bool lowOpen, const Vector<char>& highKey, bool highOpen, bool forward)
+        : m_transaction(transaction)
         , m_lowKey(lowKey)
         , m_lowOpen(lowOpen)
         , m_highKey(highKey)
@@ -2168,8 +2247,8 @@ protected:
     }
     virtual ~CursorImplCommon() {}
 
-    LevelDBDatabase* m_db;
-    OwnPtr<LevelDBIterator> m_iterator;
+    RefPtr<LevelDBTransaction> m_transaction;
+    OwnPtr<LevelDBTransaction::Iterator> m_iterator;
     Vector<char> m_lowKey;
     bool m_lowOpen;
     Vector<char> m_highKey;
@@ -2180,7 +2259,7 @@ protected:
 
 bool CursorImplCommon::firstSeek()
 {
-    m_iterator = m_db->newIterator();
+    m_iterator = m_transaction->createIterator();
 
     if (m_forward)
         m_iterator->seek(m_lowKey);
@@ -2240,10 +2319,6 @@ bool CursorImplCommon::continueFunction(const IDBKey* key)
         if (!m_iterator->isValid())
             return false;
 
-        Vector<char> trash;
-        if (!m_db->get(m_iterator->key(), trash))
-             continue;
-
         if (m_forward && m_highOpen && compareIndexKeys(m_iterator->key(), m_highKey) >= 0) // high key not included in range
             return false;
         if (m_forward && !m_highOpen && compareIndexKeys(m_iterator->key(), m_highKey) > 0)
@@ -2276,9 +2351,9 @@ bool CursorImplCommon::continueFunction(const IDBKey* key)
 
 class ObjectStoreCursorImpl : public CursorImplCommon {
 public:
-    static PassRefPtr<ObjectStoreCursorImpl> create(LevelDBDatabase* db, const Vector<char>& lowKey, bool lowOpen, const Vector<char>& highKey, bool highOpen, bool forward)
+    static PassRefPtr<ObjectStoreCursorImpl> create(LevelDBTransaction* transaction, const Vector<char>& lowKey, bool lowOpen, const Vector<char>& highKey, bool highOpen, bool forward)
     {
-        return adoptRef(new ObjectStoreCursorImpl(db, lowKey, lowOpen, highKey, highOpen, forward));
+        return adoptRef(new ObjectStoreCursorImpl(transaction, lowKey, lowOpen, highKey, highOpen, forward));
     }
 
     // CursorImplCommon
@@ -2288,8 +2363,8 @@ public:
     virtual bool loadCurrentRow();
 
 private:
-    ObjectStoreCursorImpl(LevelDBDatabase* db, const Vector<char>& lowKey, bool lowOpen, const Vector<char>& highKey, bool highOpen, bool forward)
-        : CursorImplCommon(db, lowKey, lowOpen, highKey, highOpen, forward)
+    ObjectStoreCursorImpl(LevelDBTransaction* transaction, const Vector<char>& lowKey, bool lowOpen, const Vector<char>& highKey, bool highOpen, bool forward)
+        : CursorImplCommon(transaction, lowKey, lowOpen, highKey, highOpen, forward)
     {
     }
 
@@ -2301,13 +2376,16 @@ bool ObjectStoreCursorImpl::loadCurrentRow()
     const char* p = m_iterator->key().begin();
     const char* keyLimit = m_iterator->key().end();
 
-    ObjectStoreDataKey objectStoreDataKey;
-    p = ObjectStoreDataKey::decode(p, keyLimit, &objectStoreDataKey);
+    // Decode the user key straight from the iterator's key, without copying it out first.
+    KeyPrefix prefix;
+    p = KeyPrefix::decode(p, keyLimit, &prefix);
+    ASSERT(p);
+    if (!p)
+        return false;
+    p = decodeIDBKey(p, keyLimit, m_currentKey);
     ASSERT(p);
     if (!p)
         return false;
-
-    m_currentKey = objectStoreDataKey.userKey();
 
     int64_t version;
     const char* q = decodeVarInt(m_iterator->value().begin(), m_iterator->value().end(), version);
@@ -2323,9 +2401,9 @@ bool ObjectStoreCursorImpl::loadCurrentRow()
 
 class IndexKeyCursorImpl : public CursorImplCommon {
 public:
-    static PassRefPtr<IndexKeyCursorImpl> create(LevelDBDatabase* db, const Vector<char>& lowKey, bool lowOpen, const Vector<char>& highKey, bool highOpen, bool forward)
+    static PassRefPtr<IndexKeyCursorImpl> create(LevelDBTransaction* transaction, const Vector<char>& lowKey, bool lowOpen, const Vector<char>& highKey, bool highOpen, bool forward)
     {
-        return adoptRef(new IndexKeyCursorImpl(db, lowKey, lowOpen, highKey, highOpen, forward));
+        return adoptRef(new IndexKeyCursorImpl(transaction, lowKey, lowOpen, highKey, highOpen, forward));
     }
 
     // CursorImplCommon
@@ -2336,8 +2414,8 @@ public:
     virtual bool loadCurrentRow();
 
 private:
-    IndexKeyCursorImpl(LevelDBDatabase* db, const Vector<char>& lowKey, bool lowOpen, const Vector<char>& highKey, bool highOpen, bool forward)
-        : CursorImplCommon(db, lowKey, lowOpen, highKey, highOpen, forward)
+    IndexKeyCursorImpl(LevelDBTransaction* transaction, const Vector<char>& lowKey, bool lowOpen, const Vector<char>& highKey, bool highOpen, bool forward)
+        : CursorImplCommon(transaction, lowKey, lowOpen, highKey, highOpen, forward)
     {
     }
 
@@ -2348,10 +2426,11 @@ bool IndexKeyCursorImpl::loadCurrentRow()
 {
     const char* p = m_iterator->key().begin();
     const char* keyLimit = m_iterator->key().end();
-    IndexDataKey indexDataKey;
-    p = IndexDataKey::decode(p, keyLimit, &indexDataKey);
-
-    m_currentKey = indexDataKey.userKey();
+    KeyPrefix prefix;
+    p = KeyPrefix::decode(p, keyLimit, &prefix);
+    ASSERT(p);
+    if (!p || !decodeIDBKey(p, keyLimit, m_currentKey))
+        return false;
 
     int64_t indexDataVersion;
     const char* q = decodeVarInt(m_iterator->value().begin(), m_iterator->value().end(), indexDataVersion);
@@ -2359,15 +2438,18 @@ bool IndexKeyCursorImpl::loadCurrentRow()
     if (!q)
         return false;
 
+    // The index entry's value holds the encoded primary key, which is also how the object store data key stores it.
+    const char* encodedPrimaryKey = q;
     q = decodeIDBKey(q, m_iterator->value().end(), m_primaryKey);
     ASSERT(q);
     if (!q)
         return false;
 
-    Vector<char> primaryLevelDBKey = ObjectStoreDataKey::encode(indexDataKey.databaseId(), indexDataKey.objectStoreId(), *m_primaryKey);
+    Vector<char> primaryLevelDBKey = KeyPrefix(prefix.m_databaseId, prefix.m_objectStoreId, ObjectStoreDataKey::kSpecialIndexNumber).encode();
+    primaryLevelDBKey.append(encodedPrimaryKey, q - encodedPrimaryKey);
 
     Vector<char> result;
-    if (!m_db->get(primaryLevelDBKey, result))
+    if (!m_transaction->get(primaryLevelDBKey, result))
         return false;
 
     int64_t objectStoreDataVersion;
@@ -2377,7 +2459,7 @@ bool IndexKeyCursorImpl::loadCurrentRow()
         return false;
 
     if (objectStoreDataVersion != indexDataVersion) { // FIXME: This is probably not very well covered by the layout tests.
-        m_db->remove(m_iterator->key());
+        m_transaction->remove(m_iterator->key());
         return false;
     }
 
@@ -2386,9 +2468,9 @@ bool IndexKeyCursorImpl::loadCurrentRow()
 
 class IndexCursorImpl : public CursorImplCommon {
 public:
-    static PassRefPtr<IndexCursorImpl> create(LevelDBDatabase* db, const Vector<char>& lowKey, bool lowOpen, const Vector<char>& highKey, bool highOpen, bool forward)
+    static PassRefPtr<IndexCursorImpl> create(LevelDBTransaction* transaction, const Vector<char>& lowKey, bool lowOpen, const Vector<char>& highKey, bool highOpen, bool forward)
     {
-        return adoptRef(new IndexCursorImpl(db, lowKey, lowOpen, highKey, highOpen, forward));
+        return adoptRef(new IndexCursorImpl(transaction, lowKey, lowOpen, highKey, highOpen, forward));
     }
 
     // CursorImplCommon
@@ -2399,8 +2481,8 @@ public:
     bool loadCurrentRow();
 
 private:
-    IndexCursorImpl(LevelDBDatabase* db, const Vector<char>& lowKey, bool lowOpen, const Vector<char>& highKey, bool highOpen, bool forward)
-        : CursorImplCommon(db, lowKey, lowOpen, highKey, highOpen, forward)
+    IndexCursorImpl(LevelDBTransaction* transaction, const Vector<char>& lowKey, bool lowOpen, const Vector<char>& highKey, bool highOpen, bool forward)
+        : CursorImplCommon(transaction, lowKey, lowOpen, highKey, highOpen, forward)
     {
     }
 
@@ -2414,10 +2496,11 @@ bool IndexCursorImpl::loadCurrentRow()
     const char *p = m_iterator->key().begin();
     const char *limit = m_iterator->key().end();
 
-    IndexDataKey indexDataKey;
-    p = IndexDataKey::decode(p, limit, &indexDataKey);
-
-    m_currentKey = indexDataKey.userKey();
+    KeyPrefix prefix;
+    p = KeyPrefix::decode(p, limit, &prefix);
+    ASSERT(p);
+    if (!p || !decodeIDBKey(p, limit, m_currentKey))
+        return false;
 
     const char *q = m_iterator->value().begin();
     const char *valueLimit = m_iterator->value().end();
@@ -2427,15 +2510,17 @@ bool IndexCursorImpl::loadCurrentRow()
     ASSERT(q);
     if (!q)
         return false;
+    const char* encodedPrimaryKey = q;
     q = decodeIDBKey(q, valueLimit, m_primaryKey);
     ASSERT(q);
     if (!q)
         return false;
 
-    m_primaryLevelDBKey = ObjectStoreDataKey::encode(indexDataKey.databaseId(), indexDataKey.objectStoreId(), *m_primaryKey);
+    m_primaryLevelDBKey = KeyPrefix(prefix.m_databaseId, prefix.m_objectStoreId, ObjectStoreDataKey::kSpecialIndexNumber).encode();
+    m_primaryLevelDBKey.append(encodedPrimaryKey, q - encodedPrimaryKey);
 
     Vector<char> result;
-    if (!m_db->get(m_primaryLevelDBKey, result))
+    if (!m_transaction->get(m_primaryLevelDBKey, result))
         return false;
 
     int64_t objectStoreDataVersion;
@@ -2445,7 +2530,7 @@ bool IndexCursorImpl::loadCurrentRow()
         return false;
 
     if (objectStoreDataVersion != indexDataVersion) {
-        m_db->remove(m_iterator->key());
+        m_transaction->remove(m_iterator->key());
         return false;
     }
 
@@ -2455,9 +2540,9 @@ bool IndexCursorImpl::loadCurrentRow()
 
 }
 
-static bool findLastIndexKeyEqualTo(LevelDBDatabase* db, const Vector<char>& target, Vector<char>& foundKey)
+static bool findLastIndexKeyEqualTo(LevelDBTransaction* transaction, const Vector<char>& target, Vector<char>& foundKey)
 {
-    OwnPtr<LevelDBIterator> it(db->newIterator());
+    OwnPtr<LevelDBTransaction::Iterator> it(transaction->createIterator());
     it->seek(target);
 
     if (!it->isValid())
@@ -2474,6 +2559,7 @@ static bool findLastIndexKeyEqualTo(LevelDBDatabase* db, const Vector<char>& tar
 
 PassRefPtr<IDBBackingStore::Cursor> IDBLevelDBBackingStore::openObjectStoreCursor(int64_t databaseId, int64_t objectStoreId, const IDBKeyRange* range, IDBCursor::Direction direction)
 {
+    ImplicitTransactionScope scope(this);
     bool lowerBound = range && range->lower();
     bool upperBound = range && range->upper();
     bool forward = (direction == IDBCursor::NEXT_NO_DUPLICATE || direction == IDBCursor::NEXT);
@@ -2494,7 +2580,7 @@ PassRefPtr<IDBBackingStore::Cursor> IDBLevelDBBackingStore::openObjectStoreCurso
         upperOpen = true; // Not included.
 
         if (!forward) { // We need a key that exists.
-            if (!findGreatestKeyLessThan(m_db.get(), stopKey, stopKey))
+            if (!findGreatestKeyLessThan(m_currentTransaction.get(), stopKey, stopKey))
                 return 0;
             upperOpen = false;
         }
@@ -2503,7 +2589,7 @@ PassRefPtr<IDBBackingStore::Cursor> IDBLevelDBBackingStore::openObjectStoreCurso
         upperOpen = range->upperOpen();
     }
 
-    RefPtr<ObjectStoreCursorImpl> cursor = ObjectStoreCursorImpl::create(m_db.get(), startKey, lowerOpen, stopKey, upperOpen, forward);
+    RefPtr<ObjectStoreCursorImpl> cursor = ObjectStoreCursorImpl::create(m_currentTransaction.get(), startKey, lowerOpen, stopKey, upperOpen, forward);
     if (!cursor->firstSeek())
         return 0;
 
@@ -2512,6 +2598,7 @@ PassRefPtr<IDBBackingStore::Cursor> IDBLevelDBBackingStore::openObjectStoreCurso
 
 PassRefPtr<IDBBackingStore::Cursor> IDBLevelDBBackingStore::openIndexKeyCursor(int64_t databaseId, int64_t objectStoreId, int64_t indexId, const IDBKeyRange* range, IDBCursor::Direction direction)
 {
+    ImplicitTransactionScope scope(this);
     bool lowerBound = range && range->lower();
     bool upperBound = range && range->upper();
     bool forward = (direction == IDBCursor::NEXT_NO_DUPLICATE || direction == IDBCursor::NEXT);
@@ -2532,18 +2619,18 @@ PassRefPtr<IDBBackingStore::Cursor> IDBLevelDBBackingStore::openIndexKeyCursor(i
         upperOpen = false; // Included.
 
         if (!forward) { // We need a key that exists.
-            if (!findGreatestKeyLessThan(m_db.get(), stopKey, stopKey))
+            if (!findGreatestKeyLessThan(m_currentTransaction.get(), stopKey, stopKey))
                 return 0;
             upperOpen = false;
         }
     } else {
         stopKey = IndexDataKey::encode(databaseId, objectStoreId, indexId, *range->upper(), 0);
-        if (!findLastIndexKeyEqualTo(m_db.get(), stopKey, stopKey)) // Seek to the *last* key in the set of non-unique keys.
+        if (!findLastIndexKeyEqualTo(m_currentTransaction.get(), stopKey, stopKey)) // Seek to the *last* key in the set of non-unique keys.
             return 0;
         upperOpen = range->upperOpen();
     }
 
-    RefPtr<IndexKeyCursorImpl> cursor = IndexKeyCursorImpl::create(m_db.get(), startKey, lowerOpen, stopKey, upperOpen, forward);
+    RefPtr<IndexKeyCursorImpl> cursor = IndexKeyCursorImpl::create(m_currentTransaction.get(), startKey, lowerOpen, stopKey, upperOpen, forward);
     if (!cursor->firstSeek())
         return 0;
 
@@ -2552,6 +2639,7 @@ PassRefPtr<IDBBackingStore::Cursor> IDBLevelDBBackingStore::openIndexKeyCursor(i
 
 PassRefPtr<IDBBackingStore::Cursor> IDBLevelDBBackingStore::openIndexCursor(int64_t databaseId, int64_t objectStoreId, int64_t indexId, const IDBKeyRange* range, IDBCursor::Direction direction)
 {
+    ImplicitTransactionScope scope(this);
     bool lowerBound = range && range->lower();
     bool upperBound = range && range->upper();
     bool forward = (direction == IDBCursor::NEXT_NO_DUPLICATE || direction == IDBCursor::NEXT);
@@ -2572,37 +2660,74 @@ PassRefPtr<IDBBackingStore::Cursor> IDBLevelDBBackingStore::openIndexCursor(int6
         upperOpen = false; // Included.
 
         if (!forward) { // We need a key that exists.
-            if (!findGreatestKeyLessThan(m_db.get(), stopKey, stopKey))
+            if (!findGreatestKeyLessThan(m_currentTransaction.get(), stopKey, stopKey))
                 return 0;
             upperOpen = false;
         }
     } else {
         stopKey = IndexDataKey::encode(databaseId, objectStoreId, indexId, *range->upper(), 0);
-        if (!findLastIndexKeyEqualTo(m_db.get(), stopKey, stopKey)) // Seek to the *last* key in the set of non-unique keys.
+        if (!findLastIndexKeyEqualTo(m_currentTransaction.get(), stopKey, stopKey)) // Seek to the *last* key in the set of non-unique keys.
             return 0;
         upperOpen = range->upperOpen();
     }
 
-    RefPtr<IndexCursorImpl> cursor = IndexCursorImpl::create(m_db.get(), startKey, lowerOpen, stopKey, upperOpen, forward);
+    RefPtr<IndexCursorImpl> cursor = IndexCursorImpl::create(m_currentTransaction.get(), startKey, lowerOpen, stopKey, upperOpen, forward);
     if (!cursor->firstSeek())
         return 0;
 
     return cursor.release();
 }
 
-namespace {
-class DummyTransaction : public IDBBackingStore::Transaction {
+// Collects the writes of an IndexedDB transaction and hands them to LevelDB as a single write batch when it commits.
+class IDBLevelDBBackingStore::TransactionImpl : public IDBBackingStore::Transaction {
 public:
-    virtual void begin() {}
-    virtual void commit() {}
-    virtual void rollback() {}
+    static PassRefPtr<TransactionImpl> create(IDBLevelDBBackingStore* backingStore) { return adoptRef(new TransactionImpl(backingStore)); }
+
+    virtual void begin()
+    {
+        ASSERT(!m_backingStore->m_currentTransaction);
+        m_transaction = LevelDBTransaction::create(m_backingStore->m_db.get(), m_backingStore->m_comparator.get());
+        m_backingStore->m_currentTransaction = m_transaction;
+    }
+
+    virtual void commit()
+    {
+        ASSERT(m_transaction);
+        ASSERT(m_backingStore->m_currentTransaction == m_transaction);
+        if (!m_transaction->commit())
+            LOG_ERROR("Failed to commit IndexedDB transaction to LevelDB");
+        finish();
+    }
+
+    virtual void rollback()
+    {
+        // A transaction that is aborted before it starts has nothing to roll back.
+        if (!m_transaction)
+            return;
+        ASSERT(m_backingStore->m_currentTransaction == m_transaction);
+        m_transaction->rollback();
+        finish();
+    }
+
+private:
+    TransactionImpl(IDBLevelDBBackingStore* backingStore)
+        : m_backingStore(backingStore)
+    {
+    }
+
+    void finish()
+    {
+        m_backingStore->m_currentTransaction = 0;
+        m_transaction = 0;
+    }
+
+    RefPtr<IDBLevelDBBackingStore> m_backingStore;
+    RefPtr<LevelDBTransaction> m_transaction;
 };
-}
 
 PassRefPtr<IDBBackingStore::Transaction> IDBLevelDBBackingStore::createTransaction()
 {
-    // FIXME: We need to implement a transaction abstraction that allows for roll-backs, and write tests for it.
-    return adoptRef(new DummyTransaction());
+    return TransactionImpl::create(this);
 }
 
 // FIXME: deleteDatabase should be part of IDBBackingStore.
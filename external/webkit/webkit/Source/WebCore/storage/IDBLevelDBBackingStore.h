@@ -36,6 +36,7 @@ namespace WebCore {
 
 class LevelDBComparator;
 class LevelDBDatabase;
+class LevelDBTransaction;
 
 class IDBLevelDBBackingStore : public IDBBackingStore {
 public:
@@ -76,10 +77,17 @@ public:
 private:
     IDBLevelDBBackingStore(String identifier, IDBFactoryBackendImpl*, LevelDBDatabase*);
 
+    class ImplicitTransactionScope;
+    friend class ImplicitTransactionScope;
+    class TransactionImpl;
+    friend class TransactionImpl;
+
     String m_identifier;
     RefPtr<IDBFactoryBackendImpl> m_factory;
     OwnPtr<LevelDBDatabase> m_db;
     OwnPtr<LevelDBComparator> m_comparator;
+    // Reads and writes go through the running transaction, which keeps the writes in memory until it commits.
+    RefPtr<LevelDBTransaction> m_currentTransaction;
 };
 
 } // namespace WebCore
@@ -31,6 +31,7 @@
 #if ENABLE(DATABASE)
 
 #include "Database.h"
+#include "DatabaseAuthorizer.h"
 #include "Logging.h"
 #include "SQLError.h"
 #include "SQLiteDatabase.h"
@@ -39,6 +40,7 @@
 #include "SQLStatementErrorCallback.h"
 #include "SQLTransaction.h"
 #include "SQLValue.h"
+#include <wtf/OwnPtr.h>
 #include <wtf/text/CString.h>
 
 namespace WebCore {
@@ -73,14 +75,23 @@ bool SQLStatement::execute(Database* db)
 
     SQLiteDatabase* database = &db->sqliteDatabase();
 
-    SQLiteStatement statement(*database, m_statement);
-    int result = statement.prepare();
+    DatabaseAuthorizer::Actions authorizerActions;
+    OwnPtr<SQLiteStatement> cachedStatement = db->statementCache().take(m_statement, m_permissions, authorizerActions);
+    if (cachedStatement)
+        db->replayAuthorizerActions(authorizerActions);
+    else {
+        cachedStatement = adoptPtr(new SQLiteStatement(*database, m_statement));
+        int result = cachedStatement->prepare();
 
-    if (result != SQLResultOk) {
-        LOG(StorageAPI, "Unable to verify correctness of statement %s - error %i (%s)", m_statement.ascii().data(), result, database->lastErrorMsg());
-        m_error = SQLError::create(result == SQLResultInterrupt ? SQLError::DATABASE_ERR : SQLError::SYNTAX_ERR, database->lastErrorMsg());
-        return false;
+        if (result != SQLResultOk) {
+            LOG(StorageAPI, "Unable to verify correctness of statement %s - error %i (%s)", m_statement.ascii().data(), result, database->lastErrorMsg());
+            m_error = SQLError::create(result == SQLResultInterrupt ? SQLError::DATABASE_ERR : SQLError::SYNTAX_ERR, database->lastErrorMsg());
+            return false;
+        }
+        authorizerActions = db->lastAuthorizerActions();
     }
+    SQLiteStatement& statement = *cachedStatement;
+    int result;
 
     // FIXME:  If the statement uses the ?### syntax supported by sqlite, the bind parameter count is very likely off from the number of question marks.
     // If this is the case, they might be trying to do something fishy or malicious
@@ -144,6 +155,8 @@ bool SQLStatement::execute(Database* db)
     // For now, this seems sufficient
     resultSet->setRowsAffected(database->lastChanges());
 
+    db->statementCache().add(cachedStatement.release(), m_permissions, authorizerActions);
+
     m_resultSet = resultSet;
     return true;
 }
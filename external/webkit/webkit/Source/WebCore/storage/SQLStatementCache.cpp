@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2011 Google Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "SQLStatementCache.h"
+
+#if ENABLE(DATABASE)
+
+#include "SQLiteStatement.h"
+#include <wtf/OwnPtr.h>
+
+namespace WebCore {
+
+// Pages that use Web SQL tend to run a handful of statements; a few dozen
+// prepared statements cost little memory.
+static const unsigned maximumCachedStatements = 32;
+
+struct SQLStatementCache::Entry {
+    WTF_MAKE_NONCOPYABLE(Entry); WTF_MAKE_FAST_ALLOCATED;
+public:
+    Entry(PassOwnPtr<SQLiteStatement> statement, int permissions, const DatabaseAuthorizer::Actions& actions, unsigned lastUse)
+        : statement(statement)
+        , permissions(permissions)
+        , actions(actions)
+        , lastUse(lastUse)
+    {
+    }
+
+    OwnPtr<SQLiteStatement> statement;
+    int permissions;
+    DatabaseAuthorizer::Actions actions;
+    unsigned lastUse;
+};
+
+SQLStatementCache::SQLStatementCache()
+    : m_useCount(0)
+{
+}
+
+SQLStatementCache::~SQLStatementCache()
+{
+    clear();
+}
+
+PassOwnPtr<SQLiteStatement> SQLStatementCache::take(const String& query, int permissions, DatabaseAuthorizer::Actions& actions)
+{
+    Entry* entry = m_entries.take(query);
+    if (!entry)
+        return 0;
+
+    OwnPtr<Entry> ownedEntry = adoptPtr(entry);
+    if (entry->permissions != permissions)
+        return 0;
+
+    actions = entry->actions;
+    return entry->statement.release();
+}
+
+void SQLStatementCache::add(PassOwnPtr<SQLiteStatement> passedStatement, int permissions, const DatabaseAuthorizer::Actions& actions)
+{
+    OwnPtr<SQLiteStatement> statement = passedStatement;
+    if (statement->reset() != SQLResultOk)
+        return;
+
+    String query = statement->query();
+    if (Entry* oldEntry = m_entries.take(query))
+        delete oldEntry;
+    else if (m_entries.size() >= maximumCachedStatements)
+        removeLeastRecentlyUsed();
+
+    m_entries.set(query, new Entry(statement.release(), permissions, actions, ++m_useCount));
+}
+
+void SQLStatementCache::clear()
+{
+    deleteAllValues(m_entries);
+    m_entries.clear();
+}
+
+void SQLStatementCache::removeLeastRecentlyUsed()
+{
+    EntryMap::iterator leastRecentlyUsed = m_entries.begin();
+    EntryMap::iterator end = m_entries.end();
+    for (EntryMap::iterator it = m_entries.begin(); it != end; ++it) {
+        if (it->second->lastUse < leastRecentlyUsed->second->lastUse)
+            leastRecentlyUsed = it;
+    }
+    delete leastRecentlyUsed->second;
+    m_entries.remove(leastRecentlyUsed);
+}
+
+} // namespace WebCore
+
+#endif // ENABLE(DATABASE)
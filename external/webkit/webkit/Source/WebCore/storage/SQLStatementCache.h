@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2011 Google Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SQLStatementCache_h
+#define SQLStatementCache_h
+
+#if ENABLE(DATABASE)
+
+#include "DatabaseAuthorizer.h"
+#include "PlatformString.h"
+#include <wtf/HashMap.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/PassOwnPtr.h>
+#include <wtf/text/StringHash.h>
+
+namespace WebCore {
+
+class SQLiteStatement;
+
+// Keeps the statements a database ran recently prepared, keyed by their SQL
+// text, so that a page running the same few statements over and over does
+// not pay for parsing and planning them every time. The least recently used
+// statement is finalized when the cache is full.
+//
+// Statements are prepared under the authorizer permissions of the
+// transaction that ran them, and the authorizer is not asked again when they
+// are reused, so the permissions are part of the key and the authorizer's
+// findings are kept with each statement.
+//
+// Only the database thread uses the cache. It has to be cleared before the
+// database is closed.
+class SQLStatementCache {
+    WTF_MAKE_NONCOPYABLE(SQLStatementCache); WTF_MAKE_FAST_ALLOCATED;
+public:
+    SQLStatementCache();
+    ~SQLStatementCache();
+
+    // Removes the statement for |query| from the cache and returns it, ready
+    // to be bound and stepped, or returns 0 if there is none for these
+    // permissions.
+    PassOwnPtr<SQLiteStatement> take(const String& query, int permissions, DatabaseAuthorizer::Actions&);
+
+    // Resets |statement| and keeps it for the next take().
+    void add(PassOwnPtr<SQLiteStatement> statement, int permissions, const DatabaseAuthorizer::Actions&);
+
+    void clear();
+
+private:
+    struct Entry;
+    typedef HashMap<String, Entry*> EntryMap;
+
+    void removeLeastRecentlyUsed();
+
+    EntryMap m_entries;
+    unsigned m_useCount;
+};
+
+} // namespace WebCore
+
+#endif // ENABLE(DATABASE)
+
+#endif // SQLStatementCache_h
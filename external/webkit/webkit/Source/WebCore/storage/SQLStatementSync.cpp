@@ -32,12 +32,14 @@
 
 #if ENABLE(DATABASE)
 
+#include "DatabaseAuthorizer.h"
 #include "DatabaseSync.h"
 #include "SQLException.h"
 #include "SQLResultSet.h"
 #include "SQLValue.h"
 #include "SQLiteDatabase.h"
 #include "SQLiteStatement.h"
+#include <wtf/OwnPtr.h>
 #include <wtf/PassRefPtr.h>
 #include <wtf/RefPtr.h>
 
@@ -57,12 +59,21 @@ PassRefPtr<SQLResultSet> SQLStatementSync::execute(DatabaseSync* db, ExceptionCo
 
     SQLiteDatabase* database = &db->sqliteDatabase();
 
-    SQLiteStatement statement(*database, m_statement);
-    int result = statement.prepare();
-    if (result != SQLResultOk) {
-        ec = (result == SQLResultInterrupt ? SQLException::DATABASE_ERR : SQLException::SYNTAX_ERR);
-        return 0;
+    DatabaseAuthorizer::Actions authorizerActions;
+    OwnPtr<SQLiteStatement> cachedStatement = db->statementCache().take(m_statement, m_permissions, authorizerActions);
+    if (cachedStatement)
+        db->replayAuthorizerActions(authorizerActions);
+    else {
+        cachedStatement = adoptPtr(new SQLiteStatement(*database, m_statement));
+        int result = cachedStatement->prepare();
+        if (result != SQLResultOk) {
+            ec = (result == SQLResultInterrupt ? SQLException::DATABASE_ERR : SQLException::SYNTAX_ERR);
+            return 0;
+        }
+        authorizerActions = db->lastAuthorizerActions();
     }
+    SQLiteStatement& statement = *cachedStatement;
+    int result;
 
     if (statement.bindParameterCount() != m_arguments.size()) {
         ec = (db->isInterrupted()? SQLException::DATABASE_ERR : SQLException::SYNTAX_ERR);
@@ -118,6 +129,8 @@ PassRefPtr<SQLResultSet> SQLStatementSync::execute(DatabaseSync* db, ExceptionCo
     }
 
     resultSet->setRowsAffected(database->lastChanges());
+
+    db->statementCache().add(cachedStatement.release(), m_permissions, authorizerActions);
     return resultSet.release();
 }
 
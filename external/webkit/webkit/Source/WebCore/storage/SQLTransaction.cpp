@@ -78,6 +78,7 @@ SQLTransaction::SQLTransaction(Database* db, PassRefPtr<SQLTransactionCallback>
     , m_modifiedDatabase(false)
     , m_lockAcquired(false)
     , m_readOnly(readOnly)
+    , m_commitDeferred(false)
 {
     ASSERT(m_database);
 }
@@ -239,7 +240,7 @@ void SQLTransaction::lockAcquired()
 
 void SQLTransaction::openTransactionAndPreflight()
 {
-    ASSERT(!m_database->sqliteDatabase().transactionInProgress());
+    ASSERT(!m_database->sqliteDatabase().transactionInProgress() || m_database->hasOpenBatch());
     ASSERT(m_lockAcquired);
 
     LOG(StorageAPI, "Opening and preflighting transaction %p", this);
@@ -258,14 +259,22 @@ void SQLTransaction::openTransactionAndPreflight()
     ASSERT(!m_sqliteTransaction);
     m_sqliteTransaction = adoptPtr(new SQLiteTransaction(m_database->sqliteDatabase(), m_readOnly));
 
-    m_database->resetDeletes();
     m_database->disableAuthorizer();
-    m_sqliteTransaction->begin();
+    if (isBatchable() && (m_database->transactionBatchingEnabled() || m_database->hasOpenBatch())) {
+        // Deletes are tracked for the whole batch, which vacuums when it commits.
+        if (!m_database->hasOpenBatch())
+            m_database->resetDeletes();
+        if (m_database->openBatch())
+            m_sqliteTransaction->beginSavepoint();
+    } else {
+        m_database->resetDeletes();
+        m_sqliteTransaction->begin();
+    }
     m_database->enableAuthorizer();
 
     // Transaction Steps 1+2 - Open a transaction to the database, jumping to the error callback if that fails
     if (!m_sqliteTransaction->inProgress()) {
-        ASSERT(!m_database->sqliteDatabase().transactionInProgress());
+        ASSERT(!m_database->sqliteDatabase().transactionInProgress() || m_database->hasOpenBatch());
         m_sqliteTransaction.clear();
         m_transactionError = SQLError::create(SQLError::DATABASE_ERR, "unable to open a transaction to the database");
         handleTransactionError(false);
@@ -471,6 +480,27 @@ void SQLTransaction::postflightAndCommit()
         return;
     }
 
+    // Inside a batch, the commit above only released this transaction's
+    // savepoint. Leave the real commit to the next transaction if one is
+    // waiting, keeping the lock until it takes it over.
+    if (m_database->hasOpenBatch()) {
+        m_sqliteTransaction.clear();
+        if (m_database->shouldDeferCommit(this)) {
+            LOG(StorageAPI, "Deferring the commit of transaction %p to the end of its batch\n", this);
+            m_commitDeferred = true;
+            m_database->deferCommit(this, m_modifiedDatabase);
+            m_nextStep = 0;
+            return;
+        }
+
+        if (!m_database->commitBatch(m_modifiedDatabase)) {
+            m_successCallbackWrapper.clear();
+            m_transactionError = SQLError::create(SQLError::DATABASE_ERR, "failed to commit the transaction");
+            handleTransactionError(false);
+            return;
+        }
+    }
+
     // Vacuum the database if anything was deleted.
     if (m_database->hadDeletes())
         m_database->incrementalVacuumIfNeeded();
@@ -498,6 +528,12 @@ void SQLTransaction::deliverSuccessCallback()
     if (successCallback)
         successCallback->handleEvent();
 
+    // The batch that committed this transaction has already cleaned up after it.
+    if (m_commitDeferred) {
+        m_nextStep = 0;
+        return;
+    }
+
     // Schedule a "post-success callback" step to return control to the database thread in case there
     // are further transactions queued up for this Database
     m_nextStep = &SQLTransaction::cleanupAfterSuccessCallback;
@@ -520,6 +556,27 @@ void SQLTransaction::cleanupAfterSuccessCallback()
     m_database->transactionCoordinator()->releaseLock(this);
 }
 
+void SQLTransaction::deferredCommitCompleted(bool committed)
+{
+    ASSERT(m_commitDeferred);
+
+    if (committed) {
+        m_errorCallbackWrapper.clear();
+        if (!m_successCallbackWrapper.hasCallback())
+            return;
+        m_nextStep = &SQLTransaction::deliverSuccessCallback;
+    } else {
+        m_successCallbackWrapper.clear();
+        m_transactionError = SQLError::create(SQLError::DATABASE_ERR, "failed to commit the transaction");
+        if (!m_errorCallbackWrapper.hasCallback())
+            return;
+        m_nextStep = &SQLTransaction::deliverTransactionErrorCallback;
+    }
+
+    LOG(StorageAPI, "Scheduling the callback of transaction %p after its batch committed\n", this);
+    m_database->scheduleTransactionCallback(this);
+}
+
 void SQLTransaction::handleTransactionError(bool inCallback)
 {
     if (m_errorCallbackWrapper.hasCallback()) {
@@ -554,6 +611,11 @@ void SQLTransaction::deliverTransactionErrorCallback()
     if (errorCallback)
         errorCallback->handleEvent(m_transactionError.get());
 
+    if (m_commitDeferred) {
+        m_nextStep = 0;
+        return;
+    }
+
     m_nextStep = &SQLTransaction::cleanupAfterTransactionErrorCallback;
     LOG(StorageAPI, "Scheduling cleanupAfterTransactionErrorCallback for transaction %p\n", this);
     m_database->scheduleTransactionStep(this);
@@ -568,11 +630,19 @@ void SQLTransaction::cleanupAfterTransactionErrorCallback()
         // Transaction Step 12 - Rollback the transaction.
         m_sqliteTransaction->rollback();
 
-        ASSERT(!m_database->sqliteDatabase().transactionInProgress());
+        ASSERT(!m_database->sqliteDatabase().transactionInProgress() || m_database->hasOpenBatch());
         m_sqliteTransaction.clear();
     }
     m_database->enableAuthorizer();
 
+    // The transactions that deferred their commit to this one still get
+    // theirs.
+    if (m_database->hasOpenBatch()) {
+        bool modifiedDatabase = false;
+        if (m_database->commitBatch(modifiedDatabase) && modifiedDatabase)
+            m_database->transactionClient()->didCommitWriteTransaction(database());
+    }
+
     // Transaction Step 12 - Any still-pending statements in the transaction are discarded.
     {
         MutexLocker locker(m_statementMutex);
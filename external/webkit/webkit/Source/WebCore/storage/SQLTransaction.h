@@ -75,6 +75,11 @@ public:
 
     Database* database() { return m_database.get(); }
     bool isReadOnly() { return m_readOnly; }
+    // Whether the transaction can run as part of a batch; see
+    // Database::transactionBatchingEnabled().
+    bool isBatchable() const { return !m_readOnly && !m_wrapper; }
+    bool isCommitDeferred() const { return m_commitDeferred; }
+    void deferredCommitCompleted(bool committed);
     void notifyDatabaseThreadIsShuttingDown();
 
 private:
@@ -123,6 +128,7 @@ private:
     bool m_modifiedDatabase;
     bool m_lockAcquired;
     bool m_readOnly;
+    bool m_commitDeferred;
 
     Mutex m_statementMutex;
     Deque<RefPtr<SQLStatement> > m_statementQueue;
@@ -79,6 +79,19 @@ void SQLTransactionCoordinator::acquireLock(SQLTransaction* transaction)
     }
 
     CoordinationInfo& info = coordinationInfoIterator->second;
+
+    // A write transaction whose commit was deferred keeps the lock for the
+    // rest of its batch, which runs on the same database handle. The lock is
+    // handed over instead of queueing behind it, since the batch only ends
+    // when one of its transactions commits it.
+    RefPtr<SQLTransaction> activeWriteTransaction = info.activeWriteTransaction;
+    if (activeWriteTransaction && activeWriteTransaction->isCommitDeferred()
+        && activeWriteTransaction->database() == transaction->database() && !transaction->isReadOnly()) {
+        info.activeWriteTransaction = transaction;
+        transaction->lockAcquired();
+        return;
+    }
+
     info.pendingTransactions.append(transaction);
     processPendingTransactions(info);
 }
@@ -105,6 +118,28 @@ void SQLTransactionCoordinator::releaseLock(SQLTransaction* transaction)
     processPendingTransactions(info);
 }
 
+void SQLTransactionCoordinator::releaseDeferredLock(SQLTransaction* transaction)
+{
+    ASSERT(transaction->isCommitDeferred());
+
+    CoordinationInfoMap::iterator coordinationInfoIterator = m_coordinationInfoMap.find(getDatabaseIdentifier(transaction));
+    if (coordinationInfoIterator == m_coordinationInfoMap.end())
+        return;
+
+    CoordinationInfo& info = coordinationInfoIterator->second;
+    if (info.activeWriteTransaction != transaction)
+        return;
+
+    info.activeWriteTransaction = 0;
+    processPendingTransactions(info);
+}
+
+bool SQLTransactionCoordinator::hasPendingTransactions(SQLTransaction* transaction)
+{
+    CoordinationInfoMap::iterator coordinationInfoIterator = m_coordinationInfoMap.find(getDatabaseIdentifier(transaction));
+    return coordinationInfoIterator != m_coordinationInfoMap.end() && !coordinationInfoIterator->second.pendingTransactions.isEmpty();
+}
+
 void SQLTransactionCoordinator::shutdown()
 {
     // Notify all transactions in progress that the database thread is shutting down
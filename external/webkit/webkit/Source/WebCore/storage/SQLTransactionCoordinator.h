@@ -49,6 +49,10 @@ namespace WebCore {
         SQLTransactionCoordinator() { }
         void acquireLock(SQLTransaction*);
         void releaseLock(SQLTransaction*);
+        // Releases the lock kept by a transaction whose commit was deferred,
+        // if no later transaction of its batch has taken it over yet.
+        void releaseDeferredLock(SQLTransaction*);
+        bool hasPendingTransactions(SQLTransaction*);
         void shutdown();
     private:
         typedef Deque<RefPtr<SQLTransaction> > TransactionsQueue;
@@ -57,12 +57,18 @@
 
 namespace WebCore {
 
+// Memory kept for the next frames once the receive buffer has been consumed.
+// A larger buffer, left behind by a long message, is freed instead.
+static const size_t maximumRetainedBufferCapacity = 64 * 1024;
+
 WebSocketChannel::WebSocketChannel(ScriptExecutionContext* context, WebSocketChannelClient* client, const KURL& url, const String& protocol)
     : m_context(context)
     , m_client(client)
     , m_handshake(url, protocol, context)
     , m_buffer(0)
     , m_bufferSize(0)
+    , m_bufferStorage(0)
+    , m_bufferCapacity(0)
     , m_resumeTimer(this, &WebSocketChannel::resumeTimerFired)
     , m_suspended(false)
     , m_closed(false)
@@ -80,7 +86,7 @@ WebSocketChannel::WebSocketChannel(ScriptExecutionContext* context, WebSocketCha
 
 WebSocketChannel::~WebSocketChannel()
 {
-    fastFree(m_buffer);
+    fastFree(m_bufferStorage);
 }
 
 void WebSocketChannel::connect()
@@ -98,11 +104,27 @@ bool WebSocketChannel::send(const String& msg)
     LOG(Network, "WebSocketChannel %p send %s", this, msg.utf8().data());
     ASSERT(m_handle);
     ASSERT(!m_suspended);
+    const UChar* characters = msg.characters();
+    unsigned length = msg.length();
+    unsigned asciiLength = 0;
+    while (asciiLength < length && characters[asciiLength] < 0x80)
+        ++asciiLength;
+
     Vector<char> buf;
-    buf.append('\0');  // frame type
-    CString utf8 = msg.utf8();
-    buf.append(utf8.data(), utf8.length());
-    buf.append('\xff');  // frame end
+    if (asciiLength == length) {
+        // Most messages are ASCII, which is its own UTF-8 encoding; write it
+        // straight into the frame.
+        buf.reserveInitialCapacity(length + 2);
+        buf.uncheckedAppend('\0');  // frame type
+        for (unsigned i = 0; i < length; ++i)
+            buf.uncheckedAppend(static_cast<char>(characters[i]));
+    } else {
+        CString utf8 = msg.utf8();
+        buf.reserveInitialCapacity(utf8.length() + 2);
+        buf.uncheckedAppend('\0');  // frame type
+        buf.append(utf8.data(), utf8.length());
+    }
+    buf.uncheckedAppend('\xff');  // frame end
     return m_handle->send(buf.data(), buf.size());
 }
 
@@ -235,23 +257,44 @@ void WebSocketChannel::didCancelAuthenticationChallenge(SocketStreamHandle*, con
 
 bool WebSocketChannel::appendToBuffer(const char* data, size_t len)
 {
+    if (!len)
+        return true;
     size_t newBufferSize = m_bufferSize + len;
     if (newBufferSize < m_bufferSize) {
         LOG(Network, "WebSocket buffer overflow (%lu+%lu)", static_cast<unsigned long>(m_bufferSize), static_cast<unsigned long>(len));
         return false;
     }
-    char* newBuffer = 0;
-    if (tryFastMalloc(newBufferSize).getValue(newBuffer)) {
-        if (m_buffer)
-            memcpy(newBuffer, m_buffer, m_bufferSize);
-        memcpy(newBuffer + m_bufferSize, data, len);
-        fastFree(m_buffer);
-        m_buffer = newBuffer;
-        m_bufferSize = newBufferSize;
-        return true;
+
+    // Frames are consumed from the front of the buffer by moving m_buffer
+    // forward. The unconsumed data is only moved back to the start of the
+    // storage, or into a larger one, when new data does not fit after it.
+    size_t consumed = m_buffer ? m_buffer - m_bufferStorage : 0;
+    if (consumed + newBufferSize > m_bufferCapacity) {
+        if (newBufferSize <= m_bufferCapacity) {
+            if (m_bufferSize)
+                memmove(m_bufferStorage, m_buffer, m_bufferSize);
+        } else {
+            size_t newCapacity = std::max(newBufferSize, m_bufferCapacity * 2);
+            char* newStorage = 0;
+            if (!tryFastMalloc(newCapacity).getValue(newStorage)) {
+                newCapacity = newBufferSize;
+                if (!tryFastMalloc(newCapacity).getValue(newStorage)) {
+                    m_context->addMessage(JSMessageSource, LogMessageType, ErrorMessageLevel, makeString("WebSocket frame (at ", String::number(static_cast<unsigned long>(newBufferSize)), " bytes) is too long."), 0, m_handshake.clientOrigin(), 0);
+                    return false;
+                }
+            }
+            if (m_bufferSize)
+                memcpy(newStorage, m_buffer, m_bufferSize);
+            fastFree(m_bufferStorage);
+            m_bufferStorage = newStorage;
+            m_bufferCapacity = newCapacity;
+        }
+        consumed = 0;
     }
-    m_context->addMessage(JSMessageSource, LogMessageType, ErrorMessageLevel, makeString("WebSocket frame (at ", String::number(static_cast<unsigned long>(newBufferSize)), " bytes) is too long."), 0, m_handshake.clientOrigin(), 0);
-    return false;
+    m_buffer = m_bufferStorage + consumed;
+    memcpy(m_buffer + m_bufferSize, data, len);
+    m_bufferSize = newBufferSize;
+    return true;
 }
 
 void WebSocketChannel::skipBuffer(size_t len)
@@ -259,11 +302,15 @@ void WebSocketChannel::skipBuffer(size_t len)
     ASSERT(len <= m_bufferSize);
     m_bufferSize -= len;
     if (!m_bufferSize) {
-        fastFree(m_buffer);
         m_buffer = 0;
+        if (m_bufferCapacity > maximumRetainedBufferCapacity) {
+            fastFree(m_bufferStorage);
+            m_bufferStorage = 0;
+            m_bufferCapacity = 0;
+        }
         return;
     }
-    memmove(m_buffer, m_buffer + len, m_bufferSize);
+    m_buffer += len;
 }
 
 bool WebSocketChannel::processBuffer()
@@ -367,9 +414,8 @@ bool WebSocketChannel::processBuffer()
     }
 
     const char* msgStart = p;
-    while (p < end && *p != '\xff')
-        ++p;
-    if (p < end && *p == '\xff') {
+    p = static_cast<const char*>(memchr(p, 0xff, end - p));
+    if (p) {
         int msgLength = p - msgStart;
         ++p;
         nextFrame = p;
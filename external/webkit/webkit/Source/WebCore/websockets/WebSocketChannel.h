@@ -89,8 +89,13 @@ namespace WebCore {
         WebSocketChannelClient* m_client;
         WebSocketHandshake m_handshake;
         RefPtr<SocketStreamHandle> m_handle;
+        // The received data that has not been processed yet. It starts
+        // m_buffer - m_bufferStorage bytes into m_bufferStorage, and m_buffer
+        // is null when there is none.
         char* m_buffer;
         size_t m_bufferSize;
+        char* m_bufferStorage;
+        size_t m_bufferCapacity;
 
         Timer<WebSocketChannel> m_resumeTimer;
         bool m_suspended;
@@ -39,7 +39,13 @@
 namespace WebCore {
 
 using namespace XPath;
-    
+
+static const size_t maximumCachedExpressions = 32;
+
+XPathEvaluator::~XPathEvaluator()
+{
+}
+
 PassRefPtr<XPathExpression> XPathEvaluator::createExpression(const String& expression,
                                                              XPathNSResolver* resolver,
                                                              ExceptionCode& ec)
@@ -65,13 +71,30 @@ PassRefPtr<XPathResult> XPathEvaluator::evaluate(const String& expression,
     }
 
     ec = 0;
-    RefPtr<XPathExpression> expr = createExpression(expression, resolver, ec);
+    RefPtr<XPathExpression> expr = resolver ? createExpression(expression, resolver, ec) : cachedExpression(expression, ec);
     if (ec)
         return 0;
     
     return expr->evaluate(contextNode, type, result, ec);
 }
 
+PassRefPtr<XPathExpression> XPathEvaluator::cachedExpression(const String& expression, ExceptionCode& ec)
+{
+    ExpressionCache::iterator it = m_expressionCache.find(expression);
+    if (it != m_expressionCache.end())
+        return it->second;
+
+    RefPtr<XPathExpression> expr = XPathExpression::createExpression(expression, 0, ec);
+    if (!expr)
+        return 0;
+
+    if (m_expressionCache.size() >= maximumCachedExpressions)
+        m_expressionCache.remove(m_expressionCacheOrder.takeFirst());
+    m_expressionCache.set(expression, expr);
+    m_expressionCacheOrder.append(expression);
+    return expr.release();
+}
+
 }
 
 #endif // ENABLE(XPATH)
@@ -29,9 +29,11 @@
 
 #if ENABLE(XPATH)
 
-#include <wtf/Forward.h>
+#include <wtf/Deque.h>
+#include <wtf/HashMap.h>
 #include <wtf/RefCounted.h>
-#include <wtf/PassRefPtr.h>
+#include <wtf/RefPtr.h>
+#include <wtf/text/StringHash.h>
 
 namespace WebCore {
 
@@ -45,6 +47,7 @@ namespace WebCore {
     class XPathEvaluator : public RefCounted<XPathEvaluator> {
     public:
         static PassRefPtr<XPathEvaluator> create() { return adoptRef(new XPathEvaluator); }
+        ~XPathEvaluator();
         
         PassRefPtr<XPathExpression> createExpression(const String& expression, XPathNSResolver*, ExceptionCode&);
         PassRefPtr<XPathNSResolver> createNSResolver(Node* nodeResolver);
@@ -53,6 +56,15 @@ namespace WebCore {
 
     private:
         XPathEvaluator() { }
+
+        PassRefPtr<XPathExpression> cachedExpression(const String& expression, ExceptionCode&);
+
+        // Expressions evaluated without a namespace resolver, by their text. Pages tend to evaluate the same
+        // few expressions over and over, and parsing is a noticeable part of the cost of each evaluation.
+        // Expressions that need a resolver are not cached, because it can map prefixes differently each time.
+        typedef HashMap<String, RefPtr<XPathExpression> > ExpressionCache;
+        ExpressionCache m_expressionCache;
+        Deque<String> m_expressionCacheOrder;
     };
 
 }
@@ -115,33 +115,58 @@ void LocationPath::evaluate(NodeSet& nodes) const
 
     for (unsigned i = 0; i < m_steps.size(); i++) {
         Step* step = m_steps[i];
+        Step::Axis axis = step->axis();
         NodeSet newNodes;
-        HashSet<Node*> newNodesSet;
 
-        bool needToCheckForDuplicateNodes = !nodes.subtreesAreDisjoint() || (step->axis() != Step::ChildAxis && step->axis() != Step::SelfAxis
-            && step->axis() != Step::DescendantAxis && step->axis() != Step::DescendantOrSelfAxis && step->axis() != Step::AttributeAxis);
+        if (nodes.size() == 1) {
+            // A single context node cannot produce duplicates, and every axis enumerates nodes either in document order
+            // or in reverse document order, so there is nothing to merge or sort.
+            step->evaluate(nodes[0], newNodes);
+            if (!newNodes.isSorted()) {
+                newNodes.reverse();
+                newNodes.markSorted(true);
+            }
+            resultIsSorted = true;
 
-        if (needToCheckForDuplicateNodes)
-            resultIsSorted = false;
+            if (axis == Step::ChildAxis || axis == Step::SelfAxis || axis == Step::ParentAxis || axis == Step::AttributeAxis
+                || axis == Step::FollowingSiblingAxis || axis == Step::PrecedingSiblingAxis)
+                newNodes.markSubtreesDisjoint(true);
 
-        // This is a simplified check that can be improved to handle more cases.
-        if (nodes.subtreesAreDisjoint() && (step->axis() == Step::ChildAxis || step->axis() == Step::SelfAxis))
-            newNodes.markSubtreesDisjoint(true);
+            nodes.swap(newNodes);
+            continue;
+        }
 
-        for (unsigned j = 0; j < nodes.size(); j++) {
-            NodeSet matches;
-            step->evaluate(nodes[j], matches);
+        bool needToCheckForDuplicateNodes = !nodes.subtreesAreDisjoint() || (axis != Step::ChildAxis && axis != Step::SelfAxis
+            && axis != Step::DescendantAxis && axis != Step::DescendantOrSelfAxis && axis != Step::AttributeAxis);
 
-            if (!matches.isSorted())
-                resultIsSorted = false;
+        if (needToCheckForDuplicateNodes) {
+            resultIsSorted = false;
 
-            for (size_t nodeIndex = 0; nodeIndex < matches.size(); ++nodeIndex) {
-                Node* node = matches[nodeIndex];
-                if (!needToCheckForDuplicateNodes || newNodesSet.add(node).second)
-                    newNodes.append(node);
+            HashSet<Node*> newNodesSet;
+            for (unsigned j = 0; j < nodes.size(); j++) {
+                NodeSet matches;
+                step->evaluate(nodes[j], matches);
+
+                for (size_t nodeIndex = 0; nodeIndex < matches.size(); ++nodeIndex) {
+                    Node* node = matches[nodeIndex];
+                    if (newNodesSet.add(node).second)
+                        newNodes.append(node);
+                }
             }
+        } else {
+            // These axes only select nodes from the context node's own subtree, in document order. With disjoint
+            // subtrees, the results for different context nodes can neither overlap nor interleave.
+            for (unsigned j = 0; j < nodes.size(); j++)
+                step->evaluate(nodes[j], newNodes);
+
+            if (!newNodes.isSorted())
+                resultIsSorted = false;
         }
-        
+
+        // This is a simplified check that can be improved to handle more cases.
+        if (nodes.subtreesAreDisjoint() && (axis == Step::ChildAxis || axis == Step::SelfAxis))
+            newNodes.markSubtreesDisjoint(true);
+
         nodes.swap(newNodes);
     }
 
@@ -116,28 +116,43 @@ void Step::evaluate(Node* context, NodeSet& nodes) const
     EvaluationContext& evaluationContext = Expression::evaluationContext();
     evaluationContext.position = 0;
 
-    nodesInAxis(context, nodes);
+    // Without context list sensitive predicates, there is no need for a separate set of this context node's matches.
+    if (m_predicates.isEmpty()) {
+        nodesInAxis(context, nodes);
+        return;
+    }
+
+    NodeSet matches;
+    nodesInAxis(context, matches);
 
     // Check predicates that couldn't be merged into node test.
     for (unsigned i = 0; i < m_predicates.size(); i++) {
         Predicate* predicate = m_predicates[i];
 
         NodeSet newNodes;
-        if (!nodes.isSorted())
+        if (!matches.isSorted())
             newNodes.markSorted(false);
 
-        for (unsigned j = 0; j < nodes.size(); j++) {
-            Node* node = nodes[j];
+        for (unsigned j = 0; j < matches.size(); j++) {
+            Node* node = matches[j];
 
             evaluationContext.node = node;
-            evaluationContext.size = nodes.size();
+            evaluationContext.size = matches.size();
             evaluationContext.position = j + 1;
             if (predicate->evaluate())
                 newNodes.append(node);
         }
 
-        nodes.swap(newNodes);
+        matches.swap(newNodes);
+    }
+
+    if (nodes.isEmpty()) {
+        nodes.swap(matches);
+        return;
     }
+    if (!matches.isSorted())
+        nodes.markSorted(false);
+    nodes.append(matches);
 }
 
 static inline Node::NodeType primaryNodeType(Step::Axis axis)
@@ -232,10 +247,9 @@ static inline bool nodeMatches(Node* node, Step::Axis axis, const Step::NodeTest
     return true;
 }
 
-// Result nodes are ordered in axis order. Node test (including merged predicates) is applied.
+// Result nodes are appended in axis order. Node test (including merged predicates) is applied.
 void Step::nodesInAxis(Node* context, NodeSet& nodes) const
 {
-    ASSERT(nodes.isEmpty());
     switch (m_axis) {
         case ChildAxis:
             if (context->isAttributeNode()) // In XPath model, attribute nodes do not have children.
@@ -81,6 +81,7 @@ namespace WebCore {
 
             void optimize();
 
+            // Appends the nodes this step selects from the context node, in axis order.
             void evaluate(Node* context, NodeSet&) const;
 
             Axis axis() const { return m_axis; }
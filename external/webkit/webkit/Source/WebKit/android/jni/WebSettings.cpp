@@ -34,6 +34,7 @@
 #include "ChromiumIncludes.h"
 #include "DatabaseTracker.h"
 #include "Database.h"
+#include "DiskCache.h"
 #include "Document.h"
 #include "EditorClientAndroid.h"
 #include "FileSystem.h"
@@ -60,6 +61,7 @@
 namespace android {
 
 static const int permissionFlags660 = S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP;
+static const unsigned diskCacheCapacity = 8 * 1024 * 1024;
 
 struct FieldIds {
     FieldIds(JNIEnv* env, jclass clazz) {
@@ -327,6 +329,27 @@ void syncAutoFillProfile(JNIEnv* env, jobject autoFillProfile, WebAutofill* webA
 }
 #endif
 
+// WebCore's disk cache lives next to the network stack's cache. It is shared
+// by all WebViews, so it is only opened once.
+static void openDiskCacheIfNeeded(JNIEnv* env)
+{
+    static bool triedToOpen = false;
+    if (triedToOpen)
+        return;
+    triedToOpen = true;
+
+    jclass bridgeClass = env->FindClass("android/webkit/JniUtil");
+    jmethodID method = env->GetStaticMethodID(bridgeClass, "getCacheDirectory", "()Ljava/lang/String;");
+    jstring directory = static_cast<jstring>(env->CallStaticObjectMethod(bridgeClass, method));
+    env->DeleteLocalRef(bridgeClass);
+    if (!directory)
+        return;
+    String path = jstringToWtfString(env, directory);
+    env->DeleteLocalRef(directory);
+    if (!path.isEmpty())
+        WebCore::diskCache()->open(pathByAppendingComponent(path, "webviewCacheWebCore"), diskCacheCapacity);
+}
+
 class WebSettings {
 public:
     static void Sync(JNIEnv* env, jobject obj, jint frame)
@@ -515,6 +538,9 @@ public:
         flag = env->GetBooleanField(obj, gFieldIds->mPrivateBrowsingEnabled);
         s->setPrivateBrowsingEnabled(flag);
 
+        // Private browsing frames never read or write it.
+        openDiskCacheIfNeeded(env);
+
         flag = env->GetBooleanField(obj, gFieldIds->mSyntheticLinksEnabled);
         s->setDefaultFormatDetection(flag);
         s->setFormatDetectionAddress(flag);
@@ -373,6 +373,11 @@ void WebSettingsImpl::setCaretBrowsingEnabled(bool enabled)
     m_settings->setCaretBrowsingEnabled(enabled);
 }
 
+void WebSettingsImpl::setDatabaseTransactionBatchingEnabled(bool enabled)
+{
+    m_settings->setDatabaseTransactionBatchingEnabled(enabled);
+}
+
 void WebSettingsImpl::setInteractiveFormValidationEnabled(bool enabled)
 {
     m_settings->setInteractiveFormValidationEnabled(enabled);
@@ -108,6 +108,7 @@ public:
     virtual void setHyperlinkAuditingEnabled(bool);
     virtual void setAsynchronousSpellCheckingEnabled(bool);
     virtual void setCaretBrowsingEnabled(bool);
+    virtual void setDatabaseTransactionBatchingEnabled(bool);
     virtual void setInteractiveFormValidationEnabled(bool);
     virtual void setValidationMessageTimerMagnification(int);
     virtual void setMinimumTimerInterval(double);
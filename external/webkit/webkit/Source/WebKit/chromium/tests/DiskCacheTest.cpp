@@ -0,0 +1,249 @@
+/*
+ * Copyright (C) 2011 Google Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ * 2.  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE AND ITS CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL APPLE OR ITS CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include "DiskCache.h"
+
+#include "FileSystem.h"
+#include "KURL.h"
+#include "ResourceResponse.h"
+#include "SharedBuffer.h"
+#include <gtest/gtest.h>
+#include <webkit/support/webkit_support.h>
+#include <wtf/text/CString.h>
+
+#if OS(UNIX)
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
+using namespace WebCore;
+
+namespace {
+
+#if OS(UNIX)
+
+// Local files stand in for the network: every entry is stored straight from
+// a response and a body, the way CachedResourceRequest stores a finished load.
+static const unsigned capacity = 64 * 1024;
+// With the record header and key, each of these fills exactly 7 blocks, so 9
+// of them fill 63 of the 64 blocks.
+static const size_t entrySize = 6900;
+
+class TestClient : public DiskCacheClient {
+public:
+    TestClient()
+        : m_finished(false)
+        , m_succeeded(false)
+    {
+    }
+
+    virtual void didRetrieveFromDiskCache(const ResourceResponse& response, PassRefPtr<SharedBuffer> body)
+    {
+        m_finished = true;
+        m_succeeded = true;
+        m_response = response;
+        m_body = body;
+        webkit_support::QuitMessageLoop();
+    }
+
+    virtual void didFailToRetrieveFromDiskCache()
+    {
+        m_finished = true;
+        webkit_support::QuitMessageLoop();
+    }
+
+    bool finished() const { return m_finished; }
+    bool succeeded() const { return m_succeeded; }
+    const ResourceResponse& response() const { return m_response; }
+    SharedBuffer* body() const { return m_body.get(); }
+
+private:
+    bool m_finished;
+    bool m_succeeded;
+    ResourceResponse m_response;
+    RefPtr<SharedBuffer> m_body;
+};
+
+class DiskCacheTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        char directoryTemplate[] = "/tmp/DiskCacheTestXXXXXX";
+        ASSERT_TRUE(mkdtemp(directoryTemplate));
+        m_directory = directoryTemplate;
+        ASSERT_TRUE(diskCache()->open(m_directory, capacity));
+    }
+
+    virtual void TearDown()
+    {
+        diskCache()->close();
+        deleteFile(pathByAppendingComponent(m_directory, "index"));
+        deleteFile(pathByAppendingComponent(m_directory, "data"));
+        deleteEmptyDirectory(m_directory);
+    }
+
+    static KURL urlForEntry(int i)
+    {
+        return KURL(ParsedURLString, String::format("http://example.com/resource%d.js", i));
+    }
+
+    static char characterAt(int entry, size_t offset)
+    {
+        return 'a' + (entry + offset) % 26;
+    }
+
+    static void store(int i, size_t size = entrySize)
+    {
+        ResourceResponse response(urlForEntry(i), "text/javascript", size, "utf-8", String());
+        response.setHTTPStatusCode(200);
+        Vector<char> body(size);
+        for (size_t offset = 0; offset < size; ++offset)
+            body[offset] = characterAt(i, offset);
+        diskCache()->store(urlForEntry(i), response, SharedBuffer::adoptVector(body).get(), 3600);
+    }
+
+    // Returns false on a miss. On a hit, runs the message loop until the
+    // client has been called back.
+    static bool retrieve(int i, TestClient& client)
+    {
+        if (!diskCache()->retrieve(urlForEntry(i), &client))
+            return false;
+        webkit_support::RunMessageLoop();
+        EXPECT_TRUE(client.finished());
+        return true;
+    }
+
+    void reopen()
+    {
+        diskCache()->close();
+        ASSERT_TRUE(diskCache()->open(m_directory, capacity));
+    }
+
+    String m_directory;
+};
+
+TEST_F(DiskCacheTest, StoreAndRetrieve)
+{
+    store(0, 3000);
+
+    TestClient client;
+    ASSERT_TRUE(retrieve(0, client));
+    ASSERT_TRUE(client.succeeded());
+    EXPECT_EQ(String("text/javascript"), client.response().mimeType());
+    ASSERT_EQ(3000u, client.body()->size());
+    EXPECT_EQ(characterAt(0, 2999), client.body()->data()[2999]);
+
+    TestClient missClient;
+    EXPECT_FALSE(retrieve(1, missClient));
+    EXPECT_EQ(2u, diskCache()->statistics().lookups);
+    EXPECT_EQ(1u, diskCache()->statistics().hits);
+}
+
+TEST_F(DiskCacheTest, EvictsLeastRecentlyUsed)
+{
+    for (int i = 0; i < 9; ++i)
+        store(i);
+    EXPECT_EQ(9u, diskCache()->entryCount());
+    EXPECT_EQ(0u, diskCache()->statistics().evictions);
+
+    // Using entry 0 leaves entry 1 as the least recently used.
+    TestClient client;
+    ASSERT_TRUE(retrieve(0, client));
+    store(9);
+    EXPECT_EQ(1u, diskCache()->statistics().evictions);
+    EXPECT_LE(diskCache()->size(), capacity);
+
+    TestClient evictedClient;
+    EXPECT_FALSE(retrieve(1, evictedClient));
+    TestClient keptClient;
+    ASSERT_TRUE(retrieve(0, keptClient));
+    EXPECT_TRUE(keptClient.succeeded());
+    TestClient newClient;
+    ASSERT_TRUE(retrieve(9, newClient));
+    EXPECT_TRUE(newClient.succeeded());
+
+    // Eight blocks need the runs of entries 2 and 3, which are adjacent.
+    store(10, entrySize + 1000);
+    TestClient largeClient;
+    ASSERT_TRUE(retrieve(10, largeClient));
+    EXPECT_TRUE(largeClient.succeeded());
+    EXPECT_LE(diskCache()->size(), capacity);
+}
+
+TEST_F(DiskCacheTest, ColdStart)
+{
+    static const int entryCount = 8;
+    for (int i = 0; i < entryCount; ++i)
+        store(i);
+    reopen();
+    EXPECT_EQ(0u, diskCache()->statistics().lookups);
+
+    // Half of the lookups are for URLs that were never stored.
+    for (int i = 0; i < 2 * entryCount; ++i) {
+        TestClient client;
+        if (retrieve(i, client))
+            EXPECT_TRUE(client.succeeded());
+    }
+
+    const DiskCache::Statistics& statistics = diskCache()->statistics();
+    EXPECT_EQ(static_cast<unsigned>(entryCount), statistics.hits);
+    EXPECT_EQ(0u, statistics.readFailures);
+    printf("Cold start: %u of %u lookups hit, %.3f ms average and %.3f ms maximum latency\n",
+        statistics.hits, statistics.lookups, statistics.totalReadTime * 1000 / statistics.hits, statistics.maxReadTime * 1000);
+}
+
+TEST_F(DiskCacheTest, TornRecordIsAMiss)
+{
+    store(0);
+    diskCache()->close();
+
+    // Damage the body, as if the process died halfway through the write.
+    CString dataPath = fileSystemRepresentation(pathByAppendingComponent(m_directory, "data"));
+    int file = open(dataPath.data(), O_RDWR);
+    ASSERT_GE(file, 0);
+    char byte;
+    ASSERT_EQ(1, pread(file, &byte, 1, 4096));
+    byte ^= 0x55;
+    ASSERT_EQ(1, pwrite(file, &byte, 1, 4096));
+    ::close(file);
+
+    ASSERT_TRUE(diskCache()->open(m_directory, capacity));
+    TestClient client;
+    ASSERT_TRUE(retrieve(0, client));
+    EXPECT_FALSE(client.succeeded());
+    EXPECT_EQ(1u, diskCache()->statistics().readFailures);
+
+    // The damaged entry is gone.
+    TestClient secondClient;
+    EXPECT_FALSE(retrieve(0, secondClient));
+}
+
+#endif // OS(UNIX)
+
+} // namespace
@@ -1354,6 +1354,8 @@ void LayoutTestController::overridePreference(const CppArgumentList& arguments,
         prefs->hyperlinkAuditingEnabled = cppVariantToBool(value);
     else if (key == "WebKitEnableCaretBrowsing")
         prefs->caretBrowsingEnabled = cppVariantToBool(value);
+    else if (key == "WebKitDatabaseTransactionBatchingEnabled")
+        prefs->databaseTransactionBatchingEnabled = cppVariantToBool(value);
     else {
         string message("Invalid name for preference: ");
         message.append(key);
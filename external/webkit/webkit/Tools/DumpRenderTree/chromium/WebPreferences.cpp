@@ -89,6 +89,7 @@ void WebPreferences::reset()
     usesPageCache = false;
     webSecurityEnabled = true;
     caretBrowsingEnabled = false;
+    databaseTransactionBatchingEnabled = false;
 
     // Allow those layout tests running as local files, i.e. under
     // LayoutTests/http/tests/local, to access http server.
@@ -149,6 +150,7 @@ void WebPreferences::applyTo(WebView* webView)
     // tabbing to links by default.
     webView->setTabsToLinks(tabsToLinks);
     settings->setCaretBrowsingEnabled(caretBrowsingEnabled);
+    settings->setDatabaseTransactionBatchingEnabled(databaseTransactionBatchingEnabled);
     settings->setAcceleratedCompositingEnabled(acceleratedCompositingEnabled);
     settings->setForceCompositingMode(forceCompositingMode);
     settings->setAccelerated2dCanvasEnabled(accelerated2dCanvasEnabled);